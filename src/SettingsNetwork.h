@@ -32,6 +32,8 @@ static const QString LBL_OFFLINE = QStringLiteral("offline");
 static const QString ContentTypeNONE = QStringLiteral("");
 static const QString ContentTypeJSON = QStringLiteral("application/json");
 static const QString ContentTypeJPEG = QStringLiteral("image/jpeg");
+// ST data features in binary format (see BinaryFeatureFile)
+static const QString ContentTypeBinary = QStringLiteral("application/octet-stream");
 
 static const QString PARAM_TYPE = QStringLiteral("type");
 static const QString PARAM_DATASET = QStringLiteral("dataset");
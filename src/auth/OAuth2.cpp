@@ -6,6 +6,7 @@
 #include <QUuid>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QFutureWatcher>
 
 #include "dialogs/LoginDialog.h"
 #include "error/ServerError.h"
@@ -64,7 +65,15 @@ void OAuth2::slotEnterDialog(const QString &username, const QString &password)
 void OAuth2::requestToken(const QPair<QString, QString> &requestUser,
                           const QPair<QString, QString> &requestPassword)
 {
-    if (m_dataProxy->loadAccessToken(requestUser, requestPassword)) {
+    // the token is requested without blocking the UI
+    auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+    connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+        watcher->deleteLater();
+        if (!watcher->result().ok()) {
+            emit signalError(QSharedPointer<ServerError>(
+                new ServerError(tr("Log in Error"), tr("Wrong credentials"))));
+            return;
+        }
         const OAuth2TokenDTO &dto = m_dataProxy->getAccessToken();
         const QUuid &accessToken(dto.accessToken());
         const int expiresIn = dto.expiresIn();
@@ -76,8 +85,6 @@ void OAuth2::requestToken(const QPair<QString, QString> &requestUser,
             emit signalError(QSharedPointer<ServerError>(
                 new ServerError(tr("Log in Error"), tr("Access token is expired"), this)));
         }
-    } else {
-        emit signalError(QSharedPointer<ServerError>(
-            new ServerError(tr("Log in Error"), tr("Wrong credentials"))));
-    }
+    });
+    watcher->setFuture(m_dataProxy->loadAccessTokenAsync(requestUser, requestPassword));
 }
@@ -1,40 +1,43 @@
-/*
 #ifndef DATARENDERER_H
 #define DATARENDERER_H
 
-
 #include <QRunnable>
-#include "viewOpenGL/GeneRendererGL.h"
 
-class GeneData;
+#include "viewOpenGL/GeneRendererGL.h"
 
+// Task to compute the rendering data of a range of indexes (spots) of the
+// gene renderer concurrently (see GeneRendererGL::updateIndexes()).
+// The ranges of the tasks of an update must be disjoint so every task writes
+// to different elements of the aggregates and the GeneData arrays and no lock
+// is needed. The pooled min-max of the range is kept in the task so they can be
+// merged once all the tasks are done.
 class DataRenderer : public QRunnable
 {
 
-    DataRenderer(const int total_genes_feature,
-                 const int total_reads_feature,
-                 const bool forceSelection,
-                 GeneRendererGL::GeneInfoByIndexMap &geneInfoByIndex,
-                 GeneRendererGL::GeneInfoSelectedFeatures
-&geneInfoSelectedFeatures,
-                 int &localPooledMin,
-                 int &localPooledMax,
-                 GeneData &geneData,
-                 void (*featureReadsOusideRange)(int,int)
-                 );
+public:
+    DataRenderer(GeneRendererGL &renderer,
+                 const GeneRendererGL::IndexesList &indexes,
+                 const int begin,
+                 const int end,
+                 const bool aggregates);
+    ~DataRenderer();
 
-private:
+    void run() override;
 
-    void run();
-
-    const int m_total_genes_feature;
-    const int m_total_reads_feature;
-    const bool m_forceSelection;
-    GeneRendererGL::GeneInfoByIndexMap &m_geneInfoByIndex;
-    GeneRendererGL::GeneInfoSelectedFeatures &m_geneInfoSelectedFeatures;
-    int &m_localPooledMin;
-    int &m_localPooledMax;
-    GeneData &m_geneData;
-    void (*featureReadsOusideRange)(int,int);
+    // pooled min-max of the visible indexes of the range (valid after run())
+    int pooledMin() const;
+    int pooledMax() const;
+
+private:
+    GeneRendererGL &m_renderer;
+    const GeneRendererGL::IndexesList &m_indexes;
+    const int m_begin;
+    const int m_end;
+    const bool m_aggregates;
+    int m_pooledMin;
+    int m_pooledMax;
+
+    Q_DISABLE_COPY(DataRenderer)
 };
-*/
+
+#endif // DATARENDERER_H //
@@ -129,6 +129,49 @@ bool Configuration::has_network() const
     return !readSetting(QStringLiteral("application/url")).trimmed().isEmpty();
 }
 
+int Configuration::datasetCacheSize() const
+{
+    bool ok = false;
+    const int size = readSetting(QStringLiteral("application/cache/memory")).toInt(&ok);
+    return ok ? size : -1;
+}
+
+int Configuration::diskCacheSize() const
+{
+    bool ok = false;
+    const int size = readSetting(QStringLiteral("application/cache/disk")).toInt(&ok);
+    return ok ? size : -1;
+}
+
+const QStringList Configuration::compressedEndpoints() const
+{
+    QStringList endpoints;
+    const QStringList names
+        = readSetting(QStringLiteral("data/compression")).split(',', QString::SkipEmptyParts);
+    for (const QString &name : names) {
+        const QString endpoint = readSetting(QStringLiteral("data/endpoints/") + name.trimmed());
+        if (!endpoint.isEmpty()) {
+            endpoints.append(endpoint);
+        }
+    }
+    return endpoints;
+}
+
+const QString Configuration::networkMetricsLog() const
+{
+    return readSetting(QStringLiteral("application/telemetry/log")).trimmed();
+}
+
+bool Configuration::prefetchDatasets() const
+{
+    return readSetting(QStringLiteral("application/cache/prefetch")).trimmed() == "true";
+}
+
+bool Configuration::deltaSync() const
+{
+    return readSetting(QStringLiteral("application/sync/delta")).trimmed() == "true";
+}
+
 const QString Configuration::pathSSL() const
 {
     QDir dir(QApplication::applicationDirPath());
@@ -3,6 +3,7 @@
 
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 #include <QPointer>
 
 // Configuration is a convenience class that simplifies the access of
@@ -49,6 +50,24 @@ public:
     bool is_valid() const;
     // The path to the SSL key file if present in the configuration file
     const QString pathSSL() const;
+    // The maximum memory in MB used to cache the content of the datasets
+    // opened or -1 if it is not present in the configuration file
+    int datasetCacheSize() const;
+    // The maximum disk space in MB used to cache the network replies
+    // or -1 if it is not present in the configuration file
+    int diskCacheSize() const;
+    // The URLs of the endpoints that accept request bodies compressed with gzip
+    // (data/compression has the names of the endpoints separated by commas)
+    const QStringList compressedEndpoints() const;
+    // The file the metrics of the network requests are logged to as JSON
+    // (empty if not present in the configuration file, no log)
+    const QString networkMetricsLog() const;
+    // True if the content of the datasets selected should be downloaded in the
+    // background before they are opened (false if not present in the configuration file)
+    bool prefetchDatasets() const;
+    // True if the datasets and selections should be refreshed requesting only the
+    // changes since the last download (false if not present in the configuration file)
+    bool deltaSync() const;
 
 private:
     // reads the setting stored in the key given and returns
@@ -11,21 +11,26 @@
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QUuid>
+#include <QFutureWatcher>
+#include <QFutureInterface>
+#include <QTimer>
 
 #include "config/Configuration.h"
 #include "network/NetworkManager.h"
 #include "network/NetworkCommand.h"
 #include "network/NetworkReply.h"
 #include "network/RESTCommandFactory.h"
+#include "error/Error.h"
 #include "error/NetworkError.h"
+#include "io/BinaryFeatureFile.h"
+#include "data/DatasetPrefetcher.h"
+#include "data/OfflineStore.h"
 
 // parse objects
 #include "data/ObjectParser.h"
-#include "dataModel/ChipDTO.h"
+#include "data/ObjectBinder.h"
+#include "data/FeaturesParser.h"
 #include "dataModel/DatasetDTO.h"
-#include "dataModel/FeatureDTO.h"
-#include "dataModel/ImageAlignmentDTO.h"
-#include "dataModel/UserDTO.h"
 #include "dataModel/UserSelectionDTO.h"
 #include "dataModel/LastModifiedDTO.h"
 #include "dataModel/MinVersionDTO.h"
@@ -36,127 +41,74 @@
 #include "dataModel/Gene.h"
 #include "dataModel/ImageAlignment.h"
 #include "dataModel/User.h"
-#include "dataModel/Gene.h"
-#include "rapidjson/reader.h"
-#include "rapidjson/filereadstream.h"
-#include "rapidjson/error/en.h"
-
-#include <iostream>
-#include <sstream>
-
-using namespace rapidjson;
-
-// Handler with call backs for rapidjson
-// explicitly made to parse the Features JSON type object
-// references to the containers are passed and will be filled up
-// with the parsed objects
-// TODO move to a separate file
-struct FeaturesHandler {
-
-public:
-    FeaturesHandler(DataProxy::FeatureList &featureList,
-                    DataProxy::GeneNameToObject &geneNameToGene)
-        : featuresList(featureList)
-        , geneNameToGene(geneNameToGene)
-    {
-    }
-
-    bool Null() { return false; }
-    bool Bool(bool) { return false; }
-
-    bool Int(int i)
-    {
-        varMap.insert(currentKey, i);
-        return true;
-    }
-
-    bool Uint(int u)
-    {
-        varMap.insert(currentKey, u);
-        return true;
-    }
-
-    bool Int64(int64_t i)
-    {
-        varMap.insert(currentKey, static_cast<qlonglong>(i));
-        return true;
-    }
-
-    bool Uint64(uint64_t u)
-    {
-        varMap.insert(currentKey, static_cast<qulonglong>(u));
-        return true;
-    }
-
-    bool Double(double d)
-    {
-        varMap.insert(currentKey, d);
-        return true;
-    }
-
-    bool RawNumber(const char *, SizeType, bool) { return true; }
-
-    bool String(const char *str, SizeType length, bool)
-    {
-        Q_UNUSED(length);
-        varMap.insert(currentKey, QString(str));
-        return true;
-    }
-
-    bool StartObject()
-    {
-        varMap.clear();
-        currentKey.clear();
-        return true;
-    }
-
-    bool Key(const char *str, SizeType length, bool)
-    {
-        Q_UNUSED(length);
-        currentKey = QString(str);
-        return true;
-    }
-
-    bool EndObject(SizeType)
-    {
-        // create feature object from variant map
-        FeatureDTO dto;
-        data::parseObject(varMap, &dto);
-        auto feature = std::make_shared<Feature>(dto.feature());
-        Q_ASSERT(feature);
-
-        // get the gene name
-        const QString gene_name = feature->gene();
-        Q_ASSERT(!gene_name.isNull() && !gene_name.isEmpty());
-
-        // create unique gene object
-        if (!geneNameToGene.contains(gene_name)) {
-            geneNameToGene.insert(gene_name, std::make_shared<Gene>(Gene(gene_name)));
-        }
 
-        // update containers
-        featuresList.push_back(feature);
-
-        return true;
-    }
+namespace
+{
 
-    bool StartArray() { return true; }
-    bool EndArray(SizeType) { return true; }
+// flags of the requests of the lists that are synced (see SyncState)
+// the disk cache is not used so the server answers the validators
+NetworkManager::NetworkFlags syncFlags()
+{
+    NetworkManager::NetworkFlags flags(NetworkManager::Default);
+    flags &= ~static_cast<int>(NetworkManager::UseCache);
+    return flags;
+}
 
-private:
-    DataProxy::FeatureList &featuresList;
-    DataProxy::GeneNameToObject &geneNameToGene;
-    QString currentKey;
-    QVariantMap varMap;
-};
+// interval (in ms) of the probes of the server while working offline
+const int PROBE_INTERVAL = 30 * 1000;
+// delay (in ms) before the content of a pinned dataset is downloaded again
+const int PIN_RETRY_DELAY = 30 * 1000;
+// times the content of a pinned dataset is downloaded before giving up (until the next sync)
+const int MAX_PIN_ATTEMPTS = 3;
+}
 
 DataProxy::DataProxy(QObject *parent)
     : QObject(parent)
     , m_user(nullptr)
+    , m_featuresStream(nullptr)
+    , m_datasetCache()
+    , m_datasetSnapshots()
+    , m_datasetsSync()
+    , m_selectionsSync()
     , m_networkManager(nullptr)
+    , m_prefetcher(nullptr)
+    , m_prefetchedDatasets()
+    , m_prefetchStatistics()
+    , m_offlineStore(new OfflineStore())
+    , m_offline(false)
+    , m_pinnedUser(false)
+    , m_pinQueue()
+    , m_pinning()
+    , m_pinAttempts()
+    , m_probeTimer()
+    , m_probeReply()
+    , m_contentLoad()
 {
     m_networkManager.reset(new NetworkManager(this));
     Q_ASSERT(!m_networkManager.isNull());
+
+    m_prefetcher.reset(new DatasetPrefetcher(m_networkManager.data()));
+    connect(m_prefetcher.data(),
+            &DatasetPrefetcher::signalFinished,
+            this,
+            &DataProxy::slotPrefetchFinished);
+    connect(m_prefetcher.data(),
+            &DatasetPrefetcher::signalDiscarded,
+            this,
+            &DataProxy::slotPrefetchDiscarded);
+    connect(m_networkManager.data(),
+            &NetworkManager::signalOnlineChanged,
+            this,
+            &DataProxy::slotOnlineChanged);
+
+    // the server is probed while working offline
+    m_probeTimer.setInterval(PROBE_INTERVAL);
+    connect(&m_probeTimer, &QTimer::timeout, this, &DataProxy::slotProbe);
+
+    const int cache_size = m_configurationManager.datasetCacheSize();
+    if (cache_size >= 0) {
+        m_datasetCache.setMaxSize(cache_size * qint64(1024 * 1024));
+    }
 }
 
 DataProxy::~DataProxy()
@@ -167,17 +119,32 @@ DataProxy::~DataProxy()
 void DataProxy::clean()
 {
     qDebug() << "Cleaning memory cache in Dataproxy";
+    // stop the parsing of the features and the prefetch if any
+    // (the pinned content is kept on disk)
+    m_featuresParsing.cancel();
+    m_pinQueue.clear();
+    m_pinning.clear();
+    m_pinAttempts.clear();
+    m_prefetcher->cancel();
+    m_probeTimer.stop();
+    m_offline = false;
+    m_pinnedUser = false;
+    m_prefetchedDatasets.clear();
     // every data member is a smart pointer
     m_datasetList.clear();
     m_userSelectionList.clear();
     m_imageAlignment.reset();
     m_chip.reset();
-    m_featuresList.clear();
+    m_features = FeatureStore();
     m_cellTissueImages.clear();
     m_minVersion = MinVersionArray();
     m_accessToken = OAuth2TokenDTO();
     m_user.reset();
-    m_geneNameToObject.clear();
+    m_geneDictionary.clear();
+    m_geneObjects.clear();
+    m_datasetCache.clear();
+    m_datasetsSync.clear();
+    m_selectionsSync.clear();
 }
 
 void DataProxy::cleanAll()
@@ -185,6 +152,7 @@ void DataProxy::cleanAll()
     qDebug() << "Cleaning memory cache and disk cache in Dataproxy";
     clean();
     m_networkManager->cleanCache();
+    m_datasetSnapshots.clear();
 }
 
 const DataProxy::DatasetList &DataProxy::getDatasetList() const
@@ -206,17 +174,45 @@ const DataProxy::DatasetPtr DataProxy::getDatasetById(const QString &datasetId)
 
 const DataProxy::GeneList DataProxy::getGeneList() const
 {
-    return m_geneNameToObject.values();
+    return m_geneObjects.toList();
 }
 
 DataProxy::GenePtr DataProxy::geneGeneObject(const QString &gene_name) const
 {
-    return m_geneNameToObject.value(gene_name);
+    return geneObject(m_geneDictionary.id(gene_name));
+}
+
+DataProxy::GenePtr DataProxy::geneObject(const GeneDictionary::GeneId geneId) const
+{
+    return geneId < static_cast<GeneDictionary::GeneId>(m_geneObjects.size())
+               ? m_geneObjects.at(geneId)
+               : nullptr;
+}
+
+const GeneDictionary &DataProxy::geneDictionary() const
+{
+    return m_geneDictionary;
 }
 
-const DataProxy::FeatureList &DataProxy::getFeatureList() const
+const DataProxy::FeatureList DataProxy::getFeatureList() const
 {
-    return m_featuresList;
+    return FeatureList(m_features);
+}
+
+const DataProxy::FeatureList DataProxy::getGeneFeatureList(const QString &geneName) const
+{
+    const GeneDictionary::GeneId gene_id = m_geneDictionary.id(geneName);
+    QVector<FeatureStore::FeatureIndex> indexes;
+    if (gene_id != GeneDictionary::INVALID_ID) {
+        // linear scan of the gene IDs column
+        const QVector<GeneDictionary::GeneId> &gene_ids = m_features.geneIds();
+        for (int i = 0; i < gene_ids.size(); ++i) {
+            if (gene_ids.at(i) == gene_id) {
+                indexes.push_back(static_cast<FeatureStore::FeatureIndex>(i));
+            }
+        }
+    }
+    return FeatureList(m_features, indexes);
 }
 
 const DataProxy::UserPtr DataProxy::getUser() const
@@ -265,22 +261,28 @@ const OAuth2TokenDTO DataProxy::getAccessToken() const
 
 bool DataProxy::loadDatasets()
 {
-    // clean up container (only datasets downloaded from network)
-    m_datasetList.erase(std::remove_if(m_datasetList.begin(),
-                                       m_datasetList.end(),
-                                       [](DatasetPtr dataset) { return dataset->downloaded(); }),
-                        m_datasetList.end());
-    // creates the request
-    const auto cmd = RESTCommandFactory::getDatasets(m_configurationManager);
-    auto reply = m_networkManager->httpRequest(cmd);
+    // the pinned datasets are used when working offline
+    if (m_offline) {
+        return true;
+    }
     // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::DatasetsDownloaded);
+    return finishRequest(requestDatasets(), DataProxy::DatasetsDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadDatasetsAsync()
+{
+    if (m_offline) {
+        return finishedRequest(DataProxy::DatasetsDownloaded);
     }
-    // returns status
-    return status_download && status_parsing;
+    return finishRequestAsync(requestDatasets(), DataProxy::DatasetsDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestDatasets()
+{
+    // creates the request (with the validators of the last download)
+    const auto cmd = RESTCommandFactory::getDatasets(m_configurationManager);
+    m_datasetsSync.prepare(*cmd, m_configurationManager.deltaSync());
+    return m_networkManager->httpRequest(cmd, syncFlags());
 }
 
 bool DataProxy::addDataset(const Dataset &dataset)
@@ -295,22 +297,24 @@ bool DataProxy::addDataset(const Dataset &dataset)
 }
 
 bool DataProxy::updateDataset(const Dataset &dataset)
+{
+    // create the download request (sync)
+    return finishRequest(requestUpdateDataset(dataset), DataProxy::DatasetModified);
+}
+
+DataProxy::RequestFuture DataProxy::updateDatasetAsync(const Dataset &dataset)
+{
+    return finishRequestAsync(requestUpdateDataset(dataset), DataProxy::DatasetModified);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestUpdateDataset(const Dataset &dataset)
 {
     // intermediary dto object
     DatasetDTO dto(dataset);
     auto cmd = RESTCommandFactory::updateDatasetByDatasetId(m_configurationManager, dataset.id());
     // append json data
     cmd->setBody(dto.toJson());
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        qDebug() << "Dataset " << dataset.id() << " edited";
-        status_parsing = parseRequest(reply, DataProxy::DatasetModified);
-    }
-    // returns status
-    return status_download && status_parsing;
+    return m_networkManager->httpRequest(cmd);
 }
 
 bool DataProxy::removeDataset(const QString &datasetId, const bool is_downloaded)
@@ -319,19 +323,25 @@ bool DataProxy::removeDataset(const QString &datasetId, const bool is_downloaded
         // the dataset was imported locally..
         return parseRemoveDataset(datasetId);
     }
+    // create the download request (sync)
+    return finishRequest(requestRemoveDataset(datasetId), DataProxy::DatasetRemoved);
+}
+
+DataProxy::RequestFuture DataProxy::removeDatasetAsync(const QString &datasetId)
+{
+    return finishRequestAsync(requestRemoveDataset(datasetId), DataProxy::DatasetRemoved);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestRemoveDataset(const QString &datasetId)
+{
     const auto cmd
         = RESTCommandFactory::removeDatasetByDatasetId(m_configurationManager, datasetId);
     auto reply = m_networkManager->httpRequest(cmd);
-    // add dataset ID to the reply metaproperty
-    reply->setProperty("dataset_id", QVariant::fromValue<QString>(datasetId));
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::DatasetRemoved);
+    if (reply != nullptr) {
+        // add dataset ID to the reply metaproperty
+        reply->setProperty("dataset_id", QVariant::fromValue<QString>(datasetId));
     }
-    // returns status
-    return status_download && status_parsing;
+    return reply;
 }
 
 bool DataProxy::loadDatasetContent(const DatasetPtr dataset)
@@ -340,59 +350,412 @@ bool DataProxy::loadDatasetContent(const DatasetPtr dataset)
         return false;
     }
 
-    // load image alignment
-    const bool image_alignment = loadImageAlignment(dataset->imageAlignmentId());
-    if (!image_alignment || !m_imageAlignment) {
+    // the prefetch running is canceled so it does not take bandwidth
+    // (loadDatasetContentAsync waits for the prefetch of the dataset instead)
+    m_prefetcher->cancel();
+    if (loadCachedDatasetContent(dataset)) {
+        return true;
+    }
+    cancelContentLoad();
+
+    // the features do not depend on anything so they are requested first
+    // (they are the biggest download and they are parsed while they arrive)
+    const auto features_reply = requestFeatures(dataset->id());
+
+    // the content is downloaded into its own containers so the current one
+    // is kept if anything fails
+    DatasetContentCache::Content loaded;
+
+    // load image alignment (the figures and the chip depend on it)
+    const bool image_alignment
+        = finishContentRequest(requestImageAlignment(dataset->imageAlignmentId()),
+                               DataProxy::ImageAlignmentDownloaded,
+                               loaded);
+    if (!image_alignment || !loaded.imageAlignment) {
         qDebug() << "Error downloading image alignment...";
+        abortFeaturesRequest(features_reply);
         return false;
     }
 
-    // load cell tissue figure one and two
-    const bool image_one = loadCellTissueByName(m_imageAlignment->figureBlue());
-    bool image_two = true;
-    if (image_one && m_user->hasSpecialRole()) {
-        // load cell tissue two (no need to download it for role USER)
-        image_two = loadCellTissueByName(m_imageAlignment->figureRed());
+    // request cell tissue figure one and two and the chip in parallel
+    // (the requests are pipelined and they download while the others are waited for)
+    const auto image_one_reply = requestCellTissueByName(loaded.imageAlignment->figureBlue());
+    // load cell tissue two (no need to download it for role USER)
+    const bool load_image_two = m_user->hasSpecialRole();
+    QSharedPointer<NetworkReply> image_two_reply;
+    if (load_image_two) {
+        image_two_reply = requestCellTissueByName(loaded.imageAlignment->figureRed());
     }
+    const auto chip_reply = requestChip(loaded.imageAlignment->chipId());
 
+    const bool image_one
+        = finishContentRequest(image_one_reply, DataProxy::TissueImageDownloaded, loaded);
+    const bool image_two
+        = !load_image_two
+          || finishContentRequest(image_two_reply, DataProxy::TissueImageDownloaded, loaded);
     if (!image_one || !image_two) {
         qDebug() << "Error downloading images...";
+        abortFeaturesRequest(features_reply);
+        if (chip_reply != nullptr) {
+            chip_reply->slotAbort();
+        }
+        return false;
+    }
+
+    // load chip
+    const bool chip = finishContentRequest(chip_reply, DataProxy::ChipDownloaded, loaded);
+    if (!chip) {
+        qDebug() << "Error downloading chip...";
+        abortFeaturesRequest(features_reply);
         return false;
     }
 
-    // load features
-    const bool features = loadFeatures(dataset->id());
+    // load features (they are only replaced if they are parsed)
+    const bool features = finishFeaturesRequest(features_reply);
     if (!features) {
         qDebug() << "Error downloading st data features...";
         return false;
     }
 
-    // load chip
-    const bool chip = loadChip(m_imageAlignment->chipId());
-    if (!chip) {
-        qDebug() << "Error downloading chip...";
+    // everything has been downloaded so the rest of the content is replaced
+    setDownloadedContent(dataset, loaded);
+    return true;
+}
+
+bool DataProxy::loadCachedDatasetContent(const DatasetPtr dataset)
+{
+    // the content is taken from the caches (memory first and then disk) if the
+    // dataset has not been modified (datasets without lastModified are not cached)
+    if (dataset->lastModified().isEmpty()) {
         return false;
     }
+    DatasetContentCache::Content content;
+    if (m_datasetCache.find(dataset->id(), dataset->lastModified(), content)) {
+        setDatasetContent(content);
+        storePinnedContent(dataset->id(), content);
+        if (m_prefetchedDatasets.remove(dataset->id())) {
+            ++m_prefetchStatistics.hits;
+            qDebug() << "[DataProxy] Dataset content prefetched, hit rate "
+                     << m_prefetchStatistics.hitRate();
+        }
+        qDebug() << "[DataProxy] Dataset content taken from the cache, hits "
+                 << m_datasetCache.statistics().hits << " misses "
+                 << m_datasetCache.statistics().misses;
+        return true;
+    }
+    if (m_offlineStore->readContent(dataset->id(), dataset->lastModified(), content)) {
+        setDatasetContent(content);
+        m_datasetCache.insert(dataset->id(), content);
+        qDebug() << "[DataProxy] Dataset content taken from the pinned content";
+        return true;
+    }
+    if (m_datasetSnapshots.read(dataset->id(), dataset->lastModified(), content)) {
+        setDatasetContent(content);
+        m_datasetCache.insert(dataset->id(), content);
+        storePinnedContent(dataset->id(), content);
+        qDebug() << "[DataProxy] Dataset content taken from the snapshot on disk";
+        return true;
+    }
+    return false;
+}
 
-    return true;
+void DataProxy::setDownloadedContent(const DatasetPtr dataset,
+                                     const DatasetContentCache::Content &loaded)
+{
+    m_imageAlignment = loaded.imageAlignment;
+    m_chip = loaded.chip;
+    for (auto it = loaded.images.constBegin(); it != loaded.images.constEnd(); ++it) {
+        m_cellTissueImages.insert(it.key(), it.value());
+    }
+
+    if (!dataset->lastModified().isEmpty()) {
+        const DatasetContentCache::Content loaded_content = datasetContent(dataset);
+        m_datasetCache.insert(dataset->id(), loaded_content);
+        // the snapshots are written in a worker thread
+        m_datasetSnapshots.writeAsync(dataset->id(), loaded_content);
+        storePinnedContent(dataset->id(), loaded_content);
+    }
+}
+
+// the state of the download of the content of a dataset (see loadDatasetContentAsync)
+struct DataProxy::ContentLoad {
+    ContentLoad()
+        : futureInterface()
+        , dataset()
+        , loaded()
+        , alignmentReply()
+        , featuresReply()
+        , contentReplies()
+        , features()
+        , featuresWatcher(nullptr)
+        , connections()
+        , finished(false)
+    {
+    }
+
+    QFutureInterface<RequestResult> futureInterface;
+    DatasetPtr dataset;
+    // the content is downloaded into its own containers so the current one
+    // is kept if anything fails
+    DatasetContentCache::Content loaded;
+    QSharedPointer<NetworkReply> alignmentReply;
+    QSharedPointer<NetworkReply> featuresReply;
+    // the figures and the chip (requested once the alignment has been parsed)
+    QList<QPair<QSharedPointer<NetworkReply>, DownloadType>> contentReplies;
+    // the parsing of the features, it is finished in a worker thread once they
+    // are downloaded (see FeaturesStreamParser::finishAsync)
+    QFuture<data::ParsedFeatures> features;
+    QFutureWatcher<data::ParsedFeatures> *featuresWatcher;
+    // the connections to the replies (removed once the load has finished)
+    QList<QMetaObject::Connection> connections;
+    bool finished;
+};
+
+DataProxy::RequestFuture DataProxy::loadDatasetContentAsync(const DatasetPtr dataset)
+{
+    if (!dataset || !m_user) {
+        return finishedRequest(DataProxy::DatasetContentDownloaded,
+                               QSharedPointer<Error>(new Error(
+                                   tr("Error downloading data"),
+                                   tr("The content of the dataset could not be loaded."))));
+    }
+
+    // the content is loaded once the prefetch of the dataset has finished
+    // (it is then in the memory cache) or it has been discarded
+    if (m_prefetcher->isRunning() && m_prefetcher->datasetId() == dataset->id()) {
+        QFutureInterface<RequestResult> futureInterface;
+        futureInterface.reportStarted();
+        const RequestFuture future = futureInterface.future();
+
+        // the connections are removed once the prefetch has finished
+        auto connections = QSharedPointer<QList<QMetaObject::Connection>>::create();
+        auto prefetched = [=]() {
+            for (const QMetaObject::Connection &connection : *connections) {
+                disconnect(connection);
+            }
+            // the prefetcher is not used while it is notifying
+            QTimer::singleShot(0, this, [=]() mutable {
+                auto watcher = new QFutureWatcher<RequestResult>(this);
+                connect(watcher, &QFutureWatcher<RequestResult>::finished, this, [=]() mutable {
+                    futureInterface.reportResult(watcher->result());
+                    futureInterface.reportFinished();
+                    watcher->deleteLater();
+                });
+                watcher->setFuture(loadDatasetContentAsync(dataset));
+            });
+        };
+        connections->append(
+            connect(m_prefetcher.data(), &DatasetPrefetcher::signalFinished, this, prefetched));
+        connections->append(
+            connect(m_prefetcher.data(), &DatasetPrefetcher::signalDiscarded, this, prefetched));
+        return future;
+    }
+
+    // the prefetch running is canceled so it does not take bandwidth
+    m_prefetcher->cancel();
+    if (loadCachedDatasetContent(dataset)) {
+        return finishedRequest(DataProxy::DatasetContentDownloaded);
+    }
+
+    cancelContentLoad();
+
+    // the features do not depend on anything so they are requested first
+    // (they are the biggest download and they are parsed while they arrive),
+    // the figures and the chip are requested once the alignment has been parsed
+    // (see continueContentLoad)
+    QSharedPointer<ContentLoad> load(new ContentLoad());
+    load->futureInterface.reportStarted();
+    load->dataset = dataset;
+    load->featuresReply = requestFeatures(dataset->id());
+    load->alignmentReply = requestImageAlignment(dataset->imageAlignmentId());
+    m_contentLoad = load;
+    watchContentReply(load, load->featuresReply);
+    watchContentReply(load, load->alignmentReply);
+    const RequestFuture future = load->futureInterface.future();
+    continueContentLoad(load);
+    return future;
+}
+
+void DataProxy::watchContentReply(QSharedPointer<ContentLoad> load,
+                                  QSharedPointer<NetworkReply> reply)
+{
+    if (reply == nullptr || reply->isFinished()) {
+        return;
+    }
+    load->connections.append(connect(reply.data(),
+                                     &NetworkReply::signalFinished,
+                                     this,
+                                     [this, load]() { continueContentLoad(load); }));
+}
+
+void DataProxy::continueContentLoad(QSharedPointer<ContentLoad> load)
+{
+    if (load->finished) {
+        return;
+    }
+
+    // the features are downloaded first, the rest of their parsing runs in a worker
+    // thread while the other content is parsed (they are only replaced if they are parsed)
+    if (load->featuresWatcher == nullptr
+        && (load->featuresReply == nullptr || load->featuresReply->isFinished())) {
+        const QSharedPointer<Error> error = networkError(load->featuresReply);
+        if (!error.isNull()) {
+            qDebug() << "Error downloading st data features...";
+            finishContentLoad(load, error);
+            return;
+        }
+        Q_ASSERT(!m_featuresStream.isNull());
+        m_featuresStream->append(load->featuresReply->getRaw());
+        m_featuresStream->finishAsync();
+        load->features = m_featuresStream->future();
+        load->featuresReply.clear();
+        load->featuresWatcher = new QFutureWatcher<data::ParsedFeatures>(this);
+        load->connections.append(connect(load->featuresWatcher,
+                                         &QFutureWatcherBase::finished,
+                                         this,
+                                         [this, load]() { continueContentLoad(load); }));
+        load->featuresWatcher->setFuture(load->features);
+    }
+
+    // the image alignment (the figures and the chip depend on it)
+    if (!load->loaded.imageAlignment) {
+        if (load->alignmentReply != nullptr && !load->alignmentReply->isFinished()) {
+            return;
+        }
+        QSharedPointer<Error> error
+            = replyError(load->alignmentReply, DataProxy::ImageAlignmentDownloaded, &load->loaded);
+        if (error.isNull() && !load->loaded.imageAlignment) {
+            error.reset(new Error(tr("Error downloading data"),
+                                  tr("The image alignment of the dataset is not valid.")));
+        }
+        if (!error.isNull()) {
+            qDebug() << "Error downloading image alignment...";
+            finishContentLoad(load, error);
+            return;
+        }
+
+        // request cell tissue figure one and two and the chip in parallel
+        // (no need to download the figure two for role USER)
+        const ImageAlignmentPtr alignment = load->loaded.imageAlignment;
+        load->contentReplies.append(qMakePair(requestCellTissueByName(alignment->figureBlue()),
+                                              DataProxy::TissueImageDownloaded));
+        if (m_user && m_user->hasSpecialRole()) {
+            load->contentReplies.append(
+                qMakePair(requestCellTissueByName(alignment->figureRed()),
+                          DataProxy::TissueImageDownloaded));
+        }
+        load->contentReplies.append(
+            qMakePair(requestChip(alignment->chipId()), DataProxy::ChipDownloaded));
+        for (const auto &content_reply : load->contentReplies) {
+            watchContentReply(load, content_reply.first);
+        }
+    }
+
+    // the figures and the chip (parsed once all of them have finished)
+    for (const auto &content_reply : load->contentReplies) {
+        if (content_reply.first != nullptr && !content_reply.first->isFinished()) {
+            return;
+        }
+    }
+    for (const auto &content_reply : load->contentReplies) {
+        const QSharedPointer<Error> error
+            = replyError(content_reply.first, content_reply.second, &load->loaded);
+        if (!error.isNull()) {
+            qDebug() << "Error downloading images or chip...";
+            finishContentLoad(load, error);
+            return;
+        }
+    }
+    load->contentReplies.clear();
+
+    // the features (they are only replaced if they are parsed)
+    if (load->featuresReply != nullptr || !load->features.isFinished()) {
+        return;
+    }
+    m_featuresStream.reset();
+    if (load->features.resultCount() == 0) {
+        qDebug() << "[DataProxy] The parsing of the features failed or was canceled";
+        finishContentLoad(
+            load,
+            QSharedPointer<Error>(new Error(
+                tr("Error parsing data"),
+                tr("There was an error parsing the data object from the remote server"))));
+        return;
+    }
+    data::ParsedFeatures parsed = load->features.result();
+    setFeatures(parsed);
+
+    // everything has been downloaded so the rest of the content is replaced
+    setDownloadedContent(load->dataset, load->loaded);
+    finishContentLoad(load, QSharedPointer<Error>());
+}
+
+void DataProxy::cancelContentLoad()
+{
+    // only one content is downloaded at a time (the features stream is shared)
+    if (m_contentLoad) {
+        finishContentLoad(m_contentLoad,
+                          QSharedPointer<Error>(new Error(
+                              tr("Error downloading data"),
+                              tr("The loading of the dataset was replaced by another one."))));
+    }
+}
+
+void DataProxy::finishContentLoad(QSharedPointer<ContentLoad> load, QSharedPointer<Error> error)
+{
+    load->finished = true;
+    for (const QMetaObject::Connection &connection : load->connections) {
+        disconnect(connection);
+    }
+    load->connections.clear();
+    // the requests left are aborted (the current features are kept)
+    if (load->featuresReply != nullptr) {
+        abortFeaturesRequest(load->featuresReply);
+    }
+    for (const auto &content_reply : load->contentReplies) {
+        if (content_reply.first != nullptr) {
+            content_reply.first->slotAbort();
+        }
+    }
+    load->featuresReply.clear();
+    load->alignmentReply.clear();
+    load->contentReplies.clear();
+    if (load->featuresWatcher != nullptr) {
+        // the parsing in flight is canceled
+        if (!m_featuresStream.isNull() && m_featuresStream->future() == load->features) {
+            abortFeaturesRequest(QSharedPointer<NetworkReply>());
+        }
+        load->featuresWatcher->deleteLater();
+        load->featuresWatcher = nullptr;
+    }
+    if (m_contentLoad == load) {
+        m_contentLoad.clear();
+    }
+
+    load->futureInterface.reportResult(
+        RequestResult(DataProxy::DatasetContentDownloaded, error));
+    load->futureInterface.reportFinished();
 }
 
 bool DataProxy::loadChip(const QString &chipId)
+{
+    // create the download request (sync)
+    return finishRequest(requestChip(chipId), DataProxy::ChipDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadChipAsync(const QString &chipId)
+{
+    return finishRequestAsync(requestChip(chipId), DataProxy::ChipDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestChip(const QString &chipId)
 {
     Q_ASSERT(!chipId.isNull() && !chipId.isEmpty());
-    // clear container
-    m_chip.reset();
-    // creates the request
+    // creates the request (the current chip is replaced once it is parsed)
     const auto cmd = RESTCommandFactory::getChipByChipId(m_configurationManager, chipId);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::ChipDownloaded);
-    }
-    // returns status
-    return status_download && status_parsing;
+    return m_networkManager->httpRequest(cmd,
+                                         NetworkManager::Default,
+                                         NetworkManager::VisibleContent);
 }
 
 bool DataProxy::loadChip(const Chip &chip)
@@ -402,97 +765,187 @@ bool DataProxy::loadChip(const Chip &chip)
 }
 
 bool DataProxy::loadFeatures(const QString &datasetId)
+{
+    // NOTE the containers are only replaced if the parsing succeeds
+    // create the download request (sync)
+    return finishFeaturesRequest(requestFeatures(datasetId));
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestFeatures(const QString &datasetId)
 {
     Q_ASSERT(!datasetId.isNull() && !datasetId.isEmpty());
-    // clear the containers
-    m_geneNameToObject.clear();
-    m_featuresList.clear();
     // creates the request
     const auto cmd = RESTCommandFactory::getFeatureByDatasetId(m_configurationManager, datasetId);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::FeaturesDownloaded);
+    auto reply = m_networkManager->httpRequest(cmd,
+                                               NetworkManager::Default | NetworkManager::UseRanges,
+                                               NetworkManager::VisibleContent);
+    if (reply == nullptr) {
+        return reply;
+    }
+
+    // the data is parsed as it arrives (the download is aborted if the
+    // parsing fails or it is canceled)
+    m_featuresStream.reset(new data::FeaturesStreamParser());
+    NetworkReply *network_reply = reply.data();
+    // the data is only given to the parser the reply was started for (the
+    // future keeps its state alive so another parser cannot be taken for it)
+    const QFuture<data::ParsedFeatures> stream_future = m_featuresStream->future();
+    connect(network_reply, &NetworkReply::signalDataAvailable, this, [=]() {
+        if (m_featuresStream.isNull() || m_featuresStream->future() != stream_future) {
+            return;
+        }
+        m_featuresStream->setTotalSize(network_reply->contentLength());
+        if (!m_featuresStream->append(network_reply->getRaw())) {
+            network_reply->slotAbort();
+        }
+    });
+    // the watcher is owned by the reply
+    auto watcher = new QFutureWatcher<data::ParsedFeatures>(network_reply);
+    connect(watcher, SIGNAL(canceled()), network_reply, SLOT(slotAbort()));
+    watcher->setFuture(m_featuresStream->future());
+    m_featuresParsing = m_featuresStream->future();
+    emit signalFeaturesParsing(m_featuresParsing);
+    return reply;
+}
+
+bool DataProxy::finishFeaturesRequest(QSharedPointer<NetworkReply> reply)
+{
+    const bool status = finishRequest(reply, DataProxy::FeaturesDownloaded);
+    m_featuresStream.reset();
+    return status;
+}
+
+void DataProxy::abortFeaturesRequest(QSharedPointer<NetworkReply> reply)
+{
+    // the current features are kept
+    m_featuresStream.reset();
+    if (reply != nullptr) {
+        reply->slotAbort();
     }
-    // returns status
-    return status_download && status_parsing;
 }
 
 bool DataProxy::loadFeatures(const QByteArray &rawData)
 {
-    // clear the containers
-    m_geneNameToObject.clear();
-    m_featuresList.clear();
     return parseFeatures(rawData);
 }
 
-bool DataProxy::loadImageAlignment(const QString &imageAlignmentId)
+bool DataProxy::loadFeatures(const BinaryFeatureFile &file)
 {
-    Q_ASSERT(!imageAlignmentId.isNull() && !imageAlignmentId.isEmpty());
-    // clear container
-    m_imageAlignment.reset();
-    // creates the request
-    const auto cmd
-        = RESTCommandFactory::getImageAlignmentById(m_configurationManager, imageAlignmentId);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::ImageAlignmentDownloaded);
+    // binary files do not need parsing so they are loaded synchronously
+    data::ParsedFeatures parsed;
+    if (!data::parseFeatures(file, parsed)) {
+        return false;
     }
-    // returns status
-    return status_download && status_parsing;
+    setFeatures(parsed);
+    return true;
 }
 
-bool DataProxy::loadImageAlignment(const ImageAlignment &alignment)
+void DataProxy::cancelFeaturesParsing()
 {
-    m_imageAlignment = std::make_shared<ImageAlignment>(alignment);
-    return m_imageAlignment != nullptr;
+    m_featuresParsing.cancel();
 }
 
-bool DataProxy::loadUser()
+bool DataProxy::loadImageAlignment(const QString &imageAlignmentId)
 {
-    // clear container
-    m_user.reset();
-    // creates the requet
-    const auto cmd = RESTCommandFactory::getUser(m_configurationManager);
-    auto reply = m_networkManager->httpRequest(cmd);
     // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::UserDownloaded);
+    return finishRequest(requestImageAlignment(imageAlignmentId),
+                         DataProxy::ImageAlignmentDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadImageAlignmentAsync(const QString &imageAlignmentId)
+{
+    return finishRequestAsync(requestImageAlignment(imageAlignmentId),
+                              DataProxy::ImageAlignmentDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestImageAlignment(const QString &imageAlignmentId)
+{
+    Q_ASSERT(!imageAlignmentId.isNull() && !imageAlignmentId.isEmpty());
+    // creates the request (the current alignment is replaced once it is parsed)
+    const auto cmd
+        = RESTCommandFactory::getImageAlignmentById(m_configurationManager, imageAlignmentId);
+    return m_networkManager->httpRequest(cmd,
+                                         NetworkManager::Default,
+                                         NetworkManager::VisibleContent);
+}
+
+bool DataProxy::loadImageAlignment(const ImageAlignment &alignment)
+{
+    m_imageAlignment = std::make_shared<ImageAlignment>(alignment);
+    return m_imageAlignment != nullptr;
+}
+
+bool DataProxy::loadUser()
+{
+    // the pinned user is used when working offline
+    if (m_offline && m_user) {
+        return true;
     }
-    // returns status
-    return status_download && status_parsing;
+    // create the download request (sync)
+    return finishRequest(requestUser(), DataProxy::UserDownloaded);
 }
 
-bool DataProxy::loadUserSelections()
+DataProxy::RequestFuture DataProxy::loadUserAsync()
 {
-    // clean up currently download selections
-    m_userSelectionList.erase(std::remove_if(m_userSelectionList.begin(),
-                                             m_userSelectionList.end(),
-                                             [](UserSelectionPtr selection) {
-                                  return selection->saved();
-                              }),
-                              m_userSelectionList.end());
+    if (m_offline && m_user) {
+        return finishedRequest(DataProxy::UserDownloaded);
+    }
+    return finishRequestAsync(requestUser(), DataProxy::UserDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestUser()
+{
+    // clear container (the profile loaded from the store is used until the
+    // user is parsed, see loadCachedUser)
+    if (!m_pinnedUser) {
+        m_user.reset();
+    }
     // creates the requet
-    const auto cmd = RESTCommandFactory::getSelections(m_configurationManager);
-    auto reply = m_networkManager->httpRequest(cmd);
+    const auto cmd = RESTCommandFactory::getUser(m_configurationManager);
+    return m_networkManager->httpRequest(cmd);
+}
+
+bool DataProxy::loadUserSelections()
+{
+    // the pinned selections are used when working offline
+    if (m_offline) {
+        return true;
+    }
     // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::UserSelectionsDownloaded);
+    return finishRequest(requestUserSelections(), DataProxy::UserSelectionsDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadUserSelectionsAsync()
+{
+    if (m_offline) {
+        return finishedRequest(DataProxy::UserSelectionsDownloaded);
     }
-    // returns status
-    return status_download && status_parsing;
+    return finishRequestAsync(requestUserSelections(), DataProxy::UserSelectionsDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestUserSelections()
+{
+    // creates the requet (with the validators of the last download)
+    const auto cmd = RESTCommandFactory::getSelections(m_configurationManager);
+    m_selectionsSync.prepare(*cmd, m_configurationManager.deltaSync());
+    return m_networkManager->httpRequest(cmd, syncFlags());
 }
 
 bool DataProxy::updateUserSelection(const UserSelection &userSelection)
+{
+    // create the download request (sync)
+    return finishRequest(requestUpdateUserSelection(userSelection),
+                         DataProxy::UserSelectionModified);
+}
+
+DataProxy::RequestFuture DataProxy::updateUserSelectionAsync(const UserSelection &userSelection)
+{
+    return finishRequestAsync(requestUpdateUserSelection(userSelection),
+                              DataProxy::UserSelectionModified);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestUpdateUserSelection(
+    const UserSelection &userSelection)
 {
     // intermediary dto object
     UserSelectionDTO dto(userSelection);
@@ -500,15 +953,7 @@ bool DataProxy::updateUserSelection(const UserSelection &userSelection)
                                                                userSelection.id());
     // append json data
     cmd->setBody(dto.toJson());
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::UserSelectionModified);
-    }
-    // returns status
-    return status_download && status_parsing;
+    return m_networkManager->httpRequest(cmd);
 }
 
 bool DataProxy::addUserSelection(const UserSelection &userSelection, bool save)
@@ -522,21 +967,25 @@ bool DataProxy::addUserSelection(const UserSelection &userSelection, bool save)
             return false;
         }
     }
+    // create the download request (sync)
+    return finishRequest(requestAddUserSelection(userSelection), DataProxy::UserSelectionModified);
+}
+
+DataProxy::RequestFuture DataProxy::addUserSelectionAsync(const UserSelection &userSelection)
+{
+    return finishRequestAsync(requestAddUserSelection(userSelection),
+                              DataProxy::UserSelectionModified);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestAddUserSelection(const UserSelection &userSelection)
+{
     // intermediary dto object
     UserSelectionDTO dto(userSelection);
     auto cmd = RESTCommandFactory::addSelection(m_configurationManager);
     // append json data
     const QByteArray &body = dto.toJson();
     cmd->setBody(body);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::UserSelectionModified);
-    }
-    // returns status
-    return status_download && status_parsing;
+    return m_networkManager->httpRequest(cmd);
 }
 
 bool DataProxy::removeSelection(const QString &selectionId, const bool is_downloaded)
@@ -544,80 +993,212 @@ bool DataProxy::removeSelection(const QString &selectionId, const bool is_downlo
     if (!is_downloaded) {
         return parseRemoveUserSelection(selectionId);
     }
+    // create the download request (sync)
+    return finishRequest(requestRemoveSelection(selectionId), DataProxy::UserSelectionRemoved);
+}
+
+DataProxy::RequestFuture DataProxy::removeSelectionAsync(const QString &selectionId)
+{
+    return finishRequestAsync(requestRemoveSelection(selectionId),
+                              DataProxy::UserSelectionRemoved);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestRemoveSelection(const QString &selectionId)
+{
     const auto cmd
         = RESTCommandFactory::removeSelectionBySelectionId(m_configurationManager, selectionId);
     auto reply = m_networkManager->httpRequest(cmd);
-    // add the selection id to the reply
-    reply->setProperty("selection_id", QVariant::fromValue<QString>(selectionId));
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::UserSelectionRemoved);
+    if (reply != nullptr) {
+        // add the selection id to the reply
+        reply->setProperty("selection_id", QVariant::fromValue<QString>(selectionId));
     }
-    // returns status
-    return status_download && status_parsing;
+    return reply;
 }
 
 bool DataProxy::loadCellTissueByName(const QString &name)
 {
-    // remove image if already exists and add the newly created one
-    m_cellTissueImages.remove(name);
+    // create the download request (sync)
+    return finishRequest(requestCellTissueByName(name), DataProxy::TissueImageDownloaded);
+}
 
-    // creates the request
+DataProxy::RequestFuture DataProxy::loadCellTissueByNameAsync(const QString &name)
+{
+    return finishRequestAsync(requestCellTissueByName(name), DataProxy::TissueImageDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestCellTissueByName(const QString &name)
+{
+    // creates the request (the current image is replaced once it is parsed)
     const auto cmd = RESTCommandFactory::getCellTissueFigureByName(m_configurationManager, name);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // add figure name to reply metaproperty
-    reply->setProperty("figure_name", QVariant::fromValue<QString>(name));
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::TissueImageDownloaded);
+    auto reply = m_networkManager->httpRequest(cmd,
+                                               NetworkManager::Default | NetworkManager::UseRanges,
+                                               NetworkManager::VisibleContent);
+    if (reply != nullptr) {
+        // add figure name to reply metaproperty
+        reply->setProperty("figure_name", QVariant::fromValue<QString>(name));
     }
-    // returns status
-    return status_download && status_parsing;
+    return reply;
 }
 
 bool DataProxy::loadCellTissueImage(const QByteArray &rawData, const QString &imageName)
 {
-    return parseCellTissueImage(rawData, imageName);
+    return parseCellTissueImage(rawData, imageName, m_cellTissueImages);
 }
 
 bool DataProxy::loadMinVersion()
+{
+    // create the download request (sync)
+    return finishRequest(requestMinVersion(), DataProxy::MinVersionDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadMinVersionAsync()
+{
+    return finishRequestAsync(requestMinVersion(), DataProxy::MinVersionDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestMinVersion()
 {
     const auto cmd = RESTCommandFactory::getMinVersion(m_configurationManager);
     // send empty flags to ensure access token is not appended to request
-    auto reply = m_networkManager->httpRequest(cmd, NetworkManager::Empty);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::MinVersionDownloaded);
-    }
-    // returns status
-    return status_download && status_parsing;
+    return m_networkManager->httpRequest(cmd, NetworkManager::Empty);
 }
 
 bool DataProxy::loadAccessToken(const QPair<QString, QString> &username,
                                 const QPair<QString, QString> &password)
+{
+    // create the download request (sync)
+    return finishRequest(requestAccessToken(username, password), DataProxy::AccessTokenDownloaded);
+}
+
+DataProxy::RequestFuture DataProxy::loadAccessTokenAsync(const QPair<QString, QString> &username,
+                                                         const QPair<QString, QString> &password)
+{
+    return finishRequestAsync(requestAccessToken(username, password),
+                              DataProxy::AccessTokenDownloaded);
+}
+
+QSharedPointer<NetworkReply> DataProxy::requestAccessToken(const QPair<QString, QString> &username,
+                                                           const QPair<QString, QString> &password)
 {
     auto cmd = RESTCommandFactory::getAuthorizationToken(m_configurationManager);
     // add username and password to the request
     cmd->addQueryItem(username.first, username.second);
     cmd->addQueryItem(password.first, password.second);
     // send empty flags to ensure access token is not appended to request
-    auto reply = m_networkManager->httpRequest(cmd, NetworkManager::Empty);
+    return m_networkManager->httpRequest(cmd, NetworkManager::Empty);
+}
+
+bool DataProxy::finishRequest(QSharedPointer<NetworkReply> reply, const DownloadType &type)
+{
     // create the download request (sync)
     const bool status_download = createRequest(reply);
     bool status_parsing = false;
     if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::AccessTokenDownloaded);
+        status_parsing = parseRequest(reply, type);
     }
     // returns status
     return status_download && status_parsing;
 }
 
+bool DataProxy::finishContentRequest(QSharedPointer<NetworkReply> reply,
+                                     const DownloadType &type,
+                                     DatasetContentCache::Content &content)
+{
+    // create the download request (sync)
+    if (!createRequest(reply)) {
+        return false;
+    }
+    return notifyParsing(reply, parseContentReply(reply, type, content));
+}
+
+DataProxy::RequestFuture DataProxy::finishRequestAsync(QSharedPointer<NetworkReply> reply,
+                                                       const DownloadType &type)
+{
+    QFutureInterface<RequestResult> futureInterface;
+    futureInterface.reportStarted();
+    const RequestFuture future = futureInterface.future();
+
+    // parses the reply and reports the result (errors are not shown)
+    auto finish = [=]() mutable {
+        const RequestResult result(type, replyError(reply, type));
+        futureInterface.reportResult(result);
+        futureInterface.reportFinished();
+    };
+
+    // the reply may have finished already (or the request could not be created)
+    if (reply == nullptr || reply->isFinished()) {
+        finish();
+        return future;
+    }
+
+    // the connection is removed once the reply has finished
+    auto connection = QSharedPointer<QMetaObject::Connection>::create();
+    *connection = connect(reply.data(), &NetworkReply::signalFinished, this, [=]() mutable {
+        disconnect(*connection);
+        finish();
+    });
+    return future;
+}
+
+DataProxy::RequestFuture DataProxy::finishedRequest(const DownloadType &type,
+                                                    QSharedPointer<Error> error) const
+{
+    QFutureInterface<RequestResult> futureInterface;
+    futureInterface.reportStarted();
+    futureInterface.reportResult(RequestResult(type, error));
+    futureInterface.reportFinished();
+    return futureInterface.future();
+}
+
+QSharedPointer<Error> DataProxy::replyError(QSharedPointer<NetworkReply> reply,
+                                            const DownloadType &type,
+                                            DatasetContentCache::Content *content)
+{
+    const QSharedPointer<Error> network_error = networkError(reply);
+    if (!network_error.isNull()) {
+        return network_error;
+    }
+
+    // errors could happen parsing the data
+    const bool parsedOk
+        = content != nullptr ? parseContentReply(reply, type, *content) : parseReply(reply, type);
+    if (!parsedOk || reply->hasErrors()) {
+        const auto error = reply->parseErrors();
+        if (error.isNull()) {
+            return QSharedPointer<Error>(
+                new Error(tr("Error parsing data"),
+                          tr("There was an error parsing the data object from the remote server")));
+        }
+        return QSharedPointer<Error>(new Error(error->name(), error->description()));
+    }
+
+    qDebug() << "Data from network request parsed correctly...";
+    return QSharedPointer<Error>();
+}
+
+QSharedPointer<Error> DataProxy::networkError(QSharedPointer<NetworkReply> reply) const
+{
+    if (reply == nullptr) {
+        qDebug() << "[DataProxy] : Error, the NetworkReply is null,"
+                    "there must have been a network error";
+        return QSharedPointer<Error>(new Error(tr("Error downloading data"),
+                                               tr("There was probably a network problem.")));
+    }
+
+    // the errors of the reply are owned by it so they are copied
+    // as the result can outlive the reply
+    if (reply->hasErrors()) {
+        const auto error = reply->parseErrors();
+        return QSharedPointer<Error>(new Error(error->name(), error->description()));
+    }
+
+    if (reply->return_code() == NetworkReply::CodeError) {
+        return QSharedPointer<Error>(new Error(tr("Error downloading data"),
+                                               tr("There was probably a network problem.")));
+    }
+    return QSharedPointer<Error>();
+}
+
 bool DataProxy::createRequest(QSharedPointer<NetworkReply> reply)
 {
     if (reply == nullptr) {
@@ -630,9 +1211,12 @@ bool DataProxy::createRequest(QSharedPointer<NetworkReply> reply)
         return false;
     }
 
-    QEventLoop loop;
-    connect(reply.data(), SIGNAL(signalFinished(QVariant)), &loop, SLOT(quit()));
-    loop.exec();
+    // the reply may have finished while other requests were waited for
+    if (!reply->isFinished()) {
+        QEventLoop loop;
+        connect(reply.data(), SIGNAL(signalFinished(QVariant)), &loop, SLOT(quit()));
+        loop.exec();
+    }
 
     if (reply == nullptr) {
         QWidget *mainWidget = QApplication::desktop()->screen();
@@ -671,7 +1255,394 @@ bool DataProxy::userLogIn() const
     return m_user && m_user->enabled();
 }
 
+const DatasetContentCache::Statistics &DataProxy::datasetCacheStatistics() const
+{
+    return m_datasetCache.statistics();
+}
+
+const DataProxy::PrefetchStatistics &DataProxy::prefetchStatistics() const
+{
+    return m_prefetchStatistics;
+}
+
+void DataProxy::prefetchDatasetContent(const DatasetPtr dataset)
+{
+    // only the datasets in the database that can be cached are prefetched
+    if (!m_configurationManager.prefetchDatasets() || !dataset || !m_user
+        || !dataset->downloaded() || dataset->lastModified().isEmpty()) {
+        return;
+    }
+    if (m_prefetcher->isRunning() && m_prefetcher->datasetId() == dataset->id()) {
+        return;
+    }
+    // the content of the pinned datasets is downloaded first
+    if (!m_pinning.isEmpty()) {
+        return;
+    }
+    if (m_datasetCache.contains(dataset->id(), dataset->lastModified())) {
+        m_prefetcher->cancel();
+        return;
+    }
+
+    ++m_prefetchStatistics.started;
+    m_prefetcher->start(*dataset, m_user->hasSpecialRole());
+}
+
+void DataProxy::cancelPrefetch()
+{
+    if (m_pinning.isEmpty()) {
+        m_prefetcher->cancel();
+    }
+}
+
+void DataProxy::slotPrefetchFinished(const QString &datasetId,
+                                     const DatasetContentCache::Content &content)
+{
+    m_datasetCache.insert(datasetId, content);
+    if (datasetId == m_pinning) {
+        m_pinning.clear();
+        m_pinQueue.removeAll(datasetId);
+        storePinnedContent(datasetId, content);
+        // the prefetcher is not started again while it is notifying
+        QTimer::singleShot(0, this, &DataProxy::slotPinNextDataset);
+        return;
+    }
+    ++m_prefetchStatistics.completed;
+    m_prefetchedDatasets.insert(datasetId);
+}
+
+void DataProxy::slotPrefetchDiscarded(const QString &datasetId, const qint64 bytes)
+{
+    if (datasetId == m_pinning) {
+        m_pinning.clear();
+        // the download is tried again later (it may have been canceled by
+        // the opening of another dataset) unless it has failed too many times
+        if (m_pinAttempts.value(datasetId) < MAX_PIN_ATTEMPTS) {
+            QTimer::singleShot(PIN_RETRY_DELAY, this, &DataProxy::slotPinNextDataset);
+        } else {
+            qDebug() << "[DataProxy] The content of the pinned dataset " << datasetId
+                     << " could not be downloaded";
+            m_pinQueue.removeAll(datasetId);
+            QTimer::singleShot(0, this, &DataProxy::slotPinNextDataset);
+        }
+        return;
+    }
+    m_prefetchStatistics.wastedBytes += bytes;
+    qDebug() << "[DataProxy] Prefetch of dataset " << datasetId << " discarded, wasted bytes "
+             << m_prefetchStatistics.wastedBytes;
+}
+
+void DataProxy::pinDataset(const DatasetPtr dataset)
+{
+    // only the datasets in the database can be pinned
+    if (!dataset || !m_user || !dataset->downloaded()) {
+        return;
+    }
+    m_offlineStore->setUser(*m_user);
+    const QString &datasetId = dataset->id();
+    if (!m_offlineStore->isDatasetPinned(datasetId)) {
+        m_offlineStore->pinDataset(*dataset);
+    }
+    if (m_offlineStore->hasContent(datasetId, dataset->lastModified())) {
+        return;
+    }
+
+    // the content is taken from the caches if possible
+    DatasetContentCache::Content content;
+    if (m_datasetCache.find(datasetId, dataset->lastModified(), content)
+        || m_datasetSnapshots.read(datasetId, dataset->lastModified(), content)) {
+        storePinnedContent(datasetId, content);
+        return;
+    }
+    if (!m_pinQueue.contains(datasetId)) {
+        m_pinQueue.append(datasetId);
+    }
+    m_pinAttempts.remove(datasetId);
+    slotPinNextDataset();
+}
+
+void DataProxy::unpinDataset(const QString &datasetId)
+{
+    m_offlineStore->unpinDataset(datasetId);
+    m_pinQueue.removeAll(datasetId);
+    if (m_pinning == datasetId) {
+        m_pinning.clear();
+        m_prefetcher->cancel();
+    }
+}
+
+bool DataProxy::isDatasetPinned(const QString &datasetId) const
+{
+    return m_offlineStore->isDatasetPinned(datasetId);
+}
+
+void DataProxy::pinSelection(const UserSelectionPtr selection)
+{
+    // only the selections in the database can be pinned
+    if (!selection || !m_user || !selection->saved()) {
+        return;
+    }
+    m_offlineStore->setUser(*m_user);
+    m_offlineStore->pinSelection(*selection);
+}
+
+void DataProxy::unpinSelection(const QString &selectionId)
+{
+    m_offlineStore->unpinSelection(selectionId);
+}
+
+bool DataProxy::isSelectionPinned(const QString &selectionId) const
+{
+    return m_offlineStore->isSelectionPinned(selectionId);
+}
+
+bool DataProxy::loadPinnedContent()
+{
+    if (m_offlineStore->isEmpty() || !m_offlineStore->hasUser()) {
+        return false;
+    }
+
+    m_user = std::make_shared<User>(m_offlineStore->user());
+    m_pinnedUser = true;
+    // the pinned objects replace the ones downloaded (the next sync downloads
+    // the whole lists)
+    m_datasetsSync.clear();
+    m_selectionsSync.clear();
+    m_datasetList.erase(std::remove_if(m_datasetList.begin(),
+                                       m_datasetList.end(),
+                                       [](DatasetPtr dataset) { return dataset->downloaded(); }),
+                        m_datasetList.end());
+    for (const Dataset &dataset : m_offlineStore->pinnedDatasets()) {
+        m_datasetList.push_back(std::make_shared<Dataset>(dataset));
+    }
+    m_userSelectionList.erase(std::remove_if(m_userSelectionList.begin(),
+                                             m_userSelectionList.end(),
+                                             [](UserSelectionPtr selection) {
+                                  return selection->saved();
+                              }),
+                              m_userSelectionList.end());
+    for (const UserSelection &pinned : m_offlineStore->pinnedSelections()) {
+        UserSelectionPtr selection = std::make_shared<UserSelection>(pinned);
+        const auto dataset = getDatasetById(selection->datasetId());
+        selection->datasetName(dataset ? dataset->name() : tr("Unknown dataset"));
+        m_userSelectionList.push_back(selection);
+    }
+
+    qDebug() << "[DataProxy] Pinned content loaded, datasets " << m_datasetList.size()
+             << " selections " << m_userSelectionList.size();
+    setOffline(true);
+    // the server may be reachable already
+    slotProbe();
+    return true;
+}
+
+bool DataProxy::loadCachedUser()
+{
+    if (m_user || !m_offlineStore->hasUser()) {
+        return false;
+    }
+
+    m_user = std::make_shared<User>(m_offlineStore->user());
+    m_pinnedUser = true;
+    return true;
+}
+
+bool DataProxy::isOffline() const
+{
+    return m_offline;
+}
+
+void DataProxy::syncPinnedContent()
+{
+    if (m_offline || !m_user) {
+        return;
+    }
+    // the profile of the user is kept for the next start (see loadCachedUser)
+    // and the content pinned by another user is removed
+    m_offlineStore->setUser(*m_user);
+    if (m_offlineStore->isEmpty()) {
+        return;
+    }
+    m_pinAttempts.clear();
+
+    // the lists are downloaded (only the changes if they were downloaded
+    // before) and the pinned objects refreshed with them
+    typedef QFutureWatcher<RequestResult> RequestWatcher;
+    auto datasets_watcher = new RequestWatcher(this);
+    connect(datasets_watcher, &RequestWatcher::finished, this, [=]() {
+        datasets_watcher->deleteLater();
+        if (!datasets_watcher->result().ok()) {
+            qDebug() << "[DataProxy] The pinned datasets could not be synced";
+            return;
+        }
+        for (const Dataset &pinned : m_offlineStore->pinnedDatasets()) {
+            const auto dataset = getDatasetById(pinned.id());
+            if (!dataset) {
+                // removed from the database or not accessible anymore
+                unpinDataset(pinned.id());
+            } else if (m_offlineStore->hasContent(dataset->id(), dataset->lastModified())) {
+                m_offlineStore->pinDataset(*dataset);
+            } else if (!m_pinQueue.contains(dataset->id())) {
+                // the pinned dataset is updated once its content is stored
+                m_pinQueue.append(dataset->id());
+            }
+        }
+        slotPinNextDataset();
+    });
+
+    auto selections_watcher = new RequestWatcher(this);
+    connect(selections_watcher, &RequestWatcher::finished, this, [=]() {
+        selections_watcher->deleteLater();
+        if (!selections_watcher->result().ok()) {
+            qDebug() << "[DataProxy] The pinned selections could not be synced";
+            return;
+        }
+        for (const UserSelection &pinned : m_offlineStore->pinnedSelections()) {
+            const auto it = std::find_if(m_userSelectionList.begin(),
+                                         m_userSelectionList.end(),
+                                         [&](UserSelectionPtr selection) {
+                                             return selection->id() == pinned.id();
+                                         });
+            if (it == m_userSelectionList.end()) {
+                unpinSelection(pinned.id());
+            } else {
+                m_offlineStore->pinSelection(**it);
+            }
+        }
+    });
+
+    datasets_watcher->setFuture(loadDatasetsAsync());
+    selections_watcher->setFuture(loadUserSelectionsAsync());
+}
+
+void DataProxy::slotPinNextDataset()
+{
+    if (!m_pinning.isEmpty() || m_offline || !m_user) {
+        return;
+    }
+    while (!m_pinQueue.isEmpty()) {
+        const QString datasetId = m_pinQueue.first();
+        const auto dataset = getDatasetById(datasetId);
+        if (!dataset || !m_offlineStore->isDatasetPinned(datasetId)
+            || m_offlineStore->hasContent(datasetId, dataset->lastModified())) {
+            m_pinQueue.removeFirst();
+            continue;
+        }
+        m_pinning = datasetId;
+        ++m_pinAttempts[datasetId];
+        // the prefetch of the dataset may be running already, otherwise the
+        // pinned dataset takes precedence over the one prefetched
+        if (!m_prefetcher->isRunning() || m_prefetcher->datasetId() != datasetId) {
+            m_prefetcher->start(*dataset, m_user->hasSpecialRole());
+        }
+        return;
+    }
+}
+
+void DataProxy::storePinnedContent(const QString &datasetId,
+                                   const DatasetContentCache::Content &content)
+{
+    if (!m_offlineStore->isDatasetPinned(datasetId)
+        || m_offlineStore->hasContent(datasetId, content.lastModified)) {
+        return;
+    }
+    // the content is written in a worker thread
+    if (!m_offlineStore->writeContent(datasetId, content)) {
+        return;
+    }
+    // the pinned dataset is updated to the version of its content
+    const auto dataset = getDatasetById(datasetId);
+    if (dataset && dataset->lastModified() == content.lastModified) {
+        m_offlineStore->pinDataset(*dataset);
+    }
+}
+
+void DataProxy::setOffline(const bool offline)
+{
+    if (m_offline == offline) {
+        return;
+    }
+    m_offline = offline;
+    qDebug() << "[DataProxy] Working " << (offline ? "offline" : "online");
+    if (offline) {
+        m_probeTimer.start();
+    } else {
+        m_probeTimer.stop();
+    }
+    emit signalOfflineChanged(offline);
+}
+
+void DataProxy::slotOnlineChanged(const bool online)
+{
+    if (!online) {
+        // the pinned content is served while the server cannot be reached
+        if (!m_offlineStore->isEmpty()) {
+            setOffline(true);
+        }
+        return;
+    }
+    if (m_offline) {
+        setOffline(false);
+        // the user loaded from the store is synced once it is authorized
+        if (!m_pinnedUser) {
+            syncPinnedContent();
+        }
+    }
+}
+
+void DataProxy::slotProbe()
+{
+    // only one probe at a time
+    if (m_probeReply != nullptr && !m_probeReply->isFinished()) {
+        return;
+    }
+    // the min version does not need authorization
+    const auto cmd = RESTCommandFactory::getMinVersion(m_configurationManager);
+    m_probeReply
+        = m_networkManager->httpRequest(cmd, NetworkManager::Empty, NetworkManager::Background);
+    if (m_probeReply == nullptr) {
+        return;
+    }
+    // the network manager only notifies the changes (the server may have
+    // been reachable for it already)
+    connect(m_probeReply.data(), &NetworkReply::signalFinished, this, [this]() {
+        slotOnlineChanged(m_networkManager->isOnline());
+    });
+}
+
 bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadType &type)
+{
+    Q_ASSERT(reply);
+    const bool parsedOk = parseReply(reply, type);
+
+    // the user canceled the parsing (no need to notify any error)
+    if (type == FeaturesDownloaded && !parsedOk && m_featuresParsing.isCanceled()) {
+        return false;
+    }
+    return notifyParsing(reply, parsedOk);
+}
+
+bool DataProxy::notifyParsing(QSharedPointer<NetworkReply> reply, const bool parsedOk)
+{
+    Q_ASSERT(reply);
+    // errors could happen parsing the data
+    if (reply->hasErrors() || !parsedOk) {
+        const auto error = reply->parseErrors();
+        const QString error_name = error.isNull() ? tr("Error parsing data") : error->name();
+        const QString error_dcr =
+                error.isNull() ?
+                    tr("There was an error parsing the data object from the remote server")
+                  : error->description();
+        QWidget *mainWidget = QApplication::desktop()->screen();
+        QMessageBox::critical(mainWidget, error_name, error_dcr);
+        return false;
+    } else {
+        qDebug() << "Data from network request parsed correctly...";
+        return true;
+    }
+}
+
+bool DataProxy::parseReply(QSharedPointer<NetworkReply> reply, const DownloadType &type)
 {
     Q_ASSERT(reply);
     bool parsedOk = false;
@@ -683,29 +1654,36 @@ bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadT
         parsedOk = parseOAuth2(reply->getJSON());
         break;
     case UserDownloaded:
-        parsedOk = parseUser(reply->getJSON());
+        parsedOk = parseUser(reply->getRaw());
         break;
-    case DatasetsDownloaded:
-        parsedOk = parseDatasets(reply->getJSON());
+    case DatasetsDownloaded: {
+        SyncState::Changes changes;
+        parsedOk = m_datasetsSync.update(*reply, changes) && parseDatasets(changes);
         break;
+    }
     case DatasetRemoved:
         parsedOk = parseRemoveDataset(reply->property("dataset_id").toString());
         break;
     case ImageAlignmentDownloaded:
-        parsedOk = parseImageAlignment(reply->getJSON());
+        parsedOk = parseImageAlignment(reply->getRaw(), m_imageAlignment);
         break;
     case ChipDownloaded:
-        parsedOk = parseChip(reply->getJSON());
+        parsedOk = parseChip(reply->getRaw(), m_chip);
         break;
     case TissueImageDownloaded:
-        parsedOk = parseCellTissueImage(reply->getRaw(), reply->property("figure_name").toString());
+        parsedOk = parseCellTissueImage(reply->getRaw(),
+                                        reply->property("figure_name").toString(),
+                                        m_cellTissueImages);
         break;
     case FeaturesDownloaded:
-        parsedOk = parseFeatures(reply->getRaw());
+        parsedOk = m_featuresStream.isNull() ? parseFeatures(reply->getRaw())
+                                             : parseFeaturesStream(reply->getRaw());
         break;
-    case UserSelectionsDownloaded:
-        parsedOk = parseUserSelections(reply->getJSON());
+    case UserSelectionsDownloaded: {
+        SyncState::Changes changes;
+        parsedOk = m_selectionsSync.update(*reply, changes) && parseUserSelections(changes);
         break;
+    }
     case UserSelectionRemoved:
         parsedOk = parseRemoveUserSelection(reply->property("selection_id").toString());
         break;
@@ -716,64 +1694,183 @@ bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadT
     default:
         break;
     }
+    return parsedOk;
+}
 
-    // errors could happen parsing the data
-    if (reply->hasErrors() || !parsedOk) {
-        const auto error = reply->parseErrors();
-        const QString error_name = error.isNull() ? tr("Error parsing data") : error->name();
-        const QString error_dcr =
-                error.isNull() ?
-                    tr("There was an error parsing the data object from the remote server")
-                  : error->description();
-        QWidget *mainWidget = QApplication::desktop()->screen();
-        QMessageBox::critical(mainWidget, error_name, error_dcr);
-        return false;
-    } else {
-        qDebug() << "Data from network request parsed correctly...";
-        return true;
+bool DataProxy::parseContentReply(QSharedPointer<NetworkReply> reply,
+                                  const DownloadType &type,
+                                  DatasetContentCache::Content &content)
+{
+    Q_ASSERT(reply);
+    bool parsedOk = false;
+    switch (type) {
+    case ImageAlignmentDownloaded:
+        parsedOk = parseImageAlignment(reply->getRaw(), content.imageAlignment);
+        break;
+    case ChipDownloaded:
+        parsedOk = parseChip(reply->getRaw(), content.chip);
+        break;
+    case TissueImageDownloaded:
+        parsedOk = parseCellTissueImage(reply->getRaw(),
+                                        reply->property("figure_name").toString(),
+                                        content.images);
+        break;
+    default:
+        break;
     }
+    return parsedOk;
 }
 
-// TODO this function is causing the CPU to freeze with big datasets
-// solution is to run it concurrently
 bool DataProxy::parseFeatures(const QByteArray &rawData)
 {
-    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-    FeaturesHandler handler(m_featuresList, m_geneNameToObject);
-    Reader reader;
-    StringStream is(rawData.data());
-    const bool parsedOk = reader.Parse(is, handler);
-    QGuiApplication::restoreOverrideCursor();
-    return parsedOk;
+    // the parsing is performed in a worker thread into separate containers
+    QFuture<data::ParsedFeatures> future = data::parseFeaturesAsync(rawData);
+    m_featuresParsing = future;
+    emit signalFeaturesParsing(future);
+
+    // wait for the parsing without blocking the UI
+    QFutureWatcher<data::ParsedFeatures> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(future);
+    if (!future.isFinished()) {
+        loop.exec();
+    }
+
+    if (future.isCanceled() || future.resultCount() == 0) {
+        qDebug() << "[DataProxy] The parsing of the features failed or was canceled";
+        return false;
+    }
+
+    // swap the containers only when the parsing has fully succeeded
+    data::ParsedFeatures parsed = future.result();
+    setFeatures(parsed);
+    return true;
+}
+
+bool DataProxy::parseFeaturesStream(const QByteArray &rawData)
+{
+    Q_ASSERT(!m_featuresStream.isNull());
+    // only the last objects are left to parse at this point, the chunks are merged
+    // in a worker thread (the future has no result if any of the data was not correct)
+    m_featuresStream->append(rawData);
+    m_featuresStream->finishAsync();
+    QFuture<data::ParsedFeatures> future = m_featuresStream->future();
+
+    // wait for the parsing without blocking the UI
+    QFutureWatcher<data::ParsedFeatures> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(future);
+    if (!future.isFinished()) {
+        loop.exec();
+    }
+
+    if (future.isCanceled() || future.resultCount() == 0) {
+        qDebug() << "[DataProxy] The parsing of the features failed or was canceled";
+        return false;
+    }
+
+    // swap the containers only when the parsing has fully succeeded
+    data::ParsedFeatures parsed = future.result();
+    setFeatures(parsed);
+    return true;
+}
+
+void DataProxy::setFeatures(data::ParsedFeatures &parsed)
+{
+    m_features = parsed.features;
+    parsed.features = FeatureStore();
+    m_geneDictionary = parsed.genes;
+
+    // create the unique gene objects (one per gene ID)
+    GeneIdToObject gene_objects;
+    gene_objects.reserve(m_geneDictionary.size());
+    for (int id = 0; id < m_geneDictionary.size(); ++id) {
+        gene_objects.push_back(std::make_shared<Gene>(
+            Gene(m_geneDictionary.name(id), static_cast<GeneDictionary::GeneId>(id))));
+    }
+    m_geneObjects.swap(gene_objects);
+}
+
+void DataProxy::setDatasetContent(const DatasetContentCache::Content &content)
+{
+    m_imageAlignment = content.imageAlignment;
+    m_chip = content.chip;
+    m_cellTissueImages = content.images;
+    // the gene objects are created again so the genes are shown as when they are parsed
+    data::ParsedFeatures parsed;
+    parsed.features = content.features;
+    parsed.genes = content.genes;
+    setFeatures(parsed);
+}
+
+DatasetContentCache::Content DataProxy::datasetContent(const DatasetPtr dataset) const
+{
+    DatasetContentCache::Content content;
+    content.lastModified = dataset->lastModified();
+    content.features = m_features;
+    content.genes = m_geneDictionary;
+    content.chip = m_chip;
+    content.imageAlignment = m_imageAlignment;
+    // only the images of the dataset (the container may have others)
+    if (m_imageAlignment) {
+        for (const QString &figure :
+             {m_imageAlignment->figureBlue(), m_imageAlignment->figureRed()}) {
+            if (m_cellTissueImages.contains(figure)) {
+                content.images.insert(figure, m_cellTissueImages.value(figure));
+            }
+        }
+    }
+    return content;
 }
 
-bool DataProxy::parseCellTissueImage(const QByteArray &rawData, const QString &imageName)
+bool DataProxy::parseCellTissueImage(const QByteArray &rawData,
+                                     const QString &imageName,
+                                     CellFigureMap &images)
 {
     // check data and filename
     const bool parsedOk = !rawData.isEmpty() && !rawData.isNull() && !imageName.isEmpty()
                           && !imageName.isNull();
     if (parsedOk) {
         // store the image as raw data
-        m_cellTissueImages.insert(imageName, rawData);
+        images.insert(imageName, rawData);
     }
 
     return parsedOk;
 }
 
-bool DataProxy::parseDatasets(const QJsonDocument &doc)
+bool DataProxy::parseDatasets(const SyncState::Changes &changes)
 {
-    if (doc.isNull() || doc.isEmpty()) {
-        // an error is added to the reply when this happens
+    // the objects are parsed first so nothing is changed if they are not valid
+    QList<Dataset> modified;
+    if (!changes.modified.isEmpty() && !data::bindObjects(changes.modified, modified)) {
+        // the next sync downloads the whole list again
+        m_datasetsSync.clear();
         return false;
     }
 
-    // intermediary parse object
-    DatasetDTO dto;
+    // the datasets removed in the database are removed with their content
+    for (const QString &datasetId : changes.removed) {
+        parseRemoveDataset(datasetId);
+    }
 
-    // parse the objects
-    for (const QVariant &var : doc.toVariant().toList()) {
-        data::parseObject(var, &dto);
-        DatasetPtr dataset = std::make_shared<Dataset>(dto.dataset());
+    // clean up container (only datasets downloaded from network that have changed)
+    // here so concurrent requests do not add the datasets twice
+    QSet<QString> changed = changes.removed.toSet();
+    for (const Dataset &dataset : modified) {
+        changed.insert(dataset.id());
+    }
+    m_datasetList.erase(std::remove_if(m_datasetList.begin(),
+                                       m_datasetList.end(),
+                                       [&](DatasetPtr dataset) {
+                            return dataset->downloaded()
+                                   && (changes.full || changed.contains(dataset->id()));
+                        }),
+                        m_datasetList.end());
+
+    for (const Dataset &object : modified) {
+        DatasetPtr dataset = std::make_shared<Dataset>(object);
         Q_ASSERT(dataset);
         // the commented lines are to only adds the datasets that the user has access to
         //const auto granted_users = dataset->grantedAccounts();
@@ -796,6 +1893,13 @@ bool DataProxy::parseRemoveDataset(const QString &datasetId)
                             return dataset->id() == datasetId;
                         }),
                         m_datasetList.end());
+    if (m_prefetcher->datasetId() == datasetId) {
+        m_prefetcher->cancel();
+    }
+    unpinDataset(datasetId);
+    m_prefetchedDatasets.remove(datasetId);
+    m_datasetCache.remove(datasetId);
+    m_datasetSnapshots.remove(datasetId);
 
     // remove selections created on that dataset and that are not saved in the cloud
     // the selections of the dataset that are stored in the cloud will automatically be deleted
@@ -809,20 +1913,32 @@ bool DataProxy::parseRemoveDataset(const QString &datasetId)
     return true;
 }
 
-bool DataProxy::parseUserSelections(const QJsonDocument &doc)
+bool DataProxy::parseUserSelections(const SyncState::Changes &changes)
 {
-    if (doc.isNull() || doc.isEmpty()) {
-        // an error is present in reply when this happens
+    // the objects are parsed first so nothing is changed if they are not valid
+    QList<UserSelection> modified;
+    if (!changes.modified.isEmpty() && !data::bindObjects(changes.modified, modified)) {
+        // the next sync downloads the whole list again
+        m_selectionsSync.clear();
         return false;
     }
 
-    // intermediary parse object
-    UserSelectionDTO dto;
+    // clean up currently download selections (only the ones that have changed)
+    // here so concurrent requests do not add the selections twice
+    QSet<QString> changed = changes.removed.toSet();
+    for (const UserSelection &selection : modified) {
+        changed.insert(selection.id());
+    }
+    m_userSelectionList.erase(std::remove_if(m_userSelectionList.begin(),
+                                             m_userSelectionList.end(),
+                                             [&](UserSelectionPtr selection) {
+                                  return selection->saved()
+                                         && (changes.full || changed.contains(selection->id()));
+                              }),
+                              m_userSelectionList.end());
 
-    // parse the data
-    for (const QVariant &var : doc.toVariant().toList()) {
-        data::parseObject(var, &dto);
-        UserSelectionPtr selection = std::make_shared<UserSelection>(dto.userSelection());
+    for (const UserSelection &object : modified) {
+        UserSelectionPtr selection = std::make_shared<UserSelection>(object);
         Q_ASSERT(selection);
         // get the dataset name from the cached datasets
         // TODO if we enter the user selections view without having downloaded the
@@ -851,59 +1967,46 @@ bool DataProxy::parseRemoveUserSelection(const QString &selectionId)
                                   return selection->id() == selectionId;
                               }),
                               m_userSelectionList.end());
+    unpinSelection(selectionId);
     // TODO should check that it was removed
     return true;
 }
 
-bool DataProxy::parseUser(const QJsonDocument &doc)
+bool DataProxy::parseUser(const QByteArray &rawData)
 {
-    if (doc.isNull() || doc.isEmpty()) {
+    // should only be one item
+    User user;
+    if (!data::bindObject(rawData, user)) {
         // an error is present in reply when this happens
         return false;
     }
-
-    // intermediary parse object
-    UserDTO dto;
-
-    // should only be one item
-    const QVariant root = doc.toVariant();
-    data::parseObject(root, &dto);
-    m_user = std::make_shared<User>(dto.user());
+    m_user = std::make_shared<User>(user);
+    m_pinnedUser = false;
     return m_user != nullptr;
 }
 
-bool DataProxy::parseImageAlignment(const QJsonDocument &doc)
+bool DataProxy::parseImageAlignment(const QByteArray &rawData, ImageAlignmentPtr &imageAlignment)
 {
-    if (doc.isNull() || doc.isEmpty()) {
+    // image alignment should only contain one object
+    ImageAlignment alignment;
+    if (!data::bindObject(rawData, alignment)) {
         // an error is present in reply when this happen
         return false;
     }
-
-    // intermediary parse object
-    ImageAlignmentDTO dto;
-
-    // image alignment should only contain one object
-    const QVariant root = doc.toVariant();
-    data::parseObject(root, &dto);
-    m_imageAlignment = std::make_shared<ImageAlignment>(dto.imageAlignment());
-    return m_imageAlignment != nullptr;
+    imageAlignment = std::make_shared<ImageAlignment>(alignment);
+    return imageAlignment != nullptr;
 }
 
-bool DataProxy::parseChip(const QJsonDocument &doc)
+bool DataProxy::parseChip(const QByteArray &rawData, ChipPtr &chip)
 {
-    if (doc.isNull() || doc.isEmpty()) {
+    // should only be one item
+    Chip object;
+    if (!data::bindObject(rawData, object)) {
         // an error is present in reply when this happens
         return false;
     }
-
-    // intermediary parse object
-    ChipDTO dto;
-
-    // should only be one item
-    const QVariant root = doc.toVariant();
-    data::parseObject(root, &dto);
-    m_chip = std::make_shared<Chip>(dto.chip());
-    return m_chip != nullptr;
+    chip = std::make_shared<Chip>(object);
+    return chip != nullptr;
 }
 
 bool DataProxy::parseMinVersion(const QJsonDocument &doc)
@@ -4,9 +4,18 @@
 #include <QObject>
 #include <QVector>
 #include <QMap>
+#include <QSet>
 #include <QSharedPointer>
+#include <QFuture>
+#include <QTimer>
+#include <QStringList>
 #include "config/Configuration.h"
 #include "dataModel/OAuth2TokenDTO.h"
+#include "dataModel/GeneDictionary.h"
+#include "dataModel/FeatureStore.h"
+#include "data/DatasetContentCache.h"
+#include "data/DatasetSnapshotCache.h"
+#include "data/SyncState.h"
 #include <array>
 #include <memory>
 
@@ -18,10 +27,18 @@ class UserSelection;
 class User;
 class ImageAlignment;
 class Gene;
-class Feature;
 class Dataset;
 class Chip;
 class MinVersionDTO;
+class BinaryFeatureFile;
+class Error;
+class DatasetPrefetcher;
+class OfflineStore;
+namespace data
+{
+struct ParsedFeatures;
+class FeaturesStreamParser;
+}
 
 // DataProxy is a globally accessible all-in-all data store. It provides an
 // interface to access remotely stored data and means of storing and managing
@@ -47,6 +64,7 @@ public:
         ChipDownloaded,
         TissueImageDownloaded,
         FeaturesDownloaded,
+        DatasetContentDownloaded,
         UserSelectionsDownloaded,
         UserSelectionModified,
         UserSelectionRemoved,
@@ -56,7 +74,6 @@ public:
     // MAIN CONTAINERS (MVC)
     typedef std::shared_ptr<Chip> ChipPtr;
     typedef std::shared_ptr<Dataset> DatasetPtr;
-    typedef std::shared_ptr<Feature> FeaturePtr;
     typedef std::shared_ptr<Gene> GenePtr;
     typedef std::shared_ptr<ImageAlignment> ImageAlignmentPtr;
     typedef std::shared_ptr<UserSelection> UserSelectionPtr;
@@ -67,19 +84,15 @@ public:
 
     // TODO separate data API and data adquisition
 
-    // TODO replace JSON for binary format for the features (data frame or tab
-    // delimited)
-
-    // TODO make the parsing of the features data asynchronous
-
-    // TODO Currently dataProxy does not support caching. The dataset content
-    // variables are unique for the dataset currently opened. We should cache
-    // the dataset content variable by dataset ID
+    // NOTE the dataset content variables are unique for the dataset currently
+    // opened but the content of the datasets opened recently is kept in a
+    // memory cache by dataset ID (see DatasetContentCache) and on disk
+    // (see DatasetSnapshotCache)
 
     // list of unique genes
     typedef QList<GenePtr> GeneList;
-    // list of features
-    typedef QList<FeaturePtr> FeatureList;
+    // list of features (a view over a feature store)
+    typedef FeatureView FeatureList;
     // list of unique datasets
     typedef QList<DatasetPtr> DatasetList;
     // list of user selections
@@ -88,15 +101,59 @@ public:
     typedef QHash<QString, QByteArray> CellFigureMap;
     // array of three elements containing the min version supported
     typedef std::array<qulonglong, 3> MinVersionArray;
-    // gene name to gene object
-    typedef QHash<QString, GenePtr> GeneNameToObject;
+    // gene objects indexed by gene ID
+    typedef QVector<GenePtr> GeneIdToObject;
+
+    // result of an asynchronous request (see the ASYNC DATA LOADERS)
+    // the data is added to the containers as in the synchronous loaders
+    // so it must be retrieved with the getters once the request has finished
+    struct RequestResult {
+        RequestResult()
+            : type(None)
+            , error()
+        {
+        }
+        RequestResult(const DownloadType type, QSharedPointer<Error> error)
+            : type(type)
+            , error(error)
+        {
+        }
+        // true if the download and parsing went fine
+        bool ok() const { return error.isNull(); }
+
+        DownloadType type;
+        // the error of the request (null if none)
+        QSharedPointer<Error> error;
+    };
+    typedef QFuture<RequestResult> RequestFuture;
+
+    // metrics of the prefetch of the dataset content (see prefetchDatasetContent)
+    struct PrefetchStatistics {
+        PrefetchStatistics()
+            : started(0)
+            , completed(0)
+            , hits(0)
+            , wastedBytes(0)
+        {
+        }
+        // fraction of the datasets prefetched that were opened afterwards
+        double hitRate() const { return completed > 0 ? double(hits) / completed : 0.0; }
+
+        int started;
+        int completed;
+        // datasets opened with the content prefetched
+        int hits;
+        // bytes downloaded by the prefetches canceled or failed
+        qint64 wastedBytes;
+    };
 
     explicit DataProxy(QObject *parent = 0);
     ~DataProxy();
 
     // clean up memory cache
     void clean();
-    // clean up memory cache and local cache (hard drive)
+    // clean up memory cache and local cache (hard drive, including the
+    // snapshots of the datasets)
     void cleanAll();
 
     // DATA LOADERS
@@ -105,18 +162,24 @@ public:
     // The downloading will be made synchronous.
 
     // Downloads and parses the user's datasets from the database
-    // Before it will remove previously downloaded datasets
+    // The previously downloaded datasets are replaced once the new ones are parsed
+    // (only the changes are downloaded if they were downloaded before, see SyncState)
     // Returns true if the download and parsing went fine
     bool loadDatasets();
     // Downloads and parses the dataset content (chip, cell images and features)
-    // from the database
+    // from the database (or takes it from the memory cache or the snapshot on
+    // disk if the dataset has not been modified since it was opened)
+    // The features are requested first and the figures and the chip are
+    // downloaded in parallel once the image alignment has arrived
+    // The prefetch running is canceled (see loadDatasetContentAsync)
     // Returns true if the download and parsing went fine
     bool loadDatasetContent(const DatasetPtr dataset);
     // Downloads and parses the current logged user from the database
     // Returns true if the download and parsing went fine
     bool loadUser();
     // Download and parses the selections made by the user from the database
-    // Beofre it will remove previously downloaded selections
+    // The previously downloaded selections are replaced once the new ones are parsed
+    // (only the changes are downloaded if they were downloaded before, see SyncState)
     // Returns true if the download and parsing went fine
     bool loadUserSelections();
     // Downloads and parses the min supported version from the database
@@ -130,6 +193,8 @@ public:
     // Returns true if the download and parsing went fine
     bool loadChip(const QString &chipId);
     // Download and parses the ST Data of a dataset from the database
+    // The data is parsed in worker threads while it is downloaded (see
+    // signalFeaturesParsing) and the current features are only replaced if it succeeds
     // Returns true if the download and parsing went fine
     bool loadFeatures(const QString &datasetId);
     // Download and parses an alignment from the database
@@ -139,6 +204,87 @@ public:
     // Returns true if the download and parsing went fine
     bool loadCellTissueByName(const QString &name);
 
+    // ASYNC DATA LOADERS
+    // The same as the data loaders and updaters but the requests are not
+    // waited for so several of them can run concurrently. The returned future
+    // finishes (in the main thread) once the data has been parsed and it is the
+    // caller who must notify the errors (no message boxes are shown)
+    // The features are only loaded asynchronously with the dataset content
+
+    RequestFuture loadDatasetsAsync();
+    // loads the content as loadDatasetContent but the requests are continued
+    // as they finish (see continueContentLoad), if the dataset is being prefetched
+    // its content is loaded once the prefetch has finished
+    // (the future is finished when it is returned if the content was cached)
+    // Only one content is loaded at a time (the previous load fails)
+    RequestFuture loadDatasetContentAsync(const DatasetPtr dataset);
+    RequestFuture loadUserAsync();
+    RequestFuture loadUserSelectionsAsync();
+    RequestFuture loadMinVersionAsync();
+    RequestFuture loadChipAsync(const QString &chipId);
+    RequestFuture loadImageAlignmentAsync(const QString &imageAlignmentId);
+    RequestFuture loadCellTissueByNameAsync(const QString &name);
+    RequestFuture updateDatasetAsync(const Dataset &dataset);
+    RequestFuture updateUserSelectionAsync(const UserSelection &userSelection);
+    RequestFuture removeDatasetAsync(const QString &datasetId);
+    RequestFuture removeSelectionAsync(const QString &selectionId);
+    RequestFuture loadAccessTokenAsync(const QPair<QString, QString> &username,
+                                       const QPair<QString, QString> &password);
+    // saves the selection in the database (see addUserSelection)
+    RequestFuture addUserSelectionAsync(const UserSelection &userSelection);
+    // What is still synchronous (a nested event loop waits):
+    // - the synchronous loaders and updaters (see createRequest), kept as API
+    //   but the pages only use the asynchronous ones
+    // - the features of the imported datasets given as raw data (loadFeatures(QByteArray))
+    //   are parsed in a worker thread while a nested event loop waits (see parseFeatures)
+    //   as the opening of an imported dataset loads its objects one after the other
+
+    // PREFETCH
+    // The content of a dataset can be downloaded and parsed in the background
+    // with low priority before it is opened so loadDatasetContent finds it in
+    // the memory cache. It is only done if enabled in the configuration file.
+
+    // starts the prefetch of the dataset content (any other prefetch is canceled)
+    // nothing is done if the content is already cached
+    void prefetchDatasetContent(const DatasetPtr dataset);
+    // cancels the prefetch running (if any)
+    // (the download of the content of a pinned dataset is not canceled)
+    void cancelPrefetch();
+
+    // OFFLINE
+    // The datasets and selections pinned by the user are stored on disk with
+    // the content of the datasets (see OfflineStore) so they can be used
+    // without network. When the server cannot be reached the pinned objects
+    // are served from the store with no request (working offline) and the
+    // server is probed until it is reachable again. The pinned objects are
+    // synced with the server in the background (see syncPinnedContent).
+
+    // pins the dataset, its content is downloaded in the background if it is
+    // not in the caches
+    void pinDataset(const DatasetPtr dataset);
+    // unpins the dataset and removes its content from the store
+    void unpinDataset(const QString &datasetId);
+    bool isDatasetPinned(const QString &datasetId) const;
+    // pins the selection (only the ones saved in the database)
+    void pinSelection(const UserSelectionPtr selection);
+    void unpinSelection(const QString &selectionId);
+    bool isSelectionPinned(const QString &selectionId) const;
+    // loads the user, the datasets and the selections pinned and works offline
+    // until the server is reachable (no request is made)
+    // returns false if nothing is pinned
+    bool loadPinnedContent();
+    // loads the profile of the last user validated by the server (no request is
+    // made) so it can be shown while the user is loaded again (see loadUserAsync)
+    // returns false if there is no profile or a user is loaded already
+    bool loadCachedUser();
+    // true if the pinned content is served instead of making requests
+    bool isOffline() const;
+    // refreshes the pinned objects with the ones of the server (the ones removed
+    // are unpinned) and downloads the content of the pinned datasets that is
+    // missing or out of date in the background (the profile of the user is
+    // stored as well, see loadCachedUser)
+    void syncPinnedContent();
+
     // DATA LOADERS LOCALLY
     // Methods to add data locally to the containers, for instance
     // data imported by the user
@@ -150,8 +296,13 @@ public:
     // returns true if the parsing was correct
     bool loadImageAlignment(const ImageAlignment &alignment);
     // st data features imported locally from file
+    // (parsed in a worker thread as loadFeatures(datasetId))
     // returns true if the parsing was correct
     bool loadFeatures(const QByteArray &rawData);
+    // st data features from a file in binary format (see BinaryFeatureFile)
+    // the file should be memory mapped so no parsing is needed
+    // returns true if the loading was correct
+    bool loadFeatures(const BinaryFeatureFile &file);
     // cell tissue image imported from file
     // returns true if the parsing was correct
     bool loadCellTissueImage(const QByteArray &rawData, const QString &imageName);
@@ -215,16 +366,23 @@ public:
     // returns the gene object of the given gene name
     GenePtr geneGeneObject(const QString &gene_name) const;
 
+    // returns the gene object of the given gene ID (null if not valid)
+    GenePtr geneObject(const GeneDictionary::GeneId geneId) const;
+
+    // returns the dictionary of the currently loaded genes
+    // (the gene IDs of the features belong to it)
+    const GeneDictionary &geneDictionary() const;
+
     // returns the list of currently loaded features
     // a current dataset object must be selected otherwise it returns an empty
     // list
-    const FeatureList &getFeatureList() const;
+    const FeatureList getFeatureList() const;
 
     // returns the list of currently loaded features whose gene name matches
     // geneName
     // a current dataset object must be selected otherwise it returns an empty
     // list
-    const FeatureList &getGeneFeatureList(const QString &geneName) const;
+    const FeatureList getGeneFeatureList(const QString &geneName) const;
 
     // returns the currently loaded image alignment object
     // a current dataset object must be selected otherwise it returns a null
@@ -258,45 +416,183 @@ public:
     // true if the user is currently logged in
     bool userLogIn() const;
 
+    // returns the hits and misses of the dataset content cache
+    const DatasetContentCache::Statistics &datasetCacheStatistics() const;
+
+    // returns the hit rate and the wasted bytes of the prefetch of the dataset content
+    const PrefetchStatistics &prefetchStatistics() const;
+
 public slots:
 
+    // cancels the parsing of the features if any is running
+    // the loader will then return false and the current features are kept
+    void cancelFeaturesParsing();
+
 private slots:
 
+    // the prefetched content is added to the memory cache
+    void slotPrefetchFinished(const QString &datasetId,
+                              const DatasetContentCache::Content &content);
+    void slotPrefetchDiscarded(const QString &datasetId, const qint64 bytes);
+    // the server has become reachable or unreachable
+    void slotOnlineChanged(const bool online);
+    // sends a request to check if the server is reachable
+    void slotProbe();
+    // downloads the content of the next pinned dataset waiting (if any)
+    void slotPinNextDataset();
+
 signals:
 
+    // the pinned content is being served (offline) or the server is reachable again
+    void signalOfflineChanged(bool offline);
+
+    // emitted when the features start to be parsed in the background
+    // the future reports the bytes consumed (value) and the features parsed (text)
+    // and it can be canceled (so the UI can show the progress)
+    void signalFeaturesParsing(QFuture<void> future);
+
 private:
     // Internal function to create network requests for data objects
     // The network call will be synchronous and the function will
     // return true of the the network call was successful (no errors)
     // or false otherwise.
     bool createRequest(QSharedPointer<NetworkReply> reply);
+    // Waits for the network request (see createRequest) and parses it (see parseRequest)
+    // Returns true if the download and parsing went fine
+    bool finishRequest(QSharedPointer<NetworkReply> reply, const DownloadType &type);
+    // The same as finishRequest but the image alignment, chip or tissue image
+    // is parsed into the content given instead of the containers
+    bool finishContentRequest(QSharedPointer<NetworkReply> reply,
+                              const DownloadType &type,
+                              DatasetContentCache::Content &content);
+    // Returns a future that finishes once the network request has finished and
+    // it has been parsed (see parseReply). Nothing is shown to the user
+    RequestFuture finishRequestAsync(QSharedPointer<NetworkReply> reply, const DownloadType &type);
+    // Returns a finished future of a request that was not needed (the data is
+    // already in the containers, see isOffline) or that failed with the error given
+    RequestFuture finishedRequest(const DownloadType &type,
+                                  QSharedPointer<Error> error = QSharedPointer<Error>()) const;
+    // Parses the finished network request and returns its error (null if none)
+    // into the content given if any (see parseContentReply)
+    // The returned error is not owned by the reply
+    QSharedPointer<Error> replyError(QSharedPointer<NetworkReply> reply,
+                                     const DownloadType &type,
+                                     DatasetContentCache::Content *content = nullptr);
+    // Returns the network error of the finished request (null if none), the
+    // data is not parsed (see replyError)
+    QSharedPointer<Error> networkError(QSharedPointer<NetworkReply> reply) const;
+
+    // DATASET CONTENT
+    // the state of an asynchronous load of a dataset content
+    struct ContentLoad;
+    // loads the dataset content from the caches (memory, pinned content and snapshots)
+    // returns true if it was found
+    bool loadCachedDatasetContent(const DatasetPtr dataset);
+    // replaces the current content with the one downloaded and caches it
+    void setDownloadedContent(const DatasetPtr dataset,
+                              const DatasetContentCache::Content &loaded);
+    // continues the load given when the reply given finishes
+    void watchContentReply(QSharedPointer<ContentLoad> load, QSharedPointer<NetworkReply> reply);
+    // parses the requests of the load given that have finished and makes the
+    // ones that depend on them, the load is finished once everything is parsed
+    void continueContentLoad(QSharedPointer<ContentLoad> load);
+    // fails the asynchronous load running (if any)
+    void cancelContentLoad();
+    // reports the result of the load given (the requests left are aborted)
+    void finishContentLoad(QSharedPointer<ContentLoad> load, QSharedPointer<Error> error);
+
+    // REQUEST FUNCTIONS
+    // Functions to start the download of the data objects without waiting for
+    // it so several downloads can run in parallel (see finishRequest)
+    // They return a null reply if the request could not be created
+
+    QSharedPointer<NetworkReply> requestImageAlignment(const QString &imageAlignmentId);
+    QSharedPointer<NetworkReply> requestCellTissueByName(const QString &name);
+    QSharedPointer<NetworkReply> requestChip(const QString &chipId);
+    QSharedPointer<NetworkReply> requestDatasets();
+    QSharedPointer<NetworkReply> requestUpdateDataset(const Dataset &dataset);
+    QSharedPointer<NetworkReply> requestRemoveDataset(const QString &datasetId);
+    QSharedPointer<NetworkReply> requestUser();
+    QSharedPointer<NetworkReply> requestUserSelections();
+    QSharedPointer<NetworkReply> requestUpdateUserSelection(const UserSelection &userSelection);
+    QSharedPointer<NetworkReply> requestRemoveSelection(const QString &selectionId);
+    QSharedPointer<NetworkReply> requestAddUserSelection(const UserSelection &userSelection);
+    QSharedPointer<NetworkReply> requestMinVersion();
+    QSharedPointer<NetworkReply> requestAccessToken(const QPair<QString, QString> &username,
+                                                    const QPair<QString, QString> &password);
+    // the features are parsed while they are downloaded
+    QSharedPointer<NetworkReply> requestFeatures(const QString &datasetId);
+    // waits for the features request and finishes their parsing
+    bool finishFeaturesRequest(QSharedPointer<NetworkReply> reply);
+    // aborts the features request (the current features are kept)
+    void abortFeaturesRequest(QSharedPointer<NetworkReply> reply);
     // Once the data of a network request has been downloaded the request
     // can be parsed to extract the data with this method
     // Returns true if the datas was parsed correctly false otherwise
+    // (the errors are shown to the user)
     bool parseRequest(QSharedPointer<NetworkReply> reply, const DownloadType &type);
+    // Shows the errors of the parsing of the request to the user (if any)
+    // Returns true if the data was parsed correctly and the reply has no errors
+    bool notifyParsing(QSharedPointer<NetworkReply> reply, const bool parsedOk);
+    // Parses the data of the network request and adds it to the containers
+    // Returns true if the datas was parsed correctly false otherwise
+    bool parseReply(QSharedPointer<NetworkReply> reply, const DownloadType &type);
+    // The same as parseReply but the image alignment, chip or tissue image
+    // is parsed into the content given instead of the containers
+    bool parseContentReply(QSharedPointer<NetworkReply> reply,
+                           const DownloadType &type,
+                           DatasetContentCache::Content &content);
 
     // PARSING FUNCTIONS
     // Functions to parse the data downloaded from the network
 
     // function to parse all the features and genes and add them to the containers
+    // the data can be in JSON or in binary format (see BinaryFeatureFile)
+    // the parsing is performed in a worker thread and the containers are
+    // only replaced if it succeeds
     // returns true if the parsing was correct
     bool parseFeatures(const QByteArray &rawData);
 
-    // function to parse a cell tissue image and add it to the container
+    // function to finish the parsing of the features streamed while they were
+    // downloaded (see loadFeatures) with the remaining data
+    // the chunks are merged in a worker thread (the UI is not blocked while waiting)
+    // and the containers are only replaced if the parsing succeeds
+    // returns true if the parsing was correct
+    bool parseFeaturesStream(const QByteArray &rawData);
+
+    // replaces the current features and genes with the parsed ones
+    // and creates the gene objects
+    void setFeatures(data::ParsedFeatures &parsed);
+
+    // replaces the current dataset content with the cached one
+    void setDatasetContent(const DatasetContentCache::Content &content);
+    // returns the current dataset content to be cached
+    DatasetContentCache::Content datasetContent(const DatasetPtr dataset) const;
+    // stores the content of the dataset if it is pinned
+    void storePinnedContent(const QString &datasetId, const DatasetContentCache::Content &content);
+
+    // starts or stops working offline
+    void setOffline(const bool offline);
+
+    // function to parse a cell tissue image and add it to the container given
     // returns true if the parsing was correct
-    bool parseCellTissueImage(const QByteArray &rawData, const QString &imageName);
+    bool parseCellTissueImage(const QByteArray &rawData,
+                              const QString &imageName,
+                              CellFigureMap &images);
 
-    // function to parse the datasets and add them to the container
+    // function to parse the datasets (whole list or changes since the last
+    // sync, see SyncState) and add them to the container
     // returns true if the parsing was correct
-    bool parseDatasets(const QJsonDocument &doc);
+    bool parseDatasets(const SyncState::Changes &changes);
 
     // removes the dataset from the container and its associated selections
     // returns true if it was removed
     bool parseRemoveDataset(const QString &datasetId);
 
-    // function to parse the user selections and add them to the container
+    // function to parse the user selections (whole list or changes since the
+    // last sync, see SyncState) and add them to the container
     // returns true if the parsing was correct
-    bool parseUserSelections(const QJsonDocument &doc);
+    bool parseUserSelections(const SyncState::Changes &changes);
 
     // removes the selection from the local container
     // returns true of it was removed
@@ -304,15 +600,17 @@ private:
 
     // function to parse the User and added to the container
     // returns true if the parsing was correct
-    bool parseUser(const QJsonDocument &doc);
+    bool parseUser(const QByteArray &rawData);
 
-    // function to parse the image alignment object and added to the container
+    // function to parse the image alignment object into the pointer given
+    // (it is not changed if the parsing fails)
     // returns true if the parsing was correct
-    bool parseImageAlignment(const QJsonDocument &doc);
+    bool parseImageAlignment(const QByteArray &rawData, ImageAlignmentPtr &imageAlignment);
 
-    // function to parse a chip and added to the container
+    // function to parse a chip into the pointer given
+    // (it is not changed if the parsing fails)
     // returns true if the parsing was correct
-    bool parseChip(const QJsonDocument &doc);
+    bool parseChip(const QByteArray &rawData, ChipPtr &chip);
 
     // function to parse the min version supported and added to the container
     // returns true if the parsing was correct
@@ -333,9 +631,15 @@ private:
     // the current chip object for the selected dataset
     ChipPtr m_chip;
     // the current features for the selected dataset
-    FeatureList m_featuresList;
-    // the map of gene names to gene objects
-    GeneNameToObject m_geneNameToObject;
+    FeatureStore m_features;
+    // the unique gene names of the current features
+    GeneDictionary m_geneDictionary;
+    // the gene objects indexed by gene ID
+    GeneIdToObject m_geneObjects;
+    // the features parsing currently running (if any)
+    QFuture<void> m_featuresParsing;
+    // the parser of the features being downloaded (if any)
+    QScopedPointer<data::FeaturesStreamParser> m_featuresStream;
     // the current images (blue and red) for the selected dataset
     CellFigureMap m_cellTissueImages;
     // the application min supported version
@@ -344,8 +648,38 @@ private:
     OAuth2TokenDTO m_accessToken;
     // configuration manager instance
     Configuration m_configurationManager;
+    // the content of the datasets opened recently
+    DatasetContentCache m_datasetCache;
+    // the snapshots on disk of the datasets opened
+    DatasetSnapshotCache m_datasetSnapshots;
+    // validators of the last download of the datasets and the selections
+    // so refreshing them only transfers what changed
+    SyncState m_datasetsSync;
+    SyncState m_selectionsSync;
     // network manager to make network requests (dataproxy owns it)
     QScopedPointer<NetworkManager> m_networkManager;
+    // downloads the content of the datasets in the background (uses the network manager)
+    QScopedPointer<DatasetPrefetcher> m_prefetcher;
+    // the datasets prefetched that have not been opened yet
+    QSet<QString> m_prefetchedDatasets;
+    PrefetchStatistics m_prefetchStatistics;
+    // the datasets and selections pinned for offline use
+    QScopedPointer<OfflineStore> m_offlineStore;
+    // the pinned content is served instead of making requests
+    bool m_offline;
+    // the user was loaded from the offline store (not from the server)
+    bool m_pinnedUser;
+    // pinned datasets whose content has to be downloaded
+    QStringList m_pinQueue;
+    // the pinned dataset whose content is being downloaded (see DatasetPrefetcher)
+    QString m_pinning;
+    // attempts to download the content of the pinned datasets since the last sync
+    QHash<QString, int> m_pinAttempts;
+    // probes the server while working offline
+    QTimer m_probeTimer;
+    QSharedPointer<NetworkReply> m_probeReply;
+    // the asynchronous load of a dataset content running (if any)
+    QSharedPointer<ContentLoad> m_contentLoad;
 
     Q_DISABLE_COPY(DataProxy)
 };
@@ -0,0 +1,157 @@
+#include "DatasetContentCache.h"
+
+#include <QDebug>
+
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+
+// 512MB by default
+const qint64 DatasetContentCache::DEFAULT_MAX_SIZE = 512 * 1024 * 1024;
+
+DatasetContentCache::Content::Content()
+    : lastModified()
+    , features()
+    , genes()
+    , chip(nullptr)
+    , imageAlignment(nullptr)
+    , images()
+{
+}
+
+DatasetContentCache::Statistics::Statistics()
+    : hits(0)
+    , misses(0)
+    , evictions(0)
+{
+}
+
+DatasetContentCache::DatasetContentCache(const qint64 maxSize)
+    : m_entries()
+    , m_order()
+    , m_maxSize(maxSize)
+    , m_size(0)
+    , m_statistics()
+{
+}
+
+DatasetContentCache::~DatasetContentCache()
+{
+}
+
+void DatasetContentCache::setMaxSize(const qint64 maxSize)
+{
+    m_maxSize = maxSize;
+    trim();
+}
+
+qint64 DatasetContentCache::maxSize() const
+{
+    return m_maxSize;
+}
+
+qint64 DatasetContentCache::size() const
+{
+    return m_size;
+}
+
+int DatasetContentCache::count() const
+{
+    return m_entries.size();
+}
+
+bool DatasetContentCache::find(const QString &datasetId,
+                               const QString &lastModified,
+                               Content &content)
+{
+    const auto it = m_entries.constFind(datasetId);
+    if (it == m_entries.constEnd()) {
+        ++m_statistics.misses;
+        return false;
+    }
+    if (it->content.lastModified != lastModified) {
+        // the dataset has been modified since it was cached
+        remove(datasetId);
+        ++m_statistics.misses;
+        return false;
+    }
+
+    content = it->content;
+    // make it the most recently used
+    m_order.removeOne(datasetId);
+    m_order.append(datasetId);
+    ++m_statistics.hits;
+    return true;
+}
+
+void DatasetContentCache::insert(const QString &datasetId, const Content &content)
+{
+    remove(datasetId);
+    const qint64 content_size = memoryUsage(content);
+    if (content_size > m_maxSize) {
+        qDebug() << "[DatasetContentCache] Dataset " << datasetId << " is too big to be cached";
+        return;
+    }
+
+    m_entries.insert(datasetId, {content, content_size});
+    m_order.append(datasetId);
+    m_size += content_size;
+    trim();
+}
+
+void DatasetContentCache::remove(const QString &datasetId)
+{
+    const auto it = m_entries.find(datasetId);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_size -= it->size;
+    m_entries.erase(it);
+    m_order.removeOne(datasetId);
+}
+
+bool DatasetContentCache::contains(const QString &datasetId) const
+{
+    return m_entries.contains(datasetId);
+}
+
+bool DatasetContentCache::contains(const QString &datasetId, const QString &lastModified) const
+{
+    const auto it = m_entries.constFind(datasetId);
+    return it != m_entries.constEnd() && it->content.lastModified == lastModified;
+}
+
+void DatasetContentCache::clear()
+{
+    m_entries.clear();
+    m_order.clear();
+    m_size = 0;
+    m_statistics = Statistics();
+}
+
+const DatasetContentCache::Statistics &DatasetContentCache::statistics() const
+{
+    return m_statistics;
+}
+
+qint64 DatasetContentCache::memoryUsage(const Content &content)
+{
+    qint64 size = content.features.memoryUsage();
+    // the names are stored twice (list and hash) with some overhead per entry
+    for (const QString &name : content.genes.names()) {
+        size += 2 * (name.size() * static_cast<qint64>(sizeof(QChar)) + 32);
+    }
+    for (const QByteArray &image : content.images) {
+        size += image.size();
+    }
+    return size;
+}
+
+void DatasetContentCache::trim()
+{
+    while (m_size > m_maxSize && !m_order.isEmpty()) {
+        const QString datasetId = m_order.first();
+        qDebug() << "[DatasetContentCache] Evicting dataset " << datasetId;
+        remove(datasetId);
+        ++m_statistics.evictions;
+    }
+}
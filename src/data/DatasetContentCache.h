@@ -0,0 +1,102 @@
+#ifndef DATASETCONTENTCACHE_H
+#define DATASETCONTENTCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <memory>
+
+#include "dataModel/GeneDictionary.h"
+#include "dataModel/FeatureStore.h"
+
+class Chip;
+class ImageAlignment;
+
+// DatasetContentCache keeps in memory the content of the datasets opened
+// recently (features, genes, chip, image alignment and tissue images) so
+// opening them again does not need to download and parse anything.
+// The entries are keyed by dataset ID and only valid for the lastModified
+// of the dataset they were created from. The least recently used entries
+// are evicted when the memory used exceeds the maximum size.
+class DatasetContentCache
+{
+
+public:
+    // the content of a dataset
+    struct Content {
+        Content();
+
+        // the lastModified of the dataset the content belongs to
+        QString lastModified;
+        FeatureStore features;
+        GeneDictionary genes;
+        std::shared_ptr<Chip> chip;
+        std::shared_ptr<ImageAlignment> imageAlignment;
+        // the tissue images (raw data) hashed by figure name
+        QHash<QString, QByteArray> images;
+    };
+
+    // hits and misses of the cache since it was created (or cleared)
+    struct Statistics {
+        Statistics();
+
+        int hits;
+        int misses;
+        int evictions;
+    };
+
+    // default maximum size in bytes
+    static const qint64 DEFAULT_MAX_SIZE;
+
+    explicit DatasetContentCache(const qint64 maxSize = DEFAULT_MAX_SIZE);
+    ~DatasetContentCache();
+
+    // sets the maximum memory (in bytes) the entries can use
+    // (entries are evicted if needed)
+    void setMaxSize(const qint64 maxSize);
+    qint64 maxSize() const;
+    // memory (in bytes) used by the entries
+    qint64 size() const;
+    // number of entries
+    int count() const;
+
+    // looks up the content of the dataset and returns true if it is cached and
+    // its lastModified is the one given (stale entries are removed)
+    bool find(const QString &datasetId, const QString &lastModified, Content &content);
+    // adds (or replaces) the content of the dataset as the most recently used
+    // content bigger than the maximum size is not cached
+    void insert(const QString &datasetId, const Content &content);
+    void remove(const QString &datasetId);
+    bool contains(const QString &datasetId) const;
+    // true if the content of the dataset is cached and it is up to date
+    // (it does not count as a hit or a miss)
+    bool contains(const QString &datasetId, const QString &lastModified) const;
+    // removes all the entries and resets the statistics
+    void clear();
+
+    const Statistics &statistics() const;
+
+    // returns an estimation of the memory (in bytes) used by the content
+    static qint64 memoryUsage(const Content &content);
+
+private:
+    struct Entry {
+        Content content;
+        qint64 size;
+    };
+
+    // evicts the least recently used entries until the size is within the maximum
+    void trim();
+
+    QHash<QString, Entry> m_entries;
+    // dataset IDs from the least to the most recently used
+    QList<QString> m_order;
+    qint64 m_maxSize;
+    qint64 m_size;
+    Statistics m_statistics;
+
+    Q_DISABLE_COPY(DatasetContentCache)
+};
+
+#endif // DATASETCONTENTCACHE_H //
@@ -4,6 +4,8 @@
 #include <QMessageBox>
 #include <QTextStream>
 
+#include "io/BinaryFeatureFile.h"
+
 DatasetImporter::DatasetImporter(QWidget *parent)
     : QDialog(parent)
     , m_ui(new Ui::DatasetImporter)
@@ -55,6 +57,11 @@ const QByteArray DatasetImporter::featuresFile() const
     return file.readAll();
 }
 
+const QString DatasetImporter::featuresFilePath() const
+{
+    return m_ui->featuresFile->text();
+}
+
 const QByteArray DatasetImporter::mainImageFile() const
 {
     QFile file(m_ui->mainImageFile->text());
@@ -121,7 +128,10 @@ void DatasetImporter::slotLoadFeaturesFile()
         = QFileDialog::getOpenFileName(this,
                                        tr("Open Features File"),
                                        QDir::homePath(),
-                                       QString("%1").arg(tr("JSON Files (*.json)")));
+                                       QString("%1;;%2")
+                                           .arg(tr("JSON Files (*.json)"))
+                                           .arg(tr("Binary Files (*.%1)")
+                                                    .arg(BinaryFeatureFile::FILE_SUFFIX)));
     // early out
     if (filename.isEmpty()) {
         return;
@@ -10,7 +10,7 @@ class DatasetImporter;
 
 // This widget allows the user to import a dataset.
 // The widget asks the user to introduce the chip
-// size, the alignment matrix, the features in JSON data
+// size, the alignment matrix, the features in JSON or binary data
 // and the images
 class DatasetImporter : public QDialog
 {
@@ -22,6 +22,8 @@ public:
 
     const QString datasetName() const;
     const QByteArray featuresFile() const;
+    // the path of the features file (binary files can be memory mapped)
+    const QString featuresFilePath() const;
     const QRect chipDimensions() const;
     const QTransform alignmentMatrix() const;
     const QByteArray mainImageFile() const;
@@ -0,0 +1,323 @@
+#include "DatasetPrefetcher.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <algorithm>
+
+#include "network/NetworkManager.h"
+#include "network/NetworkCommand.h"
+#include "network/NetworkReply.h"
+#include "network/RESTCommandFactory.h"
+#include "data/ObjectBinder.h"
+#include "data/FeaturesParser.h"
+#include "dataModel/Dataset.h"
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+
+DatasetPrefetcher::DatasetPrefetcher(NetworkManager *networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_configurationManager()
+    , m_datasetId()
+    , m_loadFigureRed(false)
+    , m_content()
+    , m_alignmentReply()
+    , m_chipReply()
+    , m_featuresReply()
+    , m_figureReplies()
+    , m_bytes(0)
+    , m_featuresStream(nullptr)
+    , m_featuresWatcher(nullptr)
+    , m_featuresParsed(false)
+{
+    Q_ASSERT(m_networkManager);
+}
+
+DatasetPrefetcher::~DatasetPrefetcher()
+{
+    reset();
+}
+
+void DatasetPrefetcher::start(const Dataset &dataset, const bool loadFigureRed)
+{
+    cancel();
+    if (dataset.id().isEmpty() || dataset.imageAlignmentId().isEmpty()) {
+        return;
+    }
+
+    qDebug() << "[DatasetPrefetcher] Prefetching dataset " << dataset.id();
+    m_datasetId = dataset.id();
+    m_loadFigureRed = loadFigureRed;
+    m_content.lastModified = dataset.lastModified();
+
+    // the features are requested first as they are the biggest download
+    // (they are parsed while they arrive as when the dataset is opened)
+    m_featuresStream.reset(new data::FeaturesStreamParser());
+    m_featuresReply = request(RESTCommandFactory::getFeatureByDatasetId(m_configurationManager,
+                                                                        m_datasetId),
+                              &DatasetPrefetcher::featuresFinished);
+    // the figures and the chip depend on the image alignment
+    m_alignmentReply
+        = request(RESTCommandFactory::getImageAlignmentById(m_configurationManager,
+                                                            dataset.imageAlignmentId()),
+                  &DatasetPrefetcher::alignmentFinished);
+    if (m_featuresReply.isNull() || m_alignmentReply.isNull()) {
+        discard();
+        return;
+    }
+
+    NetworkReply *features_reply = m_featuresReply.data();
+    connect(features_reply, &NetworkReply::signalDataAvailable, this, [=]() {
+        if (features_reply != m_featuresReply.data()) {
+            return;
+        }
+        m_featuresStream->setTotalSize(features_reply->contentLength());
+        // the request is aborted (and discarded when it finishes) if the data is not valid
+        if (!m_featuresStream->append(features_reply->getRaw())) {
+            features_reply->slotAbort();
+        }
+    });
+}
+
+void DatasetPrefetcher::cancel()
+{
+    if (isRunning()) {
+        qDebug() << "[DatasetPrefetcher] Canceling the prefetch of dataset " << m_datasetId;
+        discard();
+    }
+}
+
+bool DatasetPrefetcher::isRunning() const
+{
+    return !m_datasetId.isEmpty();
+}
+
+const QString &DatasetPrefetcher::datasetId() const
+{
+    return m_datasetId;
+}
+
+QSharedPointer<NetworkReply> DatasetPrefetcher::request(QSharedPointer<NetworkCommand> cmd,
+                                                        Handler handler)
+{
+    // the same flags as the other requests but with low priority, the requests
+    // are only sent when there is room for them (see NetworkManager::Priority)
+    NetworkManager::NetworkFlags flags(NetworkManager::Default);
+    flags &= ~static_cast<int>(NetworkManager::UseHighPriority);
+    flags |= NetworkManager::UseLowPriority;
+    auto reply = m_networkManager->httpRequest(cmd, flags, NetworkManager::Prefetch, this);
+    if (reply == nullptr) {
+        return reply;
+    }
+
+    // the handlers are queued so the replies can be released from them
+    NetworkReply *network_reply = reply.data();
+    connect(network_reply,
+            &NetworkReply::signalFinished,
+            this,
+            [=]() { (this->*handler)(network_reply); },
+            Qt::QueuedConnection);
+    return reply;
+}
+
+void DatasetPrefetcher::alignmentFinished(NetworkReply *reply)
+{
+    if (reply != m_alignmentReply.data()) {
+        return;
+    }
+    if (!replyOk(reply)) {
+        discard();
+        return;
+    }
+
+    ImageAlignment alignment;
+    if (!data::bindObject(reply->getRaw(), alignment)) {
+        discard();
+        return;
+    }
+    m_content.imageAlignment = std::make_shared<ImageAlignment>(alignment);
+    m_bytes += reply->bytesReceived();
+    m_alignmentReply.reset();
+
+    // the figures and the chip are downloaded in parallel
+    QStringList figures(m_content.imageAlignment->figureBlue());
+    if (m_loadFigureRed) {
+        figures.append(m_content.imageAlignment->figureRed());
+    }
+    for (const QString &name : figures) {
+        auto figure_reply
+            = request(RESTCommandFactory::getCellTissueFigureByName(m_configurationManager, name),
+                      &DatasetPrefetcher::figureFinished);
+        if (figure_reply.isNull()) {
+            discard();
+            return;
+        }
+        figure_reply->setProperty("figure_name", QVariant::fromValue<QString>(name));
+        m_figureReplies.append(figure_reply);
+    }
+    m_chipReply = request(RESTCommandFactory::getChipByChipId(m_configurationManager,
+                                                              m_content.imageAlignment->chipId()),
+                          &DatasetPrefetcher::chipFinished);
+    if (m_chipReply.isNull()) {
+        discard();
+    }
+}
+
+void DatasetPrefetcher::figureFinished(NetworkReply *reply)
+{
+    const auto it
+        = std::find_if(m_figureReplies.begin(),
+                       m_figureReplies.end(),
+                       [=](QSharedPointer<NetworkReply> figure) { return figure.data() == reply; });
+    if (it == m_figureReplies.end()) {
+        return;
+    }
+    const QByteArray raw_data = reply->getRaw();
+    if (!replyOk(reply) || raw_data.isEmpty()) {
+        discard();
+        return;
+    }
+
+    m_content.images.insert(reply->property("figure_name").toString(), raw_data);
+    m_bytes += reply->bytesReceived();
+    m_figureReplies.erase(it);
+    checkFinished();
+}
+
+void DatasetPrefetcher::chipFinished(NetworkReply *reply)
+{
+    if (reply != m_chipReply.data()) {
+        return;
+    }
+    if (!replyOk(reply)) {
+        discard();
+        return;
+    }
+
+    Chip chip;
+    if (!data::bindObject(reply->getRaw(), chip)) {
+        discard();
+        return;
+    }
+    m_content.chip = std::make_shared<Chip>(chip);
+    m_bytes += reply->bytesReceived();
+    m_chipReply.reset();
+    checkFinished();
+}
+
+void DatasetPrefetcher::featuresFinished(NetworkReply *reply)
+{
+    if (reply != m_featuresReply.data()) {
+        return;
+    }
+    if (!replyOk(reply)) {
+        discard();
+        return;
+    }
+
+    // only the last objects are left to parse at this point, the chunks are
+    // merged in a worker thread and the parsing is watched so the GUI thread is not blocked
+    m_bytes += reply->bytesReceived();
+    m_featuresStream->append(reply->getRaw());
+    m_featuresStream->finishAsync();
+    m_featuresReply.reset();
+
+    auto watcher = new QFutureWatcher<data::ParsedFeatures>(this);
+    connect(watcher,
+            &QFutureWatcherBase::finished,
+            this,
+            &DatasetPrefetcher::featuresParsed,
+            Qt::QueuedConnection);
+    watcher->setFuture(m_featuresStream->future());
+    m_featuresWatcher = watcher;
+}
+
+void DatasetPrefetcher::featuresParsed()
+{
+    // the watcher of a prefetch canceled or restarted is not connected anymore
+    auto watcher = static_cast<QFutureWatcher<data::ParsedFeatures> *>(m_featuresWatcher);
+    if (watcher == nullptr || !watcher->isFinished()) {
+        return;
+    }
+    const QFuture<data::ParsedFeatures> parsing = watcher->future();
+    m_featuresWatcher = nullptr;
+    watcher->deleteLater();
+    if (parsing.resultCount() == 0) {
+        qDebug() << "[DatasetPrefetcher] The parsing of the features failed";
+        discard();
+        return;
+    }
+
+    const data::ParsedFeatures parsed = parsing.result();
+    m_content.features = parsed.features;
+    m_content.genes = parsed.genes;
+    m_featuresParsed = true;
+    m_featuresStream.reset();
+    checkFinished();
+}
+
+void DatasetPrefetcher::checkFinished()
+{
+    const bool finished = m_featuresParsed && m_content.imageAlignment && m_content.chip
+                          && m_figureReplies.isEmpty();
+    if (!finished) {
+        return;
+    }
+
+    qDebug() << "[DatasetPrefetcher] Dataset " << m_datasetId << " prefetched";
+    const QString datasetId = m_datasetId;
+    const DatasetContentCache::Content content = m_content;
+    reset();
+    emit signalFinished(datasetId, content);
+}
+
+void DatasetPrefetcher::discard()
+{
+    qint64 bytes = m_bytes;
+    for (const auto reply : {m_alignmentReply, m_chipReply, m_featuresReply}) {
+        if (reply != nullptr) {
+            bytes += reply->bytesReceived();
+        }
+    }
+    for (const auto reply : m_figureReplies) {
+        bytes += reply->bytesReceived();
+    }
+
+    const QString datasetId = m_datasetId;
+    reset();
+    emit signalDiscarded(datasetId, bytes);
+}
+
+void DatasetPrefetcher::reset()
+{
+    QList<QSharedPointer<NetworkReply>> replies = m_figureReplies;
+    replies << m_alignmentReply << m_chipReply << m_featuresReply;
+    for (const auto reply : replies) {
+        if (reply != nullptr) {
+            reply->disconnect(this);
+        }
+    }
+    m_networkManager->cancelRequests(this);
+
+    m_datasetId.clear();
+    m_loadFigureRed = false;
+    m_content = DatasetContentCache::Content();
+    m_alignmentReply.reset();
+    m_chipReply.reset();
+    m_featuresReply.reset();
+    m_figureReplies.clear();
+    m_bytes = 0;
+    if (m_featuresWatcher != nullptr) {
+        m_featuresWatcher->disconnect(this);
+        m_featuresWatcher->deleteLater();
+        m_featuresWatcher = nullptr;
+    }
+    m_featuresStream.reset();
+    m_featuresParsed = false;
+}
+
+bool DatasetPrefetcher::replyOk(const NetworkReply *reply)
+{
+    return reply->isFinished() && !reply->hasErrors()
+           && reply->return_code() == NetworkReply::CodeSuccess;
+}
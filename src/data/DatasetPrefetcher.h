@@ -0,0 +1,104 @@
+#ifndef DATASETPREFETCHER_H
+#define DATASETPREFETCHER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QScopedPointer>
+#include <QList>
+
+#include "config/Configuration.h"
+#include "data/DatasetContentCache.h"
+
+class NetworkManager;
+class NetworkReply;
+class NetworkCommand;
+class Dataset;
+namespace data
+{
+class FeaturesStreamParser;
+}
+
+// DatasetPrefetcher downloads and parses the content of a dataset (image
+// alignment, cell tissue figures, chip and features) in the background with
+// low network priority so it is ready when the dataset is opened.
+// The content is built in its own containers (the ones of DataProxy are not
+// touched) and it is given with signalFinished.
+// Only one dataset is prefetched at a time, starting another one or canceling
+// aborts the downloads in flight. Errors are not notified to the user.
+class DatasetPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    // the network manager is not owned
+    explicit DatasetPrefetcher(NetworkManager *networkManager, QObject *parent = 0);
+    ~DatasetPrefetcher();
+
+    // starts the prefetch of the dataset (any other prefetch is canceled)
+    // the red figure is only downloaded if loadFigureRed is true
+    void start(const Dataset &dataset, const bool loadFigureRed);
+    // aborts the prefetch running (if any), signalDiscarded is emitted
+    void cancel();
+
+    // true if a dataset is being prefetched
+    bool isRunning() const;
+    // the dataset being prefetched (empty if none)
+    const QString &datasetId() const;
+
+signals:
+
+    // the content of the dataset has been downloaded and parsed
+    void signalFinished(const QString &datasetId, const DatasetContentCache::Content &content);
+    // the prefetch failed or was canceled, bytes is what had been downloaded
+    void signalDiscarded(const QString &datasetId, const qint64 bytes);
+
+private:
+    // handler of a finished request
+    typedef void (DatasetPrefetcher::*Handler)(NetworkReply *reply);
+
+    // creates a low priority request for the command (null if it failed)
+    // and connects it to the handler given (called once the request has finished)
+    QSharedPointer<NetworkReply> request(QSharedPointer<NetworkCommand> cmd, Handler handler);
+    // handlers of the finished requests
+    void alignmentFinished(NetworkReply *reply);
+    void figureFinished(NetworkReply *reply);
+    void chipFinished(NetworkReply *reply);
+    void featuresFinished(NetworkReply *reply);
+    // handler of the features parsed (the parsing finishes in a worker thread)
+    void featuresParsed();
+    // emits signalFinished if all the content is ready
+    void checkFinished();
+    // aborts everything and emits signalDiscarded
+    void discard();
+    // resets the state (the requests in flight are aborted)
+    void reset();
+    // true if the request finished correctly
+    static bool replyOk(const NetworkReply *reply);
+
+    // network manager (not owned)
+    NetworkManager *m_networkManager;
+    // configuration manager instance
+    Configuration m_configurationManager;
+    // the dataset being prefetched
+    QString m_datasetId;
+    bool m_loadFigureRed;
+    // the content built so far
+    DatasetContentCache::Content m_content;
+    // requests in flight
+    QSharedPointer<NetworkReply> m_alignmentReply;
+    QSharedPointer<NetworkReply> m_chipReply;
+    QSharedPointer<NetworkReply> m_featuresReply;
+    QList<QSharedPointer<NetworkReply>> m_figureReplies;
+    // bytes downloaded by the finished requests
+    qint64 m_bytes;
+    // the features are parsed while they are downloaded
+    QScopedPointer<data::FeaturesStreamParser> m_featuresStream;
+    // watches the end of the parsing once the features are downloaded
+    QFutureWatcherBase *m_featuresWatcher;
+    bool m_featuresParsed;
+
+    Q_DISABLE_COPY(DatasetPrefetcher)
+};
+
+#endif // DATASETPREFETCHER_H //
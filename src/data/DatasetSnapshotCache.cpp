@@ -0,0 +1,297 @@
+#include "DatasetSnapshotCache.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QMultiMap>
+#include <QtConcurrent>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "data/ObjectParser.h"
+#include "data/FeaturesParser.h"
+#include "dataModel/Chip.h"
+#include "dataModel/ChipDTO.h"
+#include "dataModel/ImageAlignment.h"
+#include "dataModel/ImageAlignmentDTO.h"
+#include "dataModel/LastModifiedDTO.h"
+#include "io/BinaryFeatureFile.h"
+#include "utils/FileFunctions.h"
+
+namespace
+{
+
+const QString META_FILE = QStringLiteral("snapshot.json");
+const QString FIGURE_FILE = QStringLiteral("figure%1");
+const QString ACCESS_FILE = QStringLiteral("access");
+
+// the name of the features file (the suffix is defined in another translation unit)
+inline QString featuresFile()
+{
+    return QStringLiteral("features.") + BinaryFeatureFile::FILE_SUFFIX;
+}
+
+// writes the current time to the access file of the snapshot in the directory given
+bool writeAccess(const QDir &dir)
+{
+    return writeFile(dir.filePath(ACCESS_FILE),
+                     QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+}
+}
+
+const int DatasetSnapshotCache::VERSION;
+const qint64 DatasetSnapshotCache::DEFAULT_MAX_SIZE = Q_INT64_C(2) * 1024 * 1024 * 1024;
+
+DatasetSnapshotCache::DatasetSnapshotCache(const QString &directory, const qint64 maxSize)
+    : m_directory(directory)
+    , m_maxSize(maxSize)
+    , m_writePool()
+    , m_writes()
+{
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                      + QDir::separator() + "snapshots";
+    }
+    m_writePool.setMaxThreadCount(1);
+}
+
+DatasetSnapshotCache::~DatasetSnapshotCache()
+{
+    waitForWrites();
+}
+
+const QString &DatasetSnapshotCache::directory() const
+{
+    return m_directory;
+}
+
+bool DatasetSnapshotCache::read(const QString &datasetId,
+                                const QString &lastModified,
+                                DatasetContentCache::Content &content) const
+{
+    // the snapshot being written is read once written
+    QFuture<bool> writing = m_writes.value(datasetId).second;
+    writing.waitForFinished();
+
+    const QDir dir(datasetDirectory(datasetId));
+    QFile meta_file(dir.filePath(META_FILE));
+    if (!meta_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(meta_file.readAll());
+    const QJsonObject root = doc.object();
+    LastModifiedDTO last_modified;
+    if (!data::parseObject(doc.toVariant(), &last_modified)
+        || root.value("version").toInt() != VERSION
+        || last_modified.lastModified() != lastModified) {
+        qDebug() << "[DatasetSnapshotCache] The snapshot of the dataset " << datasetId
+                 << " is not valid or not up to date";
+        return false;
+    }
+
+    // the features file is memory mapped and only its columns copied
+    BinaryFeatureFile features_file;
+    data::ParsedFeatures parsed;
+    if (!features_file.open(dir.filePath(featuresFile()))
+        || !data::parseFeatures(features_file, parsed)) {
+        qDebug() << "[DatasetSnapshotCache] Error reading the features of the dataset "
+                 << datasetId;
+        return false;
+    }
+
+    ChipDTO chip;
+    ImageAlignmentDTO alignment;
+    if (!data::parseObject(root.value("chip").toVariant(), &chip)
+        || !data::parseObject(root.value("image_alignment").toVariant(), &alignment)) {
+        return false;
+    }
+
+    QHash<QString, QByteArray> images;
+    const QJsonArray figures = root.value("figures").toArray();
+    for (int i = 0; i < figures.size(); ++i) {
+        QFile figure_file(dir.filePath(FIGURE_FILE.arg(i)));
+        if (!figure_file.open(QIODevice::ReadOnly)) {
+            qDebug() << "[DatasetSnapshotCache] Error reading the figures of the dataset "
+                     << datasetId;
+            return false;
+        }
+        images.insert(figures.at(i).toString(), figure_file.readAll());
+    }
+
+    content.lastModified = lastModified;
+    content.features = parsed.features;
+    content.genes = parsed.genes;
+    content.chip = std::make_shared<Chip>(chip.chip());
+    content.imageAlignment = std::make_shared<ImageAlignment>(alignment.imageAlignment());
+    content.images = images;
+    writeAccess(dir);
+    return true;
+}
+
+bool DatasetSnapshotCache::contains(const QString &datasetId, const QString &lastModified) const
+{
+    const auto writing = m_writes.find(datasetId);
+    if (writing != m_writes.end() && !writing->second.isFinished()) {
+        return writing->first == lastModified;
+    }
+    QFile meta_file(QDir(datasetDirectory(datasetId)).filePath(META_FILE));
+    if (!meta_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(meta_file.readAll()).object();
+    return root.value("version").toInt() == VERSION
+           && root.value("last_modified").toString() == lastModified;
+}
+
+bool DatasetSnapshotCache::write(const QString &datasetId,
+                                 const DatasetContentCache::Content &content) const
+{
+    if (!content.chip || !content.imageAlignment) {
+        return false;
+    }
+
+    QDir dir(datasetDirectory(datasetId));
+    if (!dir.mkpath(".")) {
+        qDebug() << "[DatasetSnapshotCache] Error creating the directory " << dir.path();
+        return false;
+    }
+    // the current snapshot is not valid while the new one is written
+    dir.remove(META_FILE);
+
+    QSaveFile features_file(dir.filePath(featuresFile()));
+    if (!features_file.open(QIODevice::WriteOnly)
+        || !BinaryFeatureFile::write(features_file, content.features, content.genes)
+        || !features_file.commit()) {
+        qDebug() << "[DatasetSnapshotCache] Error writing the features of the dataset "
+                 << datasetId;
+        return false;
+    }
+
+    QJsonArray figures;
+    for (auto it = content.images.constBegin(); it != content.images.constEnd(); ++it) {
+        if (!writeFile(dir.filePath(FIGURE_FILE.arg(figures.size())), it.value())) {
+            qDebug() << "[DatasetSnapshotCache] Error writing the figures of the dataset "
+                     << datasetId;
+            return false;
+        }
+        figures.append(it.key());
+    }
+
+    ChipDTO chip;
+    chip.chip() = *content.chip;
+    ImageAlignmentDTO alignment;
+    alignment.imageAlignment() = *content.imageAlignment;
+    QJsonObject root;
+    root["version"] = VERSION;
+    root["last_modified"] = content.lastModified;
+    root["chip"] = QJsonObject::fromVariantMap(data::serializeObject(&chip));
+    root["image_alignment"] = QJsonObject::fromVariantMap(data::serializeObject(&alignment));
+    root["figures"] = figures;
+    if (!writeAccess(dir)
+        || !writeFile(dir.filePath(META_FILE),
+                      QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        return false;
+    }
+    trim(dir.path());
+    return true;
+}
+
+QFuture<bool> DatasetSnapshotCache::writeAsync(const QString &datasetId,
+                                               const DatasetContentCache::Content &content)
+{
+    for (auto it = m_writes.begin(); it != m_writes.end();) {
+        if (it->second.isFinished()) {
+            it = m_writes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // the features, genes and images are implicitly shared but
+    // the chip and the alignment are copied so they are not shared with the worker
+    DatasetContentCache::Content written = content;
+    if (content.chip) {
+        written.chip = std::make_shared<Chip>(*content.chip);
+    }
+    if (content.imageAlignment) {
+        written.imageAlignment = std::make_shared<ImageAlignment>(*content.imageAlignment);
+    }
+    const QFuture<bool> writing = QtConcurrent::run(&m_writePool, [this, datasetId, written]() {
+        const bool ok = write(datasetId, written);
+        if (!ok) {
+            qDebug() << "[DatasetSnapshotCache] Error writing the snapshot of the dataset "
+                     << datasetId;
+        }
+        return ok;
+    });
+    m_writes.insert(datasetId, qMakePair(content.lastModified, writing));
+    return writing;
+}
+
+void DatasetSnapshotCache::waitForWrites()
+{
+    m_writePool.waitForDone();
+    m_writes.clear();
+}
+
+void DatasetSnapshotCache::remove(const QString &datasetId)
+{
+    waitForWrites();
+    QDir(datasetDirectory(datasetId)).removeRecursively();
+}
+
+void DatasetSnapshotCache::clear()
+{
+    waitForWrites();
+    QDir(m_directory).removeRecursively();
+}
+
+void DatasetSnapshotCache::trim(const QString &keptDirectory) const
+{
+    if (m_maxSize <= 0) {
+        return;
+    }
+
+    // the snapshots (directory and size) by last access
+    QMultiMap<qint64, QPair<QString, qint64>> snapshots;
+    qint64 size = 0;
+    const QString kept_name = QFileInfo(keptDirectory).fileName();
+    const QFileInfoList directories
+        = QDir(m_directory).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo &info : directories) {
+        qint64 snapshot_size = 0;
+        QDirIterator files(info.filePath(), QDir::Files);
+        while (files.hasNext()) {
+            files.next();
+            snapshot_size += files.fileInfo().size();
+        }
+        size += snapshot_size;
+        if (info.fileName() == kept_name) {
+            continue;
+        }
+        QFile access_file(QDir(info.filePath()).filePath(ACCESS_FILE));
+        const qint64 access
+            = access_file.open(QIODevice::ReadOnly) ? access_file.readAll().toLongLong() : 0;
+        snapshots.insert(access, qMakePair(info.filePath(), snapshot_size));
+    }
+
+    for (auto it = snapshots.constBegin(); it != snapshots.constEnd() && size > m_maxSize; ++it) {
+        if (QDir(it->first).removeRecursively()) {
+            size -= it->second;
+        }
+    }
+}
+
+const QString DatasetSnapshotCache::datasetDirectory(const QString &datasetId) const
+{
+    // the IDs are hashed so they are valid file names
+    const QByteArray hash = QCryptographicHash::hash(datasetId.toUtf8(), QCryptographicHash::Md5);
+    return m_directory + QDir::separator() + QString::fromLatin1(hash.toHex());
+}
@@ -0,0 +1,83 @@
+#ifndef DATASETSNAPSHOTCACHE_H
+#define DATASETSNAPSHOTCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QPair>
+#include <QFuture>
+#include <QThreadPool>
+
+#include "data/DatasetContentCache.h"
+
+// DatasetSnapshotCache stores on disk a snapshot of the content of the
+// datasets opened so opening them again, even after a restart, does not need
+// to download or parse anything. A snapshot is only valid for the
+// lastModified of the dataset it was created from.
+// Layout (one directory per dataset):
+//   snapshot.json   version, last_modified, chip, image alignment and the
+//                   names of the tissue figures
+//   features.stbin  features and genes in columnar form (see BinaryFeatureFile)
+//   figure<N>       raw data of the tissue figures (in the order of the names)
+//   access          time of the last access (ms since epoch)
+// The JSON file is written last so incomplete snapshots are never used.
+// The least recently accessed snapshots are removed when they exceed the maximum size.
+// The cut-offs of the genes are not stored: the snapshot holds the gene names only
+// (GeneDictionary) and the renderer computes the cut-offs from the counts
+// every time it loads the data (see GeneRendererGL::compuateGenesCutoff()).
+class DatasetSnapshotCache
+{
+
+public:
+    // current version of the snapshots
+    static const int VERSION = 1;
+    // default maximum size of the snapshots in bytes (2GB)
+    static const qint64 DEFAULT_MAX_SIZE;
+
+    // the snapshots are stored in the directory given
+    // (or in the cache location of the application if empty)
+    // the snapshots are never removed to meet the size if maxSize is 0
+    explicit DatasetSnapshotCache(const QString &directory = QString(),
+                                  const qint64 maxSize = DEFAULT_MAX_SIZE);
+    ~DatasetSnapshotCache();
+
+    const QString &directory() const;
+
+    // loads the snapshot of the dataset if it exists and its lastModified is the one given
+    // returns true if the snapshot was valid
+    bool read(const QString &datasetId,
+              const QString &lastModified,
+              DatasetContentCache::Content &content) const;
+    // true if the snapshot of the dataset exists and its lastModified is the one given
+    // (only the JSON file is read, a snapshot being written counts as existing)
+    bool contains(const QString &datasetId, const QString &lastModified) const;
+    // writes (or replaces) the snapshot of the dataset
+    // returns true if the writing was correct
+    bool write(const QString &datasetId, const DatasetContentCache::Content &content) const;
+    // writes (or replaces) the snapshot of the dataset in a worker thread
+    // (the writings are done one after the other, read() waits for the one of the dataset)
+    QFuture<bool> writeAsync(const QString &datasetId, const DatasetContentCache::Content &content);
+    // waits for the snapshots being written
+    void waitForWrites();
+    // removes the snapshot of the dataset
+    void remove(const QString &datasetId);
+    // removes all the snapshots
+    void clear();
+
+private:
+    // the directory of the snapshot of the dataset
+    const QString datasetDirectory(const QString &datasetId) const;
+    // removes the least recently accessed snapshots (but the one of the directory
+    // given) until they are within the maximum size
+    void trim(const QString &keptDirectory) const;
+
+    QString m_directory;
+    qint64 m_maxSize;
+    // the writings (one at a time)
+    QThreadPool m_writePool;
+    // the last writing of the datasets (by ID) with the lastModified of their content
+    QHash<QString, QPair<QString, QFuture<bool>>> m_writes;
+
+    Q_DISABLE_COPY(DatasetSnapshotCache)
+};
+
+#endif // DATASETSNAPSHOTCACHE_H //
@@ -0,0 +1,1000 @@
+#include "FeaturesParser.h"
+
+#include <QDebug>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <deque>
+#include <limits>
+
+#include "io/BinaryFeatureFile.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/error/en.h"
+
+using namespace rapidjson;
+
+namespace
+{
+
+// number of features parsed between progress reports/cancellation checks
+const int PROGRESS_INTERVAL = 10000;
+// data smaller than this is not worth parsing in parallel
+const int MIN_PARALLEL_SIZE = 4 * 1024 * 1024;
+// chunks per thread (more chunks than threads balance the load better)
+const int CHUNKS_PER_THREAD = 4;
+// size of the chunks of complete objects parsed by the stream parser
+const int STREAM_CHUNK_SIZE = 1024 * 1024;
+// bytes needed to detect the format of the data
+const int FORMAT_MAGIC_SIZE = 4;
+
+// Progress of a parsing shared by all the workers
+// it reports to the future interface (if any) and it is used to check for cancellation
+// The progress of the future interface is an int so the bytes are scaled
+// down (see setTotalBytes) when the data is bigger than 2 GB
+class ParsingProgress
+{
+
+public:
+    explicit ParsingProgress(QFutureInterface<data::ParsedFeatures> *futureInterface)
+        : m_futureInterface(futureInterface)
+        , m_bytes(0)
+        , m_features(0)
+        , m_shift(0)
+    {
+    }
+
+    // sets the total bytes of the data as the progress range
+    void setTotalBytes(const qint64 bytes)
+    {
+        int shift = 0;
+        while ((bytes >> shift) > std::numeric_limits<int>::max()) {
+            ++shift;
+        }
+        m_shift.store(shift);
+        if (m_futureInterface != nullptr) {
+            m_futureInterface->setProgressRange(0, static_cast<int>(bytes >> shift));
+        }
+    }
+
+    // adds the bytes and features given to the total
+    // returns false if the parsing has been canceled
+    bool report(const qint64 bytes, const int features)
+    {
+        if (m_futureInterface == nullptr) {
+            return true;
+        }
+        if (m_futureInterface->isCanceled()) {
+            return false;
+        }
+        const qint64 total_bytes = m_bytes.fetchAndAddRelaxed(bytes) + bytes;
+        const int total_features = m_features.fetchAndAddRelaxed(features) + features;
+        const qint64 value = qMin<qint64>(total_bytes >> m_shift.load(),
+                                          std::numeric_limits<int>::max());
+        m_futureInterface->setProgressValueAndText(static_cast<int>(value),
+                                                   QString::number(total_features));
+        return true;
+    }
+
+private:
+    QFutureInterface<data::ParsedFeatures> *m_futureInterface;
+    QAtomicInteger<qint64> m_bytes;
+    QAtomicInt m_features;
+    // the bytes are divided by 2^shift to fit the progress range
+    QAtomicInt m_shift;
+
+    Q_DISABLE_COPY(ParsingProgress)
+};
+
+// Read-only rapidjson stream over a range of objects of the features array
+// The range is presented to rapidjson as an array ("[" + range + "]") so each
+// range can be parsed independently
+class ChunkStream
+{
+
+public:
+    typedef char Ch;
+
+    ChunkStream(const char *begin, const char *end)
+        : m_begin(begin)
+        , m_size(end - begin)
+        , m_pos(-1)
+    {
+    }
+
+    Ch Peek() const
+    {
+        if (m_pos < 0) {
+            return '[';
+        } else if (m_pos < m_size) {
+            return m_begin[m_pos];
+        } else if (m_pos == m_size) {
+            return ']';
+        }
+        return '\0';
+    }
+
+    Ch Take()
+    {
+        const Ch c = Peek();
+        ++m_pos;
+        return c;
+    }
+
+    size_t Tell() const { return static_cast<size_t>(m_pos + 1); }
+
+    Ch *PutBegin()
+    {
+        Q_ASSERT(false);
+        return nullptr;
+    }
+    void Put(Ch) { Q_ASSERT(false); }
+    void Flush() { Q_ASSERT(false); }
+    size_t PutEnd(Ch *)
+    {
+        Q_ASSERT(false);
+        return 0;
+    }
+
+private:
+    const char *m_begin;
+    const ptrdiff_t m_size;
+    ptrdiff_t m_pos;
+};
+
+// The values of a feature object read so far
+struct FeatureValues {
+    FeatureValues()
+        : gene()
+        , x(0.0f)
+        , y(0.0f)
+        , count(0)
+    {
+    }
+
+    void clear()
+    {
+        gene.clear();
+        x = 0.0f;
+        y = 0.0f;
+        count = 0;
+    }
+
+    QString gene;
+    float x;
+    float y;
+    int count;
+};
+
+// A field of the feature objects: its name in the JSON and the functions
+// that set its value from a number or a string (converted as QVariant would)
+struct FeatureField {
+    typedef void (*NumberSetter)(FeatureValues &values, const double value);
+    typedef void (*StringSetter)(FeatureValues &values, const char *str, const SizeType length);
+
+    template <std::size_t N>
+    constexpr FeatureField(const char (&fieldName)[N], NumberSetter number, StringSetter string)
+        : name(fieldName)
+        , length(static_cast<SizeType>(N - 1))
+        , setNumber(number)
+        , setString(string)
+    {
+    }
+
+    bool matches(const char *key, const SizeType keyLength) const
+    {
+        return keyLength == length && std::memcmp(key, name, length) == 0;
+    }
+
+    const char *name;
+    SizeType length;
+    NumberSetter setNumber;
+    StringSetter setString;
+};
+
+void setGeneNumber(FeatureValues &values, const double value)
+{
+    values.gene = QString::number(value, 'g', std::numeric_limits<double>::digits10);
+}
+
+void setGeneString(FeatureValues &values, const char *str, const SizeType length)
+{
+    values.gene = QString::fromUtf8(str, static_cast<int>(length));
+}
+
+void setXNumber(FeatureValues &values, const double value)
+{
+    values.x = static_cast<float>(value);
+}
+
+void setXString(FeatureValues &values, const char *str, const SizeType length)
+{
+    values.x = QString::fromUtf8(str, static_cast<int>(length)).toFloat();
+}
+
+void setYNumber(FeatureValues &values, const double value)
+{
+    values.y = static_cast<float>(value);
+}
+
+void setYString(FeatureValues &values, const char *str, const SizeType length)
+{
+    values.y = QString::fromUtf8(str, static_cast<int>(length)).toFloat();
+}
+
+void setCountNumber(FeatureValues &values, const double value)
+{
+    values.count = qRound(value);
+}
+
+void setCountString(FeatureValues &values, const char *str, const SizeType length)
+{
+    values.count = QString::fromUtf8(str, static_cast<int>(length)).toInt();
+}
+
+// the fields of the features (same names as the properties of FeatureDTO)
+constexpr FeatureField FEATURE_FIELDS[] = {
+    {"gene", &setGeneNumber, &setGeneString},
+    {"x", &setXNumber, &setXString},
+    {"y", &setYNumber, &setYString},
+    {"hits", &setCountNumber, &setCountString},
+};
+
+// Handler with call backs for rapidjson
+// explicitly made to parse the Features JSON type object
+// references to the containers are passed and will be filled up
+// with the parsed objects
+// The values are set straight from the events through the table of the
+// fields (the fields that are not known and the nested values are skipped)
+template <typename Stream>
+struct FeaturesHandler {
+
+public:
+    FeaturesHandler(FeatureStoreBuilder &features,
+                    GeneDictionary &genes,
+                    const Stream &stream,
+                    ParsingProgress &progress)
+        : features(features)
+        , geneDictionary(genes)
+        , stream(stream)
+        , progress(progress)
+        , reportedBytes(0)
+        , reportedFeatures(0)
+        , depth(0)
+        , currentField(nullptr)
+        , values()
+    {
+    }
+
+    // reports the progress not reported yet
+    // returns false if the parsing has been canceled
+    bool reportProgress()
+    {
+        const qint64 bytes = static_cast<qint64>(stream.Tell());
+        const int parsed_features = features.size();
+        const bool canceled
+            = !progress.report(bytes - reportedBytes, parsed_features - reportedFeatures);
+        reportedBytes = bytes;
+        reportedFeatures = parsed_features;
+        return !canceled;
+    }
+
+    bool Null() { return false; }
+    bool Bool(bool) { return false; }
+
+    bool Int(int i) { return number(i); }
+    bool Uint(unsigned u) { return number(u); }
+    bool Int64(int64_t i) { return number(static_cast<double>(i)); }
+    bool Uint64(uint64_t u) { return number(static_cast<double>(u)); }
+    bool Double(double d) { return number(d); }
+
+    bool RawNumber(const char *, SizeType, bool) { return true; }
+
+    bool String(const char *str, SizeType length, bool)
+    {
+        if (depth == FEATURE_DEPTH && currentField != nullptr) {
+            currentField->setString(values, str, length);
+        }
+        return true;
+    }
+
+    bool StartObject()
+    {
+        if (++depth == FEATURE_DEPTH) {
+            values.clear();
+            currentField = nullptr;
+        }
+        return true;
+    }
+
+    bool Key(const char *str, SizeType length, bool)
+    {
+        if (depth != FEATURE_DEPTH) {
+            return true;
+        }
+        currentField = nullptr;
+        for (const FeatureField &field : FEATURE_FIELDS) {
+            if (field.matches(str, length)) {
+                currentField = &field;
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool EndObject(SizeType)
+    {
+        if (depth-- != FEATURE_DEPTH) {
+            return true;
+        }
+
+        Q_ASSERT(!values.gene.isNull() && !values.gene.isEmpty());
+
+        // update containers (the gene name is interned)
+        features.append(geneDictionary.insert(values.gene), values.x, values.y, values.count);
+
+        // report progress and stop the parsing if it was canceled
+        if (features.size() % PROGRESS_INTERVAL == 0) {
+            return reportProgress();
+        }
+
+        return true;
+    }
+
+    bool StartArray()
+    {
+        ++depth;
+        return true;
+    }
+
+    bool EndArray(SizeType)
+    {
+        --depth;
+        return true;
+    }
+
+private:
+    // the features are the objects of the top level array
+    static const int FEATURE_DEPTH = 2;
+
+    bool number(const double value)
+    {
+        if (depth == FEATURE_DEPTH && currentField != nullptr) {
+            currentField->setNumber(values, value);
+        }
+        return true;
+    }
+
+    FeatureStoreBuilder &features;
+    GeneDictionary &geneDictionary;
+    const Stream &stream;
+    ParsingProgress &progress;
+    qint64 reportedBytes;
+    int reportedFeatures;
+    // nesting of the arrays and objects
+    int depth;
+    // the field of the current key (null if it is not known)
+    const FeatureField *currentField;
+    FeatureValues values;
+};
+
+// parses the features from the stream given (adding them to the containers)
+// returns true if the parsing was correct
+template <typename Stream>
+bool parseStream(Stream &is,
+                 FeatureStoreBuilder &features,
+                 GeneDictionary &genes,
+                 ParsingProgress &progress)
+{
+    FeaturesHandler<Stream> handler(features, genes, is, progress);
+    Reader reader;
+    const ParseResult result = reader.Parse(is, handler);
+    if (result.IsError() && result.Code() != kParseErrorTermination) {
+        qDebug() << "[FeaturesParser] Error parsing features " << GetParseError_En(result.Code())
+                 << " at " << result.Offset();
+    }
+    return !result.IsError() && handler.reportProgress();
+}
+
+inline bool isWhiteSpace(const char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Resumable scanner of the top level array of objects of the features
+// It only finds the boundaries of the objects (the objects are validated by
+// rapidjson) and it keeps its state between calls so the data can be
+// scanned in pieces of any size
+class FeaturesArrayScanner
+{
+
+public:
+    enum Event { None, ObjectBegin, ObjectEnd, ArrayEnd, Error };
+
+    FeaturesArrayScanner()
+        : m_state(BeforeArray)
+        , m_depth(0)
+        , m_expectObject(true)
+        , m_empty(true)
+    {
+    }
+
+    // scans the next character
+    Event next(const char c)
+    {
+        switch (m_state) {
+        case BeforeArray:
+            if (c == '[') {
+                m_state = BetweenObjects;
+                return None;
+            }
+            return isWhiteSpace(c) ? None : Error;
+        case BetweenObjects:
+            // only separators are allowed between the objects
+            if (isWhiteSpace(c)) {
+                return None;
+            } else if (c == ',' && !m_expectObject) {
+                m_expectObject = true;
+                return None;
+            } else if (c == '{' && m_expectObject) {
+                m_state = InObject;
+                m_depth = 1;
+                m_expectObject = false;
+                m_empty = false;
+                return ObjectBegin;
+            } else if (c == ']' && (!m_expectObject || m_empty)) {
+                m_state = AfterArray;
+                return ArrayEnd;
+            }
+            return Error;
+        case InObject:
+            if (c == '"') {
+                m_state = InString;
+            } else if (c == '{' || c == '[') {
+                ++m_depth;
+            } else if (c == '}' || c == ']') {
+                if (--m_depth == 0) {
+                    m_state = BetweenObjects;
+                    return ObjectEnd;
+                }
+            }
+            return None;
+        case InString:
+            if (c == '\\') {
+                m_state = InEscape;
+            } else if (c == '"') {
+                m_state = InObject;
+            }
+            return None;
+        case InEscape:
+            m_state = InString;
+            return None;
+        case AfterArray:
+        default:
+            return isWhiteSpace(c) ? None : Error;
+        }
+    }
+
+    // true if the scanner is inside an object
+    bool inObject() const
+    {
+        return m_state == InObject || m_state == InString || m_state == InEscape;
+    }
+    // true if the end of the array has been found
+    bool finished() const { return m_state == AfterArray; }
+
+private:
+    enum State { BeforeArray, BetweenObjects, InObject, InString, InEscape, AfterArray };
+
+    State m_state;
+    int m_depth;
+    bool m_expectObject;
+    bool m_empty;
+};
+
+// A range of whole objects of the features array and the features parsed from it
+// (data holds a copy of the range if the chunk owns it)
+struct FeaturesChunk {
+    const char *begin;
+    const char *end;
+    FeatureStoreBuilder features;
+    GeneDictionary genes;
+    bool parsedOk;
+    QByteArray data;
+};
+
+// scans the top level array of objects and splits it into ranges of whole
+// objects of approximately the same size
+// returns false if the data is not an array of objects (or it is malformed)
+bool splitFeaturesArray(const QByteArray &rawData, const int chunks, QVector<FeaturesChunk> &ranges)
+{
+    const char *data = rawData.constData();
+    const int size = rawData.size();
+    const int chunk_size = size / chunks + 1;
+    int chunk_begin = -1;
+    int last_end = -1;
+    FeaturesArrayScanner scanner;
+    for (int pos = 0; pos < size; ++pos) {
+        switch (scanner.next(data[pos])) {
+        case FeaturesArrayScanner::ObjectBegin:
+            if (chunk_begin < 0) {
+                chunk_begin = pos;
+            }
+            break;
+        case FeaturesArrayScanner::ObjectEnd:
+            last_end = pos + 1;
+            if (last_end - chunk_begin >= chunk_size) {
+                ranges.push_back({data + chunk_begin, data + last_end, {}, {}, false, {}});
+                chunk_begin = -1;
+            }
+            break;
+        case FeaturesArrayScanner::ArrayEnd:
+            if (chunk_begin >= 0) {
+                ranges.push_back({data + chunk_begin, data + last_end, {}, {}, false, {}});
+            }
+            return true;
+        case FeaturesArrayScanner::Error:
+            return false;
+        case FeaturesArrayScanner::None:
+        default:
+            break;
+        }
+    }
+
+    // the array is not terminated
+    return false;
+}
+
+// merges the features parsed in chunks (in order) into parsed
+// returns false if the parsing of any chunk failed
+template <typename Chunks>
+bool mergeChunks(Chunks &chunks, data::ParsedFeatures &parsed)
+{
+    int total_features = 0;
+    for (const FeaturesChunk &chunk : chunks) {
+        if (!chunk.parsedOk) {
+            return false;
+        }
+        total_features += chunk.features.size();
+    }
+    FeatureStoreBuilder features;
+    GeneDictionary genes;
+    features.reserve(total_features);
+    for (FeaturesChunk &chunk : chunks) {
+        // convert the gene IDs of the chunk's dictionary to the merged one
+        features.append(chunk.features, genes.merge(chunk.genes));
+        chunk.features = FeatureStoreBuilder();
+    }
+    parsed.features = features.build();
+    parsed.genes = genes;
+    return true;
+}
+
+// Runnable that parses a chunk of the features array into the chunk's tables
+class ChunkParserTask : public QRunnable
+{
+
+public:
+    ChunkParserTask(FeaturesChunk &chunk, ParsingProgress &progress)
+        : m_chunk(chunk)
+        , m_progress(progress)
+    {
+    }
+
+    void run() override
+    {
+        ChunkStream is(m_chunk.begin, m_chunk.end);
+        m_chunk.parsedOk = parseStream(is, m_chunk.features, m_chunk.genes, m_progress);
+        // the data is not needed anymore (if the chunk owns it)
+        m_chunk.begin = nullptr;
+        m_chunk.end = nullptr;
+        m_chunk.data.clear();
+    }
+
+private:
+    FeaturesChunk &m_chunk;
+    ParsingProgress &m_progress;
+
+    Q_DISABLE_COPY(ChunkParserTask)
+};
+
+// Runnable that parses the features in a thread of the pool and reports
+// the progress and the result to the future interface
+class FeaturesParserTask : public QRunnable
+{
+
+public:
+    explicit FeaturesParserTask(const QByteArray &rawData)
+        : m_rawData(rawData)
+    {
+        m_futureInterface.reportStarted();
+    }
+
+    QFuture<data::ParsedFeatures> future() { return m_futureInterface.future(); }
+
+    void run() override
+    {
+        if (!m_futureInterface.isCanceled()) {
+            data::ParsedFeatures parsed;
+            bool parsedOk = false;
+            // the data of a byte array fits the progress range
+            m_futureInterface.setProgressRange(0, m_rawData.size());
+            if (BinaryFeatureFile::isBinary(m_rawData)) {
+                BinaryFeatureFile file;
+                parsedOk = file.open(m_rawData) && data::parseFeatures(file, parsed);
+            } else {
+                parsedOk = data::parseFeaturesParallel(m_rawData, parsed, &m_futureInterface);
+            }
+            if (parsedOk && !m_futureInterface.isCanceled()) {
+                m_futureInterface.setProgressValueAndText(m_rawData.size(),
+                                                          QString::number(parsed.features.size()));
+                m_futureInterface.reportResult(parsed);
+            }
+        }
+        m_futureInterface.reportFinished();
+    }
+
+private:
+    QByteArray m_rawData;
+    QFutureInterface<data::ParsedFeatures> m_futureInterface;
+
+    Q_DISABLE_COPY(FeaturesParserTask)
+};
+}
+
+namespace data
+{
+
+QFuture<ParsedFeatures> parseFeaturesAsync(const QByteArray &rawData)
+{
+    // the pool takes ownership of the task
+    FeaturesParserTask *task = new FeaturesParserTask(rawData);
+    QFuture<ParsedFeatures> future = task->future();
+    QThreadPool::globalInstance()->start(task);
+    return future;
+}
+
+bool parseFeatures(const QByteArray &rawData,
+                   ParsedFeatures &parsed,
+                   QFutureInterface<ParsedFeatures> *futureInterface)
+{
+    ParsingProgress progress(futureInterface);
+    StringStream is(rawData.constData());
+    FeatureStoreBuilder features;
+    GeneDictionary genes;
+    if (!parseStream(is, features, genes, progress)) {
+        return false;
+    }
+    parsed.features = features.build();
+    parsed.genes = genes;
+    return true;
+}
+
+bool parseFeaturesParallel(const QByteArray &rawData,
+                           ParsedFeatures &parsed,
+                           QFutureInterface<ParsedFeatures> *futureInterface,
+                           int threads)
+{
+    if (threads <= 0) {
+        threads = QThread::idealThreadCount();
+    }
+
+    // split the array in chunks of whole objects
+    // (the sequential parser will report the errors of malformed data)
+    QVector<FeaturesChunk> chunks;
+    if (threads == 1 || rawData.size() < MIN_PARALLEL_SIZE
+        || !splitFeaturesArray(rawData, threads * CHUNKS_PER_THREAD, chunks)) {
+        return parseFeatures(rawData, parsed, futureInterface);
+    }
+
+    // parse each chunk into its own tables
+    ParsingProgress progress(futureInterface);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (FeaturesChunk &chunk : chunks) {
+        pool.start(new ChunkParserTask(chunk, progress));
+    }
+    pool.waitForDone();
+
+    // merge the tables (the order of the features is kept)
+    return mergeChunks(chunks, parsed);
+}
+
+bool parseFeatures(const BinaryFeatureFile &file, ParsedFeatures &parsed)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    // the gene dictionary (the IDs are the same as in the file)
+    parsed.genes.reserve(file.genesCount());
+    for (quint32 gene = 0; gene < file.genesCount(); ++gene) {
+        const GeneDictionary::GeneId id = parsed.genes.insert(file.geneName(gene));
+        if (id != gene) {
+            // the names in the file are not unique
+            return false;
+        }
+    }
+
+    // the file has the same layout as the store so the columns are just copied
+    const int spots = static_cast<int>(file.spotsCount());
+    const int features = static_cast<int>(file.featuresCount());
+    QVector<float> spots_x(spots);
+    QVector<float> spots_y(spots);
+    QVector<FeatureStore::FeatureIndex> row_pointer(spots + 1);
+    for (int spot = 0; spot < spots; ++spot) {
+        spots_x[spot] = file.spotX(spot);
+        spots_y[spot] = file.spotY(spot);
+        row_pointer[spot] = file.spotBegin(spot);
+    }
+    row_pointer[spots] = static_cast<FeatureStore::FeatureIndex>(features);
+    QVector<GeneDictionary::GeneId> gene_ids(features);
+    QVector<int> counts(features);
+    for (int i = 0; i < features; ++i) {
+        gene_ids[i] = file.geneId(i);
+        counts[i] = static_cast<int>(file.count(i));
+    }
+    parsed.features = FeatureStore(spots_x, spots_y, row_pointer, gene_ids, counts);
+
+    return true;
+}
+
+// the state of the stream parser
+struct FeaturesStreamParser::State {
+    State()
+        : futureInterface()
+        , progress(&futureInterface)
+        , scanner()
+        , pending()
+        , scanned(0)
+        , objectBegin(-1)
+        , firstBegin(-1)
+        , lastEnd(-1)
+        , formatKnown(false)
+        , binary(false)
+        , failed(0)
+        , finished(false)
+        , mutex()
+        , incoming()
+        , running(false)
+        , finishing(false)
+        , pool()
+        , chunks()
+    {
+    }
+
+    QFutureInterface<ParsedFeatures> futureInterface;
+    ParsingProgress progress;
+    // the scanning state (only used by the worker processing the data)
+    FeaturesArrayScanner scanner;
+    // the data received that has not been parsed yet
+    QByteArray pending;
+    // position in pending of the scanning and of the objects found
+    int scanned;
+    int objectBegin;
+    int firstBegin;
+    int lastEnd;
+    bool formatKnown;
+    bool binary;
+    // the data is malformed (set by the worker)
+    QAtomicInt failed;
+    // finishAsync has been called (only used by the parser)
+    bool finished;
+    // the data appended not processed yet and the worker processing it (if any)
+    QMutex mutex;
+    QByteArray incoming;
+    bool running;
+    bool finishing;
+    // the workers parsing the chunks (the chunks are stored in order)
+    QThreadPool pool;
+    std::deque<FeaturesChunk> chunks;
+};
+
+FeaturesStreamParser::FeaturesStreamParser()
+    : m_state(new State())
+{
+    m_state->futureInterface.reportStarted();
+}
+
+FeaturesStreamParser::~FeaturesStreamParser()
+{
+    if (!m_state->futureInterface.isFinished()) {
+        m_state->futureInterface.cancel();
+    }
+    finishAsync();
+}
+
+QFuture<ParsedFeatures> FeaturesStreamParser::future()
+{
+    return m_state->futureInterface.future();
+}
+
+void FeaturesStreamParser::setTotalSize(const qint64 size)
+{
+    m_state->progress.setTotalBytes(size);
+}
+
+bool FeaturesStreamParser::append(const QByteArray &data)
+{
+    State &s = *m_state;
+    if (s.failed.load() != 0 || s.finished || s.futureInterface.isCanceled()) {
+        return false;
+    }
+    QMutexLocker locker(&s.mutex);
+    s.incoming.append(data);
+    if (!s.running) {
+        s.running = true;
+        const QSharedPointer<State> state = m_state;
+        QtConcurrent::run([state]() { process(state); });
+    }
+    return true;
+}
+
+void FeaturesStreamParser::finishAsync()
+{
+    State &s = *m_state;
+    if (s.finished) {
+        return;
+    }
+    s.finished = true;
+    QMutexLocker locker(&s.mutex);
+    s.finishing = true;
+    if (!s.running) {
+        s.running = true;
+        const QSharedPointer<State> state = m_state;
+        QtConcurrent::run([state]() { process(state); });
+    }
+}
+
+bool FeaturesStreamParser::finish(ParsedFeatures &parsed)
+{
+    finishAsync();
+    QFuture<ParsedFeatures> parsing = future();
+    parsing.waitForFinished();
+    if (parsing.resultCount() == 0) {
+        return false;
+    }
+    parsed = parsing.result();
+    return true;
+}
+
+bool FeaturesStreamParser::isCanceled() const
+{
+    return m_state->futureInterface.isCanceled();
+}
+
+void FeaturesStreamParser::process(QSharedPointer<State> state)
+{
+    State &s = *state;
+    while (true) {
+        QByteArray data;
+        bool finishing = false;
+        {
+            QMutexLocker locker(&s.mutex);
+            data.swap(s.incoming);
+            finishing = s.finishing;
+            if (data.isEmpty() && !finishing) {
+                s.running = false;
+                return;
+            }
+        }
+        if (!data.isEmpty() && s.failed.load() == 0 && !s.futureInterface.isCanceled()) {
+            scan(s, data);
+        }
+        // nothing is appended once the parsing is finishing
+        if (finishing) {
+            merge(s);
+            return;
+        }
+    }
+}
+
+void FeaturesStreamParser::scan(State &s, const QByteArray &data)
+{
+    s.pending.append(data);
+    if (!s.formatKnown) {
+        if (s.pending.size() < FORMAT_MAGIC_SIZE) {
+            return;
+        }
+        s.formatKnown = true;
+        s.binary = BinaryFeatureFile::isBinary(s.pending);
+    }
+    // the binary format does not need parsing so it is loaded at the end
+    if (!s.binary) {
+        scanPending(s);
+    }
+}
+
+void FeaturesStreamParser::merge(State &s)
+{
+    ParsedFeatures parsed;
+    bool parsedOk = s.failed.load() == 0 && !s.futureInterface.isCanceled();
+    if (parsedOk && !s.formatKnown) {
+        s.formatKnown = true;
+        s.binary = BinaryFeatureFile::isBinary(s.pending);
+        parsedOk = s.binary || scanPending(s);
+    }
+    if (parsedOk && s.binary) {
+        BinaryFeatureFile file;
+        parsedOk = file.open(s.pending) && parseFeatures(file, parsed);
+    } else if (parsedOk) {
+        // the array must be complete (the last objects are already being parsed)
+        parsedOk = s.scanner.finished();
+        if (!parsedOk) {
+            qDebug() << "[FeaturesParser] Error parsing features, the data is incomplete";
+        }
+        s.pool.waitForDone();
+        parsedOk = parsedOk && mergeChunks(s.chunks, parsed);
+    }
+    s.pool.waitForDone();
+
+    parsedOk = parsedOk && !s.futureInterface.isCanceled();
+    if (parsedOk) {
+        s.futureInterface.setProgressValueAndText(s.futureInterface.progressMaximum(),
+                                                  QString::number(parsed.features.size()));
+        s.futureInterface.reportResult(parsed);
+    }
+    s.pending.clear();
+    s.chunks.clear();
+    s.futureInterface.reportFinished();
+}
+
+bool FeaturesStreamParser::scanPending(State &s)
+{
+    const char *data = s.pending.constData();
+    const int size = s.pending.size();
+    for (int pos = s.scanned; pos < size; ++pos) {
+        switch (s.scanner.next(data[pos])) {
+        case FeaturesArrayScanner::ObjectBegin:
+            s.objectBegin = pos;
+            if (s.firstBegin < 0) {
+                s.firstBegin = pos;
+            }
+            break;
+        case FeaturesArrayScanner::ObjectEnd:
+            s.lastEnd = pos + 1;
+            break;
+        case FeaturesArrayScanner::Error:
+            qDebug() << "[FeaturesParser] Error parsing features, malformed array";
+            s.failed.store(1);
+            return false;
+        case FeaturesArrayScanner::ArrayEnd:
+        case FeaturesArrayScanner::None:
+        default:
+            break;
+        }
+    }
+    s.scanned = size;
+
+    // parse the complete objects when there are enough of them (or no more will come)
+    if (s.lastEnd > 0 && (s.lastEnd - s.firstBegin >= STREAM_CHUNK_SIZE || s.scanner.finished())) {
+        parsePending(s);
+    }
+    return true;
+}
+
+void FeaturesStreamParser::parsePending(State &s)
+{
+    Q_ASSERT(s.firstBegin >= 0 && s.lastEnd > s.firstBegin);
+
+    // the chunk keeps a copy of the complete objects (deque elements do not move)
+    s.chunks.push_back(
+        {nullptr, nullptr, {}, {}, false, s.pending.mid(s.firstBegin, s.lastEnd - s.firstBegin)});
+    FeaturesChunk &chunk = s.chunks.back();
+    chunk.begin = chunk.data.constData();
+    chunk.end = chunk.begin + chunk.data.size();
+    s.pool.start(new ChunkParserTask(chunk, s.progress));
+
+    // only the data after the complete objects is kept
+    s.pending.remove(0, s.lastEnd);
+    s.scanned -= s.lastEnd;
+    s.firstBegin = s.scanner.inObject() ? s.objectBegin - s.lastEnd : -1;
+    s.lastEnd = -1;
+}
+}
@@ -0,0 +1,112 @@
+#ifndef FEATURESPARSER_H
+#define FEATURESPARSER_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QSharedPointer>
+
+#include "data/DataProxy.h"
+#include "dataModel/GeneDictionary.h"
+#include "dataModel/FeatureStore.h"
+
+class BinaryFeatureFile;
+
+// The features parser is used to parse the ST data (features) into
+// containers that are independent from the ones in DataProxy so the parsing
+// can be performed in a worker thread and the containers only swapped in
+// once the parsing has fully succeeded.
+
+namespace data
+{
+
+// containers of the parsed features and their unique genes
+// (the features store the IDs of the genes in the dictionary)
+struct ParsedFeatures {
+    FeatureStore features;
+    GeneDictionary genes;
+};
+
+// parses the features in a worker thread (JSON or binary format)
+// the future reports the bytes consumed as progress value and the number of
+// features parsed as progress text and it can be canceled.
+// A result is only reported if the parsing was correct
+QFuture<ParsedFeatures> parseFeaturesAsync(const QByteArray &rawData);
+
+// parses the features in JSON format in the current thread
+// if futureInterface is given it is used to report progress and check for cancellation
+// returns true if the parsing was correct
+bool parseFeatures(const QByteArray &rawData,
+                   ParsedFeatures &parsed,
+                   QFutureInterface<ParsedFeatures> *futureInterface = nullptr);
+
+// parses the features in JSON format splitting the array in chunks of whole
+// objects that are parsed in parallel (threads = 0 uses all the cores)
+// small data is parsed sequentially
+// if futureInterface is given it is used to report progress and check for cancellation
+// returns true if the parsing was correct
+bool parseFeaturesParallel(const QByteArray &rawData,
+                           ParsedFeatures &parsed,
+                           QFutureInterface<ParsedFeatures> *futureInterface = nullptr,
+                           int threads = 0);
+
+// loads the features from a file in binary format in the current thread
+// returns true if the loading was correct
+bool parseFeatures(const BinaryFeatureFile &file, ParsedFeatures &parsed);
+
+// Incremental parser of the features (JSON or binary format) for data that
+// arrives in pieces, for example while it is being downloaded. The complete
+// objects received are parsed in worker threads while the rest of the data
+// arrives so only the data not parsed yet is kept in memory. The data appended is
+// scanned for complete objects and the chunks merged in worker threads too.
+class FeaturesStreamParser
+{
+
+public:
+    FeaturesStreamParser();
+    // the parsing is canceled if it has not finished (the workers finish it
+    // in the background so the destruction does not wait for them)
+    ~FeaturesStreamParser();
+
+    // the future reports the bytes parsed as progress value and the number of
+    // features parsed as progress text and it can be canceled.
+    // A result is only reported if the parsing was correct
+    QFuture<ParsedFeatures> future();
+    // sets the total size of the data (if known) as the progress range
+    void setTotalSize(const qint64 size);
+
+    // adds the next piece of data (it is scanned in a worker thread)
+    // returns false if the data added so far is malformed or the parsing has been canceled
+    bool append(const QByteArray &data);
+    // finishes the parsing of all the data added in a worker thread, the future
+    // reports the result (if the data is correct and complete) once the chunks are merged
+    void finishAsync();
+    // the same as finishAsync but it waits for the result
+    // returns false if the data is malformed, incomplete or the parsing has been canceled
+    bool finish(ParsedFeatures &parsed);
+
+    bool isCanceled() const;
+
+private:
+    struct State;
+
+    // scans the data appended (in order) until there is no more and merges the
+    // chunks once the parsing is finishing (runs in a worker thread)
+    static void process(QSharedPointer<State> state);
+    // adds the data to the pending one and scans it
+    static void scan(State &s, const QByteArray &data);
+    // scans the new data for complete objects and parses them when there are enough
+    static bool scanPending(State &s);
+    // parses the complete objects received in a worker thread
+    static void parsePending(State &s);
+    // waits for the chunks and merges them and reports the result
+    static void merge(State &s);
+
+    // the state is shared with the workers
+    QSharedPointer<State> m_state;
+
+    Q_DISABLE_COPY(FeaturesStreamParser)
+};
+}
+
+#endif // FEATURESPARSER_H //
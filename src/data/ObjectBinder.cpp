@@ -0,0 +1,596 @@
+#include "ObjectBinder.h"
+
+#include <QDebug>
+#include <QString>
+#include <QVector>
+#include <QTransform>
+
+#include <cstring>
+#include <limits>
+
+#include "dataModel/Dataset.h"
+#include "dataModel/UserSelection.h"
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+#include "dataModel/User.h"
+#include "dataModel/FeatureStore.h"
+#include "dataModel/GeneDictionary.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/error/en.h"
+
+using namespace rapidjson;
+
+namespace
+{
+
+// A scalar value of the JSON
+// the conversions are the same as the ones of QVariant
+class JsonScalar
+{
+
+public:
+    enum Type { Null, Bool, Integer, Double, String };
+
+    JsonScalar()
+        : m_type(Null)
+        , m_bool(false)
+        , m_integer(0)
+        , m_double(0.0)
+        , m_string()
+    {
+    }
+
+    static JsonScalar fromBool(const bool value)
+    {
+        JsonScalar scalar;
+        scalar.m_type = Bool;
+        scalar.m_bool = value;
+        return scalar;
+    }
+
+    static JsonScalar fromInteger(const qint64 value)
+    {
+        JsonScalar scalar;
+        scalar.m_type = Integer;
+        scalar.m_integer = value;
+        return scalar;
+    }
+
+    static JsonScalar fromDouble(const double value)
+    {
+        JsonScalar scalar;
+        scalar.m_type = Double;
+        scalar.m_double = value;
+        return scalar;
+    }
+
+    static JsonScalar fromString(const QString &value)
+    {
+        JsonScalar scalar;
+        scalar.m_type = String;
+        scalar.m_string = value;
+        return scalar;
+    }
+
+    // null is converted to a null string
+    QString toString() const
+    {
+        switch (m_type) {
+        case Bool:
+            return m_bool ? QStringLiteral("true") : QStringLiteral("false");
+        case Integer:
+            return QString::number(m_integer);
+        case Double:
+            return QString::number(m_double, 'g', std::numeric_limits<double>::digits10);
+        case String:
+            return m_string;
+        case Null:
+        default:
+            return QString();
+        }
+    }
+
+    int toInt() const
+    {
+        switch (m_type) {
+        case Bool:
+            return m_bool ? 1 : 0;
+        case Integer:
+            return static_cast<int>(m_integer);
+        case Double:
+            return qRound(m_double);
+        case String:
+            return m_string.toInt();
+        case Null:
+        default:
+            return 0;
+        }
+    }
+
+    float toFloat() const
+    {
+        switch (m_type) {
+        case Bool:
+            return m_bool ? 1.0f : 0.0f;
+        case Integer:
+            return static_cast<float>(m_integer);
+        case Double:
+            return static_cast<float>(m_double);
+        case String:
+            return m_string.toFloat();
+        case Null:
+        default:
+            return 0.0f;
+        }
+    }
+
+    bool toBool() const
+    {
+        switch (m_type) {
+        case Bool:
+            return m_bool;
+        case Integer:
+            return m_integer != 0;
+        case Double:
+            return m_double != 0.0;
+        case String:
+            return !(m_string.isEmpty() || m_string == QLatin1String("0")
+                     || m_string.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0);
+        case Null:
+        default:
+            return false;
+        }
+    }
+
+private:
+    Type m_type;
+    bool m_bool;
+    qint64 m_integer;
+    double m_double;
+    QString m_string;
+};
+
+// The value of a field: a scalar or the scalars of an array
+// (the scalars of the nested arrays are flattened, rows has the index of the
+// first scalar of each nested array)
+struct FieldValue {
+    FieldValue()
+        : scalar()
+        , items()
+        , rows()
+    {
+    }
+
+    JsonScalar scalar;
+    QVector<JsonScalar> items;
+    QVector<int> rows;
+
+    void clear()
+    {
+        scalar = JsonScalar();
+        items.clear();
+        rows.clear();
+    }
+};
+
+// A field of the objects of type T: its name in the JSON and the function
+// that binds its value to an object
+template <typename T>
+struct Field {
+    typedef void (*Binder)(T &object, const FieldValue &value);
+
+    template <std::size_t N>
+    constexpr Field(const char (&fieldName)[N], Binder binder)
+        : name(fieldName)
+        , length(static_cast<SizeType>(N - 1))
+        , bind(binder)
+    {
+    }
+
+    bool matches(const char *key, const SizeType keyLength) const
+    {
+        return keyLength == length && std::memcmp(key, name, length) == 0;
+    }
+
+    const char *name;
+    SizeType length;
+    Binder bind;
+};
+
+// binders of the common types of fields (the setter is a template argument
+// so every binder is a plain function that can be placed in the tables)
+
+template <typename T, void (T::*Setter)(const QString &)>
+void bindString(T &object, const FieldValue &value)
+{
+    (object.*Setter)(value.scalar.toString());
+}
+
+template <typename T, void (T::*Setter)(int)>
+void bindInt(T &object, const FieldValue &value)
+{
+    (object.*Setter)(value.scalar.toInt());
+}
+
+template <typename T, void (T::*Setter)(bool)>
+void bindBool(T &object, const FieldValue &value)
+{
+    (object.*Setter)(value.scalar.toBool());
+}
+
+template <typename T, void (T::*Setter)(const QVector<QString> &)>
+void bindStrings(T &object, const FieldValue &value)
+{
+    QVector<QString> strings;
+    strings.reserve(value.items.size());
+    for (const JsonScalar &item : value.items) {
+        strings.append(item.toString());
+    }
+    (object.*Setter)(strings);
+}
+
+// the matrix of the alignment is a flat array of 9 values in column-major order
+void bindAlignment(ImageAlignment &alignment, const FieldValue &value)
+{
+    if (value.items.size() != 9) {
+        qDebug() << "[ObjectBinder] Warning: the alignment matrix has " << value.items.size()
+                 << " values";
+        return;
+    }
+    const JsonScalar *m = value.items.constData();
+    alignment.alignment(QTransform(m[0].toFloat(),
+                                   m[3].toFloat(),
+                                   m[6].toFloat(),
+                                   m[1].toFloat(),
+                                   m[4].toFloat(),
+                                   m[7].toFloat(),
+                                   m[2].toFloat(),
+                                   m[5].toFloat(),
+                                   m[8].toFloat()));
+}
+
+// the features of a selection are arrays of [gene, x, y, count]
+void bindFeatures(UserSelection &selection, const FieldValue &value)
+{
+    GeneDictionary genes;
+    FeatureStoreBuilder features;
+    features.reserve(value.rows.size());
+    for (int row = 0; row < value.rows.size(); ++row) {
+        const int begin = value.rows.at(row);
+        const int end = row + 1 < value.rows.size() ? value.rows.at(row + 1) : value.items.size();
+        // TODO there seems to be some buggy selection items in the DB with 5 elements
+        if (end - begin < 4) {
+            qDebug() << "[ObjectBinder] Warning: skipping a selected feature with "
+                     << end - begin << " values";
+            continue;
+        }
+        const JsonScalar *feature = value.items.constData() + begin;
+        features.append(genes.insert(feature[0].toString()),
+                        feature[1].toInt(),
+                        feature[2].toInt(),
+                        feature[3].toInt());
+    }
+    selection.loadFeatures(DataProxy::FeatureList(features.build()), genes);
+}
+
+void bindSelectionType(UserSelection &selection, const FieldValue &value)
+{
+    selection.type(UserSelection::QStringToType(value.scalar.toString()));
+}
+
+void bindTissueSnapshot(UserSelection &selection, const FieldValue &value)
+{
+    selection.tissueSnapShot(value.scalar.toString().toUtf8());
+}
+
+// the tables of the fields (same names as the properties of the DTOs)
+
+constexpr Field<Dataset> DATASET_FIELDS[] = {
+    {"id", &bindString<Dataset, &Dataset::id>},
+    {"name", &bindString<Dataset, &Dataset::name>},
+    {"image_alignment_id", &bindString<Dataset, &Dataset::imageAlignmentId>},
+    {"tissue", &bindString<Dataset, &Dataset::statTissue>},
+    {"species", &bindString<Dataset, &Dataset::statSpecies>},
+    {"comment", &bindString<Dataset, &Dataset::statComments>},
+    {"enabled", &bindBool<Dataset, &Dataset::enabled>},
+    {"granted_accounts", &bindStrings<Dataset, &Dataset::grantedAccounts>},
+    {"created_by_account_id", &bindString<Dataset, &Dataset::createdByAccount>},
+    {"created_at", &bindString<Dataset, &Dataset::created>},
+    {"last_modified", &bindString<Dataset, &Dataset::lastModified>},
+};
+
+constexpr Field<UserSelection> SELECTION_FIELDS[] = {
+    {"id", &bindString<UserSelection, &UserSelection::id>},
+    {"name", &bindString<UserSelection, &UserSelection::name>},
+    {"account_id", &bindString<UserSelection, &UserSelection::userId>},
+    {"dataset_id", &bindString<UserSelection, &UserSelection::datasetId>},
+    {"gene_hits", &bindFeatures},
+    {"type", &bindSelectionType},
+    {"status", &bindString<UserSelection, &UserSelection::status>},
+    {"comment", &bindString<UserSelection, &UserSelection::comment>},
+    {"enabled", &bindBool<UserSelection, &UserSelection::enabled>},
+    {"created_at", &bindString<UserSelection, &UserSelection::created>},
+    {"last_modified", &bindString<UserSelection, &UserSelection::lastModified>},
+    {"tissue_snapshot", &bindTissueSnapshot},
+};
+
+constexpr Field<Chip> CHIP_FIELDS[] = {
+    {"x1", &bindInt<Chip, &Chip::x1>},
+    {"x2", &bindInt<Chip, &Chip::x2>},
+    {"x1_total", &bindInt<Chip, &Chip::x1Total>},
+    {"x2_total", &bindInt<Chip, &Chip::x2Total>},
+    {"x1_border", &bindInt<Chip, &Chip::x1Border>},
+    {"x2_border", &bindInt<Chip, &Chip::x2Border>},
+    {"y1", &bindInt<Chip, &Chip::y1>},
+    {"y2", &bindInt<Chip, &Chip::y2>},
+    {"y1_total", &bindInt<Chip, &Chip::y1Total>},
+    {"y2_total", &bindInt<Chip, &Chip::y2Total>},
+    {"y1_border", &bindInt<Chip, &Chip::y1Border>},
+    {"y2_border", &bindInt<Chip, &Chip::y2Border>},
+    {"barcodes", &bindInt<Chip, &Chip::spots>},
+    {"id", &bindString<Chip, &Chip::id>},
+    {"name", &bindString<Chip, &Chip::name>},
+    {"created_at", &bindString<Chip, &Chip::created>},
+    {"last_modified", &bindString<Chip, &Chip::lastModified>},
+};
+
+constexpr Field<ImageAlignment> ALIGNMENT_FIELDS[] = {
+    {"id", &bindString<ImageAlignment, &ImageAlignment::id>},
+    {"name", &bindString<ImageAlignment, &ImageAlignment::name>},
+    {"chip_id", &bindString<ImageAlignment, &ImageAlignment::chipId>},
+    {"figure_red", &bindString<ImageAlignment, &ImageAlignment::figureRed>},
+    {"figure_blue", &bindString<ImageAlignment, &ImageAlignment::figureBlue>},
+    {"alignment_matrix", &bindAlignment},
+    {"created_at", &bindString<ImageAlignment, &ImageAlignment::created>},
+    {"last_modified", &bindString<ImageAlignment, &ImageAlignment::lastModified>},
+};
+
+constexpr Field<User> USER_FIELDS[] = {
+    {"id", &bindString<User, &User::id>},
+    {"username", &bindString<User, &User::username>},
+    {"institution", &bindString<User, &User::institution>},
+    {"first_name", &bindString<User, &User::firstName>},
+    {"last_name", &bindString<User, &User::secondName>},
+    {"street_address", &bindString<User, &User::address>},
+    {"postcode", &bindInt<User, &User::postcode>},
+    {"city", &bindString<User, &User::city>},
+    {"country", &bindString<User, &User::country>},
+    {"role", &bindString<User, &User::role>},
+    {"password", &bindString<User, &User::password>},
+    {"enabled", &bindBool<User, &User::enabled>},
+    {"granted_datasets", &bindStrings<User, &User::grantedDatasets>},
+    {"created_at", &bindString<User, &User::created>},
+    {"last_modified", &bindString<User, &User::lastModified>},
+};
+
+// Handler with call backs for rapidjson
+// it binds the fields of the objects (the root object or the objects of the
+// root array) and appends the objects to the list given
+// the values of the fields can be scalars, arrays of scalars or arrays of
+// arrays of scalars (other values are skipped)
+template <typename T>
+class BindingHandler
+{
+
+public:
+    template <std::size_t N>
+    BindingHandler(const Field<T> (&fields)[N], const bool inArray, QList<T> &objects)
+        : m_fields(fields)
+        , m_fieldsEnd(fields + N)
+        , m_objectDepth(inArray ? 2 : 1)
+        , m_objects(objects)
+        , m_object()
+        , m_depth(0)
+        , m_field(nullptr)
+        , m_value()
+    {
+    }
+
+    bool Null() { return scalar(JsonScalar()); }
+    bool Bool(bool b) { return scalar(JsonScalar::fromBool(b)); }
+    bool Int(int i) { return scalar(JsonScalar::fromInteger(i)); }
+    bool Uint(unsigned u) { return scalar(JsonScalar::fromInteger(u)); }
+    bool Int64(int64_t i) { return scalar(JsonScalar::fromInteger(i)); }
+
+    bool Uint64(uint64_t u)
+    {
+        if (u > static_cast<uint64_t>(std::numeric_limits<qint64>::max())) {
+            return scalar(JsonScalar::fromDouble(static_cast<double>(u)));
+        }
+        return scalar(JsonScalar::fromInteger(static_cast<qint64>(u)));
+    }
+
+    bool Double(double d) { return scalar(JsonScalar::fromDouble(d)); }
+    bool RawNumber(const char *, SizeType, bool) { return true; }
+
+    bool String(const char *str, SizeType length, bool)
+    {
+        // the strings of the fields skipped are not converted
+        if (m_field == nullptr) {
+            return m_depth >= m_objectDepth;
+        }
+        return scalar(JsonScalar::fromString(QString::fromUtf8(str, static_cast<int>(length))));
+    }
+
+    bool StartObject()
+    {
+        ++m_depth;
+        if (m_depth < m_objectDepth) {
+            return false;
+        }
+        if (m_depth == m_objectDepth) {
+            m_object = T();
+        }
+        // objects in the values of the fields are not supported
+        m_field = nullptr;
+        return true;
+    }
+
+    bool Key(const char *str, SizeType length, bool)
+    {
+        if (m_depth == m_objectDepth) {
+            m_field = findField(str, length);
+            if (m_field != nullptr) {
+                m_value.clear();
+            }
+        }
+        return true;
+    }
+
+    bool EndObject(SizeType)
+    {
+        if (m_depth == m_objectDepth) {
+            m_objects.append(m_object);
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool StartArray()
+    {
+        ++m_depth;
+        // the root array of the objects (only valid if the objects are in one)
+        if (m_depth < m_objectDepth) {
+            return true;
+        }
+        // an array where an object is expected
+        if (m_depth == m_objectDepth) {
+            return false;
+        }
+        if (m_depth == m_objectDepth + 2 && m_field != nullptr) {
+            m_value.rows.append(m_value.items.size());
+        } else if (m_depth > m_objectDepth + 2) {
+            m_field = nullptr;
+        }
+        return true;
+    }
+
+    bool EndArray(SizeType)
+    {
+        if (m_depth == m_objectDepth + 1 && m_field != nullptr) {
+            bindField();
+        }
+        --m_depth;
+        return true;
+    }
+
+private:
+    const Field<T> *findField(const char *key, const SizeType length) const
+    {
+        for (const Field<T> *field = m_fields; field != m_fieldsEnd; ++field) {
+            if (field->matches(key, length)) {
+                return field;
+            }
+        }
+        return nullptr;
+    }
+
+    bool scalar(const JsonScalar &value)
+    {
+        // only objects are expected out of the objects
+        if (m_depth < m_objectDepth) {
+            return false;
+        }
+        if (m_field == nullptr) {
+            return true;
+        }
+        if (m_depth == m_objectDepth) {
+            m_value.scalar = value;
+            bindField();
+        } else {
+            m_value.items.append(value);
+        }
+        return true;
+    }
+
+    void bindField()
+    {
+        m_field->bind(m_object, m_value);
+        m_field = nullptr;
+    }
+
+    const Field<T> *m_fields;
+    const Field<T> *m_fieldsEnd;
+    // depth of the objects bound (1 the root object, 2 the objects of the root array)
+    const int m_objectDepth;
+    QList<T> &m_objects;
+    T m_object;
+    int m_depth;
+    // the field whose value is being parsed (null if it is skipped)
+    const Field<T> *m_field;
+    FieldValue m_value;
+
+    Q_DISABLE_COPY(BindingHandler)
+};
+
+// parses the JSON appending the objects to the list given
+// returns true if the parsing was correct
+template <typename T, std::size_t N>
+bool bindJson(const QByteArray &json,
+              const Field<T> (&fields)[N],
+              const bool inArray,
+              QList<T> &objects)
+{
+    BindingHandler<T> handler(fields, inArray, objects);
+    Reader reader;
+    StringStream is(json.constData());
+    const ParseResult result = reader.Parse(is, handler);
+    if (result.IsError()) {
+        qDebug() << "[ObjectBinder] Error parsing the objects " << GetParseError_En(result.Code())
+                 << " at " << result.Offset();
+        return false;
+    }
+    return true;
+}
+
+// parses the JSON of a single object
+template <typename T, std::size_t N>
+bool bindJsonObject(const QByteArray &json, const Field<T> (&fields)[N], T &object)
+{
+    QList<T> objects;
+    if (!bindJson(json, fields, false, objects) || objects.size() != 1) {
+        return false;
+    }
+    object = objects.first();
+    return true;
+}
+}
+
+namespace data
+{
+
+bool bindObject(const QByteArray &json, Dataset &dataset)
+{
+    return bindJsonObject(json, DATASET_FIELDS, dataset);
+}
+
+bool bindObject(const QByteArray &json, UserSelection &selection)
+{
+    return bindJsonObject(json, SELECTION_FIELDS, selection);
+}
+
+bool bindObject(const QByteArray &json, Chip &chip)
+{
+    return bindJsonObject(json, CHIP_FIELDS, chip);
+}
+
+bool bindObject(const QByteArray &json, ImageAlignment &alignment)
+{
+    return bindJsonObject(json, ALIGNMENT_FIELDS, alignment);
+}
+
+bool bindObject(const QByteArray &json, User &user)
+{
+    return bindJsonObject(json, USER_FIELDS, user);
+}
+
+bool bindObjects(const QByteArray &json, QList<Dataset> &datasets)
+{
+    return bindJson(json, DATASET_FIELDS, true, datasets);
+}
+
+bool bindObjects(const QByteArray &json, QList<UserSelection> &selections)
+{
+    return bindJson(json, SELECTION_FIELDS, true, selections);
+}
+}
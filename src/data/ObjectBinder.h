@@ -0,0 +1,41 @@
+#ifndef OBJECTBINDER_H
+#define OBJECTBINDER_H
+
+#include <QByteArray>
+#include <QList>
+
+class Dataset;
+class UserSelection;
+class Chip;
+class ImageAlignment;
+class User;
+
+// The object binder parses the JSON objects of the server straight into the
+// data model objects. Unlike the object parser (see ObjectParser.h) no
+// QJsonDocument, QVariant or meta property is involved: the events of a SAX
+// parser (rapidjson) are dispatched through a constant table of the fields of
+// each type (name and setter) to the setters of the object.
+// The names of the fields are the same as the ones of the DTO properties and
+// the values are converted as QVariant would (numbers as strings and so on).
+// The fields that are not known are skipped and the ones missing keep the
+// default value of the object.
+
+namespace data
+{
+
+// parses a JSON object into the object given
+// returns false if the JSON is malformed or it is not an object
+bool bindObject(const QByteArray &json, Dataset &dataset);
+bool bindObject(const QByteArray &json, UserSelection &selection);
+bool bindObject(const QByteArray &json, Chip &chip);
+bool bindObject(const QByteArray &json, ImageAlignment &alignment);
+bool bindObject(const QByteArray &json, User &user);
+
+// parses a JSON array of objects appending them to the list given
+// returns false if the JSON is malformed or it is not an array of objects
+// (the objects parsed before the error are appended)
+bool bindObjects(const QByteArray &json, QList<Dataset> &datasets);
+bool bindObjects(const QByteArray &json, QList<UserSelection> &selections);
+}
+
+#endif // OBJECTBINDER_H //
@@ -47,4 +47,18 @@ bool parseObject(const QVariant &source, QObject *target)
 
     return true;
 }
+
+QVariantMap serializeObject(const QObject *source)
+{
+    QVariantMap map;
+    const QMetaObject *metaobject = source->metaObject();
+    // skip the properties of QObject (objectName)
+    for (int index = QObject::staticMetaObject.propertyCount();
+         index < metaobject->propertyCount();
+         ++index) {
+        const QMetaProperty metaproperty = metaobject->property(index);
+        map.insert(QLatin1String(metaproperty.name()), metaproperty.read(source));
+    }
+    return map;
+}
 }
@@ -7,7 +7,8 @@
 #include <QDebug>
 
 // The object parser is used to initialize or construct QObjects using their
-// meta data properties as targets and a variant data structure as the source.
+// meta data properties as targets and a variant data structure as the source
+// (and to serialize them back into a variant map).
 // The variant source, which can be either a QVariant or a QVariantMap, is
 // mapped to the properties of the QObject trying to convert the variant data
 // to the data type of the mapped object member variable.
@@ -19,6 +20,10 @@ namespace data
 // parse an object from variant map using intermediary DTO type
 // the attributes name/type must match in the QVariant and the DTO
 bool parseObject(const QVariant &source, QObject *target);
+
+// serializes the properties of the object (DTO) into a variant map
+// with the same names so it can be parsed back with parseObject
+QVariantMap serializeObject(const QObject *source);
 }
 
 #endif // OBJECTPARSER_H //
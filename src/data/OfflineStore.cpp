@@ -0,0 +1,244 @@
+#include "OfflineStore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QStandardPaths>
+
+#include "data/ObjectParser.h"
+#include "dataModel/DatasetDTO.h"
+#include "dataModel/UserDTO.h"
+#include "dataModel/UserSelectionDTO.h"
+
+namespace
+{
+
+const QString PINNED_FILE = QStringLiteral("pinned");
+const quint32 PINNED_MAGIC = 0x5354504e; // "STPN"
+
+// the directory given or the default one
+QString storeDirectory(const QString &directory)
+{
+    if (!directory.isEmpty()) {
+        return directory;
+    }
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator()
+           + "offline";
+}
+}
+
+const int OfflineStore::VERSION;
+
+OfflineStore::OfflineStore(const QString &directory)
+    : m_directory(storeDirectory(directory))
+    // the pinned content is never removed to meet a size
+    , m_snapshots(m_directory + QDir::separator() + "snapshots", 0)
+    , m_user()
+    , m_hasUser(false)
+    , m_datasets()
+    , m_selections()
+{
+    if (!load()) {
+        m_user = User();
+        m_hasUser = false;
+        m_datasets.clear();
+        m_selections.clear();
+    }
+}
+
+OfflineStore::~OfflineStore()
+{
+}
+
+const QString &OfflineStore::directory() const
+{
+    return m_directory;
+}
+
+bool OfflineStore::isEmpty() const
+{
+    return m_datasets.isEmpty() && m_selections.isEmpty();
+}
+
+bool OfflineStore::hasUser() const
+{
+    return m_hasUser;
+}
+
+const User &OfflineStore::user() const
+{
+    return m_user;
+}
+
+void OfflineStore::setUser(const User &user)
+{
+    // the content pinned by another user is not accessible anymore
+    if (m_hasUser && m_user.id() != user.id()) {
+        clear();
+    }
+    m_user = user;
+    m_hasUser = true;
+    save();
+}
+
+bool OfflineStore::isDatasetPinned(const QString &datasetId) const
+{
+    return m_datasets.contains(datasetId);
+}
+
+void OfflineStore::pinDataset(const Dataset &dataset)
+{
+    m_datasets.insert(dataset.id(), dataset);
+    save();
+}
+
+void OfflineStore::unpinDataset(const QString &datasetId)
+{
+    if (m_datasets.remove(datasetId) > 0) {
+        m_snapshots.remove(datasetId);
+        save();
+    }
+}
+
+const QList<Dataset> OfflineStore::pinnedDatasets() const
+{
+    return m_datasets.values();
+}
+
+bool OfflineStore::hasContent(const QString &datasetId, const QString &lastModified) const
+{
+    return m_datasets.contains(datasetId) && m_snapshots.contains(datasetId, lastModified);
+}
+
+bool OfflineStore::readContent(const QString &datasetId,
+                               const QString &lastModified,
+                               DatasetContentCache::Content &content) const
+{
+    return m_datasets.contains(datasetId) && m_snapshots.read(datasetId, lastModified, content);
+}
+
+bool OfflineStore::writeContent(const QString &datasetId,
+                                const DatasetContentCache::Content &content)
+{
+    if (!m_datasets.contains(datasetId)) {
+        return false;
+    }
+    m_snapshots.writeAsync(datasetId, content);
+    return true;
+}
+
+bool OfflineStore::isSelectionPinned(const QString &selectionId) const
+{
+    return m_selections.contains(selectionId);
+}
+
+void OfflineStore::pinSelection(const UserSelection &selection)
+{
+    m_selections.insert(selection.id(), selection);
+    save();
+}
+
+void OfflineStore::unpinSelection(const QString &selectionId)
+{
+    if (m_selections.remove(selectionId) > 0) {
+        save();
+    }
+}
+
+const QList<UserSelection> OfflineStore::pinnedSelections() const
+{
+    return m_selections.values();
+}
+
+void OfflineStore::clear()
+{
+    m_user = User();
+    m_hasUser = false;
+    m_datasets.clear();
+    m_selections.clear();
+    m_snapshots.waitForWrites();
+    QDir(m_directory).removeRecursively();
+}
+
+bool OfflineStore::load()
+{
+    QFile file(QDir(m_directory).filePath(PINNED_FILE));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+    if (magic != PINNED_MAGIC || version != VERSION) {
+        qDebug() << "[OfflineStore] The pinned file is not valid " << file.fileName();
+        return false;
+    }
+
+    // the objects are stored as the properties of their DTOs
+    QVariantMap user;
+    QList<QVariantMap> datasets;
+    QList<QVariantMap> selections;
+    stream >> m_hasUser >> user >> datasets >> selections;
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "[OfflineStore] Error reading the pinned file " << file.fileName();
+        return false;
+    }
+
+    UserDTO user_dto;
+    if (m_hasUser && !data::parseObject(user, &user_dto)) {
+        return false;
+    }
+    m_user = user_dto.user();
+    for (const QVariantMap &object : datasets) {
+        DatasetDTO dto;
+        if (!data::parseObject(object, &dto)) {
+            return false;
+        }
+        m_datasets.insert(dto.dataset().id(), dto.dataset());
+    }
+    for (const QVariantMap &object : selections) {
+        UserSelectionDTO dto;
+        if (!data::parseObject(object, &dto)) {
+            return false;
+        }
+        dto.userSelection().saved(true);
+        m_selections.insert(dto.userSelection().id(), dto.userSelection());
+    }
+    return true;
+}
+
+bool OfflineStore::save() const
+{
+    if (!QDir(m_directory).mkpath(".")) {
+        qDebug() << "[OfflineStore] Error creating the directory " << m_directory;
+        return false;
+    }
+
+    UserDTO user_dto;
+    user_dto.user() = m_user;
+    QList<QVariantMap> datasets;
+    for (const Dataset &dataset : m_datasets) {
+        const DatasetDTO dto(dataset);
+        datasets.append(data::serializeObject(&dto));
+    }
+    QList<QVariantMap> selections;
+    for (const UserSelection &selection : m_selections) {
+        const UserSelectionDTO dto(selection);
+        selections.append(data::serializeObject(&dto));
+    }
+
+    QSaveFile file(QDir(m_directory).filePath(PINNED_FILE));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "[OfflineStore] Error writing the pinned file " << file.fileName();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << PINNED_MAGIC << static_cast<qint32>(VERSION);
+    stream << m_hasUser << data::serializeObject(&user_dto) << datasets << selections;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,95 @@
+#ifndef OFFLINESTORE_H
+#define OFFLINESTORE_H
+
+#include <QString>
+#include <QList>
+#include <QMap>
+
+#include "data/DatasetSnapshotCache.h"
+#include "dataModel/Dataset.h"
+#include "dataModel/User.h"
+#include "dataModel/UserSelection.h"
+
+// OfflineStore keeps on disk the datasets and selections the user has pinned
+// so they can be used without network (see DataProxy). It is kept apart from
+// the caches (the application data location instead of the cache one) so
+// cleaning the caches or evicting their entries never removes pinned content.
+// Layout:
+//   pinned      the user and the datasets and selections pinned in binary form
+//               (written on every change)
+//   snapshots/  the content of the datasets pinned (see DatasetSnapshotCache)
+// A dataset can be pinned before its content has been stored (the content is
+// stored once it has been downloaded, see hasContent()).
+class OfflineStore
+{
+
+public:
+    // current version of the pinned file
+    static const int VERSION = 1;
+
+    // the content is stored in the directory given
+    // (or in the data location of the application if empty)
+    explicit OfflineStore(const QString &directory = QString());
+    ~OfflineStore();
+
+    const QString &directory() const;
+
+    // true if nothing is pinned
+    bool isEmpty() const;
+
+    // the user that pinned the content (the pinned content is only valid for it)
+    // or the last one validated by the server if nothing is pinned
+    bool hasUser() const;
+    const User &user() const;
+    void setUser(const User &user);
+
+    // DATASETS
+
+    bool isDatasetPinned(const QString &datasetId) const;
+    // pins the dataset (or updates it if already pinned)
+    void pinDataset(const Dataset &dataset);
+    // unpins the dataset and removes its content
+    void unpinDataset(const QString &datasetId);
+    const QList<Dataset> pinnedDatasets() const;
+
+    // true if the content of the dataset is stored for the lastModified given
+    bool hasContent(const QString &datasetId, const QString &lastModified) const;
+    // loads the content of the dataset if it is stored for the lastModified given
+    // returns true if the content was valid
+    bool readContent(const QString &datasetId,
+                     const QString &lastModified,
+                     DatasetContentCache::Content &content) const;
+    // stores the content of the dataset in a worker thread (only if it is pinned)
+    // returns false if the dataset is not pinned (hasContent() is true from now on)
+    bool writeContent(const QString &datasetId, const DatasetContentCache::Content &content);
+
+    // SELECTIONS
+
+    bool isSelectionPinned(const QString &selectionId) const;
+    // pins the selection (or updates it if already pinned)
+    void pinSelection(const UserSelection &selection);
+    void unpinSelection(const QString &selectionId);
+    const QList<UserSelection> pinnedSelections() const;
+
+    // unpins everything and removes the user
+    void clear();
+
+private:
+    // reads the pinned file, returns false if it does not exist or it is not valid
+    bool load();
+    // writes the pinned file, returns false if the writing failed
+    bool save() const;
+
+    QString m_directory;
+    // the content of the datasets pinned
+    DatasetSnapshotCache m_snapshots;
+    User m_user;
+    bool m_hasUser;
+    // pinned objects by ID
+    QMap<QString, Dataset> m_datasets;
+    QMap<QString, UserSelection> m_selections;
+
+    Q_DISABLE_COPY(OfflineStore)
+};
+
+#endif // OFFLINESTORE_H //
@@ -0,0 +1,155 @@
+#include "SyncState.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "network/NetworkCommand.h"
+#include "network/NetworkReply.h"
+
+namespace
+{
+
+// the first character of the JSON given that is not a white space
+char firstCharacter(const QByteArray &json)
+{
+    for (const char c : json) {
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            return c;
+        }
+    }
+    return '\0';
+}
+
+// true if the time given is later than the other one (empty if none), they are
+// compared as dates if they can be parsed (ISO 8601) or as strings otherwise
+bool isLater(const QString &time, const QString &other)
+{
+    if (time.isEmpty() || other.isEmpty()) {
+        return !time.isEmpty();
+    }
+    const QDateTime date = QDateTime::fromString(time, Qt::ISODate);
+    const QDateTime other_date = QDateTime::fromString(other, Qt::ISODate);
+    if (date.isValid() && other_date.isValid()) {
+        return date > other_date;
+    }
+    return time > other;
+}
+
+// the latest last_modified of the objects given or latest if none is later
+QString latestModified(const QJsonArray &objects, QString latest)
+{
+    for (const QJsonValue &object : objects) {
+        const QString last_modified
+            = object.toObject().value(QStringLiteral("last_modified")).toString();
+        if (isLater(last_modified, latest)) {
+            latest = last_modified;
+        }
+    }
+    return latest;
+}
+}
+
+SyncState::Changes::Changes()
+    : full(false)
+    , modified()
+    , removed()
+{
+}
+
+SyncState::SyncState()
+    : m_etag()
+    , m_lastModifiedHeader()
+    , m_lastModified()
+    , m_synced(false)
+{
+}
+
+SyncState::~SyncState()
+{
+}
+
+void SyncState::prepare(NetworkCommand &cmd, const bool delta) const
+{
+    if (!m_synced) {
+        return;
+    }
+    if (!m_etag.isEmpty()) {
+        cmd.setHeader("If-None-Match", m_etag);
+    }
+    if (!m_lastModifiedHeader.isEmpty()) {
+        cmd.setHeader("If-Modified-Since", m_lastModifiedHeader);
+    }
+    if (delta && !m_lastModified.isEmpty()) {
+        cmd.addQueryItem(QStringLiteral("modified_since"), m_lastModified);
+    }
+}
+
+bool SyncState::update(NetworkReply &reply, Changes &changes)
+{
+    changes = Changes();
+    // nothing has changed since the last sync (only valid if there was one)
+    if (reply.notModified()) {
+        return m_synced;
+    }
+
+    QString last_modified;
+    const QByteArray body = reply.getRaw();
+    const char first = firstCharacter(body);
+    if (first == '[') {
+        // the whole list (the objects are bound by the caller), the next delta
+        // starts from the latest object
+        changes.full = true;
+        changes.modified = body;
+        last_modified = latestModified(QJsonDocument::fromJson(body).array(), QString());
+    } else if (first == '{' && m_synced) {
+        // the changes since the last sync (small), the envelope is parsed as a
+        // plain JSON object and its last_modified is not used (see m_lastModified)
+        const QJsonObject delta = QJsonDocument::fromJson(body).object();
+        if (!delta.value(QStringLiteral("modified")).isArray()) {
+            return false;
+        }
+        const QJsonArray modified = delta.value(QStringLiteral("modified")).toArray();
+        if (!modified.isEmpty()) {
+            changes.modified = QJsonDocument(modified).toJson(QJsonDocument::Compact);
+        }
+        for (const QJsonValue &id : delta.value(QStringLiteral("removed")).toArray()) {
+            changes.removed.append(id.toString());
+        }
+        last_modified = latestModified(modified, m_lastModified);
+    } else {
+        qDebug() << "[SyncState] The response is not a list or a delta of one";
+        return false;
+    }
+
+    m_etag = reply.rawHeader("ETag");
+    m_lastModifiedHeader = reply.rawHeader("Last-Modified");
+    m_lastModified = last_modified;
+    m_synced = true;
+    return true;
+}
+
+void SyncState::clear()
+{
+    m_etag.clear();
+    m_lastModifiedHeader.clear();
+    m_lastModified.clear();
+    m_synced = false;
+}
+
+bool SyncState::isEmpty() const
+{
+    return !m_synced;
+}
+
+const QByteArray &SyncState::etag() const
+{
+    return m_etag;
+}
+
+const QString &SyncState::lastModified() const
+{
+    return m_lastModified;
+}
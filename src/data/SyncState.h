@@ -0,0 +1,69 @@
+#ifndef SYNCSTATE_H
+#define SYNCSTATE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class NetworkCommand;
+class NetworkReply;
+
+// SyncState keeps what is needed to refresh a list of objects downloaded
+// from the database (datasets or selections) transferring only what changed:
+// - conditional revalidation: the ETag and Last-Modified headers of the last
+//   response are sent back (If-None-Match and If-Modified-Since) so the server
+//   answers 304 Not Modified with no body if the list has not changed
+// - delta sync: the latest last_modified of the objects received is sent as
+//   the modified_since query item so the server answers with only the objects
+//   changed since then as {"last_modified": "", "modified": [], "removed": []}
+//   (a server that does not support it answers with the whole list)
+//   The cursor always comes from the objects (the times of the server in ISO 8601)
+//   so it is never mixed with the HTTP dates of the headers, a delta with no
+//   objects modified keeps it
+// The objects are identified by their "id" field.
+// The objects modified are given as JSON so they can be parsed straight into
+// the data model objects (see data::bindObjects).
+class SyncState
+{
+
+public:
+    // the changes of a sync
+    struct Changes {
+        Changes();
+        // true if modified has the whole list (the current objects must be replaced)
+        bool full;
+        // JSON array of the objects added or modified (whole list if full)
+        // empty if nothing has changed
+        QByteArray modified;
+        // IDs of the objects removed (only for delta syncs)
+        QStringList removed;
+    };
+
+    SyncState();
+    ~SyncState();
+
+    // adds the validators of the last sync to the command given
+    // and the modified_since query item if delta is true
+    void prepare(NetworkCommand &cmd, const bool delta) const;
+    // parses the response of the command (304, whole list or delta) and keeps
+    // its validators for the next sync
+    // returns false if the response is not valid (the state is not changed)
+    bool update(NetworkReply &reply, Changes &changes);
+    // forgets the last sync (the next one downloads the whole list)
+    void clear();
+    // true if there has not been any sync
+    bool isEmpty() const;
+
+    const QByteArray &etag() const;
+    const QString &lastModified() const;
+
+private:
+    // validators of the last response
+    QByteArray m_etag;
+    QByteArray m_lastModifiedHeader;
+    // latest last_modified of the objects received (time of the server)
+    QString m_lastModified;
+    bool m_synced;
+};
+
+#endif // SYNCSTATE_H //
@@ -1,15 +1,15 @@
 #include "dataModel/Feature.h"
 
 Feature::Feature()
-    : m_gene()
+    : m_geneId(GeneDictionary::INVALID_ID)
     , m_count(0)
     , m_x(0)
     , m_y(0)
 {
 }
 
-Feature::Feature(const QString &gene, float x, float y, int count)
-    : m_gene(gene)
+Feature::Feature(GeneDictionary::GeneId geneId, float x, float y, int count)
+    : m_geneId(geneId)
     , m_count(count)
     , m_x(x)
     , m_y(y)
@@ -18,7 +18,7 @@ Feature::Feature(const QString &gene, float x, float y, int count)
 
 Feature::Feature(const Feature &other)
 {
-    m_gene = other.m_gene;
+    m_geneId = other.m_geneId;
     m_count = other.m_count;
     m_x = other.m_x;
     m_y = other.m_y;
@@ -30,7 +30,7 @@ Feature::~Feature()
 
 Feature &Feature::operator=(const Feature &other)
 {
-    m_gene = other.m_gene;
+    m_geneId = other.m_geneId;
     m_count = other.m_count;
     m_x = other.m_x;
     m_y = other.m_y;
@@ -39,13 +39,13 @@ Feature &Feature::operator=(const Feature &other)
 
 bool Feature::operator==(const Feature &other) const
 {
-    return (m_gene == other.m_gene && m_count == other.m_count && m_x == other.m_x
+    return (m_geneId == other.m_geneId && m_count == other.m_count && m_x == other.m_x
             && m_y == other.m_y);
 }
 
-const QString Feature::gene() const
+GeneDictionary::GeneId Feature::geneId() const
 {
-    return m_gene;
+    return m_geneId;
 }
 
 int Feature::count() const
@@ -68,9 +68,9 @@ Feature::SpotType Feature::spot() const
     return Feature::SpotType(m_x, m_y);
 }
 
-void Feature::gene(const QString &gene)
+void Feature::geneId(GeneDictionary::GeneId geneId)
 {
-    m_gene = gene;
+    m_geneId = geneId;
 }
 
 void Feature::count(int count)
@@ -5,9 +5,12 @@
 #include <QHash>
 #include <QSet>
 
+#include "dataModel/GeneDictionary.h"
+
 // Data model class to store feature data
 // A feature corresponds to a tuple (barcode or spot in the array)
 // and a gene. In each barcode/spot there can be up to 20k genes.
+// The gene is stored as an ID of the dataset's (or selection's) GeneDictionary
 // The coordinates x,y refers to chip coordinates but the chip object
 // contains an affine matrix that converts chip coordinates to image pixel
 // coordinates
@@ -21,17 +24,18 @@ public:
     typedef QPair<float, float> SpotType;
     typedef QSet<SpotType> UniqueSpotsType;
     typedef QHash<Feature::SpotType, int> spotTotalCounts;
-    typedef QHash<QString, int> geneTotalCounts;
+    typedef QHash<GeneDictionary::GeneId, int> geneTotalCounts;
 
     Feature();
     explicit Feature(const Feature &other);
-    Feature(const QString &gene, float x, float y, int count);
+    Feature(GeneDictionary::GeneId geneId, float x, float y, int count);
     ~Feature();
 
     Feature &operator=(const Feature &other);
     bool operator==(const Feature &other) const;
 
-    const QString gene() const;
+    // the ID of the gene in the gene dictionary
+    GeneDictionary::GeneId geneId() const;
     // count represents the expression level
     int count() const;
     float x() const;
@@ -39,14 +43,14 @@ public:
     // the coordinates of the spot in the array
     SpotType spot() const;
 
-    void gene(const QString &gene);
+    void geneId(GeneDictionary::GeneId geneId);
     void count(int count);
     void x(float x);
     void y(float y);
 
 protected:
     // basic attributes
-    QString m_gene;
+    GeneDictionary::GeneId m_geneId;
     int m_count;
     float m_x;
     float m_y;
@@ -29,13 +29,14 @@ public:
     ~FeatureDTO() {}
 
     // binding
-    void gene(const QString &gene) { m_feature.gene(gene); }
+    // NOTE the gene name must be converted to an ID of a GeneDictionary
+    void gene(const QString &gene) { m_gene = gene; }
     void count(int count) { m_feature.count(count); }
     void x(float x) { m_feature.x(x); }
     void y(float y) { m_feature.y(y); }
 
     // read
-    const QString gene() { return m_feature.gene(); }
+    const QString gene() { return m_gene; }
     int count() { return m_feature.count(); }
     float x() { return m_feature.x(); }
     float y() { return m_feature.y(); }
@@ -46,6 +47,7 @@ public:
 
 private:
     Feature m_feature;
+    QString m_gene;
 };
 
 #endif // FEATUREDTO_H //
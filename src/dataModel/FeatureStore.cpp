@@ -0,0 +1,427 @@
+#include "FeatureStore.h"
+
+#include <algorithm>
+
+FeatureStore::FeatureStore()
+    : m_spotsX()
+    , m_spotsY()
+    , m_rowPointer(1, 0)
+    , m_geneIds()
+    , m_counts()
+{
+}
+
+FeatureStore::FeatureStore(const QVector<float> &spotsX,
+                           const QVector<float> &spotsY,
+                           const QVector<FeatureIndex> &rowPointer,
+                           const QVector<GeneDictionary::GeneId> &geneIds,
+                           const QVector<int> &counts)
+    : m_spotsX(spotsX)
+    , m_spotsY(spotsY)
+    , m_rowPointer(rowPointer)
+    , m_geneIds(geneIds)
+    , m_counts(counts)
+{
+    Q_ASSERT(m_spotsX.size() == m_spotsY.size());
+    Q_ASSERT(m_rowPointer.size() == m_spotsX.size() + 1);
+    Q_ASSERT(m_geneIds.size() == m_counts.size());
+    Q_ASSERT(static_cast<int>(m_rowPointer.last()) == m_geneIds.size());
+}
+
+FeatureStore::FeatureStore(const FeatureStore &other)
+    : m_spotsX(other.m_spotsX)
+    , m_spotsY(other.m_spotsY)
+    , m_rowPointer(other.m_rowPointer)
+    , m_geneIds(other.m_geneIds)
+    , m_counts(other.m_counts)
+{
+}
+
+FeatureStore::~FeatureStore()
+{
+}
+
+FeatureStore &FeatureStore::operator=(const FeatureStore &other)
+{
+    m_spotsX = other.m_spotsX;
+    m_spotsY = other.m_spotsY;
+    m_rowPointer = other.m_rowPointer;
+    m_geneIds = other.m_geneIds;
+    m_counts = other.m_counts;
+    return (*this);
+}
+
+bool FeatureStore::operator==(const FeatureStore &other) const
+{
+    return (m_spotsX == other.m_spotsX && m_spotsY == other.m_spotsY
+            && m_rowPointer == other.m_rowPointer && m_geneIds == other.m_geneIds
+            && m_counts == other.m_counts);
+}
+
+int FeatureStore::size() const
+{
+    return m_geneIds.size();
+}
+
+bool FeatureStore::isEmpty() const
+{
+    return m_geneIds.isEmpty();
+}
+
+int FeatureStore::spotsCount() const
+{
+    return m_spotsX.size();
+}
+
+GeneDictionary::GeneId FeatureStore::geneId(const FeatureIndex feature) const
+{
+    return m_geneIds.at(feature);
+}
+
+int FeatureStore::count(const FeatureIndex feature) const
+{
+    return m_counts.at(feature);
+}
+
+FeatureStore::SpotIndex FeatureStore::spot(const FeatureIndex feature) const
+{
+    Q_ASSERT(static_cast<int>(feature) < size());
+    // the last row pointer that is not greater than the feature (empty spots are skipped)
+    const auto it = std::upper_bound(m_rowPointer.constBegin(), m_rowPointer.constEnd(), feature);
+    return static_cast<SpotIndex>(it - m_rowPointer.constBegin() - 1);
+}
+
+float FeatureStore::spotX(const SpotIndex spot) const
+{
+    return m_spotsX.at(spot);
+}
+
+float FeatureStore::spotY(const SpotIndex spot) const
+{
+    return m_spotsY.at(spot);
+}
+
+FeatureStore::FeatureIndex FeatureStore::spotBegin(const SpotIndex spot) const
+{
+    return m_rowPointer.at(spot);
+}
+
+FeatureStore::FeatureIndex FeatureStore::spotEnd(const SpotIndex spot) const
+{
+    return m_rowPointer.at(spot + 1);
+}
+
+Feature FeatureStore::feature(const FeatureIndex index) const
+{
+    const SpotIndex spot_index = spot(index);
+    return Feature(geneId(index), spotX(spot_index), spotY(spot_index), count(index));
+}
+
+const QVector<float> &FeatureStore::spotsX() const
+{
+    return m_spotsX;
+}
+
+const QVector<float> &FeatureStore::spotsY() const
+{
+    return m_spotsY;
+}
+
+const QVector<FeatureStore::FeatureIndex> &FeatureStore::rowPointer() const
+{
+    return m_rowPointer;
+}
+
+const QVector<GeneDictionary::GeneId> &FeatureStore::geneIds() const
+{
+    return m_geneIds;
+}
+
+const QVector<int> &FeatureStore::counts() const
+{
+    return m_counts;
+}
+
+qint64 FeatureStore::memoryUsage() const
+{
+    return static_cast<qint64>(m_spotsX.capacity()) * sizeof(float)
+           + static_cast<qint64>(m_spotsY.capacity()) * sizeof(float)
+           + static_cast<qint64>(m_rowPointer.capacity()) * sizeof(FeatureIndex)
+           + static_cast<qint64>(m_geneIds.capacity()) * sizeof(GeneDictionary::GeneId)
+           + static_cast<qint64>(m_counts.capacity()) * sizeof(int);
+}
+
+FeatureStoreBuilder::FeatureStoreBuilder()
+    : m_spotIndexes()
+    , m_spotsX()
+    , m_spotsY()
+    , m_spots()
+    , m_geneIds()
+    , m_counts()
+{
+}
+
+FeatureStoreBuilder::~FeatureStoreBuilder()
+{
+}
+
+void FeatureStoreBuilder::reserve(const int size)
+{
+    m_spots.reserve(size);
+    m_geneIds.reserve(size);
+    m_counts.reserve(size);
+}
+
+void FeatureStoreBuilder::append(const GeneDictionary::GeneId geneId,
+                                 const float x,
+                                 const float y,
+                                 const int count)
+{
+    const Feature::SpotType spot(x, y);
+    auto it = m_spotIndexes.find(spot);
+    if (it == m_spotIndexes.end()) {
+        it = m_spotIndexes.insert(spot, static_cast<FeatureStore::SpotIndex>(m_spotsX.size()));
+        m_spotsX.push_back(x);
+        m_spotsY.push_back(y);
+    }
+    m_spots.push_back(it.value());
+    m_geneIds.push_back(geneId);
+    m_counts.push_back(count);
+}
+
+void FeatureStoreBuilder::append(const FeatureStoreBuilder &other,
+                                 const QVector<GeneDictionary::GeneId> &geneIds)
+{
+    reserve(size() + other.size());
+    for (int i = 0; i < other.size(); ++i) {
+        const FeatureStore::SpotIndex spot = other.m_spots.at(i);
+        append(geneIds.at(other.m_geneIds.at(i)),
+               other.m_spotsX.at(spot),
+               other.m_spotsY.at(spot),
+               other.m_counts.at(i));
+    }
+}
+
+int FeatureStoreBuilder::size() const
+{
+    return m_geneIds.size();
+}
+
+FeatureStore FeatureStoreBuilder::build()
+{
+    // group the features by spot (counting sort)
+    QVector<FeatureStore::FeatureIndex> row_pointer(m_spotsX.size() + 1, 0);
+    for (const FeatureStore::SpotIndex spot : m_spots) {
+        ++row_pointer[spot + 1];
+    }
+    for (int i = 1; i < row_pointer.size(); ++i) {
+        row_pointer[i] += row_pointer[i - 1];
+    }
+    QVector<FeatureStore::FeatureIndex> position = row_pointer;
+    QVector<GeneDictionary::GeneId> gene_ids(m_geneIds.size());
+    QVector<int> counts(m_counts.size());
+    for (int i = 0; i < m_spots.size(); ++i) {
+        const FeatureStore::FeatureIndex pos = position[m_spots.at(i)]++;
+        gene_ids[pos] = m_geneIds.at(i);
+        counts[pos] = m_counts.at(i);
+    }
+
+    const FeatureStore store(m_spotsX, m_spotsY, row_pointer, gene_ids, counts);
+
+    // clear the builder
+    m_spotIndexes.clear();
+    m_spotsX.clear();
+    m_spotsY.clear();
+    m_spots.clear();
+    m_geneIds.clear();
+    m_counts.clear();
+
+    return store;
+}
+
+FeatureRef::FeatureRef(const FeatureStore &store,
+                       const FeatureStore::FeatureIndex index,
+                       const FeatureStore::SpotIndex spot)
+    : m_store(&store)
+    , m_index(index)
+    , m_spot(spot)
+{
+}
+
+bool FeatureRef::operator==(const FeatureRef &other) const
+{
+    return (geneId() == other.geneId() && count() == other.count() && x() == other.x()
+            && y() == other.y());
+}
+
+FeatureStore::FeatureIndex FeatureRef::index() const
+{
+    return m_index;
+}
+
+FeatureStore::SpotIndex FeatureRef::spotIndex() const
+{
+    return m_spot;
+}
+
+GeneDictionary::GeneId FeatureRef::geneId() const
+{
+    return m_store->geneId(m_index);
+}
+
+int FeatureRef::count() const
+{
+    return m_store->count(m_index);
+}
+
+float FeatureRef::x() const
+{
+    return m_store->spotX(m_spot);
+}
+
+float FeatureRef::y() const
+{
+    return m_store->spotY(m_spot);
+}
+
+Feature::SpotType FeatureRef::spot() const
+{
+    return Feature::SpotType(x(), y());
+}
+
+FeatureView::const_iterator::const_iterator(const FeatureView &view, const int pos)
+    : m_view(&view)
+    , m_pos(pos)
+    , m_spot(0)
+{
+    if (m_pos < m_view->size()) {
+        m_spot = m_view->m_store.spot(m_view->index(m_pos));
+    }
+}
+
+FeatureRef FeatureView::const_iterator::operator*() const
+{
+    return FeatureRef(m_view->m_store, m_view->index(m_pos), m_spot);
+}
+
+FeatureView::const_iterator &FeatureView::const_iterator::operator++()
+{
+    ++m_pos;
+    if (m_pos < m_view->size()) {
+        const FeatureStore &store = m_view->m_store;
+        const FeatureStore::FeatureIndex index = m_view->index(m_pos);
+        if (index < store.spotBegin(m_spot)) {
+            m_spot = store.spot(index);
+        } else {
+            // features are usually visited in order of the store
+            while (index >= store.spotEnd(m_spot)) {
+                ++m_spot;
+            }
+        }
+    }
+    return *this;
+}
+
+bool FeatureView::const_iterator::operator!=(const const_iterator &other) const
+{
+    return m_pos != other.m_pos || m_view != other.m_view;
+}
+
+bool FeatureView::const_iterator::operator==(const const_iterator &other) const
+{
+    return !(*this != other);
+}
+
+FeatureView::FeatureView()
+    : m_store()
+    , m_indexes()
+    , m_all(true)
+{
+}
+
+FeatureView::FeatureView(const FeatureStore &store)
+    : m_store(store)
+    , m_indexes()
+    , m_all(true)
+{
+}
+
+FeatureView::FeatureView(const FeatureStore &store,
+                         const QVector<FeatureStore::FeatureIndex> &indexes)
+    : m_store(store)
+    , m_indexes(indexes)
+    , m_all(false)
+{
+}
+
+FeatureView::FeatureView(const FeatureView &other)
+    : m_store(other.m_store)
+    , m_indexes(other.m_indexes)
+    , m_all(other.m_all)
+{
+}
+
+FeatureView::~FeatureView()
+{
+}
+
+FeatureView &FeatureView::operator=(const FeatureView &other)
+{
+    m_store = other.m_store;
+    m_indexes = other.m_indexes;
+    m_all = other.m_all;
+    return (*this);
+}
+
+bool FeatureView::operator==(const FeatureView &other) const
+{
+    return (m_store == other.m_store && m_indexes == other.m_indexes && m_all == other.m_all);
+}
+
+int FeatureView::size() const
+{
+    return m_all ? m_store.size() : m_indexes.size();
+}
+
+bool FeatureView::isEmpty() const
+{
+    return size() == 0;
+}
+
+FeatureStore::FeatureIndex FeatureView::index(const int i) const
+{
+    return m_all ? static_cast<FeatureStore::FeatureIndex>(i) : m_indexes.at(i);
+}
+
+FeatureRef FeatureView::at(const int i) const
+{
+    const FeatureStore::FeatureIndex feature = index(i);
+    return FeatureRef(m_store, feature, m_store.spot(feature));
+}
+
+FeatureRef FeatureView::first() const
+{
+    Q_ASSERT(!isEmpty());
+    return at(0);
+}
+
+FeatureRef FeatureView::last() const
+{
+    Q_ASSERT(!isEmpty());
+    return at(size() - 1);
+}
+
+FeatureView::const_iterator FeatureView::begin() const
+{
+    return const_iterator(*this, 0);
+}
+
+FeatureView::const_iterator FeatureView::end() const
+{
+    return const_iterator(*this, size());
+}
+
+const FeatureStore &FeatureView::store() const
+{
+    return m_store;
+}
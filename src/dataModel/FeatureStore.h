@@ -0,0 +1,207 @@
+#ifndef FEATURESTORE_H
+#define FEATURESTORE_H
+
+#include <QVector>
+#include <QHash>
+
+#include "dataModel/Feature.h"
+#include "dataModel/GeneDictionary.h"
+
+// Data model class to store the features of a dataset (or selection) in
+// compact form. Instead of one object per feature the store keeps a few
+// contiguous columns (struct of arrays) with the features grouped by spot:
+//   Spots        x and y coordinates of each unique spot
+//   Row pointer  (spots + 1) offsets of the features of each spot
+//   Gene IDs     features x ID in the GeneDictionary
+//   Counts       features x count
+// The features of the spot i are then the range [spotBegin(i), spotEnd(i))
+// so a feature takes 8 bytes plus its share of the spot columns.
+// The store is immutable (see FeatureStoreBuilder) and copies are cheap
+// as the columns are implicitly shared.
+class FeatureStore
+{
+
+public:
+    // index of a spot in the store
+    typedef quint32 SpotIndex;
+    // index of a feature in the store
+    typedef quint32 FeatureIndex;
+
+    FeatureStore();
+    // creates a store from its columns (see the layout above)
+    // rowPointer must have spots + 1 elements and geneIds and counts the same size
+    FeatureStore(const QVector<float> &spotsX,
+                 const QVector<float> &spotsY,
+                 const QVector<FeatureIndex> &rowPointer,
+                 const QVector<GeneDictionary::GeneId> &geneIds,
+                 const QVector<int> &counts);
+    FeatureStore(const FeatureStore &other);
+    ~FeatureStore();
+
+    FeatureStore &operator=(const FeatureStore &other);
+    bool operator==(const FeatureStore &other) const;
+
+    // number of features
+    int size() const;
+    bool isEmpty() const;
+    // number of unique spots
+    int spotsCount() const;
+
+    // feature columns
+    GeneDictionary::GeneId geneId(const FeatureIndex feature) const;
+    int count(const FeatureIndex feature) const;
+    // returns the spot of the feature (binary search, iterate the spots
+    // instead when possible)
+    SpotIndex spot(const FeatureIndex feature) const;
+
+    // spot columns
+    float spotX(const SpotIndex spot) const;
+    float spotY(const SpotIndex spot) const;
+    // range of features of the spot [spotBegin, spotEnd)
+    FeatureIndex spotBegin(const SpotIndex spot) const;
+    FeatureIndex spotEnd(const SpotIndex spot) const;
+
+    // returns a copy of the feature as an object
+    Feature feature(const FeatureIndex index) const;
+
+    // raw columns (for serialization)
+    const QVector<float> &spotsX() const;
+    const QVector<float> &spotsY() const;
+    const QVector<FeatureIndex> &rowPointer() const;
+    const QVector<GeneDictionary::GeneId> &geneIds() const;
+    const QVector<int> &counts() const;
+
+    // returns the memory used by the columns in bytes
+    qint64 memoryUsage() const;
+
+private:
+    QVector<float> m_spotsX;
+    QVector<float> m_spotsY;
+    QVector<FeatureIndex> m_rowPointer;
+    QVector<GeneDictionary::GeneId> m_geneIds;
+    QVector<int> m_counts;
+};
+
+// Helper class to create a FeatureStore from features added in any order.
+// Spots are indexed in order of appearance and the order of the features
+// of the same spot is kept.
+class FeatureStoreBuilder
+{
+
+public:
+    FeatureStoreBuilder();
+    ~FeatureStoreBuilder();
+
+    void reserve(const int size);
+    // adds a feature
+    void append(const GeneDictionary::GeneId geneId, const float x, const float y, const int count);
+    // adds the features of the other builder converting their gene IDs
+    // with the table given (see GeneDictionary::merge())
+    void append(const FeatureStoreBuilder &other, const QVector<GeneDictionary::GeneId> &geneIds);
+
+    // number of features added
+    int size() const;
+
+    // groups the features by spot into a store and clears the builder
+    FeatureStore build();
+
+private:
+    // unique spots
+    QHash<Feature::SpotType, FeatureStore::SpotIndex> m_spotIndexes;
+    QVector<float> m_spotsX;
+    QVector<float> m_spotsY;
+    // features in order of addition
+    QVector<FeatureStore::SpotIndex> m_spots;
+    QVector<GeneDictionary::GeneId> m_geneIds;
+    QVector<int> m_counts;
+};
+
+// Light-weight reference to a feature of a store (only valid while the store is)
+class FeatureRef
+{
+
+public:
+    FeatureRef(const FeatureStore &store,
+               const FeatureStore::FeatureIndex index,
+               const FeatureStore::SpotIndex spot);
+
+    bool operator==(const FeatureRef &other) const;
+
+    // index of the feature in the store
+    FeatureStore::FeatureIndex index() const;
+    // index of the spot in the store
+    FeatureStore::SpotIndex spotIndex() const;
+
+    GeneDictionary::GeneId geneId() const;
+    int count() const;
+    float x() const;
+    float y() const;
+    // the coordinates of the spot in the array
+    Feature::SpotType spot() const;
+
+private:
+    const FeatureStore *m_store;
+    FeatureStore::FeatureIndex m_index;
+    FeatureStore::SpotIndex m_spot;
+};
+
+// Light-weight view over the features of a store, either all of them or
+// a list of feature indexes (for example the features of a gene or a selection)
+// The view shares the columns of the store so it can outlive the original one
+class FeatureView
+{
+
+public:
+    class const_iterator
+    {
+
+    public:
+        const_iterator(const FeatureView &view, const int pos);
+
+        FeatureRef operator*() const;
+        const_iterator &operator++();
+        bool operator!=(const const_iterator &other) const;
+        bool operator==(const const_iterator &other) const;
+
+    private:
+        const FeatureView *m_view;
+        int m_pos;
+        // the spot of the current feature (iterating in order of the
+        // store only advances it)
+        FeatureStore::SpotIndex m_spot;
+    };
+
+    // an empty view
+    FeatureView();
+    // a view with all the features of the store
+    explicit FeatureView(const FeatureStore &store);
+    // a view with the features of the store given by their indexes
+    FeatureView(const FeatureStore &store, const QVector<FeatureStore::FeatureIndex> &indexes);
+    FeatureView(const FeatureView &other);
+    ~FeatureView();
+
+    FeatureView &operator=(const FeatureView &other);
+    bool operator==(const FeatureView &other) const;
+
+    int size() const;
+    bool isEmpty() const;
+    // the index in the store of the i-th feature of the view
+    FeatureStore::FeatureIndex index(const int i) const;
+    FeatureRef at(const int i) const;
+    FeatureRef first() const;
+    FeatureRef last() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // the store the view refers to
+    const FeatureStore &store() const;
+
+private:
+    FeatureStore m_store;
+    QVector<FeatureStore::FeatureIndex> m_indexes;
+    // true if the view has all the features of the store (m_indexes is not used)
+    bool m_all;
+};
+
+#endif // FEATURESTORE_H //
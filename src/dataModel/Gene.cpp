@@ -2,6 +2,7 @@
 
 Gene::Gene()
     : m_name()
+    , m_id(GeneDictionary::INVALID_ID)
     , m_color(Visual::DEFAULT_COLOR_GENE)
     , m_selected(false)
     , m_cutoff(1)
@@ -10,14 +11,20 @@ Gene::Gene()
 
 Gene::Gene(const Gene &other)
     : m_name(other.m_name)
+    , m_id(other.m_id)
     , m_color(other.m_color)
     , m_selected(other.m_selected)
     , m_cutoff(other.m_cutoff)
 {
 }
 
-Gene::Gene(const QString &name, bool selected, const QColor &color, const int cutoff)
+Gene::Gene(const QString &name,
+           const GeneDictionary::GeneId id,
+           bool selected,
+           const QColor &color,
+           const int cutoff)
     : m_name(name)
+    , m_id(id)
     , m_color(color)
     , m_selected(selected)
     , m_cutoff(cutoff)
@@ -30,6 +37,7 @@ Gene::~Gene()
 Gene &Gene::operator=(const Gene &other)
 {
     m_name = other.m_name;
+    m_id = other.m_id;
     m_selected = other.m_selected;
     m_color = other.m_color;
     m_cutoff = other.m_cutoff;
@@ -38,8 +46,8 @@ Gene &Gene::operator=(const Gene &other)
 
 bool Gene::operator==(const Gene &other) const
 {
-    return (m_selected == other.m_selected && m_name == other.m_name && m_color == other.m_color
-            && m_cutoff == other.m_cutoff);
+    return (m_selected == other.m_selected && m_name == other.m_name && m_id == other.m_id
+            && m_color == other.m_color && m_cutoff == other.m_cutoff);
 }
 
 const QString Gene::name() const
@@ -47,6 +55,11 @@ const QString Gene::name() const
     return m_name;
 }
 
+GeneDictionary::GeneId Gene::id() const
+{
+    return m_id;
+}
+
 bool Gene::selected() const
 {
     return m_selected;
@@ -67,6 +80,11 @@ void Gene::name(const QString &name)
     m_name = name;
 }
 
+void Gene::id(const GeneDictionary::GeneId id)
+{
+    m_id = id;
+}
+
 void Gene::selected(bool selected)
 {
     m_selected = selected;
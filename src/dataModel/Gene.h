@@ -5,6 +5,7 @@
 #include <QColor>
 
 #include "SettingsVisual.h"
+#include "dataModel/GeneDictionary.h"
 
 // Data model class to store gene data.
 // The genes are part of the features, they are modeled in a class
@@ -16,6 +17,7 @@ public:
     Gene();
     explicit Gene(const Gene &other);
     explicit Gene(const QString &name,
+                  const GeneDictionary::GeneId id = GeneDictionary::INVALID_ID,
                   bool selected = false,
                   const QColor &color = Visual::DEFAULT_COLOR_GENE,
                   const int cutoff = 1);
@@ -25,11 +27,14 @@ public:
     bool operator==(const Gene &other) const;
 
     const QString name() const;
+    // the ID of the gene in the dataset's gene dictionary
+    GeneDictionary::GeneId id() const;
     bool selected() const;
     const QColor color() const;
     int cut_off() const;
 
     void name(const QString &name);
+    void id(const GeneDictionary::GeneId id);
     void selected(bool selected);
     void color(const QColor &color);
     // the gene cut-off is used to hide
@@ -41,6 +46,7 @@ public:
 
 private:
     QString m_name;
+    GeneDictionary::GeneId m_id;
     QColor m_color;
     bool m_selected;
     int m_cutoff;
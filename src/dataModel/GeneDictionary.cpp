@@ -0,0 +1,94 @@
+#include "GeneDictionary.h"
+
+const GeneDictionary::GeneId GeneDictionary::INVALID_ID;
+
+GeneDictionary::GeneDictionary()
+    : m_names()
+    , m_ids()
+{
+}
+
+GeneDictionary::GeneDictionary(const GeneDictionary &other)
+    : m_names(other.m_names)
+    , m_ids(other.m_ids)
+{
+}
+
+GeneDictionary::~GeneDictionary()
+{
+}
+
+GeneDictionary &GeneDictionary::operator=(const GeneDictionary &other)
+{
+    m_names = other.m_names;
+    m_ids = other.m_ids;
+    return (*this);
+}
+
+bool GeneDictionary::operator==(const GeneDictionary &other) const
+{
+    return m_names == other.m_names;
+}
+
+GeneDictionary::GeneId GeneDictionary::insert(const QString &name)
+{
+    auto it = m_ids.find(name);
+    if (it == m_ids.end()) {
+        it = m_ids.insert(name, static_cast<GeneId>(m_names.size()));
+        m_names.push_back(name);
+    }
+    return it.value();
+}
+
+GeneDictionary::GeneId GeneDictionary::id(const QString &name) const
+{
+    return m_ids.value(name, INVALID_ID);
+}
+
+const QString GeneDictionary::name(const GeneId id) const
+{
+    Q_ASSERT(id < static_cast<GeneId>(m_names.size()));
+    return m_names.at(id);
+}
+
+bool GeneDictionary::contains(const QString &name) const
+{
+    return m_ids.contains(name);
+}
+
+const QVector<QString> &GeneDictionary::names() const
+{
+    return m_names;
+}
+
+int GeneDictionary::size() const
+{
+    return m_names.size();
+}
+
+bool GeneDictionary::isEmpty() const
+{
+    return m_names.isEmpty();
+}
+
+void GeneDictionary::reserve(const int size)
+{
+    m_names.reserve(size);
+    m_ids.reserve(size);
+}
+
+void GeneDictionary::clear()
+{
+    m_names.clear();
+    m_ids.clear();
+}
+
+QVector<GeneDictionary::GeneId> GeneDictionary::merge(const GeneDictionary &other)
+{
+    QVector<GeneId> other_to_this;
+    other_to_this.reserve(other.size());
+    for (const QString &name : other.m_names) {
+        other_to_this.push_back(insert(name));
+    }
+    return other_to_this;
+}
@@ -0,0 +1,52 @@
+#ifndef GENEDICTIONARY_H
+#define GENEDICTIONARY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+// Data model class to store the unique gene names of a dataset (or selection)
+// Every gene name is interned and mapped to a dense integer ID (0..size - 1)
+// so the features and the lookups can use the ID instead of the name.
+// Names should only be resolved when they are shown to the user.
+// Copies are cheap as the containers are implicitly shared.
+class GeneDictionary
+{
+
+public:
+    typedef quint32 GeneId;
+    // ID returned for names that are not in the dictionary
+    static const GeneId INVALID_ID = 0xFFFFFFFF;
+
+    GeneDictionary();
+    GeneDictionary(const GeneDictionary &other);
+    ~GeneDictionary();
+
+    GeneDictionary &operator=(const GeneDictionary &other);
+    bool operator==(const GeneDictionary &other) const;
+
+    // returns the ID of the gene name given (it is added if not present)
+    GeneId insert(const QString &name);
+    // returns the ID of the gene name given or INVALID_ID if not present
+    GeneId id(const QString &name) const;
+    // returns the name of the gene ID given (ID must be valid)
+    const QString name(const GeneId id) const;
+    bool contains(const QString &name) const;
+
+    // the names ordered by ID
+    const QVector<QString> &names() const;
+    int size() const;
+    bool isEmpty() const;
+    void reserve(const int size);
+    void clear();
+
+    // adds the genes of the other dictionary and returns a table
+    // to convert the IDs of the other dictionary to IDs of this one
+    QVector<GeneId> merge(const GeneDictionary &other);
+
+private:
+    QVector<QString> m_names;
+    QHash<QString, GeneId> m_ids;
+};
+
+#endif // GENEDICTIONARY_H //
@@ -0,0 +1,180 @@
+#include "SpotGeneMatrix.h"
+
+#include <algorithm>
+#include <numeric>
+
+SpotGeneMatrix::SpotGeneMatrix()
+    : m_rowPointer(1, 0)
+    , m_geneIds()
+    , m_counts()
+    , m_features()
+    , m_rowReads()
+    , m_genePointer(1, 0)
+    , m_geneRows()
+    , m_geneCounts()
+{
+}
+
+SpotGeneMatrix::SpotGeneMatrix(const FeatureStore &store,
+                               const QVector<int> &spotRows,
+                               const int rows)
+    : m_rowPointer(rows + 1, 0)
+    , m_geneIds(store.size())
+    , m_counts(store.size())
+    , m_features(store.size())
+    , m_rowReads(rows, 0)
+    , m_genePointer()
+    , m_geneRows(store.size())
+    , m_geneCounts(store.size())
+{
+    Q_ASSERT(spotRows.size() == store.spotsCount());
+
+    // the features of the store are grouped by spot so the rows are
+    // created with a counting sort of the spots (one pass to size the rows
+    // and another one to fill them)
+    const FeatureStore::SpotIndex spots = static_cast<FeatureStore::SpotIndex>(spotRows.size());
+    GeneDictionary::GeneId columns = 0;
+    for (FeatureStore::SpotIndex spot = 0; spot < spots; ++spot) {
+        const int row = spotRows.at(spot);
+        Q_ASSERT(row >= 0 && row < rows);
+        m_rowPointer[row + 1] += static_cast<int>(store.spotEnd(spot) - store.spotBegin(spot));
+    }
+    std::partial_sum(m_rowPointer.begin(), m_rowPointer.end(), m_rowPointer.begin());
+
+    QVector<EntryIndex> rowCursor(m_rowPointer);
+    for (FeatureStore::SpotIndex spot = 0; spot < spots; ++spot) {
+        const int row = spotRows.at(spot);
+        for (FeatureStore::FeatureIndex feature = store.spotBegin(spot);
+             feature < store.spotEnd(spot);
+             ++feature) {
+            const EntryIndex entry = rowCursor[row]++;
+            const GeneDictionary::GeneId gene = store.geneId(feature);
+            m_geneIds[entry] = gene;
+            m_counts[entry] = store.count(feature);
+            m_features[entry] = feature;
+            m_rowReads[row] += m_counts.at(entry);
+            columns = std::max(columns, gene + 1);
+        }
+    }
+
+    // the transpose is created the same way iterating the rows in order
+    // so the rows of each gene are sorted
+    m_genePointer.fill(0, static_cast<int>(columns) + 1);
+    for (const GeneDictionary::GeneId gene : m_geneIds) {
+        ++m_genePointer[gene + 1];
+    }
+    std::partial_sum(m_genePointer.begin(), m_genePointer.end(), m_genePointer.begin());
+
+    QVector<EntryIndex> geneCursor(m_genePointer);
+    for (int row = 0; row < rows; ++row) {
+        for (EntryIndex entry = m_rowPointer.at(row); entry < m_rowPointer.at(row + 1); ++entry) {
+            const EntryIndex gene_entry = geneCursor[m_geneIds.at(entry)]++;
+            m_geneRows[gene_entry] = row;
+            m_geneCounts[gene_entry] = m_counts.at(entry);
+        }
+    }
+}
+
+SpotGeneMatrix::SpotGeneMatrix(const SpotGeneMatrix &other)
+    : m_rowPointer(other.m_rowPointer)
+    , m_geneIds(other.m_geneIds)
+    , m_counts(other.m_counts)
+    , m_features(other.m_features)
+    , m_rowReads(other.m_rowReads)
+    , m_genePointer(other.m_genePointer)
+    , m_geneRows(other.m_geneRows)
+    , m_geneCounts(other.m_geneCounts)
+{
+}
+
+SpotGeneMatrix::~SpotGeneMatrix()
+{
+}
+
+SpotGeneMatrix &SpotGeneMatrix::operator=(const SpotGeneMatrix &other)
+{
+    m_rowPointer = other.m_rowPointer;
+    m_geneIds = other.m_geneIds;
+    m_counts = other.m_counts;
+    m_features = other.m_features;
+    m_rowReads = other.m_rowReads;
+    m_genePointer = other.m_genePointer;
+    m_geneRows = other.m_geneRows;
+    m_geneCounts = other.m_geneCounts;
+    return (*this);
+}
+
+int SpotGeneMatrix::rows() const
+{
+    return m_rowPointer.size() - 1;
+}
+
+int SpotGeneMatrix::columns() const
+{
+    return m_genePointer.size() - 1;
+}
+
+int SpotGeneMatrix::size() const
+{
+    return m_geneIds.size();
+}
+
+bool SpotGeneMatrix::isEmpty() const
+{
+    return m_geneIds.isEmpty();
+}
+
+SpotGeneMatrix::EntryIndex SpotGeneMatrix::rowBegin(const int row) const
+{
+    return m_rowPointer.at(row);
+}
+
+SpotGeneMatrix::EntryIndex SpotGeneMatrix::rowEnd(const int row) const
+{
+    return m_rowPointer.at(row + 1);
+}
+
+GeneDictionary::GeneId SpotGeneMatrix::geneId(const EntryIndex entry) const
+{
+    return m_geneIds.at(entry);
+}
+
+int SpotGeneMatrix::count(const EntryIndex entry) const
+{
+    return m_counts.at(entry);
+}
+
+FeatureStore::FeatureIndex SpotGeneMatrix::feature(const EntryIndex entry) const
+{
+    return m_features.at(entry);
+}
+
+int SpotGeneMatrix::rowReads(const int row) const
+{
+    return m_rowReads.at(row);
+}
+
+int SpotGeneMatrix::rowGenes(const int row) const
+{
+    return m_rowPointer.at(row + 1) - m_rowPointer.at(row);
+}
+
+SpotGeneMatrix::EntryIndex SpotGeneMatrix::geneBegin(const GeneDictionary::GeneId gene) const
+{
+    return gene < static_cast<GeneDictionary::GeneId>(columns()) ? m_genePointer.at(gene) : 0;
+}
+
+SpotGeneMatrix::EntryIndex SpotGeneMatrix::geneEnd(const GeneDictionary::GeneId gene) const
+{
+    return gene < static_cast<GeneDictionary::GeneId>(columns()) ? m_genePointer.at(gene + 1) : 0;
+}
+
+int SpotGeneMatrix::geneRow(const EntryIndex entry) const
+{
+    return m_geneRows.at(entry);
+}
+
+int SpotGeneMatrix::geneCount(const EntryIndex entry) const
+{
+    return m_geneCounts.at(entry);
+}
@@ -0,0 +1,72 @@
+#ifndef SPOTGENEMATRIX_H
+#define SPOTGENEMATRIX_H
+
+#include <QVector>
+
+#include "dataModel/FeatureStore.h"
+#include "dataModel/GeneDictionary.h"
+
+// Immutable sparse spot x gene matrix of counts built from a FeatureStore.
+// The rows are spots (the rendering indexes, several spots of the store can
+// be mapped to the same row) and the columns are the gene IDs.
+// The matrix is kept twice:
+//   CSR  the entries of the row i are the range [rowBegin(i), rowEnd(i))
+//        each one with its gene ID, count and feature (index in the store)
+//   CSC  the entries of the gene g are the range [geneBegin(g), geneEnd(g))
+//        each one with its row and count (rows in ascending order)
+// plus the total reads and genes of each row, so every lookup of the
+// renderer is a linear scan of contiguous memory with no allocation.
+// Copies are cheap as the columns are implicitly shared.
+class SpotGeneMatrix
+{
+
+public:
+    // index of an entry (a non-zero element) of the matrix
+    typedef int EntryIndex;
+
+    SpotGeneMatrix();
+    // creates the matrix of the store given where spotRows has the row
+    // of each spot of the store (store.spotsCount() elements from 0 to rows - 1)
+    SpotGeneMatrix(const FeatureStore &store, const QVector<int> &spotRows, const int rows);
+    SpotGeneMatrix(const SpotGeneMatrix &other);
+    ~SpotGeneMatrix();
+
+    SpotGeneMatrix &operator=(const SpotGeneMatrix &other);
+
+    // number of rows (spots), columns (genes) and entries
+    int rows() const;
+    int columns() const;
+    int size() const;
+    bool isEmpty() const;
+
+    // CSR access (by row)
+    EntryIndex rowBegin(const int row) const;
+    EntryIndex rowEnd(const int row) const;
+    GeneDictionary::GeneId geneId(const EntryIndex entry) const;
+    int count(const EntryIndex entry) const;
+    FeatureStore::FeatureIndex feature(const EntryIndex entry) const;
+
+    // totals of the row (sum of the counts and number of entries)
+    int rowReads(const int row) const;
+    int rowGenes(const int row) const;
+
+    // CSC access (by gene), the ranges of the genes not present are empty
+    EntryIndex geneBegin(const GeneDictionary::GeneId gene) const;
+    EntryIndex geneEnd(const GeneDictionary::GeneId gene) const;
+    int geneRow(const EntryIndex entry) const;
+    int geneCount(const EntryIndex entry) const;
+
+private:
+    // CSR
+    QVector<EntryIndex> m_rowPointer;
+    QVector<GeneDictionary::GeneId> m_geneIds;
+    QVector<int> m_counts;
+    QVector<FeatureStore::FeatureIndex> m_features;
+    QVector<int> m_rowReads;
+    // CSC
+    QVector<EntryIndex> m_genePointer;
+    QVector<int> m_geneRows;
+    QVector<int> m_geneCounts;
+};
+
+#endif // SPOTGENEMATRIX_H //
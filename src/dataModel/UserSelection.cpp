@@ -15,6 +15,7 @@ UserSelection::UserSelection()
     , m_userId()
     , m_datasetId()
     , m_selectedFeatures()
+    , m_geneDictionary()
     , m_type()
     , m_status()
     , m_comment()
@@ -37,6 +38,7 @@ UserSelection::UserSelection(const UserSelection &other)
     , m_userId(other.m_userId)
     , m_datasetId(other.m_datasetId)
     , m_selectedFeatures(other.m_selectedFeatures)
+    , m_geneDictionary(other.m_geneDictionary)
     , m_type(other.m_type)
     , m_status(other.m_status)
     , m_comment(other.m_comment)
@@ -64,6 +66,7 @@ UserSelection &UserSelection::operator=(const UserSelection &other)
     m_userId = other.m_userId;
     m_datasetId = other.m_datasetId;
     m_selectedFeatures = other.m_selectedFeatures;
+    m_geneDictionary = other.m_geneDictionary;
     m_type = other.m_type;
     m_status = other.m_status;
     m_comment = other.m_comment;
@@ -84,7 +87,7 @@ bool UserSelection::operator==(const UserSelection &other) const
 {
     return (m_id == other.m_id && m_name == other.m_name && m_userId == other.m_userId
             && m_datasetId == other.m_datasetId && m_selectedFeatures == other.m_selectedFeatures
-            && m_type == other.m_type && m_status == other.m_status && m_comment == other.m_comment
+            && m_geneDictionary == other.m_geneDictionary && m_type == other.m_type && m_status == other.m_status && m_comment == other.m_comment
             && m_enabled == other.m_enabled && m_created == other.m_created
             && m_lastMofidied == other.m_lastMofidied && m_datasetName == other.m_datasetName
             && m_tissueSnapShot == other.m_tissueSnapShot && m_totalReads == other.m_totalReads
@@ -117,6 +120,11 @@ const DataProxy::FeatureList UserSelection::selectedFeatures() const
     return m_selectedFeatures;
 }
 
+const GeneDictionary &UserSelection::geneDictionary() const
+{
+    return m_geneDictionary;
+}
+
 const QString UserSelection::status() const
 {
     return m_status;
@@ -247,9 +255,16 @@ void UserSelection::saved(const bool saved)
     m_saved = saved;
 }
 
-void UserSelection::loadFeatures(const DataProxy::FeatureList &features)
+void UserSelection::geneDictionary(const GeneDictionary &geneDictionary)
+{
+    m_geneDictionary = geneDictionary;
+}
+
+void UserSelection::loadFeatures(const DataProxy::FeatureList &features,
+                                 const GeneDictionary &geneDictionary)
 {
     m_selectedFeatures = features;
+    m_geneDictionary = geneDictionary;
     // clear variables
     m_totalReads = 0;
     m_totalGenes = 0;
@@ -257,12 +272,12 @@ void UserSelection::loadFeatures(const DataProxy::FeatureList &features)
     m_totalSpots = 0;
 
     // populate the selected genes and spots by iterating the features
-    QSet<QString> unique_genes;
-    Feature::UniqueSpotsType unique_spots;
+    QSet<GeneDictionary::GeneId> unique_genes;
+    QSet<FeatureStore::SpotIndex> unique_spots;
     for (const auto &feature : features) {
-        unique_genes.insert(feature->gene());
-        unique_spots.insert(feature->spot());
-        m_totalReads += feature->count();
+        unique_genes.insert(feature.geneId());
+        unique_spots.insert(feature.spotIndex());
+        m_totalReads += feature.count();
     }
 
     m_totalSpots = unique_spots.size();
@@ -319,13 +334,13 @@ UserSelection::geneTotalCountsVector UserSelection::getGeneCounts() const
     geneTotalCountsVector gene_countsVector;
     // aggreate counts by gene
     for (const auto &feature : m_selectedFeatures) {
-        Q_ASSERT(feature);
-        gene_countsMap[feature->gene()] += feature->count();
+        gene_countsMap[feature.geneId()] += feature.count();
     }
-    // create a vector of gene-count pairs
+    // create a vector of gene-count pairs (gene names are resolved here)
+    gene_countsVector.reserve(gene_countsMap.size());
     Feature::geneTotalCounts::const_iterator it = gene_countsMap.constBegin();
     while (it != gene_countsMap.constEnd()) {
-        gene_countsVector.push_back(geneCount(it.key(), it.value()));
+        gene_countsVector.push_back(geneCount(m_geneDictionary.name(it.key()), it.value()));
         ++it;
     }
     // return the vector
@@ -336,7 +351,7 @@ Feature::spotTotalCounts UserSelection::getTotalCounts() const
 {
     Feature::spotTotalCounts read_counts;
     for (const auto &feature : m_selectedFeatures) {
-        read_counts[feature->spot()] += feature->count();
+        read_counts[feature.spot()] += feature.count();
     }
     return read_counts;
 }
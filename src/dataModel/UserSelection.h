@@ -7,6 +7,7 @@
 #include <QColor>
 
 #include "dataModel/Feature.h"
+#include "dataModel/GeneDictionary.h"
 #include "data/DataProxy.h"
 
 // Gene selection represents a selection of spots made by the user trough the
@@ -41,6 +42,8 @@ public:
     const QString datasetId() const;
     // the list of features present in the selection
     const DataProxy::FeatureList selectedFeatures() const;
+    // the dictionary to resolve the gene IDs of the features
+    const GeneDictionary &geneDictionary() const;
     const QString status() const;
     const QString comment() const;
     // whether the selection is valid or not
@@ -68,6 +71,7 @@ public:
     void userId(const QString &userId);
     void datasetId(const QString &datasetId);
     void selectedFeatures(const DataProxy::FeatureList &features);
+    void geneDictionary(const GeneDictionary &geneDictionary);
     void status(const QString &status);
     void comment(const QString &comment);
     void enabled(const bool enabled);
@@ -81,7 +85,9 @@ public:
     // this method will call selectedFeatures(features) to assign the features
     // but will also compute the selectedGenes and selectedSpots
     // so they can be stored in the selection
-    void loadFeatures(const DataProxy::FeatureList &features);
+    // the gene IDs of the features must belong to the dictionary given
+    void loadFeatures(const DataProxy::FeatureList &features,
+                      const GeneDictionary &geneDictionary);
 
     // convenience type to convert enum types to qstring and viceversea
     static QString typeToQString(const Type &type);
@@ -99,6 +105,7 @@ private:
     QString m_userId;
     QString m_datasetId;
     DataProxy::FeatureList m_selectedFeatures;
+    GeneDictionary m_geneDictionary;
     Type m_type;
     QString m_status;
     QString m_comment;
@@ -72,7 +72,10 @@ public:
     void datasetId(const QString &datasetId) { m_userSelection.datasetId(datasetId); }
     void selectedFeatures(const QVariantList &selectedFeatures)
     {
-        m_userSelection.loadFeatures(unserializeSelectionVector(selectedFeatures));
+        GeneDictionary geneDictionary;
+        const DataProxy::FeatureList features
+            = unserializeSelectionVector(selectedFeatures, geneDictionary);
+        m_userSelection.loadFeatures(features, geneDictionary);
     }
     void type(const QString &type) { m_userSelection.type(UserSelection::QStringToType(type)); }
     void status(const QString &status) { m_userSelection.status(status); }
@@ -104,11 +107,11 @@ public:
         QJsonArray geneHits;
         for (const auto &feature : m_userSelection.selectedFeatures()) {
             QJsonArray geneHit;
-            geneHit.append(feature->gene());
+            geneHit.append(m_userSelection.geneDictionary().name(feature.geneId()));
             // TODO temp hack coz they are wronly defined as strings in the server
-            geneHit.append(QString::number(feature->x()));
-            geneHit.append(QString::number(feature->y()));
-            geneHit.append(QString::number(feature->count()));
+            geneHit.append(QString::number(feature.x()));
+            geneHit.append(QString::number(feature.y()));
+            geneHit.append(QString::number(feature.count()));
             geneHits.append(geneHit);
         }
         jsonObj["gene_hits"] = geneHits;
@@ -136,8 +139,9 @@ private:
         QVariantList newList;
         for (const auto &feature : unserializedVector) {
             QVariantList itemList;
-            itemList << feature->gene() << QString::number(feature->x())
-                     << QString::number(feature->y()) << QString::number(feature->count());
+            itemList << m_userSelection.geneDictionary().name(feature.geneId())
+                     << QString::number(feature.x())
+                     << QString::number(feature.y()) << QString::number(feature.count());
             newList << QVariant::fromValue(itemList);
         }
 
@@ -145,14 +149,16 @@ private:
     }
 
     // Transforms a QVariantList of features to a list of features
+    // the gene names are added to the dictionary given
     // TODO this could be done automatically in serializeVector() we just need to
     // register
     // the selection metatype conversion in the Feature Object
-    const DataProxy::FeatureList unserializeSelectionVector(
-        const QVariantList &serializedVector) const
+    const DataProxy::FeatureList unserializeSelectionVector(const QVariantList &serializedVector,
+                                                            GeneDictionary &geneDictionary) const
     {
         // unserialize data
-        DataProxy::FeatureList features;
+        FeatureStoreBuilder features;
+        features.reserve(serializedVector.size());
         QVariantList::const_iterator it;
         QVariantList::const_iterator end = serializedVector.end();
         for (it = serializedVector.begin(); it != end; ++it) {
@@ -164,9 +170,9 @@ private:
             const int x = elementList.at(1).toInt();
             const int y = elementList.at(2).toInt();
             const int count = elementList.at(3).toInt();
-            features.push_back(std::make_shared<Feature>(Feature(gene, x, y, count)));
+            features.append(geneDictionary.insert(gene), x, y, count);
         }
-        return features;
+        return DataProxy::FeatureList(features.build());
     }
 
     UserSelection m_userSelection;
@@ -0,0 +1,364 @@
+#include "BinaryFeatureFile.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace
+{
+
+// magic bytes at the beginning of the file
+const char MAGIC[4] = {'S', 'T', 'V', 'F'};
+// size of the header in bytes
+const qint64 HEADER_SIZE = 32;
+
+// rounds up the size given to a multiple of 4 bytes
+inline qint64 align4(const qint64 size)
+{
+    return (size + 3) & ~qint64(3);
+}
+
+// reads the nth uint32 field of the header
+inline quint32 headerField(const uchar *data, const int field)
+{
+    return qFromLittleEndian<quint32>(data + sizeof(MAGIC) + field * sizeof(quint32));
+}
+
+// writes the raw content of a vector (the host must be little endian)
+template <typename T>
+bool writeColumn(QIODevice &device, const QVector<T> &column)
+{
+    const qint64 size = column.size() * static_cast<qint64>(sizeof(T));
+    return device.write(reinterpret_cast<const char *>(column.constData()), size) == size;
+}
+}
+
+const quint32 BinaryFeatureFile::VERSION;
+const QString BinaryFeatureFile::FILE_SUFFIX = QStringLiteral("stbin");
+
+BinaryFeatureFile::BinaryFeatureFile()
+    : m_file(nullptr)
+    , m_data(nullptr)
+    , m_geneOffsets(nullptr)
+    , m_geneNames(nullptr)
+    , m_spotsX(nullptr)
+    , m_spotsY(nullptr)
+    , m_rowPointer(nullptr)
+    , m_geneIds(nullptr)
+    , m_counts(nullptr)
+    , m_version(0)
+    , m_genes(0)
+    , m_spots(0)
+    , m_features(0)
+{
+}
+
+BinaryFeatureFile::~BinaryFeatureFile()
+{
+    close();
+}
+
+bool BinaryFeatureFile::open(const QString &filename)
+{
+    close();
+    m_file.reset(new QFile(filename));
+    if (!m_file->open(QIODevice::ReadOnly) || m_file->size() < HEADER_SIZE) {
+        close();
+        return false;
+    }
+    // check the magic before mapping the whole file
+    const QByteArray magic = m_file->peek(sizeof(MAGIC));
+    if (!isBinary(magic)) {
+        close();
+        return false;
+    }
+    const qint64 size = m_file->size();
+    const uchar *data = m_file->map(0, size);
+    if (data == nullptr) {
+        qDebug() << "[BinaryFeatureFile] Error mapping file " << filename << m_file->errorString();
+        close();
+        return false;
+    }
+    // NOTE the file is kept open while it is mapped
+    if (!load(data, size)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool BinaryFeatureFile::open(const QByteArray &rawData)
+{
+    close();
+    if (!isBinary(rawData)) {
+        return false;
+    }
+    m_rawData = rawData;
+    if (!load(reinterpret_cast<const uchar *>(m_rawData.constData()), m_rawData.size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void BinaryFeatureFile::close()
+{
+    if (!m_file.isNull() && m_data != nullptr) {
+        m_file->unmap(const_cast<uchar *>(m_data));
+    }
+    m_file.reset();
+    m_rawData.clear();
+    m_data = nullptr;
+    m_geneOffsets = nullptr;
+    m_geneNames = nullptr;
+    m_spotsX = nullptr;
+    m_spotsY = nullptr;
+    m_rowPointer = nullptr;
+    m_geneIds = nullptr;
+    m_counts = nullptr;
+    m_version = 0;
+    m_genes = 0;
+    m_spots = 0;
+    m_features = 0;
+}
+
+bool BinaryFeatureFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+bool BinaryFeatureFile::load(const uchar *data, const qint64 size)
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    // the columns are used directly from the mapped memory
+    qDebug() << "[BinaryFeatureFile] Big endian architectures are not supported";
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return false;
+#else
+    // the columns are accessed directly so they must be aligned
+    if (size < HEADER_SIZE || (reinterpret_cast<quintptr>(data) & 3) != 0) {
+        return false;
+    }
+
+    const quint32 version = headerField(data, 0);
+    if (version != VERSION) {
+        qDebug() << "[BinaryFeatureFile] Unsupported version " << version;
+        return false;
+    }
+    const quint32 genes = headerField(data, 1);
+    const quint32 spots = headerField(data, 2);
+    const quint32 features = headerField(data, 3);
+    const quint32 names_size = headerField(data, 4);
+
+    // compute the offsets of the sections
+    const qint64 offsets_pos = HEADER_SIZE;
+    const qint64 names_pos = offsets_pos + (qint64(genes) + 1) * 4;
+    const qint64 x_pos = names_pos + align4(names_size);
+    const qint64 y_pos = x_pos + qint64(spots) * 4;
+    const qint64 row_pos = y_pos + qint64(spots) * 4;
+    const qint64 ids_pos = row_pos + (qint64(spots) + 1) * 4;
+    const qint64 counts_pos = ids_pos + qint64(features) * 4;
+    const qint64 total_size = counts_pos + qint64(features) * 4;
+    if (total_size != size) {
+        qDebug() << "[BinaryFeatureFile] Corrupted file, expected size " << total_size
+                 << " got " << size;
+        return false;
+    }
+
+    const quint32 *gene_offsets = reinterpret_cast<const quint32 *>(data + offsets_pos);
+    const quint32 *row_pointer = reinterpret_cast<const quint32 *>(data + row_pos);
+    const quint32 *gene_ids = reinterpret_cast<const quint32 *>(data + ids_pos);
+
+    // validate the indexes so the accessors do not need to
+    if (gene_offsets[0] != 0 || gene_offsets[genes] != names_size) {
+        return false;
+    }
+    for (quint32 i = 0; i < genes; ++i) {
+        if (gene_offsets[i] > gene_offsets[i + 1]) {
+            return false;
+        }
+    }
+    if (row_pointer[0] != 0 || row_pointer[spots] != features) {
+        return false;
+    }
+    for (quint32 i = 0; i < spots; ++i) {
+        if (row_pointer[i] > row_pointer[i + 1]) {
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < features; ++i) {
+        if (gene_ids[i] >= genes) {
+            return false;
+        }
+    }
+
+    m_data = data;
+    m_geneOffsets = gene_offsets;
+    m_geneNames = reinterpret_cast<const char *>(data + names_pos);
+    m_spotsX = reinterpret_cast<const float *>(data + x_pos);
+    m_spotsY = reinterpret_cast<const float *>(data + y_pos);
+    m_rowPointer = row_pointer;
+    m_geneIds = gene_ids;
+    m_counts = reinterpret_cast<const quint32 *>(data + counts_pos);
+    m_version = version;
+    m_genes = genes;
+    m_spots = spots;
+    m_features = features;
+    return true;
+#endif
+}
+
+quint32 BinaryFeatureFile::version() const
+{
+    return m_version;
+}
+
+quint32 BinaryFeatureFile::genesCount() const
+{
+    return m_genes;
+}
+
+quint32 BinaryFeatureFile::spotsCount() const
+{
+    return m_spots;
+}
+
+quint32 BinaryFeatureFile::featuresCount() const
+{
+    return m_features;
+}
+
+const QString BinaryFeatureFile::geneName(const quint32 gene) const
+{
+    Q_ASSERT(gene < m_genes);
+    const quint32 begin = m_geneOffsets[gene];
+    const quint32 end = m_geneOffsets[gene + 1];
+    return QString::fromUtf8(m_geneNames + begin, end - begin);
+}
+
+float BinaryFeatureFile::spotX(const quint32 spot) const
+{
+    Q_ASSERT(spot < m_spots);
+    return m_spotsX[spot];
+}
+
+float BinaryFeatureFile::spotY(const quint32 spot) const
+{
+    Q_ASSERT(spot < m_spots);
+    return m_spotsY[spot];
+}
+
+quint32 BinaryFeatureFile::spotBegin(const quint32 spot) const
+{
+    Q_ASSERT(spot < m_spots);
+    return m_rowPointer[spot];
+}
+
+quint32 BinaryFeatureFile::spotEnd(const quint32 spot) const
+{
+    Q_ASSERT(spot < m_spots);
+    return m_rowPointer[spot + 1];
+}
+
+quint32 BinaryFeatureFile::geneId(const quint32 feature) const
+{
+    Q_ASSERT(feature < m_features);
+    return m_geneIds[feature];
+}
+
+quint32 BinaryFeatureFile::count(const quint32 feature) const
+{
+    Q_ASSERT(feature < m_features);
+    return m_counts[feature];
+}
+
+bool BinaryFeatureFile::isBinary(const QByteArray &rawData)
+{
+    return rawData.size() >= static_cast<int>(sizeof(MAGIC))
+           && qstrncmp(rawData.constData(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool BinaryFeatureFile::write(QIODevice &device,
+                              const QStringList &genes,
+                              const QVector<float> &spotsX,
+                              const QVector<float> &spotsY,
+                              const QVector<quint32> &rowPointer,
+                              const QVector<quint32> &geneIds,
+                              const QVector<quint32> &counts)
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    qDebug() << "[BinaryFeatureFile] Big endian architectures are not supported";
+    Q_UNUSED(device);
+    Q_UNUSED(genes);
+    Q_UNUSED(spotsX);
+    Q_UNUSED(spotsY);
+    Q_UNUSED(rowPointer);
+    Q_UNUSED(geneIds);
+    Q_UNUSED(counts);
+    return false;
+#else
+    if (spotsX.size() != spotsY.size() || rowPointer.size() != spotsX.size() + 1
+        || geneIds.size() != counts.size()) {
+        return false;
+    }
+
+    // build the gene dictionary
+    QVector<quint32> gene_offsets;
+    gene_offsets.reserve(genes.size() + 1);
+    QByteArray gene_names;
+    gene_offsets.push_back(0);
+    for (const QString &gene : genes) {
+        gene_names.append(gene.toUtf8());
+        gene_offsets.push_back(static_cast<quint32>(gene_names.size()));
+    }
+    const quint32 names_size = static_cast<quint32>(gene_names.size());
+    gene_names.append(QByteArray(align4(names_size) - names_size, '\0'));
+
+    // header
+    QByteArray header(HEADER_SIZE, '\0');
+    uchar *header_data = reinterpret_cast<uchar *>(header.data());
+    std::memcpy(header_data, MAGIC, sizeof(MAGIC));
+    const quint32 fields[] = {VERSION,
+                              static_cast<quint32>(genes.size()),
+                              static_cast<quint32>(spotsX.size()),
+                              static_cast<quint32>(geneIds.size()),
+                              names_size};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        qToLittleEndian<quint32>(fields[i], header_data + sizeof(MAGIC) + i * sizeof(quint32));
+    }
+
+    return device.write(header) == header.size() && writeColumn(device, gene_offsets)
+           && device.write(gene_names) == gene_names.size() && writeColumn(device, spotsX)
+           && writeColumn(device, spotsY) && writeColumn(device, rowPointer)
+           && writeColumn(device, geneIds) && writeColumn(device, counts);
+#endif
+}
+
+bool BinaryFeatureFile::write(QIODevice &device,
+                              const FeatureStore &features,
+                              const GeneDictionary &genes)
+{
+    // the store has the same layout as the file (features grouped by spot)
+    QVector<quint32> counts;
+    counts.reserve(features.size());
+    for (const int count : features.counts()) {
+        counts.push_back(static_cast<quint32>(count));
+    }
+    for (const GeneDictionary::GeneId gene : features.geneIds()) {
+        if (gene >= static_cast<GeneDictionary::GeneId>(genes.size())) {
+            qDebug() << "[BinaryFeatureFile] Feature with an invalid gene ID";
+            return false;
+        }
+    }
+
+    return write(device,
+                 genes.names().toList(),
+                 features.spotsX(),
+                 features.spotsY(),
+                 features.rowPointer(),
+                 features.geneIds(),
+                 counts);
+}
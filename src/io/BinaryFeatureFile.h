@@ -0,0 +1,116 @@
+#ifndef BINARYFEATUREFILE_H
+#define BINARYFEATUREFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QScopedPointer>
+
+#include "dataModel/GeneDictionary.h"
+#include "dataModel/FeatureStore.h"
+
+class QFile;
+class QIODevice;
+
+// Reader/writer of the versioned columnar binary format for ST data (features)
+// The file is meant to be memory mapped so no parsing is needed to access the
+// data, everything is stored little endian and every section is 4 bytes aligned.
+// Layout:
+//   Header       magic "STVF", version, number of genes, spots, features and
+//                the size in bytes of the gene names blob (32 bytes)
+//   Gene offsets (genes + 1) x uint32 offsets of each name in the blob
+//   Gene names   UTF-8 blob with all the gene names (padded to 4 bytes)
+//   Spots X      spots x float32 (chip coordinates)
+//   Spots Y      spots x float32 (chip coordinates)
+//   Row pointer  (spots + 1) x uint32 CSR offsets of the features of each spot
+//   Gene ids     features x uint32 (index in the gene dictionary)
+//   Counts       features x uint32
+// The features of the spot i are then the range [rowPointer(i), rowPointer(i + 1))
+class BinaryFeatureFile
+{
+
+public:
+    // current version of the format
+    static const quint32 VERSION = 1;
+    // suffix used for the files in this format
+    static const QString FILE_SUFFIX;
+
+    BinaryFeatureFile();
+    ~BinaryFeatureFile();
+
+    // memory maps the file given and validates its content
+    // returns false if the file is not in the binary format or it is corrupted
+    bool open(const QString &filename);
+    // uses the buffer given (no copies are made) and validates its content
+    // returns false if the buffer is not in the binary format or it is corrupted
+    bool open(const QByteArray &rawData);
+    // unmaps/releases the data
+    void close();
+    bool isOpen() const;
+
+    quint32 version() const;
+    quint32 genesCount() const;
+    quint32 spotsCount() const;
+    quint32 featuresCount() const;
+
+    // gene dictionary
+    const QString geneName(const quint32 gene) const;
+    // spot coordinates
+    float spotX(const quint32 spot) const;
+    float spotY(const quint32 spot) const;
+    // range of features of the spot [spotBegin, spotEnd)
+    quint32 spotBegin(const quint32 spot) const;
+    quint32 spotEnd(const quint32 spot) const;
+    // feature columns
+    quint32 geneId(const quint32 feature) const;
+    quint32 count(const quint32 feature) const;
+
+    // returns true if the data given starts with the format magic
+    static bool isBinary(const QByteArray &rawData);
+
+    // writes the columns given in the binary format to the device
+    // rowPointer must have spots + 1 elements and geneIds and counts must have
+    // the same size
+    // returns true if the writing was correct
+    static bool write(QIODevice &device,
+                      const QStringList &genes,
+                      const QVector<float> &spotsX,
+                      const QVector<float> &spotsY,
+                      const QVector<quint32> &rowPointer,
+                      const QVector<quint32> &geneIds,
+                      const QVector<quint32> &counts);
+    // writes the features given in the binary format to the device
+    // the gene IDs of the features must belong to the dictionary given, which is
+    // stored as it is so the IDs are preserved
+    // returns true if the writing was correct
+    static bool write(QIODevice &device,
+                      const FeatureStore &features,
+                      const GeneDictionary &genes);
+
+private:
+    // sets the pointers to the sections and validates the content
+    bool load(const uchar *data, const qint64 size);
+
+    // the mapped file (if opened from a file)
+    QScopedPointer<QFile> m_file;
+    // the buffer (if opened from memory, to keep it alive)
+    QByteArray m_rawData;
+    // pointers to the sections (point to the mapped memory)
+    const uchar *m_data;
+    const quint32 *m_geneOffsets;
+    const char *m_geneNames;
+    const float *m_spotsX;
+    const float *m_spotsY;
+    const quint32 *m_rowPointer;
+    const quint32 *m_geneIds;
+    const quint32 *m_counts;
+    quint32 m_version;
+    quint32 m_genes;
+    quint32 m_spots;
+    quint32 m_features;
+
+    Q_DISABLE_COPY(BinaryFeatureFile)
+};
+
+#endif // BINARYFEATUREFILE_H
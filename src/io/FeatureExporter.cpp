@@ -3,7 +3,7 @@
 #include <QCoreApplication>
 #include <QDateTime>
 
-#include "dataModel/Feature.h"
+#include "dataModel/FeatureStore.h"
 
 static const QString PROPERTY_LIST_DELIMITER = QStringLiteral(";;");
 
@@ -58,16 +58,21 @@ void FeatureExporter::exportStrings(QTextStream &otxt, const QStringList &string
     otxt << strings.join(delimiter) << endl;
 }
 
-void FeatureExporter::exportItem(QTextStream &otxt, const Feature &feature) const
+void FeatureExporter::exportItem(QTextStream &otxt,
+                                  const FeatureRef &feature,
+                                  const GeneDictionary &geneDictionary) const
 {
     QStringList list;
-    list << QString("%1").arg(feature.gene()) << QString("%1").arg(feature.x())
-         << QString("%1").arg(feature.y()) << QString("%1").arg(feature.count());
+    list << QString("%1").arg(geneDictionary.name(feature.geneId()))
+         << QString("%1").arg(feature.x()) << QString("%1").arg(feature.y())
+         << QString("%1").arg(feature.count());
 
     exportStrings(otxt, list);
 }
 
-void FeatureExporter::exportItem(QTextStream &otxt, const DataProxy::FeatureList &featureList) const
+void FeatureExporter::exportItem(QTextStream &otxt,
+                                  const DataProxy::FeatureList &featureList,
+                                  const GeneDictionary &geneDictionary) const
 {
     // prepend header
     if (m_detailLevel.testFlag(FeatureExporter::Comments)) {
@@ -81,11 +86,13 @@ void FeatureExporter::exportItem(QTextStream &otxt, const DataProxy::FeatureList
     }
 
     for (const auto &feature : featureList) {
-        exportItem(otxt, *feature);
+        exportItem(otxt, feature, geneDictionary);
     }
 }
 
-void FeatureExporter::exportItem(QIODevice &device, const DataProxy::FeatureList &featureList) const
+void FeatureExporter::exportItem(QIODevice &device,
+                                  const DataProxy::FeatureList &featureList,
+                                  const GeneDictionary &geneDictionary) const
 {
     // early out
     if (!device.isWritable()) {
@@ -117,5 +124,5 @@ void FeatureExporter::exportItem(QIODevice &device, const DataProxy::FeatureList
         otxt << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << endl;
     }
 
-    exportItem(otxt, featureList);
+    exportItem(otxt, featureList, geneDictionary);
 }
@@ -6,9 +6,10 @@
 #include <QTextStream>
 
 #include "data/DataProxy.h"
+#include "dataModel/GeneDictionary.h"
 
 class QIODevice;
-class Feature;
+class FeatureRef;
 
 // Simple class to export an UserSelection to a file
 class FeatureExporter
@@ -37,7 +38,10 @@ public:
     ~FeatureExporter();
 
     // the method to call to write the features to a file
-    void exportItem(QIODevice &device, const DataProxy::FeatureList &featureList) const;
+    // the gene names are resolved with the dictionary given
+    void exportItem(QIODevice &device,
+                    const DataProxy::FeatureList &featureList,
+                    const GeneDictionary &geneDictionary) const;
 
     // to add dybamic properties to the document
     void addExportProperty(const QString &property);
@@ -53,8 +57,12 @@ private:
     const QString delimiterCharacter() const;
     // internal functions to do the writing to file object by object
     void exportStrings(QTextStream &otxt, const QStringList &strings) const;
-    void exportItem(QTextStream &otxt, const Feature &feature) const;
-    void exportItem(QTextStream &otxt, const DataProxy::FeatureList &selectionList) const;
+    void exportItem(QTextStream &otxt,
+                    const FeatureRef &feature,
+                    const GeneDictionary &geneDictionary) const;
+    void exportItem(QTextStream &otxt,
+                    const DataProxy::FeatureList &selectionList,
+                    const GeneDictionary &geneDictionary) const;
 
     DetailLevels m_detailLevel;
     SeparationModes m_separationMode;
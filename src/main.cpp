@@ -7,6 +7,8 @@
 #include <QSplashScreen>
 #include <QDesktopWidget>
 #include <QFontDatabase>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include "mainWindow.h"
 #include "options_cmake.h"
@@ -16,6 +18,9 @@
 namespace
 {
 
+// the main window must be usable within this time after the start (ms)
+const qint64 TIME_TO_INTERACTIVE_BUDGET = 300;
+
 // Application flags must be set before instantiating QApplication
 void setApplicationFlags()
 {
@@ -43,6 +48,10 @@ void setApplicationFlags()
 
 int main(int argc, char **argv)
 {
+    // time to interactive window
+    QElapsedTimer startTimer;
+    startTimer.start();
+
     const QString VERSION = QString("%1.%2.%3").arg(MAJOR).arg(MINOR).arg(PATCH);
 
     // Define some configuration flags
@@ -80,8 +89,18 @@ int main(int argc, char **argv)
     mainWindow.init();
     // Show main window.
     mainWindow.show();
-    // Authorize (if the online mode is supported)
-    mainWindow.startAuthorization();
+    // the window is interactive once the event loop processes its first events
+    QTimer::singleShot(0, [&startTimer]() {
+        const qint64 elapsed = startTimer.elapsed();
+        qDebug() << "[Main] Time to interactive window" << elapsed << "ms";
+        if (elapsed > TIME_TO_INTERACTIVE_BUDGET) {
+            qDebug() << "[Main] Warning: the start took longer than"
+                     << TIME_TO_INTERACTIVE_BUDGET << "ms";
+        }
+    });
+    // Authorize (if the online mode is supported) once the window is shown
+    // (the log in dialog and the requests do not delay the first paint)
+    QTimer::singleShot(0, &mainWindow, &MainWindow::startAuthorization);
     // launch the app
     return app.exec();
 }
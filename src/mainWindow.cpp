@@ -22,6 +22,7 @@
 #include <QStatusBar>
 #include <QFont>
 #include <QDir>
+#include <QFutureWatcher>
 
 #include "error/Error.h"
 #include "error/ApplicationError.h"
@@ -78,6 +79,8 @@ MainWindow::MainWindow(QWidget *parent)
     , m_cellview(nullptr)
     , m_user_selections(nullptr)
     , m_genes(nullptr)
+    , m_authorizeOnline(false)
+    , m_useCachedUser(false)
 {
     setUnifiedTitleAndToolBarOnMac(true);
 
@@ -87,10 +90,8 @@ MainWindow::MainWindow(QWidget *parent)
     m_authManager = QSharedPointer<AuthorizationManager>(new AuthorizationManager(m_dataProxy));
     Q_ASSERT(!m_authManager.isNull());
 
-    // We init the views here
-    m_datasets.reset(new DatasetPage(m_dataProxy));
+    // We init the views here (the datasets and the selections when they are shown)
     m_cellview.reset(new CellViewPage(m_dataProxy));
-    m_user_selections.reset(new UserSelectionsPage(m_dataProxy));
     m_genes.reset(new GenesWidget(m_dataProxy));
 }
 
@@ -285,9 +286,7 @@ void MainWindow::initStyle()
 {
     // TODO move to stylesheet.css file
     setStyleSheet(GENERAL_STYLE);
-    m_datasets->setStyleSheet(GENERAL_STYLE);
     m_cellview->setStyleSheet(GENERAL_STYLE);
-    m_user_selections->setStyleSheet(GENERAL_STYLE);
 }
 
 void MainWindow::createShorcuts()
@@ -315,14 +314,11 @@ void MainWindow::createConnections()
     // signal that shows the about dialog
     connect(m_actionAbout.data(), SIGNAL(triggered()), this, SLOT(slotShowAbout()));
     // signal that shows the datasets
-    connect(m_actionDatasets.data(), SIGNAL(triggered(bool)), m_datasets.data(), SLOT(show()));
+    connect(m_actionDatasets.data(), SIGNAL(triggered(bool)), this, SLOT(slotShowDatasets()));
     // signal that shows the log in widget
     connect(m_actionLogOut.data(), SIGNAL(triggered()), this, SLOT(slotLogOutButton()));
     // signal that shows the selections
-    connect(m_actionSelections.data(),
-            SIGNAL(triggered(bool)),
-            m_user_selections.data(),
-            SLOT(show()));
+    connect(m_actionSelections.data(), SIGNAL(triggered(bool)), this, SLOT(slotShowSelections()));
 
     // connect authorization signals
     connect(m_authManager.data(), SIGNAL(signalAuthorize()), this, SLOT(slotAuthorized()));
@@ -330,6 +326,40 @@ void MainWindow::createConnections()
             SIGNAL(signalError(QSharedPointer<Error>)),
             this,
             SLOT(slotAuthorizationError(QSharedPointer<Error>)));
+    connect(m_dataProxy.data(),
+            SIGNAL(signalOfflineChanged(bool)),
+            this,
+            SLOT(slotOfflineChanged(bool)));
+
+    // the signals of the datasets and the selections are connected when
+    // they are created (see datasetPage() and userSelectionsPage())
+
+    // connect genes table signals to cellview
+    connect(m_genes.data(),
+            SIGNAL(signalSelectionChanged(DataProxy::GeneList)),
+            m_cellview.data(),
+            SLOT(slotGenesSelected(DataProxy::GeneList)));
+    connect(m_genes.data(),
+            SIGNAL(signalColorChanged(DataProxy::GeneList)),
+            m_cellview.data(),
+            SLOT(slotGenesColor(DataProxy::GeneList)));
+    connect(m_genes.data(),
+            SIGNAL(signalCutOffChanged(DataProxy::GenePtr)),
+            m_cellview.data(),
+            SLOT(slotGeneCutOff(DataProxy::GenePtr)));
+
+    // connect log out signal from cell view
+    connect(m_cellview.data(), SIGNAL(signalLogOut()), this, SLOT(slotLogOutButton()));
+}
+
+DatasetPage *MainWindow::datasetPage()
+{
+    if (!m_datasets.isNull()) {
+        return m_datasets.data();
+    }
+
+    m_datasets.reset(new DatasetPage(m_dataProxy));
+    m_datasets->setStyleSheet(GENERAL_STYLE);
 
     // connect the open dataset from datasetview -> cellview
     connect(m_datasets.data(),
@@ -367,19 +397,17 @@ void MainWindow::createConnections()
             m_genes.data(),
             SLOT(slotDatasetRemoved(QString)));
 
-    // connect genes table signals to cellview
-    connect(m_genes.data(),
-            SIGNAL(signalSelectionChanged(DataProxy::GeneList)),
-            m_cellview.data(),
-            SLOT(slotGenesSelected(DataProxy::GeneList)));
-    connect(m_genes.data(),
-            SIGNAL(signalColorChanged(DataProxy::GeneList)),
-            m_cellview.data(),
-            SLOT(slotGenesColor(DataProxy::GeneList)));
-    connect(m_genes.data(),
-            SIGNAL(signalCutOffChanged(DataProxy::GenePtr)),
-            m_cellview.data(),
-            SLOT(slotGeneCutOff(DataProxy::GenePtr)));
+    return m_datasets.data();
+}
+
+UserSelectionsPage *MainWindow::userSelectionsPage()
+{
+    if (!m_user_selections.isNull()) {
+        return m_user_selections.data();
+    }
+
+    m_user_selections.reset(new UserSelectionsPage(m_dataProxy));
+    m_user_selections->setStyleSheet(GENERAL_STYLE);
 
     // connect gene selection signals from selections view
     connect(m_user_selections.data(),
@@ -391,8 +419,17 @@ void MainWindow::createConnections()
             m_user_selections.data(),
             SLOT(slotSelectionsUpdated()));
 
-    // connect log out signal from cell view
-    connect(m_cellview.data(), SIGNAL(signalLogOut()), this, SLOT(slotLogOutButton()));
+    return m_user_selections.data();
+}
+
+void MainWindow::slotShowDatasets()
+{
+    datasetPage()->show();
+}
+
+void MainWindow::slotShowSelections()
+{
+    userSelectionsPage()->show();
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -429,7 +466,16 @@ void MainWindow::startAuthorization()
 
     // clean the cache in the dataproxy
     m_dataProxy->clean();
+    // the pinned content is used right away (no request is made) and the
+    // authorization starts once the server is reachable (see slotOfflineChanged)
+    m_authorizeOnline = false;
+    if (m_dataProxy->loadPinnedContent()) {
+        m_authorizeOnline = true;
+        m_cellview->slotSetUserName(m_dataProxy->getUser()->username());
+        return;
+    }
     // start the authorization (quiet if access token exists or interactive otherwise)
+    m_useCachedUser = true;
     m_authManager->startAuthorization();
 }
 
@@ -439,7 +485,8 @@ void MainWindow::slotAuthorizationError(QSharedPointer<Error> error)
         return;
     }
 
-    // force clean access token and authorize again
+    // force clean access token and authorize again (another user may log in)
+    m_useCachedUser = false;
     m_authManager->cleanAccesToken();
     m_authManager->startAuthorization();
     qDebug() << "Error trying to log in " << error->name() << " " << error->description();
@@ -451,42 +498,76 @@ void MainWindow::slotAuthorized()
         return;
     }
 
-    // clean datasets/selections and main view
-    m_datasets->clean();
+    // clean datasets/selections (if they were created) and main view
+    if (!m_datasets.isNull()) {
+        m_datasets->clean();
+    }
     m_cellview->clean();
-    m_user_selections->clean();
+    if (!m_user_selections.isNull()) {
+        m_user_selections->clean();
+    }
     m_genes->clear();
 
-    // check for min version if supported and load user (only in online mode)
-    if (m_dataProxy->loadMinVersion()) {
-        const auto minVersion = m_dataProxy->getMinVersion();
-        if (!versionIsGreaterOrEqual(VersionNumbers, minVersion)) {
-            QMessageBox::critical(this->centralWidget(),
-                                  tr("Minimum Version"),
-                                  tr("This version of the software is not supported anymore,"
-                                     "please update!"));
-            QApplication::exit(EXIT_FAILURE);
-        }
-    } else {
-        // TODO exit here?
-        qDebug() << "Min version could not be downloaded..";
+    // the profile of the last user is shown right away, the user is validated
+    // in the background (the window is usable meanwhile)
+    if (m_useCachedUser && m_dataProxy->loadCachedUser()) {
+        m_cellview->slotSetUserName(m_dataProxy->getUser()->username());
     }
+    m_useCachedUser = false;
 
-    if (m_dataProxy->loadUser()) {
-        const auto user = m_dataProxy->getUser();
-        Q_ASSERT(user);
-        if (!user->enabled()) {
-            QMessageBox::critical(this,
-                                  tr("Authorization Error"),
-                                  tr("The current user is disabled"));
+    // check for min version if supported and load user (only in online mode)
+    // both requests are made concurrently
+    typedef QFutureWatcher<DataProxy::RequestResult> RequestWatcher;
+    auto version_watcher = new RequestWatcher(this);
+    connect(version_watcher, &RequestWatcher::finished, this, [=]() {
+        if (version_watcher->result().ok()) {
+            const auto minVersion = m_dataProxy->getMinVersion();
+            if (!versionIsGreaterOrEqual(VersionNumbers, minVersion)) {
+                QMessageBox::critical(this->centralWidget(),
+                                      tr("Minimum Version"),
+                                      tr("This version of the software is not supported anymore,"
+                                         "please update!"));
+                QApplication::exit(EXIT_FAILURE);
+            }
         } else {
-            // show user info in label
-            m_cellview->slotSetUserName(user->username());
+            // TODO exit here?
+            qDebug() << "Min version could not be downloaded..";
         }
-    } else {
-        // TODO exit here?
-        qDebug() << "User information could not be downloaded..";
-    }
+        version_watcher->deleteLater();
+    });
+
+    auto user_watcher = new RequestWatcher(this);
+    connect(user_watcher, &RequestWatcher::finished, this, [=]() {
+        const auto result = user_watcher->result();
+        if (result.ok()) {
+            const auto user = m_dataProxy->getUser();
+            Q_ASSERT(user);
+            if (!user->enabled()) {
+                m_cellview->slotSetUserName("");
+                QMessageBox::critical(this,
+                                      tr("Authorization Error"),
+                                      tr("The current user is disabled"));
+            } else {
+                // show user info in label
+                m_cellview->slotSetUserName(user->username());
+                // refresh the pinned content in the background
+                m_dataProxy->syncPinnedContent();
+            }
+        } else if (m_dataProxy->isOffline() && m_dataProxy->loadPinnedContent()) {
+            // the server has become unreachable, the pinned content is used meanwhile
+            m_authorizeOnline = true;
+            m_cellview->slotSetUserName(m_dataProxy->getUser()->username());
+        } else {
+            // TODO exit here?
+            qDebug() << "User information could not be downloaded..";
+            m_cellview->slotSetUserName("");
+            QMessageBox::critical(this, result.error->name(), result.error->description());
+        }
+        user_watcher->deleteLater();
+    });
+
+    version_watcher->setFuture(m_dataProxy->loadMinVersionAsync());
+    user_watcher->setFuture(m_dataProxy->loadUserAsync());
 }
 
 void MainWindow::slotLogOutButton()
@@ -497,9 +578,26 @@ void MainWindow::slotLogOutButton()
 
     // clear user name in label
     m_cellview->slotSetUserName("");
+    m_authorizeOnline = false;
+    m_useCachedUser = false;
     // clean the cache in the dataproxy
     m_dataProxy->clean();
     // clean access token and start authorization
     m_authManager->cleanAccesToken();
     m_authManager->startAuthorization();
 }
+
+void MainWindow::slotOfflineChanged(bool offline)
+{
+    if (offline) {
+        statusBar()->showMessage(tr("Working offline with the pinned datasets and selections"));
+        return;
+    }
+
+    statusBar()->showMessage(tr("Spatial Transcriptomics Research Viewer"));
+    // the user of the pinned content can be authorized now
+    if (m_authorizeOnline) {
+        m_authorizeOnline = false;
+        m_authManager->startAuthorization();
+    }
+}
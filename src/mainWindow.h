@@ -40,6 +40,7 @@ public:
     void saveSettings() const;
 
     // Tries to find a cached access token otherwise it will show a log in dialog
+    // (the profile of the last user is shown while the user is validated)
     void startAuthorization();
 
 private slots:
@@ -47,6 +48,10 @@ private slots:
     // exit the application
     void slotExit();
 
+    // show the datasets and the selections windows (created the first time)
+    void slotShowDatasets();
+    void slotShowSelections();
+
     // clear the cache and local stored files
     void slotClearCache();
 
@@ -58,6 +63,8 @@ private slots:
     void slotAuthorized();
     // when user clicks to log out, shows log in dialog
     void slotLogOutButton();
+    // the pinned content is being used (offline) or the server is reachable again
+    void slotOfflineChanged(bool offline);
 
 private:
     // create all the widgets
@@ -71,6 +78,11 @@ private:
     // create some connections
     void createConnections();
 
+    // the datasets and selections windows are only created when they are used
+    // (they are not needed to show the main window)
+    DatasetPage *datasetPage();
+    UserSelectionsPage *userSelectionsPage();
+
     // overloaded close Event function to handle the exit
     void closeEvent(QCloseEvent *event) override;
 
@@ -88,7 +100,7 @@ private:
     QSharedPointer<DataProxy> m_dataProxy;
     QSharedPointer<AuthorizationManager> m_authManager;
 
-    // different views
+    // different views (the datasets and the selections are created lazily)
     QScopedPointer<DatasetPage> m_datasets;
     QScopedPointer<CellViewPage> m_cellview;
     QScopedPointer<UserSelectionsPage> m_user_selections;
@@ -96,6 +108,11 @@ private:
 
     // the configuration settings
     Configuration m_config;
+    // the user of the pinned content has to be authorized once the server is reachable
+    bool m_authorizeOnline;
+    // the profile of the last user is shown until the user is validated (only
+    // when the session is resumed at start)
+    bool m_useCachedUser;
 };
 
 #endif // stVi_H
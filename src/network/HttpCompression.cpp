@@ -0,0 +1,69 @@
+#include "HttpCompression.h"
+
+#include <array>
+
+namespace
+{
+
+typedef std::array<quint32, 256> CrcTable;
+
+CrcTable createCrcTable()
+{
+    CrcTable table;
+    for (quint32 i = 0; i < table.size(); ++i) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+void appendLittleEndian(QByteArray &data, const quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        data.append(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+// magic, deflate, no flags, no time, no extra flags, unknown OS
+const char GZIP_HEADER[] = "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff";
+const int GZIP_HEADER_SIZE = 10;
+// qCompress() gives the size of the data (4 bytes) and a zlib stream: header
+// (2 bytes), deflate data and Adler-32 checksum (4 bytes)
+const int QCOMPRESS_HEADER_SIZE = 6;
+const int QCOMPRESS_TRAILER_SIZE = 4;
+}
+
+namespace Network
+{
+
+QByteArray gzip(const QByteArray &data, const int level)
+{
+    const QByteArray compressed = qCompress(data, level);
+    if (compressed.size() < QCOMPRESS_HEADER_SIZE + QCOMPRESS_TRAILER_SIZE) {
+        return QByteArray();
+    }
+
+    QByteArray gzip_data;
+    gzip_data.reserve(compressed.size() + GZIP_HEADER_SIZE);
+    gzip_data.append(GZIP_HEADER, GZIP_HEADER_SIZE);
+    gzip_data.append(compressed.constData() + QCOMPRESS_HEADER_SIZE,
+                     compressed.size() - QCOMPRESS_HEADER_SIZE - QCOMPRESS_TRAILER_SIZE);
+    appendLittleEndian(gzip_data, crc32(data));
+    appendLittleEndian(gzip_data, static_cast<quint32>(data.size()));
+    return gzip_data;
+}
+
+quint32 crc32(const QByteArray &data)
+{
+    static const CrcTable table = createCrcTable();
+    quint32 crc = 0xffffffff;
+    for (const char byte : data) {
+        crc = table[(crc ^ static_cast<quint8>(byte)) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffff;
+}
+
+} // namespace Network //
@@ -0,0 +1,21 @@
+#ifndef HTTPCOMPRESSION_H
+#define HTTPCOMPRESSION_H
+
+#include <QByteArray>
+
+// Compression of the bodies of the requests (Content-Encoding), the responses
+// are decompressed by Qt. zlib is not exposed by Qt so the gzip format is
+// built from the deflate data of qCompress().
+namespace Network
+{
+
+// returns the data compressed in the gzip format (RFC 1952) with the level
+// given (0-9, -1 for the default of zlib)
+QByteArray gzip(const QByteArray &data, const int level = -1);
+
+// CRC-32 (as used by gzip) of the data
+quint32 crc32(const QByteArray &data);
+
+} // namespace Network //
+
+#endif // HTTPCOMPRESSION_H //
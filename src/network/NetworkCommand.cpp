@@ -12,6 +12,7 @@ NetworkCommand::NetworkCommand(QObject *parent)
     , m_type(HttpRequestTypeNone)
     , m_query()
     , m_body()
+    , m_headers()
 {
 }
 
@@ -21,6 +22,7 @@ NetworkCommand::NetworkCommand(const QUrl &url, HttpRequestType type, QObject *p
     , m_type(type)
     , m_query()
     , m_body()
+    , m_headers()
 {
 }
 
@@ -91,6 +93,16 @@ const QByteArray NetworkCommand::body() const
     return m_body;
 }
 
+void NetworkCommand::setHeader(const QByteArray &name, const QByteArray &value)
+{
+    m_headers.insert(name, value);
+}
+
+const QMap<QByteArray, QByteArray> &NetworkCommand::headers() const
+{
+    return m_headers;
+}
+
 void NetworkCommand::addQueryItem(const QString &param, const QString &value)
 {
     m_query.addQueryItem(param, value);
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QMap>
 
 #include "SettingsNetwork.h"
 
@@ -52,12 +53,18 @@ public:
     void setBody(const QByteArray &body);
     const QByteArray body() const;
 
+    // raw headers to add to the request (for instance validators
+    // like If-None-Match)
+    void setHeader(const QByteArray &name, const QByteArray &value);
+    const QMap<QByteArray, QByteArray> &headers() const;
+
 private:
     typedef HttpRequestType Type;
     QUrl m_url;
     Type m_type;
     QUrlQuery m_query;
     QByteArray m_body;
+    QMap<QByteArray, QByteArray> m_headers;
 
     Q_DISABLE_COPY(NetworkCommand)
 };
@@ -1,64 +1,697 @@
 #include "NetworkDiskCache.h"
 
 #include <QDebug>
-#include <QNetworkCacheMetaData>
-#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QDataStream>
+#include <QStorageInfo>
+#include <QCryptographicHash>
+#include <QTemporaryFile>
+#include <QtEndian>
+#include <QtConcurrent>
+
+#include "SettingsNetwork.h"
+#include "utils/FileFunctions.h"
+
+namespace
+{
+
+const QString INDEX_FILE = QStringLiteral("index");
+const QString BLOBS_DIRECTORY = QStringLiteral("blobs");
+const QString TEMPORARY_DIRECTORY = QStringLiteral("tmp");
+const quint32 INDEX_MAGIC = 0x5354434e; // "STCN"
+// the index is written after this time (in ms) without changes
+const int SAVE_DELAY = 2000;
+// the contents larger than this (in bytes) or of unknown size are written
+// to a temporary file as they are downloaded instead of being kept in memory
+const qint64 MEMORY_CONTENT_SIZE = 1024 * 1024;
+// the compressed blobs are a sequence of chunks of this size (in bytes) compressed
+// independently (the size of the compressed chunk in 32 bits big endian followed
+// by the qCompress() data) so they are never held in memory as a whole
+const qint64 CHUNK_SIZE = 1024 * 1024;
+const int CHUNK_HEADER_SIZE = 4;
+
+QString contentType(const QNetworkCacheMetaData &metaData)
+{
+    for (const QNetworkCacheMetaData::RawHeader &header : metaData.rawHeaders()) {
+        if (header.first.toLower() == "content-type") {
+            return QString::fromLatin1(header.second);
+        }
+    }
+    return QString();
+}
+
+// the content of the database that can be cached
+bool isCacheable(const QString &mime)
+{
+    return mime.startsWith("application/xml") || mime.startsWith(Network::ContentTypeJSON)
+           || mime.startsWith(Network::ContentTypeJPEG) || mime.startsWith("application/x-gzip")
+           || mime.startsWith(Network::ContentTypeBinary);
+}
+
+// the text content is compressed (images and binary data are already compressed)
+bool isCompressible(const QString &mime)
+{
+    return mime.startsWith("application/xml") || mime.startsWith(Network::ContentTypeJSON);
+}
+
+// the size of the content or -1 if the server does not give it
+qint64 contentLength(const QNetworkCacheMetaData &metaData)
+{
+    for (const QNetworkCacheMetaData::RawHeader &header : metaData.rawHeaders()) {
+        if (header.first.toLower() == "content-length") {
+            bool ok = false;
+            const qint64 length = header.second.trimmed().toLongLong(&ok);
+            return ok ? length : -1;
+        }
+    }
+    return -1;
+}
+
+QString urlKey(const QUrl &url)
+{
+    return url.toString(QUrl::FullyEncoded);
+}
+
+QString blobPath(const QString &directory, const QByteArray &hash)
+{
+    const QString name = QString::fromLatin1(hash);
+    return directory + QDir::separator() + BLOBS_DIRECTORY + QDir::separator() + name.left(2)
+           + QDir::separator() + name;
+}
+
+// writes the content of the device given compressed in chunks to the file given,
+// returns false (nothing is written) if it fails or the content does not get smaller
+bool writeCompressed(QIODevice &input, const QString &filename, qint64 &size)
+{
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    size = 0;
+    while (!input.atEnd()) {
+        const QByteArray chunk = qCompress(input.read(CHUNK_SIZE));
+        uchar header[CHUNK_HEADER_SIZE];
+        qToBigEndian<quint32>(static_cast<quint32>(chunk.size()), header);
+        const char *header_data = reinterpret_cast<const char *>(header);
+        if (file.write(header_data, CHUNK_HEADER_SIZE) != CHUNK_HEADER_SIZE
+            || file.write(chunk) != chunk.size()) {
+            return false;
+        }
+        size += CHUNK_HEADER_SIZE + chunk.size();
+        if (size >= input.size()) {
+            return false;
+        }
+    }
+    return size < input.size() && file.commit();
+}
+
+// reads a compressed blob uncompressing its chunks as they are read
+class CompressedBlobDevice : public QIODevice
+{
+
+public:
+    CompressedBlobDevice(const QString &filename, const qint64 size)
+        : QIODevice()
+        , m_file(filename)
+        , m_size(size)
+        , m_read(0)
+        , m_chunk()
+        , m_chunkOffset(0)
+    {
+    }
+
+    bool open(OpenMode mode) override
+    {
+        return mode == QIODevice::ReadOnly && m_file.open(QIODevice::ReadOnly)
+               && QIODevice::open(QIODevice::ReadOnly);
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 size() const override { return m_size; }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_size - m_read + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        qint64 read = 0;
+        while (read < maxSize && m_read < m_size) {
+            if (m_chunkOffset == m_chunk.size() && !readChunk()) {
+                setErrorString(QStringLiteral("Corrupted blob ") + m_file.fileName());
+                return read > 0 ? read : -1;
+            }
+            const qint64 chunk_left = m_chunk.size() - m_chunkOffset;
+            const qint64 count = qMin(maxSize - read, chunk_left);
+            memcpy(data + read, m_chunk.constData() + m_chunkOffset, static_cast<size_t>(count));
+            read += count;
+            m_chunkOffset += static_cast<int>(count);
+            m_read += count;
+        }
+        return read;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    bool readChunk()
+    {
+        uchar header[CHUNK_HEADER_SIZE];
+        if (m_file.read(reinterpret_cast<char *>(header), CHUNK_HEADER_SIZE) != CHUNK_HEADER_SIZE) {
+            return false;
+        }
+        m_chunk = qUncompress(m_file.read(qFromBigEndian<quint32>(header)));
+        m_chunkOffset = 0;
+        return !m_chunk.isEmpty();
+    }
+
+    QFile m_file;
+    // size of the content
+    qint64 m_size;
+    // content read
+    qint64 m_read;
+    // chunk being read
+    QByteArray m_chunk;
+    int m_chunkOffset;
+};
+
+// discards a device returned by prepare()
+void discard(QIODevice *device)
+{
+    QFile *file = qobject_cast<QFile *>(device);
+    if (file != nullptr) {
+        file->remove();
+    }
+    delete device;
+}
+}
+
+const int NetworkDiskCache::VERSION;
+const qint64 NetworkDiskCache::DEFAULT_MAX_SIZE = Q_INT64_C(5) * 1024 * 1024 * 1024;
+const qint64 NetworkDiskCache::MIN_FREE_SPACE = Q_INT64_C(1024) * 1024 * 1024;
+
+NetworkDiskCache::Entry::Entry()
+    : metaData()
+    , hash()
+    , size(0)
+    , access(0)
+{
+}
+
+NetworkDiskCache::Blob::Blob()
+    : size(0)
+    , compressed(false)
+    , references(0)
+{
+}
+
+NetworkDiskCache::StoredContent::StoredContent()
+    : hash()
+    , contentSize(0)
+    , size(0)
+    , compressed(false)
+    , existing(false)
+    , ok(false)
+{
+}
 
 NetworkDiskCache::NetworkDiskCache(QObject *parent)
-    : QNetworkDiskCache(parent)
+    : QAbstractNetworkCache(parent)
+    , m_directory()
+    , m_maxSize(DEFAULT_MAX_SIZE)
+    , m_size(0)
+    , m_contentSize(0)
+    , m_entries()
+    , m_blobs()
+    , m_lru()
+    , m_clock(0)
+    , m_inserting()
+    , m_storing()
+    , m_indexChanged(false)
+    , m_saveTimer()
 {
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SAVE_DELAY);
+    connect(&m_saveTimer, &QTimer::timeout, this, [this]() { saveIndex(); });
 }
 
 NetworkDiskCache::~NetworkDiskCache()
 {
+    finishStores();
+    saveIndex();
+    for (QIODevice *device : m_inserting.keys()) {
+        discard(device);
+    }
+}
+
+void NetworkDiskCache::setCacheDirectory(const QString &directory)
+{
+    finishStores();
+    saveIndex();
+    m_directory = directory;
+    m_entries.clear();
+    m_blobs.clear();
+    m_lru.clear();
+    m_size = 0;
+    m_contentSize = 0;
+    m_clock = 0;
+    if (!loadIndex()) {
+        qDebug() << "[NetworkDiskCache] No valid index in " << m_directory
+                 << ", the cache is emptied";
+        clear();
+    }
+    // the contents of the downloads interrupted by a previous run
+    QDir(QDir(m_directory).filePath(TEMPORARY_DIRECTORY)).removeRecursively();
+    trim();
+}
+
+const QString &NetworkDiskCache::cacheDirectory() const
+{
+    return m_directory;
+}
+
+void NetworkDiskCache::setMaximumCacheSize(const qint64 size)
+{
+    m_maxSize = size;
+    trim();
+}
+
+qint64 NetworkDiskCache::maximumCacheSize() const
+{
+    return m_maxSize;
+}
+
+qint64 NetworkDiskCache::budget() const
+{
+    const QStorageInfo storage(m_directory);
+    if (!storage.isValid() || !storage.isReady()) {
+        return m_maxSize;
+    }
+    const qint64 available = qMax(Q_INT64_C(0), storage.bytesAvailable() - MIN_FREE_SPACE);
+    return qMin(m_maxSize, m_size + available);
+}
+
+int NetworkDiskCache::count() const
+{
+    return m_entries.size();
+}
+
+qint64 NetworkDiskCache::contentSize() const
+{
+    return m_contentSize;
 }
 
 qint64 NetworkDiskCache::cacheSize() const
 {
-    return QNetworkDiskCache::cacheSize();
+    return m_size;
+}
+
+void NetworkDiskCache::finishStores()
+{
+    for (QFutureWatcher<StoredContent> *watcher : m_storing.keys()) {
+        watcher->waitForFinished();
+        storeFinished(watcher);
+    }
 }
 
 QIODevice *NetworkDiskCache::data(const QUrl &url)
 {
-    return QNetworkDiskCache::data(url);
+    const QString key = urlKey(url);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+
+    // the content is read from the file of the blob as the reply is read
+    const Blob blob = m_blobs.value(it->hash);
+    const QString path = blobPath(m_directory, it->hash);
+    QIODevice *device = nullptr;
+    if (blob.compressed) {
+        device = new CompressedBlobDevice(path, it->size);
+    } else {
+        device = new QFile(path);
+    }
+    if (QFileInfo(path).size() != blob.size || !device->open(QIODevice::ReadOnly)) {
+        qDebug() << "[NetworkDiskCache] The content of " << url << " is missing or corrupted";
+        delete device;
+        removeEntry(key);
+        return nullptr;
+    }
+    touch(key, *it);
+    return device;
 }
 
 void NetworkDiskCache::insert(QIODevice *device)
 {
-    return QNetworkDiskCache::insert(device);
+    const auto it = m_inserting.find(device);
+    if (it == m_inserting.end()) {
+        qDebug() << "[NetworkDiskCache] Trying to insert an unknown device";
+        return;
+    }
+    const QNetworkCacheMetaData metaData = it.value();
+    m_inserting.erase(it);
+
+    // the content is hashed, compressed and written in a worker thread,
+    // the URL is cached once it is done (see storeFinished())
+    QString source;
+    QByteArray content;
+    QFile *file = qobject_cast<QFile *>(device);
+    if (file != nullptr) {
+        file->close();
+        source = file->fileName();
+    } else {
+        content = qobject_cast<QBuffer *>(device)->data();
+    }
+    delete device;
+
+    const QString directory = m_directory;
+    const bool compressible = isCompressible(contentType(metaData));
+    auto watcher = new QFutureWatcher<StoredContent>(this);
+    m_storing.insert(watcher, metaData);
+    connect(watcher, &QFutureWatcher<StoredContent>::finished, this,
+            [this, watcher]() { storeFinished(watcher); });
+    watcher->setFuture(QtConcurrent::run([directory, source, content, compressible]() {
+        return storeContent(directory, source, content, compressible);
+    }));
 }
 
 QNetworkCacheMetaData NetworkDiskCache::metaData(const QUrl &url)
 {
-    return QNetworkDiskCache::metaData(url);
+    return m_entries.value(urlKey(url)).metaData;
 }
 
 QIODevice *NetworkDiskCache::prepare(const QNetworkCacheMetaData &metaData)
 {
-    QString mime;
-    for (QNetworkCacheMetaData::RawHeader header : metaData.rawHeaders()) {
-        if (header.first == "Content-Type") {
-            mime = header.second;
-            break;
-        }
+    // only cache jpeg/xml, json and binary (features) content
+    if (m_directory.isEmpty() || !metaData.isValid() || !metaData.saveToDisk()
+        || !isCacheable(contentType(metaData))) {
+        return nullptr;
     }
 
-    // only cache jpeg/xml and json content
-    // TODO this will have to be updated when we add binnary format
-    if (mime.startsWith("application/xml") || mime.startsWith("application/json")
-        || mime.startsWith("image/jpeg") || mime.startsWith("application/x-gzip")) {
-        return QNetworkDiskCache::prepare(metaData);
+    // the small contents are kept in memory and the others written
+    // to a temporary file (in the directory of the cache to be moved to their blob)
+    QIODevice *device = nullptr;
+    const qint64 length = contentLength(metaData);
+    if (length >= 0 && length < MEMORY_CONTENT_SIZE) {
+        device = new QBuffer();
+        device->open(QIODevice::ReadWrite);
+    } else {
+        const QDir dir(m_directory);
+        QTemporaryFile *file
+            = new QTemporaryFile(dir.filePath(TEMPORARY_DIRECTORY) + QDir::separator() + "XXXXXX");
+        file->setAutoRemove(false);
+        if (!dir.mkpath(TEMPORARY_DIRECTORY) || !file->open()) {
+            qDebug() << "[NetworkDiskCache] Error creating a temporary file in " << m_directory;
+            delete file;
+            return nullptr;
+        }
+        device = file;
     }
-
-    return nullptr;
+    m_inserting.insert(device, metaData);
+    return device;
 }
 
 bool NetworkDiskCache::remove(const QUrl &url)
 {
-    return QNetworkDiskCache::remove(url);
+    // the content being downloaded for the URL is discarded too
+    for (auto it = m_inserting.begin(); it != m_inserting.end();) {
+        if (it.value().url() == url) {
+            discard(it.key());
+            it = m_inserting.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // and the content being stored is not cached once stored
+    for (auto it = m_storing.begin(); it != m_storing.end(); ++it) {
+        if (it.value().url() == url) {
+            it.value() = QNetworkCacheMetaData();
+        }
+    }
+
+    const QString key = urlKey(url);
+    if (!m_entries.contains(key)) {
+        return false;
+    }
+    removeEntry(key);
+    return true;
 }
 
 void NetworkDiskCache::updateMetaData(const QNetworkCacheMetaData &metaData)
 {
-    return QNetworkDiskCache::updateMetaData(metaData);
+    const QString key = urlKey(metaData.url());
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    if (!metaData.isValid() || !metaData.saveToDisk()) {
+        removeEntry(key);
+        return;
+    }
+    it->metaData = metaData;
+    indexChanged();
+}
+
+void NetworkDiskCache::clear()
+{
+    for (auto it = m_storing.begin(); it != m_storing.end(); ++it) {
+        it.value() = QNetworkCacheMetaData();
+    }
+    m_entries.clear();
+    m_blobs.clear();
+    m_lru.clear();
+    m_size = 0;
+    m_contentSize = 0;
+    m_clock = 0;
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    QDir dir(m_directory);
+    dir.removeRecursively();
+    if (!dir.mkpath(BLOBS_DIRECTORY)) {
+        qDebug() << "[NetworkDiskCache] Error creating the directory " << dir.path();
+    }
+    m_indexChanged = true;
+    saveIndex();
+}
+
+bool NetworkDiskCache::saveIndex()
+{
+    m_saveTimer.stop();
+    if (!m_indexChanged || m_directory.isEmpty()) {
+        return true;
+    }
+
+    QByteArray index;
+    QDataStream stream(&index, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << INDEX_MAGIC << static_cast<qint32>(VERSION) << m_clock;
+    stream << static_cast<qint32>(m_blobs.size());
+    for (auto it = m_blobs.constBegin(); it != m_blobs.constEnd(); ++it) {
+        stream << it.key() << it->size << it->compressed;
+    }
+    stream << static_cast<qint32>(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        stream << it.key() << it->metaData << it->hash << it->size << it->access;
+    }
+
+    if (!writeFile(QDir(m_directory).filePath(INDEX_FILE), index)) {
+        qDebug() << "[NetworkDiskCache] Error writing the index of " << m_directory;
+        return false;
+    }
+    m_indexChanged = false;
+    return true;
+}
+
+bool NetworkDiskCache::loadIndex()
+{
+    QFile file(QDir(m_directory).filePath(INDEX_FILE));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version >> m_clock;
+    if (magic != INDEX_MAGIC || version != VERSION) {
+        return false;
+    }
+
+    qint32 blobs = 0;
+    stream >> blobs;
+    for (qint32 i = 0; i < blobs && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray hash;
+        Blob blob;
+        stream >> hash >> blob.size >> blob.compressed;
+        m_blobs.insert(hash, blob);
+    }
+    qint32 entries = 0;
+    stream >> entries;
+    for (qint32 i = 0; i < entries && stream.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Entry entry;
+        stream >> key >> entry.metaData >> entry.hash >> entry.size >> entry.access;
+        const auto blob = m_blobs.find(entry.hash);
+        if (blob == m_blobs.end()) {
+            return false;
+        }
+        ++blob->references;
+        m_contentSize += entry.size;
+        m_lru.insert(entry.access, key);
+        m_entries.insert(key, entry);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    // blobs not referred anymore (the index is always written after the blobs)
+    for (auto it = m_blobs.begin(); it != m_blobs.end();) {
+        if (it->references == 0) {
+            QFile::remove(blobPath(m_directory, it.key()));
+            it = m_blobs.erase(it);
+            m_indexChanged = true;
+        } else {
+            m_size += it->size;
+            ++it;
+        }
+    }
+    return true;
+}
+
+NetworkDiskCache::StoredContent NetworkDiskCache::storeContent(const QString &directory,
+                                                               const QString &source,
+                                                               const QByteArray &content,
+                                                               const bool compressible)
+{
+    StoredContent stored;
+    QFile file(source);
+    QBuffer buffer;
+    buffer.setData(content);
+    QIODevice &input = source.isEmpty() ? static_cast<QIODevice &>(buffer) : file;
+    if (input.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        stored.ok = hash.addData(&input);
+        stored.hash = hash.result().toHex();
+        stored.contentSize = input.size();
+    }
+
+    // the blobs are named by their content so an existing one is not written again
+    const QString path = blobPath(directory, stored.hash);
+    if (stored.ok && QFileInfo::exists(path)) {
+        stored.existing = true;
+    } else if (stored.ok) {
+        stored.ok = QDir().mkpath(QFileInfo(path).path()) && input.seek(0);
+        if (stored.ok && compressible) {
+            stored.compressed = writeCompressed(input, path, stored.size);
+        }
+        if (stored.ok && !stored.compressed) {
+            input.close();
+            stored.size = stored.contentSize;
+            stored.ok = source.isEmpty() ? writeFile(path, content) : QFile::rename(source, path);
+        }
+    }
+    if (!source.isEmpty()) {
+        QFile::remove(source);
+    }
+    return stored;
+}
+
+void NetworkDiskCache::storeFinished(QFutureWatcher<StoredContent> *watcher)
+{
+    const auto it = m_storing.find(watcher);
+    if (it == m_storing.end()) {
+        return;
+    }
+    const QNetworkCacheMetaData metaData = it.value();
+    const StoredContent stored = watcher->result();
+    m_storing.erase(it);
+    watcher->deleteLater();
+
+    auto blob = m_blobs.find(stored.hash);
+    if (!metaData.isValid()) {
+        // the URL was removed while its content was stored
+        if (stored.ok && !stored.existing && blob == m_blobs.end()) {
+            QFile::remove(blobPath(m_directory, stored.hash));
+        }
+        return;
+    }
+    // the blob found existing can have been evicted since (its format is then unknown)
+    if (!stored.ok || (stored.existing && blob == m_blobs.end())) {
+        qDebug() << "[NetworkDiskCache] Error writing the content of " << metaData.url();
+        return;
+    }
+
+    if (blob == m_blobs.end()) {
+        Blob new_blob;
+        new_blob.size = stored.size;
+        new_blob.compressed = stored.compressed;
+        m_size += new_blob.size;
+        blob = m_blobs.insert(stored.hash, new_blob);
+    }
+    // referred before replacing the URL in case the URL already had this content
+    ++blob->references;
+    const QString key = urlKey(metaData.url());
+    if (m_entries.contains(key)) {
+        removeEntry(key);
+    }
+
+    Entry entry;
+    entry.metaData = metaData;
+    entry.hash = stored.hash;
+    entry.size = stored.contentSize;
+    entry.access = ++m_clock;
+    m_lru.insert(entry.access, key);
+    m_entries.insert(key, entry);
+    m_contentSize += entry.size;
+    trim();
+    indexChanged();
+}
+
+void NetworkDiskCache::removeEntry(const QString &key)
+{
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_lru.remove(it->access);
+    m_contentSize -= it->size;
+    const auto blob = m_blobs.find(it->hash);
+    if (blob != m_blobs.end() && --blob->references <= 0) {
+        QFile::remove(blobPath(m_directory, blob.key()));
+        m_size -= blob->size;
+        m_blobs.erase(blob);
+    }
+    m_entries.erase(it);
+    indexChanged();
+}
+
+void NetworkDiskCache::touch(const QString &key, Entry &entry)
+{
+    m_lru.remove(entry.access);
+    entry.access = ++m_clock;
+    m_lru.insert(entry.access, key);
+    indexChanged();
+}
+
+void NetworkDiskCache::trim()
+{
+    const qint64 limit = budget();
+    while (m_size > limit && !m_lru.isEmpty()) {
+        const QString key = m_lru.first();
+        removeEntry(key);
+    }
+}
+
+void NetworkDiskCache::indexChanged()
+{
+    m_indexChanged = true;
+    m_saveTimer.start();
 }
@@ -1,18 +1,65 @@
 #ifndef NETWORKDISKCACHE_H
 #define NETWORKDISKCACHE_H
 
-#include <QNetworkDiskCache>
+#include <QAbstractNetworkCache>
+#include <QNetworkCacheMetaData>
+#include <QHash>
+#include <QMap>
+#include <QTimer>
+#include <QFutureWatcher>
 
-// Wrapper around QNetworkDiskCache to control
-// what type of content can be cached to avoid to always have
-// to download content from the internet
-class NetworkDiskCache : public QNetworkDiskCache
+// Disk cache of the network replies to avoid to always have to download
+// content from the internet (only the types of content of the database are cached).
+// The content is stored once per hash (SHA-1) no matter how many URLs lead to it
+// (the same figure or dataset reached with different access tokens for instance)
+// and the text content (JSON and XML) is compressed (deflate) in chunks.
+// The contents are never held in memory as a whole (but the small ones):
+// they are written to a temporary file as they are downloaded, hashed, compressed
+// and moved to their blob in a worker thread and read from the blob as the reply is read.
+// Layout:
+//   index          URLs (meta data and hash of their content) and blobs in binary form
+//                  (loaded at startup and written shortly after any change)
+//   blobs/XX/HASH  the content with that hash (XX are the first 2 characters of it)
+//   tmp/           the contents being downloaded
+// The least recently used URLs are evicted when the blobs exceed the size budget,
+// which is the maximum size but never more than the free space of the disk allows.
+class NetworkDiskCache : public QAbstractNetworkCache
 {
 
 public:
+    // current version of the index
+    static const int VERSION = 2;
+    // default maximum size in bytes (5GB)
+    static const qint64 DEFAULT_MAX_SIZE;
+    // space of the disk (in bytes) the cache always leaves free
+    static const qint64 MIN_FREE_SPACE;
+
     explicit NetworkDiskCache(QObject *parent = 0);
     virtual ~NetworkDiskCache();
 
+    // sets the directory of the cache and loads its index
+    // (the content of the directory is discarded if the index is not valid)
+    void setCacheDirectory(const QString &directory);
+    const QString &cacheDirectory() const;
+    // sets the maximum size (in bytes) of the cache (URLs are evicted if needed)
+    void setMaximumCacheSize(const qint64 size);
+    qint64 maximumCacheSize() const;
+    // the size (in bytes) the cache can use now (the maximum size limited
+    // by the free space of the disk, the size of the cache counts as free)
+    qint64 budget() const;
+    // number of URLs cached
+    int count() const;
+    // size (in bytes) of the content of the URLs cached
+    // (before deduplication and compression)
+    qint64 contentSize() const;
+    // writes the index if it has changed (done automatically shortly after any change)
+    // returns false if the writing failed
+    bool saveIndex();
+    // waits for the contents inserted to be stored, their URLs are then cached
+    // (they are stored in a worker thread and cached shortly after insert())
+    void finishStores();
+
+    // size (in bytes) of the blobs on disk
     virtual qint64 cacheSize() const;
     virtual QIODevice *data(const QUrl &url);
     virtual void insert(QIODevice *device);
@@ -20,6 +67,88 @@ public:
     virtual QIODevice *prepare(const QNetworkCacheMetaData &metaData);
     virtual bool remove(const QUrl &url);
     virtual void updateMetaData(const QNetworkCacheMetaData &metaData);
+    virtual void clear();
+
+private:
+    // an URL cached
+    struct Entry {
+        Entry();
+        QNetworkCacheMetaData metaData;
+        // hash of the content (hex)
+        QByteArray hash;
+        // size of the content
+        qint64 size;
+        // last access (see m_clock)
+        quint64 access;
+    };
+
+    // a content stored on disk
+    struct Blob {
+        Blob();
+        // size of the file
+        qint64 size;
+        bool compressed;
+        // URLs with this content
+        int references;
+    };
+
+    // reads the index of the directory, returns false if it does not exist or it is not valid
+    bool loadIndex();
+    // the result of storeContent()
+    struct StoredContent {
+        StoredContent();
+        // hash of the content (hex)
+        QByteArray hash;
+        qint64 contentSize;
+        // size of the file of the blob
+        qint64 size;
+        bool compressed;
+        // the blob was already on disk (nothing is written)
+        bool existing;
+        bool ok;
+    };
+
+    // hashes the content of the file source (or the content given if there is no source)
+    // and writes it to its blob in the directory given (compressed if compressible),
+    // the file source is moved or removed (runs in a worker thread)
+    static StoredContent storeContent(const QString &directory,
+                                      const QString &source,
+                                      const QByteArray &content,
+                                      const bool compressible);
+    // caches the URL of the content stored by the watcher given
+    void storeFinished(QFutureWatcher<StoredContent> *watcher);
+    // removes the URL given by key, the blob is removed if no other URL refers to it
+    void removeEntry(const QString &key);
+    // makes the entry the most recently used
+    void touch(const QString &key, Entry &entry);
+    // evicts the least recently used URLs until the blobs are within the budget
+    void trim();
+    // schedules the writing of the index
+    void indexChanged();
+
+    QString m_directory;
+    qint64 m_maxSize;
+    // size of the blobs
+    qint64 m_size;
+    // size of the content of the URLs
+    qint64 m_contentSize;
+    // URLs (encoded) cached
+    QHash<QString, Entry> m_entries;
+    // blobs by hash
+    QHash<QByteArray, Blob> m_blobs;
+    // URLs (encoded) by last access
+    QMap<quint64, QString> m_lru;
+    // increased on every access
+    quint64 m_clock;
+    // devices returned by prepare() with their meta data
+    QHash<QIODevice *, QNetworkCacheMetaData> m_inserting;
+    // contents being stored with the meta data of their URLs
+    // (not valid if the URL was removed meanwhile)
+    QHash<QFutureWatcher<StoredContent> *, QNetworkCacheMetaData> m_storing;
+    bool m_indexChanged;
+    QTimer m_saveTimer;
+
+    Q_DISABLE_COPY(NetworkDiskCache)
 };
 
 #endif // NETWORKDISKCACHE_H
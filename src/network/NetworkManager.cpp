@@ -12,24 +12,92 @@
 #include <QSslConfiguration>
 #include <QFile>
 #include <QAuthenticator>
-#include <QNetworkDiskCache>
 #include <QDesktopServices>
 #include <QHostInfo>
 #include <QDir>
 #include <QUuid>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <algorithm>
 
 #include "NetworkCommand.h"
 #include "NetworkReply.h"
 #include "NetworkDiskCache.h"
+#include "RangeNetworkReply.h"
+#include "HttpCompression.h"
 #include "error/Error.h"
 #include "SettingsNetwork.h"
 
 using namespace Network;
 
+namespace
+{
+
+// the connections of the non interactive requests (of all the classes together)
+// under which a request of the class given can start on a host, so the highest
+// limit bounds the total: QNetworkAccessManager opens up to 6 connections per
+// host so there are always 2 left for the interactive requests
+int hostLimit(const NetworkManager::Priority priority)
+{
+    switch (priority) {
+    case NetworkManager::Interactive:
+    case NetworkManager::VisibleContent:
+        return 4;
+    case NetworkManager::Prefetch:
+        return 2;
+    case NetworkManager::Background:
+        return 1;
+    default:
+        return 1;
+    }
+}
+
+// the bodies smaller than this (in bytes) are not worth compressing
+const int MIN_COMPRESSED_SIZE = 1024;
+
+// true if the error means the server could not be reached
+// (and not that it answered with an error)
+bool isConnectivityError(const QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionRefusedError:
+    case QNetworkReply::ProxyNotFoundError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QString hostKey(const QUrl &url)
+{
+    return url.scheme() + QStringLiteral("://") + url.host() + QLatin1Char(':')
+           + QString::number(url.port());
+}
+}
+
 NetworkManager::NetworkManager(QObject *parent)
     : QObject(parent)
     , m_nam(nullptr)
     , m_diskCache(nullptr)
+    , m_pending()
+    , m_running()
+    , m_hostRequests()
+    , m_ownerRequests()
+    , m_metrics()
+    , m_rangesDirectory()
+    , m_rangeSegmentSize(RangeNetworkReply::DEFAULT_SEGMENT_SIZE)
+    , m_scheduling(false)
+    , m_compressing()
+    , m_compressedEndpoints()
+    , m_online(true)
 {
     // Setup network access manager
     m_nam.reset(new QNetworkAccessManager(this));
@@ -54,12 +122,30 @@ NetworkManager::NetworkManager(QObject *parent)
     Q_ASSERT(!m_diskCache.isNull());
     const QString location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
     qDebug() << "Network disk cache location " << location;
-    m_diskCache->setCacheDirectory(location + QDir::separator() + "data");
-    const quint64 cacheSizeinGB = 5368709120; // 1024*1024*1024*5 5GB
-    // TODO some HD free space check should be added here
-    m_diskCache->setMaximumCacheSize(cacheSizeinGB);
+    // the cache of previous versions (QNetworkDiskCache) is not used anymore
+    // (it can be large so it is removed in the background to not delay the start)
+    const QString legacyLocation = location + QDir::separator() + "data";
+    if (QDir(legacyLocation).exists()) {
+        QtConcurrent::run([legacyLocation]() { QDir(legacyLocation).removeRecursively(); });
+    }
+    m_diskCache->setCacheDirectory(location + QDir::separator() + "network");
+    m_rangesDirectory = location + QDir::separator() + "ranges";
+    // the cache never takes the free space of the disk (see NetworkDiskCache::budget())
+    const int cacheSizeInMB = m_configurationManager.diskCacheSize();
+    m_diskCache->setMaximumCacheSize(cacheSizeInMB > 0 ? Q_INT64_C(1024) * 1024 * cacheSizeInMB
+                                                       : NetworkDiskCache::DEFAULT_MAX_SIZE);
     m_nam->setCache(m_diskCache.data());
 
+    // the endpoints that accept compressed bodies
+    m_compressedEndpoints = m_configurationManager.compressedEndpoints();
+
+    // log the metrics of the requests if enabled
+    const QString metricsLog = m_configurationManager.networkMetricsLog();
+    if (!metricsLog.isEmpty()) {
+        qDebug() << "Network metrics log " << metricsLog;
+        m_metrics.setLogFile(metricsLog);
+    }
+
     // we need to provide Authentication to our OAuth based servers
     connect(m_nam.data(),
             SIGNAL(authenticationRequired(QNetworkReply *, QAuthenticator *)),
@@ -78,7 +164,9 @@ void NetworkManager::provideAuthentication(QNetworkReply *reply, QAuthenticator
 }
 
 QSharedPointer<NetworkReply> NetworkManager::httpRequest(QSharedPointer<NetworkCommand> cmd,
-                                                         NetworkFlags flags)
+                                                         NetworkFlags flags,
+                                                         Priority priority,
+                                                         const QObject *owner)
 {
     QSharedPointer<NetworkReply> replyWrapper;
 
@@ -114,6 +202,17 @@ QSharedPointer<NetworkReply> NetworkManager::httpRequest(QSharedPointer<NetworkC
         request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
                              QNetworkRequest::PreferCache);
         request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, true);
+    } else {
+        // the disk cache must not answer the validators of the command
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                             QNetworkRequest::AlwaysNetwork);
+        request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    }
+
+    // add the raw headers of the command
+    const auto &headers = cmd->headers();
+    for (auto it = headers.constBegin(); it != headers.constEnd(); ++it) {
+        request.setRawHeader(it.key(), it.value());
     }
 
     // add pipeline option to the request
@@ -123,61 +222,407 @@ QSharedPointer<NetworkReply> NetworkManager::httpRequest(QSharedPointer<NetworkC
     // add high priority
     if (flags.testFlag(UseHighPriority)) {
         request.setPriority(QNetworkRequest::HighPriority);
+    } else if (flags.testFlag(UseLowPriority)) {
+        request.setPriority(QNetworkRequest::LowPriority);
     }
 
-    // keep track of reply to match command later on (async callback)
-    QNetworkReply *networkReply = nullptr;
-
     // encode query as part of the url in the request
     QUrl queryUrl(cmd->url());
     queryUrl.setQuery(cmd->query());
     request.setUrl(queryUrl);
 
+    PendingRequest pending;
+    pending.request = request;
+    pending.type = cmd->type();
+    pending.priority = priority;
+    pending.owner = owner;
+    pending.host = hostKey(queryUrl);
+    // the cached bodies are loaded from the cache as usual
+    pending.ranges = flags.testFlag(UseRanges) && cmd->type() == HttpRequestTypeGet
+                     && !(flags.testFlag(UseCache) && m_diskCache->metaData(queryUrl).isValid());
     switch (cmd->type()) {
+    case HttpRequestTypeGet:
+    case HttpRequestTypeDelete:
+        break;
+    case HttpRequestTypePost:
+    case HttpRequestTypePut: {
+        // POST and PUT methods need a special request header
+        pending.body = addJSONDatatoRequest(cmd, pending.request);
+        break;
+    }
+    case HttpRequestTypeNone: {
+        qDebug() << "[NetworkManager] Error: Unkown request type";
+        return replyWrapper;
+    }
+    default:
+        qDebug() << "[NetworkManager] Error: Unkown network command type";
+        return replyWrapper;
+    }
+
+    // the bodies are compressed in a worker thread and the request is sent
+    // (or queued) once it is done
+    if (pending.body.size() >= MIN_COMPRESSED_SIZE && acceptsCompressedBody(queryUrl)) {
+        replyWrapper = QSharedPointer<NetworkReply>(new NetworkReply());
+        pending.reply = replyWrapper.toWeakRef();
+        compressRequest(pending);
+        return replyWrapper;
+    }
+
+    // interactive requests are sent right away
+    if (priority == Interactive) {
+        QNetworkReply *networkReply = sendRequest(pending);
+        if (networkReply == nullptr) {
+            qDebug() << "[NetworkManager] Error: created network reply is null";
+            return replyWrapper;
+        }
+        replyWrapper = QSharedPointer<NetworkReply>(new NetworkReply());
+        startRequest(replyWrapper, pending, networkReply);
+        return replyWrapper;
+    }
+
+    // the rest wait until there is room for them on the host
+    replyWrapper = QSharedPointer<NetworkReply>(new NetworkReply());
+    pending.reply = replyWrapper.toWeakRef();
+    enqueueRequest(pending);
+    return replyWrapper;
+}
+
+bool NetworkManager::acceptsCompressedBody(const QUrl &url) const
+{
+    const QString urlString = url.toString(QUrl::RemoveQuery);
+    for (const QString &endpoint : m_compressedEndpoints) {
+        if (urlString.startsWith(endpoint)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetworkManager::compressRequest(const PendingRequest &pending)
+{
+    m_compressing.append(pending);
+    const QWeakPointer<NetworkReply> reply = pending.reply;
+    auto watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcher<QByteArray>::finished, this, [=]() {
+        watcher->deleteLater();
+        const auto it = std::find_if(m_compressing.begin(),
+                                     m_compressing.end(),
+                                     [&](const PendingRequest &compressing) {
+                                         return compressing.reply == reply;
+                                     });
+        if (it == m_compressing.end()) {
+            return;
+        }
+        PendingRequest compressed = *it;
+        m_compressing.erase(it);
+        const QByteArray body = watcher->result();
+        if (!body.isEmpty()) {
+            qDebug() << "[NetworkManager] Body compressed from " << compressed.body.size()
+                     << " to " << body.size() << " bytes";
+            compressed.body = body;
+            compressed.request.setRawHeader("Content-Encoding", "gzip");
+            compressed.request.setHeader(QNetworkRequest::ContentLengthHeader, body.size());
+        }
+        enqueueRequest(compressed);
+    });
+    const QByteArray body = pending.body;
+    watcher->setFuture(QtConcurrent::run([body]() { return Network::gzip(body); }));
+}
+
+void NetworkManager::enqueueRequest(const PendingRequest &pending)
+{
+    // the reply could have been released or aborted in the meantime
+    const auto reply = pending.reply.toStrongRef();
+    if (reply == nullptr || reply->isFinished()) {
+        return;
+    }
+
+    if (pending.priority != Interactive) {
+        m_pending.append(pending);
+        schedule();
+        return;
+    }
+    QNetworkReply *networkReply = sendRequest(pending);
+    if (networkReply == nullptr) {
+        reply->registerError(QSharedPointer<Error>(
+            new Error(tr("Network Error"), tr("The network request could not be created"))));
+        reply->slotAbort();
+        return;
+    }
+    startRequest(reply, pending, networkReply);
+}
+
+void NetworkManager::cancelRequests(const QObject *owner)
+{
+    // the replies are aborted after updating the containers as
+    // aborting a running reply finishes it right away
+    QList<QSharedPointer<NetworkReply>> replies;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (it->owner == owner) {
+            replies.append(it->reply.toStrongRef());
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const PendingRequest &compressing : m_compressing) {
+        if (compressing.owner == owner) {
+            replies.append(compressing.reply.toStrongRef());
+        }
+    }
+    QList<NetworkReply *> running;
+    for (auto it = m_running.constBegin(); it != m_running.constEnd(); ++it) {
+        if (it->owner == owner) {
+            running.append(it.key());
+        }
+    }
+
+    for (auto reply : replies) {
+        if (reply != nullptr) {
+            reply->slotAbort();
+        }
+    }
+    for (NetworkReply *reply : running) {
+        // a reply could have been destroyed by a previous abort
+        if (m_running.contains(reply)) {
+            reply->slotAbort();
+        }
+    }
+}
+
+int NetworkManager::pendingRequests() const
+{
+    return m_pending.size();
+}
+
+int NetworkManager::runningRequests(const QUrl &url) const
+{
+    return m_hostRequests.value(hostKey(url), 0);
+}
+
+void NetworkManager::setRangeSegmentSize(const qint64 size)
+{
+    m_rangeSegmentSize = size;
+}
+
+NetworkMetrics &NetworkManager::metrics()
+{
+    return m_metrics;
+}
+
+const NetworkMetrics &NetworkManager::metrics() const
+{
+    return m_metrics;
+}
+
+bool NetworkManager::isOnline() const
+{
+    return m_online;
+}
+
+void NetworkManager::updateOnline(const NetworkReply &reply)
+{
+    // the replies from the cache say nothing about the network
+    if (reply.wasCached()) {
+        return;
+    }
+    bool online = m_online;
+    if (reply.statusCode() > 0) {
+        // the server answered (even if it was with an error)
+        online = true;
+    } else if (isConnectivityError(reply.networkError())) {
+        online = false;
+    }
+    if (online != m_online) {
+        m_online = online;
+        qDebug() << "[NetworkManager] The server is " << (online ? "reachable" : "unreachable");
+        emit signalOnlineChanged(online);
+    }
+}
+
+QNetworkReply *NetworkManager::sendRequest(const PendingRequest &pending)
+{
+    QNetworkReply *networkReply = nullptr;
+    switch (pending.type) {
     case HttpRequestTypeGet: {
-        qDebug() << "[NetworkManager] GET:" << request.url();
-        networkReply = m_nam->get(request);
+        qDebug() << "[NetworkManager] GET:" << pending.request.url();
+        if (pending.ranges) {
+            networkReply = new RangeNetworkReply(m_nam.data(),
+                                                 pending.request,
+                                                 m_rangesDirectory,
+                                                 m_rangeSegmentSize,
+                                                 m_nam.data());
+        } else {
+            networkReply = m_nam->get(pending.request);
+        }
         break;
     }
     case HttpRequestTypePost: {
-        qDebug() << "[NetworkManager] POST:" << request.url();
-        // POST methods need a special request header
-        QByteArray jsonData = addJSONDatatoRequest(cmd, request);
-        networkReply = m_nam->post(request, jsonData);
+        qDebug() << "[NetworkManager] POST:" << pending.request.url();
+        networkReply = m_nam->post(pending.request, pending.body);
         break;
     }
     case HttpRequestTypePut: {
-        qDebug() << "[NetworkManager] PUT:" << request.url();
-        // PUT methods need a special request header
-        QByteArray jsonData = addJSONDatatoRequest(cmd, request);
-        networkReply = m_nam->put(request, jsonData);
+        qDebug() << "[NetworkManager] PUT:" << pending.request.url();
+        networkReply = m_nam->put(pending.request, pending.body);
         break;
     }
     case HttpRequestTypeDelete: {
-        qDebug() << "[NetworkManager] DELETE: " << request.url();
-        networkReply = m_nam->deleteResource(request);
-        break;
-    }
-    case HttpRequestTypeNone: {
-        qDebug() << "[NetworkManager] Error: Unkown request type";
+        qDebug() << "[NetworkManager] DELETE: " << pending.request.url();
+        networkReply = m_nam->deleteResource(pending.request);
         break;
     }
     default:
         qDebug() << "[NetworkManager] Error: Unkown network command type";
     }
+    return networkReply;
+}
 
-    if (networkReply == nullptr) {
-        qDebug() << "[NetworkManager] Error: created network reply is null";
-        return replyWrapper;
+void NetworkManager::startRequest(QSharedPointer<NetworkReply> reply,
+                                  const PendingRequest &pending,
+                                  QNetworkReply *networkReply)
+{
+    reply->start(networkReply);
+
+    // the interactive requests do not count for the limits of the host but the
+    // segments of a range download use connections of the host whatever its class
+    // (they are given the room left, see assignConnections())
+    RunningRequest running;
+    running.host = pending.host;
+    running.owner = pending.owner;
+    running.priority = pending.priority;
+    running.connections = pending.priority != Interactive || pending.ranges ? 1 : 0;
+    if (pending.ranges) {
+        running.ranges = qobject_cast<RangeNetworkReply *>(networkReply);
+        Q_ASSERT(running.ranges);
+        running.ranges->setMaxConnections(running.connections);
+        connect(running.ranges.data(), &RangeNetworkReply::connectionsChanged, this, [=]() {
+            schedule();
+        });
+    }
+    NetworkReply *network_reply = reply.data();
+    m_running.insert(network_reply, running);
+    if (running.connections > 0) {
+        m_hostRequests[running.host] += running.connections;
+    }
+    if (pending.owner != nullptr) {
+        ++m_ownerRequests[pending.owner];
     }
 
-    replyWrapper = QSharedPointer<NetworkReply>(new NetworkReply(networkReply));
-    if (replyWrapper.isNull()) {
-        qDebug() << "[NetworkManager] Error: Unable to create network request";
-        return replyWrapper;
+    // the reply could be released by its user without finishing
+    const Priority priority = pending.priority;
+    connect(network_reply, &NetworkReply::signalFinished, this, [=]() {
+        RequestMetrics metrics = network_reply->metrics();
+        metrics.priority = priority;
+        m_metrics.record(metrics);
+        updateOnline(*network_reply);
+        requestFinished(network_reply);
+    });
+    connect(network_reply, &QObject::destroyed, this, [=]() { requestFinished(network_reply); });
+}
+
+void NetworkManager::requestFinished(NetworkReply *reply)
+{
+    const auto it = m_running.find(reply);
+    if (it == m_running.end()) {
+        return;
+    }
+    if (it->connections > 0 && (m_hostRequests[it->host] -= it->connections) <= 0) {
+        m_hostRequests.remove(it->host);
     }
+    m_running.erase(it);
+    schedule();
+}
 
-    return replyWrapper;
+void NetworkManager::schedule()
+{
+    // the classes are served in order and each one only while the connections
+    // of all the non interactive requests running on the host are under its limit
+    // (so there is always room for the interactive requests and the rest never delay them)
+    // within a class the owner with less requests started goes first (fair queuing)
+    if (m_scheduling) {
+        return;
+    }
+    m_scheduling = true;
+    bool started = true;
+    while (started && !m_pending.isEmpty()) {
+        started = false;
+        auto next = m_pending.end();
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            // the user of the reply has released it or aborted it
+            const auto reply = it->reply.toStrongRef();
+            if (reply == nullptr || reply->isFinished()) {
+                it = m_pending.erase(it);
+                continue;
+            }
+            if (m_hostRequests.value(it->host, 0) < hostLimit(it->priority)) {
+                const bool better = next == m_pending.end() || it->priority < next->priority
+                                    || (it->priority == next->priority
+                                        && m_ownerRequests.value(it->owner, 0)
+                                               < m_ownerRequests.value(next->owner, 0));
+                if (better) {
+                    next = it;
+                }
+            }
+            ++it;
+        }
+        if (next == m_pending.end()) {
+            break;
+        }
+
+        const PendingRequest pending = *next;
+        m_pending.erase(next);
+        const auto reply = pending.reply.toStrongRef();
+        QNetworkReply *networkReply = sendRequest(pending);
+        if (networkReply == nullptr) {
+            reply->registerError(QSharedPointer<Error>(
+                new Error(tr("Network Error"), tr("The network request could not be created"))));
+            reply->slotAbort();
+        } else {
+            startRequest(reply, pending, networkReply);
+        }
+        started = true;
+    }
+
+    // the requests served only matter while there are requests waiting
+    if (m_pending.isEmpty()) {
+        m_ownerRequests.clear();
+    }
+    assignConnections();
+    m_scheduling = false;
+}
+
+void NetworkManager::assignConnections()
+{
+    // the replies are taken first as a download can finish when it is changed
+    const QList<NetworkReply *> replies = m_running.keys();
+    for (NetworkReply *reply : replies) {
+        const auto it = m_running.find(reply);
+        if (it == m_running.end() || it->ranges.isNull()) {
+            continue;
+        }
+        const QString host = it->host;
+        const Priority priority = it->priority;
+        const bool waiting = std::any_of(m_pending.constBegin(),
+                                         m_pending.constEnd(),
+                                         [&](const PendingRequest &pending) {
+                                             return pending.host == host
+                                                    && pending.priority <= priority;
+                                         });
+        // the connections open are always counted, the download takes the room
+        // left on the host unless there are requests of its class (or before) waiting
+        const int open = it->ranges->connections();
+        int connections = std::max(1, open);
+        if (!waiting) {
+            const int room = hostLimit(priority) - m_hostRequests.value(host, 0);
+            connections = std::max(connections,
+                                   std::min(it->ranges->connectionsWanted(),
+                                            it->connections + room));
+        }
+        m_hostRequests[host] += connections - it->connections;
+        it->connections = connections;
+        it->ranges->setMaxConnections(connections);
+    }
 }
 
 QByteArray NetworkManager::addJSONDatatoRequest(QSharedPointer<NetworkCommand> cmd,
@@ -192,4 +637,5 @@ QByteArray NetworkManager::addJSONDatatoRequest(QSharedPointer<NetworkCommand> c
 void NetworkManager::cleanCache()
 {
     m_diskCache->clear();
+    QDir(m_rangesDirectory).removeRecursively();
 }
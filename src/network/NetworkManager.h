@@ -6,15 +6,23 @@
 #include <QVariant>
 #include <QFlags>
 #include <QPointer>
+#include <QNetworkRequest>
+#include <QWeakPointer>
+#include <QHash>
+#include <QList>
+#include <QStringList>
 
 #include "config/Configuration.h"
 #include "auth/TokenStorage.h"
+#include "SettingsNetwork.h"
+#include "network/NetworkMetrics.h"
 
 class NetworkCommand;
 class NetworkReply;
 class QNetworkReply;
 class Error;
 class NetworkDiskCache;
+class RangeNetworkReply;
 
 // Class used to manage all network related functionalities. Creates
 // an abstract layer to easily send network requests.
@@ -25,26 +33,74 @@ class NetworkManager : public QObject
 
 public:
     enum NetworkFlag {
-        Empty,
-        UseAuthentication,
-        UseCache,
-        UsePipelineMode,
-        UseHighPriority,
-        UseTimeOutAbort,
+        Empty = 0x00,
+        UseAuthentication = 0x01,
+        UseCache = 0x02,
+        UsePipelineMode = 0x04,
+        UseHighPriority = 0x08,
+        UseTimeOutAbort = 0x10,
+        // for background requests (ignored if UseHighPriority is present)
+        UseLowPriority = 0x20,
+        // large bodies: GET requests not cached are downloaded as parallel range
+        // segments that resume after errors and restarts (see RangeNetworkReply)
+        UseRanges = 0x40,
         Default = UseAuthentication | UseCache | UsePipelineMode | UseHighPriority | UseTimeOutAbort
     };
     Q_DECLARE_FLAGS(NetworkFlags, NetworkFlag)
 
+    // classes of requests in the order they are served, the interactive ones
+    // (what the user is waiting for) are sent right away and the rest wait
+    // until there is room for them on the host. The limit of a class is not a
+    // quota of its own, it bounds the total connections of all the non interactive
+    // requests running on the host (a class starts while the total is under its
+    // limit, see hostLimit()), so the lower classes only use the room left
+    enum Priority {
+        Interactive = 0,
+        // content the user is going to see (the dataset being opened)
+        VisibleContent = 1,
+        // content the user might see (see DatasetPrefetcher)
+        Prefetch = 2,
+        Background = 3
+    };
+
     NetworkManager(QObject *parent = 0);
     virtual ~NetworkManager();
 
     // default use Authentication
+    // the requests of the same class are served fairly among their owners
+    // (the reply of a request waiting to be sent is not started, see NetworkReply)
     QSharedPointer<NetworkReply> httpRequest(QSharedPointer<NetworkCommand> cmd,
-                                             NetworkFlags flags = NetworkFlag::Default);
+                                             NetworkFlags flags = NetworkFlag::Default,
+                                             Priority priority = Interactive,
+                                             const QObject *owner = nullptr);
+
+    // aborts the requests (waiting and running) of the owner given
+    void cancelRequests(const QObject *owner);
+
+    // requests waiting to be sent
+    int pendingRequests() const;
+    // connections used on the host of the URL given by the requests running
+    // (not counting the interactive ones but for their range downloads)
+    int runningRequests(const QUrl &url) const;
+
+    // size of the segments of the range downloads (see RangeNetworkReply)
+    void setRangeSegmentSize(const qint64 size);
+
+    // the metrics of the requests finished
+    NetworkMetrics &metrics();
+    const NetworkMetrics &metrics() const;
+
+    // false if the last request that reached the network could not connect
+    // to the server (true until a request fails)
+    bool isOnline() const;
 
     // clear network disk cache
     void cleanCache();
 
+signals:
+    // the server has become reachable (online) or unreachable
+    void signalOnlineChanged(bool online);
+
 private slots:
     // if remote server requires authentication
     void provideAuthentication(QNetworkReply *, QAuthenticator *);
@@ -56,6 +112,70 @@ private:
     QByteArray addJSONDatatoRequest(QSharedPointer<NetworkCommand> cmd,
                                     QNetworkRequest &request) const;
 
+    // a request waiting to be sent
+    struct PendingRequest {
+        PendingRequest()
+            : reply()
+            , request()
+            , type(Network::HttpRequestTypeNone)
+            , body()
+            , priority(Interactive)
+            , owner(nullptr)
+            , host()
+            , ranges(false)
+        {
+        }
+        QWeakPointer<NetworkReply> reply;
+        QNetworkRequest request;
+        Network::HttpRequestType type;
+        QByteArray body;
+        Priority priority;
+        const QObject *owner;
+        QString host;
+        bool ranges;
+    };
+
+    // a request that has been sent
+    struct RunningRequest {
+        RunningRequest()
+            : host()
+            , owner(nullptr)
+            , priority(Interactive)
+            , connections(0)
+            , ranges()
+        {
+        }
+        QString host;
+        const QObject *owner;
+        Priority priority;
+        // connections counted on the host (0 for the interactive requests
+        // but range downloads, which open several, see assignConnections())
+        int connections;
+        QPointer<RangeNetworkReply> ranges;
+    };
+
+    // true if the server of the URL accepts request bodies compressed with gzip
+    bool acceptsCompressedBody(const QUrl &url) const;
+    // compresses the body of the request in a worker thread and enqueues it then
+    void compressRequest(const PendingRequest &pending);
+    // sends the request if it is interactive or queues it otherwise
+    void enqueueRequest(const PendingRequest &pending);
+    // sends the request and returns the Qt reply (null if it could not be created)
+    QNetworkReply *sendRequest(const PendingRequest &pending);
+    // updates the connectivity with the outcome of the finished reply
+    void updateOnline(const NetworkReply &reply);
+    // attaches the Qt reply to the reply and keeps track of it until it finishes
+    void startRequest(QSharedPointer<NetworkReply> reply,
+                      const PendingRequest &pending,
+                      QNetworkReply *networkReply);
+    // called when a running request finishes or its reply is released
+    void requestFinished(NetworkReply *reply);
+    // sends the waiting requests there is room for
+    void schedule();
+    // gives the room left on the hosts to the range downloads running, which
+    // stop opening connections while other requests of their class wait
+    void assignConnections();
+
     // qt network manager object
     QScopedPointer<QNetworkAccessManager> m_nam;
     // configuration manager instance
@@ -64,6 +184,27 @@ private:
     TokenStorage m_tokenStorage;
     // network disk cache
     QScopedPointer<NetworkDiskCache> m_diskCache;
+    // requests waiting to be sent in the order they were made
+    QList<PendingRequest> m_pending;
+    // requests running
+    QHash<NetworkReply *, RunningRequest> m_running;
+    // connections of the non interactive requests running per host, one count
+    // shared by all the classes (it is compared with the limit of each one)
+    QHash<QString, int> m_hostRequests;
+    // requests sent per owner (for fair queuing)
+    QHash<const QObject *, int> m_ownerRequests;
+    NetworkMetrics m_metrics;
+    // directory of the range downloads interrupted
+    QString m_rangesDirectory;
+    qint64 m_rangeSegmentSize;
+    // schedule() is running (the range downloads call it when they change)
+    bool m_scheduling;
+    // requests whose body is being compressed
+    QList<PendingRequest> m_compressing;
+    // URLs of the endpoints that accept compressed bodies
+    QStringList m_compressedEndpoints;
+    // the server was reachable by the last request that reached the network
+    bool m_online;
 
     Q_DISABLE_COPY(NetworkManager)
 };
@@ -0,0 +1,191 @@
+#include "NetworkMetrics.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+
+namespace
+{
+
+// the time between two events (-1 if any of them did not happen)
+qint64 elapsed(const qint64 from, const qint64 to)
+{
+    return from < 0 || to < 0 ? -1 : to - from;
+}
+}
+
+const int NetworkMetrics::DEFAULT_MAX_REQUESTS;
+
+RequestMetrics::RequestMetrics()
+    : url()
+    , method()
+    , priority(0)
+    , timestamp(0)
+    , sent(-1)
+    , connected(-1)
+    , firstByte(-1)
+    , finished(-1)
+    , bytesReceived(0)
+    , bytesSent(0)
+    , cached(false)
+    , retries(0)
+    , statusCode(0)
+    , succeeded(false)
+{
+}
+
+qint64 RequestMetrics::queueTime() const
+{
+    return elapsed(0, sent);
+}
+
+qint64 RequestMetrics::connectTime() const
+{
+    return elapsed(sent, connected);
+}
+
+qint64 RequestMetrics::timeToFirstByte() const
+{
+    return elapsed(sent, firstByte);
+}
+
+qint64 RequestMetrics::transferTime() const
+{
+    return elapsed(firstByte, finished);
+}
+
+qint64 RequestMetrics::totalTime() const
+{
+    return elapsed(0, finished);
+}
+
+QJsonObject RequestMetrics::toJson() const
+{
+    QJsonObject json;
+    json["url"] = url;
+    json["method"] = method;
+    json["priority"] = priority;
+    json["timestamp"] = timestamp;
+    json["queue_ms"] = queueTime();
+    json["connect_ms"] = connectTime();
+    json["ttfb_ms"] = timeToFirstByte();
+    json["transfer_ms"] = transferTime();
+    json["total_ms"] = totalTime();
+    json["bytes_received"] = bytesReceived;
+    json["bytes_sent"] = bytesSent;
+    json["cached"] = cached;
+    json["retries"] = retries;
+    json["status"] = statusCode;
+    json["succeeded"] = succeeded;
+    return json;
+}
+
+NetworkMetrics::Summary::Summary()
+    : requests(0)
+    , cached(0)
+    , errors(0)
+    , bytesReceived(0)
+    , bytesSent(0)
+    , meanTimeToFirstByte(0)
+    , meanTotalTime(0)
+    , maxTotalTime(0)
+{
+}
+
+NetworkMetrics::NetworkMetrics(const int maxRequests)
+    : m_requests()
+    , m_maxRequests(maxRequests)
+    , m_count(0)
+    , m_log()
+{
+}
+
+NetworkMetrics::~NetworkMetrics()
+{
+}
+
+bool NetworkMetrics::setLogFile(const QString &path)
+{
+    m_log.close();
+    if (path.isEmpty()) {
+        return true;
+    }
+    m_log.setFileName(path);
+    if (!m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "[NetworkMetrics] Error opening the log file " << path;
+        return false;
+    }
+    return true;
+}
+
+QString NetworkMetrics::logFile() const
+{
+    return m_log.isOpen() ? m_log.fileName() : QString();
+}
+
+void NetworkMetrics::record(const RequestMetrics &metrics)
+{
+    m_requests.append(metrics);
+    if (m_requests.size() > m_maxRequests) {
+        m_requests.removeFirst();
+    }
+    ++m_count;
+
+    if (m_log.isOpen()) {
+        m_log.write(QJsonDocument(metrics.toJson()).toJson(QJsonDocument::Compact) + '\n');
+        m_log.flush();
+    }
+}
+
+QList<RequestMetrics> NetworkMetrics::requests(const QString &urlPrefix) const
+{
+    QList<RequestMetrics> requests;
+    for (const RequestMetrics &metrics : m_requests) {
+        if (metrics.url.startsWith(urlPrefix)) {
+            requests.append(metrics);
+        }
+    }
+    return requests;
+}
+
+NetworkMetrics::Summary NetworkMetrics::summary(const QString &urlPrefix) const
+{
+    Summary summary;
+    qint64 total_ttfb = 0;
+    qint64 total_time = 0;
+    int timed = 0;
+    for (const RequestMetrics &metrics : m_requests) {
+        if (!metrics.url.startsWith(urlPrefix)) {
+            continue;
+        }
+        ++summary.requests;
+        summary.bytesReceived += metrics.bytesReceived;
+        summary.bytesSent += metrics.bytesSent;
+        if (!metrics.succeeded) {
+            ++summary.errors;
+        }
+        if (metrics.cached) {
+            ++summary.cached;
+        } else if (metrics.timeToFirstByte() >= 0) {
+            ++timed;
+            total_ttfb += metrics.timeToFirstByte();
+            total_time += metrics.totalTime();
+            summary.maxTotalTime = qMax(summary.maxTotalTime, metrics.totalTime());
+        }
+    }
+    if (timed > 0) {
+        summary.meanTimeToFirstByte = total_ttfb / timed;
+        summary.meanTotalTime = total_time / timed;
+    }
+    return summary;
+}
+
+int NetworkMetrics::count() const
+{
+    return m_count;
+}
+
+void NetworkMetrics::clear()
+{
+    m_requests.clear();
+    m_count = 0;
+}
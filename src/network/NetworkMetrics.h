@@ -0,0 +1,101 @@
+#ifndef NETWORKMETRICS_H
+#define NETWORKMETRICS_H
+
+#include <QString>
+#include <QList>
+#include <QFile>
+#include <QJsonObject>
+
+// The timings and sizes of a network request, the times are in ms since the
+// request was made (-1 if the event did not happen):
+//   queued -> sent -> connected -> first byte -> finished
+// DNS lookup, TCP connect and TLS handshake are not reported separately by Qt
+// so "connected" covers the three of them (only for new HTTPS connections)
+struct RequestMetrics {
+    RequestMetrics();
+
+    // time waiting to be sent (see NetworkManager::Priority)
+    qint64 queueTime() const;
+    // DNS, connect and TLS (-1 if the connection was reused or not encrypted)
+    qint64 connectTime() const;
+    // from sending the request to receiving the headers of the response
+    qint64 timeToFirstByte() const;
+    // from receiving the headers to the end of the body
+    qint64 transferTime() const;
+    // from making the request to finishing it
+    qint64 totalTime() const;
+
+    QJsonObject toJson() const;
+
+    // the URL without the query (it has the access token)
+    QString url;
+    QString method;
+    int priority;
+    // when the request was made (ms since the epoch)
+    qint64 timestamp;
+    qint64 sent;
+    qint64 connected;
+    qint64 firstByte;
+    qint64 finished;
+    qint64 bytesReceived;
+    qint64 bytesSent;
+    // true if the response came from the disk cache
+    bool cached;
+    // segments requested again (see RangeNetworkReply)
+    int retries;
+    int statusCode;
+    // true if the request finished with no errors (not aborted)
+    bool succeeded;
+};
+
+// NetworkMetrics keeps the metrics of the last requests finished
+// (see NetworkManager) so they can be queried in process, and optionally
+// appends them to a log file as JSON (one object per line)
+class NetworkMetrics
+{
+
+public:
+    // totals of a set of requests
+    struct Summary {
+        Summary();
+
+        int requests;
+        int cached;
+        int errors;
+        qint64 bytesReceived;
+        qint64 bytesSent;
+        // averages of the requests not cached (ms)
+        qint64 meanTimeToFirstByte;
+        qint64 meanTotalTime;
+        qint64 maxTotalTime;
+    };
+
+    // number of requests kept by default
+    static const int DEFAULT_MAX_REQUESTS = 1000;
+
+    explicit NetworkMetrics(const int maxRequests = DEFAULT_MAX_REQUESTS);
+    ~NetworkMetrics();
+
+    // appends the metrics of all the requests recorded from now on to the file given
+    // (an empty path disables the log), returns false if the file could not be opened
+    bool setLogFile(const QString &path);
+    QString logFile() const;
+
+    void record(const RequestMetrics &metrics);
+    // the requests recorded (from the oldest) whose URL starts with the prefix given
+    QList<RequestMetrics> requests(const QString &urlPrefix = QString()) const;
+    Summary summary(const QString &urlPrefix = QString()) const;
+    // requests recorded since the creation (or clear)
+    int count() const;
+    void clear();
+
+private:
+    QList<RequestMetrics> m_requests;
+    int m_maxRequests;
+    int m_count;
+    QFile m_log;
+
+    Q_DISABLE_COPY(NetworkMetrics)
+};
+
+#endif // NETWORKMETRICS_H //
@@ -9,8 +9,10 @@
 #include <QJsonArray>
 #include <QTimer>
 #include <QNetworkRequest>
+#include <QDateTime>
 
 #include "network/NetworkCommand.h"
+#include "network/RangeNetworkReply.h"
 #include "error/Error.h"
 #include "error/JSONError.h"
 #include "error/NetworkError.h"
@@ -20,10 +22,57 @@
 #include "dataModel/ErrorDTO.h"
 #include "data/ObjectParser.h"
 
+namespace
+{
+
+QString methodName(const QNetworkAccessManager::Operation operation)
+{
+    switch (operation) {
+    case QNetworkAccessManager::HeadOperation:
+        return QStringLiteral("HEAD");
+    case QNetworkAccessManager::GetOperation:
+        return QStringLiteral("GET");
+    case QNetworkAccessManager::PutOperation:
+        return QStringLiteral("PUT");
+    case QNetworkAccessManager::PostOperation:
+        return QStringLiteral("POST");
+    case QNetworkAccessManager::DeleteOperation:
+        return QStringLiteral("DELETE");
+    default:
+        return QStringLiteral("CUSTOM");
+    }
+}
+}
+
 NetworkReply::NetworkReply(QNetworkReply *networkReply)
-    : m_reply(networkReply)
+    : m_reply(nullptr)
+    , m_errors()
+    , m_code(CodeSuccess)
+    , m_mime()
+    , m_bytesReceived(0)
+    , m_abortedPending(false)
+    , m_timer()
+    , m_metrics()
+{
+    m_timer.start();
+    m_metrics.timestamp = QDateTime::currentMSecsSinceEpoch();
+    if (networkReply != nullptr) {
+        start(networkReply);
+    }
+}
+
+NetworkReply::~NetworkReply()
+{
+}
+
+void NetworkReply::start(QNetworkReply *networkReply)
 {
     Q_ASSERT_X(networkReply != nullptr, "NetworkReply", "Null-pointer assertion error!");
+    Q_ASSERT(m_reply.isNull());
+    m_reply.reset(networkReply);
+    m_metrics.sent = m_timer.elapsed();
+    m_metrics.url = networkReply->url().adjusted(QUrl::RemoveQuery).toString();
+    m_metrics.method = methodName(networkReply->operation());
 
     // set read buffer to 0 to try to download as fast as possible
     networkReply->setReadBufferSize(0);
@@ -31,6 +80,11 @@ NetworkReply::NetworkReply(QNetworkReply *networkReply)
     // connect signals
     connect(m_reply.data(), SIGNAL(finished()), this, SLOT(slotFinished()));
     connect(m_reply.data(), SIGNAL(metaDataChanged()), this, SLOT(slotMetaDataChanged()));
+    connect(m_reply.data(), SIGNAL(readyRead()), this, SIGNAL(signalDataAvailable()));
+    connect(m_reply.data(),
+            SIGNAL(downloadProgress(qint64, qint64)),
+            this,
+            SLOT(slotDownloadProgress(qint64, qint64)));
     connect(m_reply.data(),
             SIGNAL(error(QNetworkReply::NetworkError)),
             this,
@@ -39,15 +93,24 @@ NetworkReply::NetworkReply(QNetworkReply *networkReply)
             SIGNAL(sslErrors(QList<QSslError>)),
             this,
             SLOT(slotSslErrors(QList<QSslError>)));
+    connect(m_reply.data(), &QNetworkReply::encrypted, this, [this]() {
+        if (m_metrics.connected < 0) {
+            m_metrics.connected = m_timer.elapsed();
+        }
+    });
+    connect(m_reply.data(), &QNetworkReply::uploadProgress, this, [this](qint64 bytesSent) {
+        m_metrics.bytesSent = bytesSent;
+    });
 }
 
-NetworkReply::~NetworkReply()
+bool NetworkReply::isStarted() const
 {
+    return !m_reply.isNull();
 }
 
 QJsonDocument NetworkReply::getJSON()
 {
-    const QByteArray &rawJSON = m_reply->readAll();
+    const QByteArray rawJSON = getRaw();
     QJsonParseError parseError;
     QJsonDocument doc = QJsonDocument::fromJson(rawJSON, &parseError);
 
@@ -63,17 +126,53 @@ QJsonDocument NetworkReply::getJSON()
 
 QString NetworkReply::getText() const
 {
-    return QString::fromUtf8(m_reply->readAll());
+    return QString::fromUtf8(getRaw());
 }
 
 QByteArray NetworkReply::getRaw() const
 {
-    return m_reply->readAll();
+    return m_reply.isNull() ? QByteArray() : m_reply->readAll();
+}
+
+qint64 NetworkReply::contentLength() const
+{
+    if (m_reply.isNull()) {
+        return -1;
+    }
+    const QVariant length = m_reply->header(QNetworkRequest::ContentLengthHeader);
+    return length.isValid() ? length.toLongLong() : -1;
+}
+
+qint64 NetworkReply::bytesReceived() const
+{
+    return m_bytesReceived;
+}
+
+int NetworkReply::statusCode() const
+{
+    return m_reply.isNull()
+               ? 0
+               : m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+}
+
+QNetworkReply::NetworkError NetworkReply::networkError() const
+{
+    return m_reply.isNull() ? QNetworkReply::NoError : m_reply->error();
+}
+
+bool NetworkReply::notModified() const
+{
+    return statusCode() == 304;
+}
+
+QByteArray NetworkReply::rawHeader(const QByteArray &name) const
+{
+    return m_reply.isNull() ? QByteArray() : m_reply->rawHeader(name);
 }
 
 bool NetworkReply::isFinished() const
 {
-    return m_reply->isFinished();
+    return m_reply.isNull() ? m_abortedPending : m_reply->isFinished();
 }
 
 bool NetworkReply::hasErrors() const
@@ -88,6 +187,16 @@ const NetworkReply::ErrorList &NetworkReply::errors() const
 
 void NetworkReply::slotAbort()
 {
+    if (m_reply.isNull()) {
+        // the request was waiting to be started (see NetworkManager)
+        if (!m_abortedPending) {
+            m_abortedPending = true;
+            m_code = hasErrors() ? CodeError : CodeAbort;
+            m_metrics.finished = m_timer.elapsed();
+            emit signalFinished(QVariant::fromValue<int>(m_code));
+        }
+        return;
+    }
     // abort network operation
     m_reply->abort();
 }
@@ -106,12 +215,25 @@ void NetworkReply::slotFinished()
         m_code = CodeError;
     }
 
+    m_metrics.finished = m_timer.elapsed();
+    m_metrics.bytesReceived = m_bytesReceived;
+    m_metrics.cached = wasCached();
+    const auto range_reply = qobject_cast<RangeNetworkReply *>(m_reply.data());
+    if (range_reply != nullptr) {
+        m_metrics.retries = range_reply->retries();
+    }
+    m_metrics.statusCode = statusCode();
+    m_metrics.succeeded = m_code == CodeSuccess && !hasErrors();
+
     // send a signal with the return code and the meta data
     emit signalFinished(QVariant::fromValue<int>(m_code));
 }
 
 void NetworkReply::slotMetaDataChanged()
 {
+    if (m_metrics.firstByte < 0) {
+        m_metrics.firstByte = m_timer.elapsed();
+    }
     QString contentTypeHeader = m_reply->header(QNetworkRequest::ContentTypeHeader).toString();
     m_mime = contentTypeHeader.split(';')[0];
 }
@@ -134,6 +256,12 @@ void NetworkReply::slotSslErrors(QList<QSslError> sslErrorList)
     }
 }
 
+void NetworkReply::slotDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesTotal);
+    m_bytesReceived = bytesReceived;
+}
+
 void NetworkReply::registerError(QSharedPointer<Error> error)
 {
     m_errors += error;
@@ -170,7 +298,13 @@ QSharedPointer<Error> NetworkReply::parseErrors()
 
 bool NetworkReply::wasCached() const
 {
-    return m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    return !m_reply.isNull()
+           && m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+}
+
+const RequestMetrics &NetworkReply::metrics() const
+{
+    return m_metrics;
 }
 
 NetworkReply::ReturnCode NetworkReply::return_code() const
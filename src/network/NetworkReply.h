@@ -5,6 +5,9 @@
 #include <QNetworkReply>
 #include <QPointer>
 #include <QList>
+#include <QElapsedTimer>
+
+#include "network/NetworkMetrics.h"
 
 class Error;
 class QSslError;
@@ -25,14 +28,34 @@ public:
 
     typedef QList<QSharedPointer<Error>> ErrorList;
 
+    // the reply can be created before the request is sent (see NetworkManager)
     explicit NetworkReply(QNetworkReply *networkReply = 0);
     ~NetworkReply();
 
+    // attaches the Qt network reply once the request has been sent
+    // (only for replies created without it)
+    void start(QNetworkReply *networkReply);
+    // false if the request is still waiting to be sent
+    bool isStarted() const;
+
     // parse body (once the data has been parsed cannot be parsed again)
     QJsonDocument getJSON();
     QString getText() const;
     QByteArray getRaw() const;
 
+    // size of the body given by the server (-1 if unknown)
+    qint64 contentLength() const;
+    // bytes of the body received so far
+    qint64 bytesReceived() const;
+    // the HTTP status code (0 if not available)
+    int statusCode() const;
+    // the error of the Qt network reply (NoError if not started)
+    QNetworkReply::NetworkError networkError() const;
+    // true if the server answered 304 Not Modified (to the validators of the request)
+    bool notModified() const;
+    // the raw header of the response (empty if not present)
+    QByteArray rawHeader(const QByteArray &name) const;
+
     // reply status
     bool isFinished() const;
     bool hasErrors() const;
@@ -51,19 +74,27 @@ public:
     // adds an error to the list
     void registerError(QSharedPointer<Error> error);
 
+    // the timings and sizes of the request (complete once it has finished)
+    const RequestMetrics &metrics() const;
+
 public slots:
 
     // These slots are invoked from the Qt network reply object
+    // (the request is not sent if it has not been yet)
     void slotAbort();
     void slotFinished();
     void slotMetaDataChanged();
     void slotError(QNetworkReply::NetworkError networkError);
     void slotSslErrors(QList<QSslError> sslErrorList);
+    void slotDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
 
 signals:
 
     // signal operation Finished (code = abort, error, ok)
     void signalFinished(QVariant code);
+    // signal new data is available to read (the data read
+    // with getRaw() before finishing is not returned again)
+    void signalDataAvailable();
 
 private:
     // Qt network reply
@@ -74,6 +105,13 @@ private:
     ReturnCode m_code;
     // header content type
     QString m_mime;
+    // bytes of the body received so far
+    qint64 m_bytesReceived;
+    // the request was aborted before being sent
+    bool m_abortedPending;
+    // measures the times of the metrics since the reply was created
+    QElapsedTimer m_timer;
+    RequestMetrics m_metrics;
 
     Q_DISABLE_COPY(NetworkReply)
 };
@@ -0,0 +1,542 @@
+#include "RangeNetworkReply.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCryptographicHash>
+#include <QNetworkAccessManager>
+#include <QAbstractNetworkCache>
+#include <QNetworkCacheMetaData>
+#include <cstring>
+
+#include "utils/FileFunctions.h"
+
+namespace
+{
+
+const QString STATE_FILE = QStringLiteral("range.json");
+const QString SEGMENT_FILE = QStringLiteral("segment%1");
+
+// the size of the body given in a Content-Range header ("bytes 0-99/1000")
+// returns -1 if the header is not valid or the size is unknown
+qint64 contentRangeTotal(const QByteArray &header)
+{
+    const int slash = header.lastIndexOf('/');
+    if (!header.startsWith("bytes ") || slash == -1) {
+        return -1;
+    }
+    bool ok = false;
+    const qint64 total = header.mid(slash + 1).trimmed().toLongLong(&ok);
+    return ok ? total : -1;
+}
+}
+
+const qint64 RangeNetworkReply::DEFAULT_SEGMENT_SIZE = Q_INT64_C(8) * 1024 * 1024;
+const int RangeNetworkReply::MAX_CONNECTIONS;
+const int RangeNetworkReply::MAX_RETRIES;
+
+RangeNetworkReply::RangeNetworkReply(QNetworkAccessManager *nam,
+                                     const QNetworkRequest &request,
+                                     const QString &stateDirectory,
+                                     const qint64 segmentSize,
+                                     QObject *parent)
+    : QNetworkReply(parent)
+    , m_nam(nam)
+    , m_stateDirectory()
+    , m_segmentSize(segmentSize)
+    , m_maxConnections(MAX_CONNECTIONS)
+    , m_total(-1)
+    , m_validator()
+    , m_contentType()
+    , m_segments()
+    , m_completed()
+    , m_queue()
+    , m_retries()
+    , m_retryCount(0)
+    , m_active()
+    , m_delivered(0)
+    , m_bytesCompleted(0)
+    , m_readSegment(0)
+    , m_readOffset(0)
+    , m_resumed(0)
+    , m_validated(false)
+    , m_encrypted(false)
+    , m_cacheDevice(nullptr)
+{
+    Q_ASSERT(m_nam);
+    Q_ASSERT(m_segmentSize > 0);
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(QNetworkAccessManager::GetOperation);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    if (!stateDirectory.isEmpty()) {
+        // the query is not part of the key as it has the access token
+        const QByteArray hash
+            = QCryptographicHash::hash(url().adjusted(QUrl::RemoveQuery).toEncoded(),
+                                       QCryptographicHash::Md5);
+        m_stateDirectory = stateDirectory + QDir::separator() + QString::fromLatin1(hash.toHex());
+    }
+
+    // the download starts once the signals of the reply have been connected
+    QMetaObject::invokeMethod(this, "slotStart", Qt::QueuedConnection);
+}
+
+RangeNetworkReply::~RangeNetworkReply()
+{
+    abortSegments();
+    if (m_cacheDevice != nullptr && m_nam != nullptr && m_nam->cache() != nullptr) {
+        m_nam->cache()->remove(url());
+    }
+}
+
+int RangeNetworkReply::segmentsResumed() const
+{
+    return m_resumed;
+}
+
+int RangeNetworkReply::retries() const
+{
+    return m_retryCount;
+}
+
+void RangeNetworkReply::setMaxConnections(const int connections)
+{
+    m_maxConnections = qBound(1, connections, MAX_CONNECTIONS);
+    requestNext();
+}
+
+int RangeNetworkReply::connections() const
+{
+    return m_active.size();
+}
+
+int RangeNetworkReply::connectionsWanted() const
+{
+    return qMin(MAX_CONNECTIONS, m_active.size() + m_queue.size());
+}
+
+void RangeNetworkReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+    // the segments completed are kept on disk to resume the download
+    fail(QNetworkReply::OperationCanceledError, tr("Operation canceled"), 0, QByteArray());
+}
+
+qint64 RangeNetworkReply::bytesAvailable() const
+{
+    qint64 available = QNetworkReply::bytesAvailable() - m_readOffset;
+    for (int i = m_readSegment; i < m_delivered; ++i) {
+        available += m_segments.at(i).size();
+    }
+    return available;
+}
+
+qint64 RangeNetworkReply::readData(char *data, qint64 maxSize)
+{
+    qint64 read = 0;
+    while (read < maxSize && m_readSegment < m_delivered) {
+        const QByteArray &segment = m_segments.at(m_readSegment);
+        const qint64 count = qMin(maxSize - read, segment.size() - m_readOffset);
+        std::memcpy(data + read, segment.constData() + m_readOffset, static_cast<size_t>(count));
+        read += count;
+        m_readOffset += count;
+        if (m_readOffset == segment.size()) {
+            // the data read is released
+            m_segments[m_readSegment] = QByteArray();
+            ++m_readSegment;
+            m_readOffset = 0;
+        }
+    }
+    return read == 0 && isFinished() ? -1 : read;
+}
+
+void RangeNetworkReply::slotStart()
+{
+    // aborted before starting
+    if (isFinished()) {
+        return;
+    }
+
+    if (!loadState()) {
+        requestSegment(0);
+        return;
+    }
+
+    qDebug() << "[RangeNetworkReply] Resuming the download of "
+             << url().adjusted(QUrl::RemoveQuery) << " with " << m_resumed << " segments";
+    setBodyHeaders(m_contentType);
+    // a segment is always requested to validate the ones stored
+    if (m_queue.isEmpty()) {
+        const int last = m_segments.size() - 1;
+        m_completed[last] = false;
+        m_bytesCompleted -= m_segments.at(last).size();
+        m_segments[last] = QByteArray();
+        --m_resumed;
+        m_queue.append(last);
+    }
+    requestNext();
+}
+
+bool RangeNetworkReply::loadState()
+{
+    if (m_stateDirectory.isEmpty()) {
+        return false;
+    }
+    QFile file(QDir(m_stateDirectory).filePath(STATE_FILE));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const qint64 total = static_cast<qint64>(root.value("total").toDouble());
+    const qint64 segment_size = static_cast<qint64>(root.value("segment_size").toDouble());
+    const QByteArray validator = root.value("validator").toString().toLatin1();
+    if (root.value("url").toString() != url().adjusted(QUrl::RemoveQuery).toString()
+        || segment_size != m_segmentSize || total <= 0 || validator.isEmpty()) {
+        removeState();
+        return false;
+    }
+
+    m_validator = validator;
+    m_contentType = root.value("content_type").toString().toLatin1();
+    initSegments(total);
+    for (int i = 0; i < m_segments.size(); ++i) {
+        QFile segment_file(segmentPath(i));
+        if (segment_file.open(QIODevice::ReadOnly) && segment_file.size() == segmentLength(i)) {
+            storeSegment(i, segment_file.readAll(), false);
+            ++m_resumed;
+        } else {
+            m_queue.append(i);
+        }
+    }
+    return true;
+}
+
+void RangeNetworkReply::saveState() const
+{
+    // without a validator the segments could belong to different bodies
+    if (m_stateDirectory.isEmpty() || m_validator.isEmpty()) {
+        return;
+    }
+    QDir dir(m_stateDirectory);
+    if (!dir.mkpath(".")) {
+        qDebug() << "[RangeNetworkReply] Error creating the directory " << dir.path();
+        return;
+    }
+    QJsonObject root;
+    root["url"] = url().adjusted(QUrl::RemoveQuery).toString();
+    root["validator"] = QString::fromLatin1(m_validator);
+    root["content_type"] = QString::fromLatin1(m_contentType);
+    root["total"] = m_total;
+    root["segment_size"] = m_segmentSize;
+    if (!writeFile(dir.filePath(STATE_FILE), QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        qDebug() << "[RangeNetworkReply] Error writing the state of the download";
+    }
+}
+
+void RangeNetworkReply::removeState() const
+{
+    if (!m_stateDirectory.isEmpty()) {
+        QDir(m_stateDirectory).removeRecursively();
+    }
+}
+
+const QString RangeNetworkReply::segmentPath(const int segment) const
+{
+    return QDir(m_stateDirectory).filePath(SEGMENT_FILE.arg(segment));
+}
+
+void RangeNetworkReply::restart()
+{
+    // the data delivered so far belongs to another body
+    if (m_delivered > 0) {
+        fail(QNetworkReply::ContentReSendError,
+             tr("The content changed during the download"),
+             0,
+             QByteArray());
+        return;
+    }
+
+    qDebug() << "[RangeNetworkReply] The content of " << url().adjusted(QUrl::RemoveQuery)
+             << " has changed, downloading it again";
+    abortSegments();
+    removeState();
+    m_total = -1;
+    m_validator.clear();
+    m_segments.clear();
+    m_completed.clear();
+    m_queue.clear();
+    m_retries.clear();
+    m_bytesCompleted = 0;
+    m_resumed = 0;
+    m_validated = false;
+    requestSegment(0);
+}
+
+void RangeNetworkReply::requestSegment(const int segment)
+{
+    if (m_nam == nullptr) {
+        fail(QNetworkReply::UnknownNetworkError, tr("Network access not available"), 0, QByteArray());
+        return;
+    }
+
+    // the size of the first segment is not known until it is received
+    const qint64 from = segment * m_segmentSize;
+    const qint64 to = from + (m_total < 0 ? m_segmentSize : segmentLength(segment)) - 1;
+    QNetworkRequest segment_request(request());
+    segment_request.setRawHeader("Range",
+                                 "bytes=" + QByteArray::number(from) + '-' + QByteArray::number(to));
+    if (!m_validator.isEmpty()) {
+        segment_request.setRawHeader("If-Range", m_validator);
+    }
+    // the segments use their own connections and are never cached (see complete())
+    segment_request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, false);
+    segment_request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                                 QNetworkRequest::AlwaysNetwork);
+    segment_request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+
+    QNetworkReply *reply = m_nam->get(segment_request);
+    m_active.insert(reply, segment);
+    connect(reply, &QNetworkReply::finished, this, [=]() { segmentFinished(reply); });
+    // the TLS handshake of the first segment is the one of the download (see RequestMetrics)
+    if (segment == 0 && !m_encrypted) {
+        connect(reply, &QNetworkReply::encrypted, this, [this]() {
+            if (!m_encrypted) {
+                m_encrypted = true;
+                emit encrypted();
+            }
+        });
+    }
+}
+
+void RangeNetworkReply::requestNext()
+{
+    if (isFinished()) {
+        return;
+    }
+    while (m_active.size() < m_maxConnections && !m_queue.isEmpty()) {
+        requestSegment(m_queue.takeFirst());
+    }
+    emit connectionsChanged();
+}
+
+void RangeNetworkReply::segmentFinished(QNetworkReply *reply)
+{
+    const int segment = m_active.take(reply);
+    reply->deleteLater();
+    if (isFinished()) {
+        return;
+    }
+    // the connection can be given to another request before it is used again
+    emit connectionsChanged();
+
+    const QNetworkReply::NetworkError code = reply->error();
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (code == QNetworkReply::NoError && status == 200) {
+        if (m_total >= 0) {
+            // If-Range did not match, the body has changed since the segments were stored
+            restart();
+            return;
+        }
+        // the server does not support ranges, the whole body is delivered as it is
+        const QByteArray body = reply->readAll();
+        m_segmentSize = qMax(static_cast<qint64>(body.size()), Q_INT64_C(1));
+        initSegments(body.size());
+        setResponseHeaders(*reply);
+        m_validated = true;
+        if (!body.isEmpty()) {
+            storeSegment(0, body, false);
+        }
+        deliver();
+        complete();
+        return;
+    }
+
+    if (code == QNetworkReply::NoError && status == 206) {
+        if (m_total < 0) {
+            const qint64 total = contentRangeTotal(reply->rawHeader("Content-Range"));
+            if (total <= 0) {
+                fail(QNetworkReply::ProtocolFailure,
+                     tr("Invalid Content-Range header"),
+                     status,
+                     QByteArray());
+                return;
+            }
+            initSegments(total);
+            setResponseHeaders(*reply);
+            for (int i = 1; i < m_segments.size(); ++i) {
+                m_queue.append(i);
+            }
+            saveState();
+        }
+        m_validated = true;
+        const QByteArray data = reply->readAll();
+        if (data.size() == segmentLength(segment)) {
+            storeSegment(segment, data, true);
+            deliver();
+            if (m_delivered == m_segments.size()) {
+                complete();
+            } else {
+                requestNext();
+            }
+            return;
+        }
+    }
+
+    // the segments that fail because of the connection (or arrive incomplete)
+    // are requested again, HTTP errors are not solved that way
+    const bool connection_error = code != QNetworkReply::NoError
+                                  && code != QNetworkReply::OperationCanceledError
+                                  && code < QNetworkReply::ProxyConnectionRefusedError;
+    const bool incomplete = code == QNetworkReply::NoError && status == 206;
+    if ((connection_error || incomplete) && m_retries.value(segment, 0) < MAX_RETRIES) {
+        ++m_retries[segment];
+        ++m_retryCount;
+        qDebug() << "[RangeNetworkReply] Requesting again segment " << segment << " of "
+                 << url().adjusted(QUrl::RemoveQuery) << ": " << reply->errorString();
+        m_queue.prepend(segment);
+        requestNext();
+        return;
+    }
+    fail(code != QNetworkReply::NoError ? code : QNetworkReply::ProtocolFailure,
+         reply->errorString(),
+         status,
+         reply->readAll());
+}
+
+void RangeNetworkReply::initSegments(const qint64 total)
+{
+    m_total = total;
+    const int segments = static_cast<int>((total + m_segmentSize - 1) / m_segmentSize);
+    m_segments = QVector<QByteArray>(segments);
+    m_completed = QVector<bool>(segments, false);
+    m_queue.clear();
+    setHeader(QNetworkRequest::ContentLengthHeader, total);
+}
+
+void RangeNetworkReply::setResponseHeaders(const QNetworkReply &reply)
+{
+    // weak ETags cannot be used in If-Range
+    m_validator = reply.rawHeader("ETag");
+    if (m_validator.isEmpty() || m_validator.startsWith("W/")) {
+        m_validator = reply.rawHeader("Last-Modified");
+    }
+    for (const QByteArray &name : {QByteArray("ETag"), QByteArray("Last-Modified")}) {
+        if (reply.hasRawHeader(name)) {
+            setRawHeader(name, reply.rawHeader(name));
+        }
+    }
+    m_contentType = reply.rawHeader("Content-Type");
+    setBodyHeaders(m_contentType);
+}
+
+void RangeNetworkReply::setBodyHeaders(const QByteArray &contentType)
+{
+    // the reply is presented as a regular response with the whole body
+    if (!contentType.isEmpty()) {
+        setRawHeader("Content-Type", contentType);
+    }
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, QByteArray("OK"));
+    emit metaDataChanged();
+}
+
+void RangeNetworkReply::storeSegment(const int segment, const QByteArray &data, const bool persist)
+{
+    m_segments[segment] = data;
+    m_completed[segment] = true;
+    m_bytesCompleted += data.size();
+    if (persist && !m_stateDirectory.isEmpty() && !m_validator.isEmpty()
+        && !writeFile(segmentPath(segment), data)) {
+        qDebug() << "[RangeNetworkReply] Error writing segment " << segment;
+    }
+}
+
+void RangeNetworkReply::deliver()
+{
+    // the segments resumed are not delivered until the server confirms them
+    if (!m_validated) {
+        return;
+    }
+
+    const int delivered = m_delivered;
+    while (m_delivered < m_segments.size() && m_completed.at(m_delivered)) {
+        if (m_delivered == 0 && m_nam != nullptr && m_nam->cache() != nullptr
+            && request().attribute(QNetworkRequest::CacheSaveControlAttribute, true).toBool()) {
+            QNetworkCacheMetaData metaData;
+            metaData.setUrl(url());
+            metaData.setSaveToDisk(true);
+            metaData.setRawHeaders(rawHeaderPairs());
+            QNetworkCacheMetaData::AttributesMap attributes;
+            attributes.insert(QNetworkRequest::HttpStatusCodeAttribute, 200);
+            attributes.insert(QNetworkRequest::HttpReasonPhraseAttribute, QByteArray("OK"));
+            metaData.setAttributes(attributes);
+            m_cacheDevice = m_nam->cache()->prepare(metaData);
+        }
+        if (m_cacheDevice != nullptr) {
+            m_cacheDevice->write(m_segments.at(m_delivered));
+        }
+        ++m_delivered;
+    }
+    if (m_delivered > delivered) {
+        emit readyRead();
+    }
+    emit downloadProgress(m_bytesCompleted, m_total);
+}
+
+void RangeNetworkReply::complete()
+{
+    removeState();
+    if (m_cacheDevice != nullptr && m_nam != nullptr && m_nam->cache() != nullptr) {
+        m_nam->cache()->insert(m_cacheDevice);
+    }
+    m_cacheDevice = nullptr;
+    setFinished(true);
+    emit finished();
+}
+
+void RangeNetworkReply::fail(const QNetworkReply::NetworkError code,
+                             const QString &message,
+                             const int statusCode,
+                             const QByteArray &body)
+{
+    abortSegments();
+    if (m_cacheDevice != nullptr && m_nam != nullptr && m_nam->cache() != nullptr) {
+        m_nam->cache()->remove(url());
+    }
+    m_cacheDevice = nullptr;
+
+    // the body of the error is what is left to read (see NetworkReply::parseErrors())
+    m_segments = QVector<QByteArray>(1, body);
+    m_completed = QVector<bool>(1, true);
+    m_delivered = 1;
+    m_readSegment = 0;
+    m_readOffset = 0;
+    if (statusCode > 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+    }
+    setError(code, message);
+    setFinished(true);
+    emit error(code);
+    emit finished();
+}
+
+void RangeNetworkReply::abortSegments()
+{
+    const QList<QNetworkReply *> replies = m_active.keys();
+    m_active.clear();
+    for (QNetworkReply *reply : replies) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+qint64 RangeNetworkReply::segmentLength(const int segment) const
+{
+    return qMin(m_segmentSize, m_total - segment * m_segmentSize);
+}
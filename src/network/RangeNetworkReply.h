@@ -0,0 +1,136 @@
+#ifndef RANGENETWORKREPLY_H
+#define RANGENETWORKREPLY_H
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+#include <QList>
+
+class QNetworkAccessManager;
+
+// RangeNetworkReply downloads the body of a GET request as HTTP range segments
+// and presents it as a regular QNetworkReply (see NetworkManager::UseRanges):
+// - the first segment gives the size of the body, the rest are downloaded in
+//   parallel over several connections (see setMaxConnections())
+// - the segments that fail are requested again (the ones completed are kept)
+// - the segments completed are stored on disk until the download finishes so an
+//   interrupted download resumes after a restart (If-Range makes the server send
+//   the whole body again if it has changed since)
+// - the body is delivered in order as the segments before it complete
+// - the whole body is inserted in the cache of the network access manager
+// A server that does not support ranges answers the first segment with the
+// whole body, which is delivered as it is.
+class RangeNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    // default size of the segments in bytes
+    static const qint64 DEFAULT_SEGMENT_SIZE;
+    // segments downloaded at the same time
+    static const int MAX_CONNECTIONS = 4;
+    // times a segment is requested again after a connection error
+    static const int MAX_RETRIES = 3;
+
+    // the segments completed are stored in stateDirectory (nothing is stored if empty)
+    RangeNetworkReply(QNetworkAccessManager *nam,
+                      const QNetworkRequest &request,
+                      const QString &stateDirectory,
+                      const qint64 segmentSize = DEFAULT_SEGMENT_SIZE,
+                      QObject *parent = 0);
+    virtual ~RangeNetworkReply();
+
+    // segments of the body loaded from a previous download
+    int segmentsResumed() const;
+    // times the segments have been requested again (see MAX_RETRIES)
+    int retries() const;
+
+    // the segments downloaded at the same time (1 to MAX_CONNECTIONS), the
+    // connections open are not closed if it is lowered
+    void setMaxConnections(const int connections);
+    // connections open and the ones that could be used by the segments waiting
+    int connections() const;
+    int connectionsWanted() const;
+
+    virtual void abort();
+    virtual qint64 bytesAvailable() const;
+
+signals:
+    // a segment has finished or more segments are waiting to be requested
+    void connectionsChanged();
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize);
+
+private slots:
+    void slotStart();
+
+private:
+    // the state stored on disk of an interrupted download
+    bool loadState();
+    void saveState() const;
+    void removeState() const;
+    const QString segmentPath(const int segment) const;
+
+    // starts the download of the body from the beginning
+    void restart();
+    void requestSegment(const int segment);
+    // requests the segments waiting while there are connections free
+    void requestNext();
+    void segmentFinished(QNetworkReply *reply);
+    // sets the size of the body and the segments it has
+    void initSegments(const qint64 total);
+    // sets the headers of the body from the response given
+    void setResponseHeaders(const QNetworkReply &reply);
+    void setBodyHeaders(const QByteArray &contentType);
+    void storeSegment(const int segment, const QByteArray &data, const bool persist);
+    // delivers the segments completed after the ones already delivered
+    void deliver();
+    void complete();
+    void fail(const QNetworkReply::NetworkError code,
+              const QString &message,
+              const int statusCode,
+              const QByteArray &body);
+    void abortSegments();
+    qint64 segmentLength(const int segment) const;
+
+    QPointer<QNetworkAccessManager> m_nam;
+    // directory of the state of the download (empty if it is not stored)
+    QString m_stateDirectory;
+    qint64 m_segmentSize;
+    int m_maxConnections;
+    // size of the body (-1 until the first segment is received)
+    qint64 m_total;
+    // ETag or Last-Modified of the body (for If-Range)
+    QByteArray m_validator;
+    QByteArray m_contentType;
+    // data of the segments completed and not read yet
+    QVector<QByteArray> m_segments;
+    QVector<bool> m_completed;
+    // segments waiting to be requested
+    QList<int> m_queue;
+    // retries by segment and in total
+    QHash<int, int> m_retries;
+    int m_retryCount;
+    // segments being downloaded
+    QHash<QNetworkReply *, int> m_active;
+    // segments delivered (all of them complete)
+    int m_delivered;
+    qint64 m_bytesCompleted;
+    // next byte to read
+    int m_readSegment;
+    qint64 m_readOffset;
+    int m_resumed;
+    // false while the segments resumed have not been validated by the server
+    bool m_validated;
+    // encrypted is emitted once (the connection of the first segment)
+    bool m_encrypted;
+    // the body is written to the cache as it is delivered
+    QIODevice *m_cacheDevice;
+
+    Q_DISABLE_COPY(RangeNetworkReply)
+};
+
+#endif // RANGENETWORKREPLY_H //
@@ -0,0 +1,89 @@
+#include <QtTest/QTest>
+#include <QBuffer>
+
+#include "io/BinaryFeatureFile.h"
+
+#include "tst_binaryfeaturefiletest.h"
+
+namespace unit
+{
+
+BinaryFeatureFileTest::BinaryFeatureFileTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void BinaryFeatureFileTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void BinaryFeatureFileTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void BinaryFeatureFileTest::testWriteAndRead()
+{
+    // two spots, the first with two genes and the second with one
+    const QStringList genes = QStringList() << "Actb" << "Gapdh" << "Ö-gene";
+    const QVector<float> spots_x = QVector<float>() << 1.0f << 2.5f;
+    const QVector<float> spots_y = QVector<float>() << 3.0f << 4.5f;
+    const QVector<quint32> row_pointer = QVector<quint32>() << 0 << 2 << 3;
+    const QVector<quint32> gene_ids = QVector<quint32>() << 0 << 2 << 1;
+    const QVector<quint32> counts = QVector<quint32>() << 10 << 20 << 30;
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(BinaryFeatureFile::write(buffer,
+                                     genes,
+                                     spots_x,
+                                     spots_y,
+                                     row_pointer,
+                                     gene_ids,
+                                     counts));
+    buffer.close();
+    QVERIFY(BinaryFeatureFile::isBinary(buffer.data()));
+
+    BinaryFeatureFile file;
+    QVERIFY(file.open(buffer.data()));
+    QCOMPARE(file.version(), BinaryFeatureFile::VERSION);
+    QCOMPARE(file.genesCount(), 3u);
+    QCOMPARE(file.spotsCount(), 2u);
+    QCOMPARE(file.featuresCount(), 3u);
+    QCOMPARE(file.geneName(2), QString("Ö-gene"));
+    QCOMPARE(file.spotX(1), 2.5f);
+    QCOMPARE(file.spotY(0), 3.0f);
+    QCOMPARE(file.spotBegin(1), 2u);
+    QCOMPARE(file.spotEnd(1), 3u);
+    QCOMPARE(file.geneId(1), 2u);
+    QCOMPARE(file.count(2), 30u);
+}
+
+void BinaryFeatureFileTest::testInvalidData()
+{
+    BinaryFeatureFile file;
+    const QByteArray json("[{\"gene\":\"Actb\",\"hits\":1,\"x\":1,\"y\":1}]");
+    QVERIFY(!BinaryFeatureFile::isBinary(json));
+    QVERIFY(!file.open(json));
+    QVERIFY(!file.isOpen());
+
+    // a truncated file must be rejected
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(BinaryFeatureFile::write(buffer,
+                                     QStringList() << "Actb",
+                                     QVector<float>() << 1.0f,
+                                     QVector<float>() << 1.0f,
+                                     QVector<quint32>() << 0 << 1,
+                                     QVector<quint32>() << 0,
+                                     QVector<quint32>() << 5));
+    buffer.close();
+    QVERIFY(file.open(buffer.data()));
+    QVERIFY(!file.open(buffer.data().left(buffer.data().size() - 4)));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::BinaryFeatureFileTest)
+#include "tst_binaryfeaturefiletest.moc"
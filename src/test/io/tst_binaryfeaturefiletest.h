@@ -0,0 +1,26 @@
+#ifndef TST_BINARYFEATUREFILETEST_H
+#define TST_BINARYFEATUREFILETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class BinaryFeatureFileTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BinaryFeatureFileTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testWriteAndRead();
+    void testInvalidData();
+};
+
+} // namespace unit //
+
+#endif // TST_BINARYFEATUREFILETEST_H
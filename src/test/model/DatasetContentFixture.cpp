@@ -0,0 +1,39 @@
+#include "DatasetContentFixture.h"
+
+#include <QTransform>
+
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+
+namespace unit
+{
+
+DatasetContentCache::Content createDatasetContent(const QString &lastModified,
+                                                  const int imageSize)
+{
+    DatasetContentCache::Content content;
+    content.lastModified = lastModified;
+    FeatureStoreBuilder builder;
+    builder.append(content.genes.insert("Actb"), 1.0f, 3.0f, 10);
+    builder.append(content.genes.insert("Gapdh"), 2.5f, 4.5f, 30);
+    builder.append(content.genes.insert("Ö-gene"), 1.0f, 3.0f, 20);
+    content.features = builder.build();
+
+    Chip chip;
+    chip.id("chip");
+    chip.x1(1);
+    chip.y2(33);
+    content.chip = std::make_shared<Chip>(chip);
+
+    ImageAlignment alignment;
+    alignment.id("alignment");
+    alignment.chipId("chip");
+    alignment.figureBlue("blue.jpg");
+    alignment.alignment(QTransform(0.5, 0.0, 0.0, 0.25, 10.0, 20.0));
+    content.imageAlignment = std::make_shared<ImageAlignment>(alignment);
+
+    content.images.insert("blue.jpg", QByteArray(imageSize, 'x'));
+    return content;
+}
+
+} // namespace unit //
@@ -0,0 +1,19 @@
+#ifndef DATASETCONTENTFIXTURE_H
+#define DATASETCONTENTFIXTURE_H
+
+#include <QString>
+
+#include "data/DatasetContentCache.h"
+
+namespace unit
+{
+
+// content of a dataset for the tests of the caches and the stores:
+// two spots and three genes (one with a non ASCII name), a chip, an image
+// alignment and the blue figure (imageSize bytes)
+DatasetContentCache::Content createDatasetContent(const QString &lastModified,
+                                                  const int imageSize = 10);
+
+} // namespace unit //
+
+#endif // DATASETCONTENTFIXTURE_H
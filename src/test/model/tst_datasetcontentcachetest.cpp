@@ -0,0 +1,80 @@
+#include <QtTest/QTest>
+
+#include "data/DatasetContentCache.h"
+
+#include "DatasetContentFixture.h"
+#include "tst_datasetcontentcachetest.h"
+
+namespace unit
+{
+
+DatasetContentCacheTest::DatasetContentCacheTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DatasetContentCacheTest::testFind()
+{
+    DatasetContentCache cache;
+    DatasetContentCache::Content content;
+    QVERIFY(!cache.find("dataset", "1", content));
+
+    const DatasetContentCache::Content cached = createDatasetContent("1", 100);
+    cache.insert("dataset", cached);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.size(), DatasetContentCache::memoryUsage(cached));
+    QVERIFY(cache.find("dataset", "1", content));
+    QVERIFY(content.features == cached.features);
+    QVERIFY(content.genes == cached.genes);
+    QCOMPARE(content.images.value("figure"), cached.images.value("figure"));
+
+    QCOMPARE(cache.statistics().hits, 1);
+    QCOMPARE(cache.statistics().misses, 1);
+}
+
+void DatasetContentCacheTest::testStaleEntry()
+{
+    DatasetContentCache cache;
+    cache.insert("dataset", createDatasetContent("1", 100));
+    QVERIFY(cache.contains("dataset", "1"));
+    QVERIFY(!cache.contains("dataset", "2"));
+    QCOMPARE(cache.statistics().hits + cache.statistics().misses, 0);
+
+    // the dataset has been modified
+    DatasetContentCache::Content content;
+    QVERIFY(!cache.find("dataset", "2", content));
+    QVERIFY(!cache.contains("dataset"));
+    QCOMPARE(cache.size(), qint64(0));
+}
+
+void DatasetContentCacheTest::testEviction()
+{
+    const qint64 entry_size = DatasetContentCache::memoryUsage(createDatasetContent("1", 1000));
+    DatasetContentCache cache(entry_size * 2);
+    cache.insert("a", createDatasetContent("1", 1000));
+    cache.insert("b", createDatasetContent("1", 1000));
+
+    // using a makes b the least recently used
+    DatasetContentCache::Content content;
+    QVERIFY(cache.find("a", "1", content));
+    cache.insert("c", createDatasetContent("1", 1000));
+    QVERIFY(cache.contains("a"));
+    QVERIFY(!cache.contains("b"));
+    QVERIFY(cache.contains("c"));
+    QCOMPARE(cache.statistics().evictions, 1);
+    QVERIFY(cache.size() <= cache.maxSize());
+
+    // content bigger than the cache is not cached
+    cache.insert("d", createDatasetContent("1", 10000));
+    QVERIFY(!cache.contains("d"));
+
+    // reducing the size evicts the least recently used
+    cache.setMaxSize(entry_size);
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains("c"));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DatasetContentCacheTest)
+#include "tst_datasetcontentcachetest.moc"
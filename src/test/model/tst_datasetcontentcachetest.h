@@ -0,0 +1,24 @@
+#ifndef TST_DATASETCONTENTCACHETEST_H
+#define TST_DATASETCONTENTCACHETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class DatasetContentCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatasetContentCacheTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void testFind();
+    void testStaleEntry();
+    void testEviction();
+};
+
+} // namespace unit //
+
+#endif // TST_DATASETCONTENTCACHETEST_H
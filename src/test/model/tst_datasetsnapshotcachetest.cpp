@@ -0,0 +1,131 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QDirIterator>
+
+#include "data/DatasetSnapshotCache.h"
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+
+#include "DatasetContentFixture.h"
+#include "tst_datasetsnapshotcachetest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// size of the files of the directory given
+qint64 directorySize(const QString &path)
+{
+    qint64 size = 0;
+    QDirIterator files(path, QDir::Files, QDirIterator::Subdirectories);
+    while (files.hasNext()) {
+        files.next();
+        size += files.fileInfo().size();
+    }
+    return size;
+}
+}
+
+DatasetSnapshotCacheTest::DatasetSnapshotCacheTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DatasetSnapshotCacheTest::testWriteAndRead()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    DatasetSnapshotCache cache(dir.path());
+    DatasetContentCache::Content content;
+    QVERIFY(!cache.read("dataset", "1", content));
+
+    const DatasetContentCache::Content written = createDatasetContent("1");
+    QVERIFY(cache.write("dataset", written));
+    QVERIFY(cache.read("dataset", "1", content));
+    QVERIFY(content.features == written.features);
+    QVERIFY(content.genes == written.genes);
+    QVERIFY(*content.chip == *written.chip);
+    QVERIFY(*content.imageAlignment == *written.imageAlignment);
+    QVERIFY(content.images == written.images);
+
+    cache.remove("dataset");
+    QVERIFY(!cache.read("dataset", "1", content));
+}
+
+void DatasetSnapshotCacheTest::testStaleSnapshot()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    DatasetSnapshotCache cache(dir.path());
+    QVERIFY(cache.write("dataset", createDatasetContent("1")));
+
+    // the dataset has been modified since the snapshot was written
+    DatasetContentCache::Content content;
+    QVERIFY(!cache.read("dataset", "2", content));
+    QVERIFY(cache.read("dataset", "1", content));
+
+    cache.clear();
+    QVERIFY(!cache.read("dataset", "1", content));
+}
+
+void DatasetSnapshotCacheTest::testWriteAsync()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    DatasetSnapshotCache cache(dir.path());
+
+    // the snapshot being written exists and it is read once written
+    const DatasetContentCache::Content written = createDatasetContent("1");
+    QFuture<bool> writing = cache.writeAsync("dataset", written);
+    QVERIFY(cache.contains("dataset", "1"));
+    QVERIFY(!cache.contains("dataset", "2"));
+    DatasetContentCache::Content content;
+    QVERIFY(cache.read("dataset", "1", content));
+    QVERIFY(writing.isFinished());
+    QVERIFY(writing.result());
+    QVERIFY(content.features == written.features);
+    QVERIFY(*content.chip == *written.chip);
+
+    // the removal waits for the writings
+    cache.writeAsync("dataset", createDatasetContent("2"));
+    cache.remove("dataset");
+    QVERIFY(!cache.contains("dataset", "2"));
+}
+
+void DatasetSnapshotCacheTest::testEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    qint64 snapshot_size = 0;
+    {
+        DatasetSnapshotCache cache(dir.path(), 0);
+        QVERIFY(cache.write("size", createDatasetContent("1")));
+        snapshot_size = directorySize(dir.path());
+        cache.clear();
+    }
+    QVERIFY(snapshot_size > 0);
+
+    // room for two snapshots
+    DatasetSnapshotCache cache(dir.path(), 2 * snapshot_size + snapshot_size / 2);
+    QVERIFY(cache.write("a", createDatasetContent("1")));
+    QTest::qWait(10);
+    QVERIFY(cache.write("b", createDatasetContent("1")));
+    QTest::qWait(10);
+    DatasetContentCache::Content content;
+    QVERIFY(cache.read("a", "1", content));
+    QTest::qWait(10);
+
+    // the least recently accessed snapshot is removed
+    QVERIFY(cache.write("c", createDatasetContent("1")));
+    QVERIFY(cache.contains("a", "1"));
+    QVERIFY(!cache.contains("b", "1"));
+    QVERIFY(cache.contains("c", "1"));
+    QVERIFY(directorySize(dir.path()) <= 2 * snapshot_size + snapshot_size / 2);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DatasetSnapshotCacheTest)
+#include "tst_datasetsnapshotcachetest.moc"
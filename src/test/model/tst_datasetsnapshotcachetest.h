@@ -0,0 +1,25 @@
+#ifndef TST_DATASETSNAPSHOTCACHETEST_H
+#define TST_DATASETSNAPSHOTCACHETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class DatasetSnapshotCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatasetSnapshotCacheTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void testWriteAndRead();
+    void testStaleSnapshot();
+    void testWriteAsync();
+    void testEviction();
+};
+
+} // namespace unit //
+
+#endif // TST_DATASETSNAPSHOTCACHETEST_H
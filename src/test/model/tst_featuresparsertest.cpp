@@ -0,0 +1,174 @@
+#include <QtTest/QTest>
+
+#include "data/FeaturesParser.h"
+#include "dataModel/FeatureStore.h"
+
+#include "tst_featuresparsertest.h"
+
+namespace unit
+{
+
+// size of the synthetic dataset (spots x genes features)
+static const int SPOTS = 2000;
+static const int GENES_PER_SPOT = 200;
+
+FeaturesParserTest::FeaturesParserTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeaturesParserTest::initTestCase()
+{
+    // generate a dataset big enough to be parsed in parallel
+    m_rawData.append('[');
+    for (int spot = 0; spot < SPOTS; ++spot) {
+        for (int gene = 0; gene < GENES_PER_SPOT; ++gene) {
+            if (spot != 0 || gene != 0) {
+                m_rawData.append(",\n");
+            }
+            // some gene names contain escaped quotes and brackets
+            m_rawData.append(QString("{\"gene\": \"Gene\\\"{%1}\", \"hits\": %2, \"x\": %3, \"y\": %4}")
+                                 .arg((spot + gene) % 5000)
+                                 .arg(gene + 1)
+                                 .arg(spot % 33)
+                                 .arg(spot / 33)
+                                 .toUtf8());
+        }
+    }
+    m_rawData.append(']');
+}
+
+void FeaturesParserTest::cleanupTestCase()
+{
+    m_rawData.clear();
+}
+
+void FeaturesParserTest::testParallelEqualsSequential()
+{
+    data::ParsedFeatures sequential;
+    QVERIFY(data::parseFeatures(m_rawData, sequential));
+    QCOMPARE(sequential.features.size(), SPOTS * GENES_PER_SPOT);
+
+    data::ParsedFeatures parallel;
+    QVERIFY(data::parseFeaturesParallel(m_rawData, parallel, nullptr, 4));
+    QCOMPARE(parallel.features.size(), sequential.features.size());
+    // the genes are interned in order of appearance so the IDs must match
+    QCOMPARE(parallel.genes.size(), sequential.genes.size());
+    QVERIFY(parallel.genes == sequential.genes);
+    QCOMPARE(sequential.genes.name(sequential.features.geneId(0)), QString("Gene\"{0}"));
+    // the order of the features must be kept
+    QCOMPARE(parallel.features.spotsCount(), SPOTS);
+    QVERIFY(parallel.features == sequential.features);
+    // the store must take less than 12 bytes per feature
+    QVERIFY(sequential.features.memoryUsage() < 12 * sequential.features.size());
+}
+
+void FeaturesParserTest::testMalformedData()
+{
+    // truncate the data (the array is not terminated)
+    data::ParsedFeatures parsed;
+    QVERIFY(!data::parseFeaturesParallel(m_rawData.left(m_rawData.size() - 10), parsed));
+
+    // trailing comma
+    QByteArray trailing = m_rawData;
+    trailing.insert(trailing.size() - 1, ',');
+    data::ParsedFeatures parsed_trailing;
+    QVERIFY(!data::parseFeaturesParallel(trailing, parsed_trailing));
+}
+
+void FeaturesParserTest::testStreamEqualsSequential()
+{
+    data::ParsedFeatures sequential;
+    QVERIFY(data::parseFeatures(m_rawData, sequential));
+
+    // feed the data in pieces that split objects, strings and escapes
+    const int piece_size = 4093;
+    data::FeaturesStreamParser parser;
+    parser.setTotalSize(m_rawData.size());
+    for (int pos = 0; pos < m_rawData.size(); pos += piece_size) {
+        QVERIFY(parser.append(m_rawData.mid(pos, piece_size)));
+    }
+    data::ParsedFeatures streamed;
+    QVERIFY(parser.finish(streamed));
+    QVERIFY(parser.future().isFinished());
+    QCOMPARE(parser.future().resultCount(), 1);
+    QVERIFY(streamed.genes == sequential.genes);
+    QVERIFY(streamed.features == sequential.features);
+
+    // the data is not complete
+    data::FeaturesStreamParser truncated_parser;
+    QVERIFY(truncated_parser.append(m_rawData.left(m_rawData.size() - 10)));
+    data::ParsedFeatures truncated;
+    QVERIFY(!truncated_parser.finish(truncated));
+}
+
+void FeaturesParserTest::testFeatureStore()
+{
+    // features of two spots added out of order
+    FeatureStoreBuilder builder;
+    builder.append(0, 1.0f, 1.0f, 10);
+    builder.append(1, 2.0f, 2.0f, 20);
+    builder.append(2, 1.0f, 1.0f, 30);
+    builder.append(1, 1.0f, 1.0f, 40);
+    const FeatureStore store = builder.build();
+    QCOMPARE(builder.size(), 0);
+    QCOMPARE(store.size(), 4);
+    QCOMPARE(store.spotsCount(), 2);
+    // the features are grouped by spot keeping their order
+    QCOMPARE(store.spotBegin(0), 0u);
+    QCOMPARE(store.spotEnd(0), 3u);
+    QCOMPARE(store.count(2), 40);
+    QCOMPARE(store.spot(3), 1u);
+    QCOMPARE(store.spotX(1), 2.0f);
+
+    // a view with all the features
+    const FeatureView all(store);
+    QCOMPARE(all.size(), 4);
+    int reads = 0;
+    for (const auto &feature : all) {
+        QCOMPARE(feature.spotIndex(), store.spot(feature.index()));
+        reads += feature.count();
+    }
+    QCOMPARE(reads, 100);
+
+    // a view with the features of the gene 1
+    const FeatureView gene(store, QVector<FeatureStore::FeatureIndex>() << 2 << 3);
+    QCOMPARE(gene.size(), 2);
+    QCOMPARE(gene.first().count(), 40);
+    QCOMPARE(gene.last().x(), 2.0f);
+    QVERIFY(gene.last().spot() == Feature::SpotType(2.0f, 2.0f));
+}
+
+void FeaturesParserTest::benchmarkSequential()
+{
+    QBENCHMARK
+    {
+        data::ParsedFeatures parsed;
+        data::parseFeatures(m_rawData, parsed);
+    }
+}
+
+void FeaturesParserTest::benchmarkParallel()
+{
+    QFETCH(int, threads);
+    QBENCHMARK
+    {
+        data::ParsedFeatures parsed;
+        data::parseFeaturesParallel(m_rawData, parsed, nullptr, threads);
+    }
+}
+
+void FeaturesParserTest::benchmarkParallel_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+    QTest::newRow("16 threads") << 16;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::FeaturesParserTest)
+#include "tst_featuresparsertest.moc"
@@ -0,0 +1,39 @@
+#ifndef TST_FEATURESPARSERTEST_H
+#define TST_FEATURESPARSERTEST_H
+
+#include <QObject>
+#include <QByteArray>
+
+namespace unit
+{
+
+// Tests and benchmarks of the features parsers (sequential, parallel and stream)
+// and the feature store they create
+class FeaturesParserTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FeaturesParserTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testParallelEqualsSequential();
+    void testMalformedData();
+    void testStreamEqualsSequential();
+    void testFeatureStore();
+
+    void benchmarkSequential();
+    void benchmarkParallel();
+    void benchmarkParallel_data();
+
+private:
+    // synthetic features data in JSON format
+    QByteArray m_rawData;
+};
+
+} // namespace unit //
+
+#endif // TST_FEATURESPARSERTEST_H
@@ -0,0 +1,327 @@
+#include <QtTest/QTest>
+#include <QJsonDocument>
+#include <QTransform>
+
+#include "data/ObjectBinder.h"
+#include "data/ObjectParser.h"
+#include "dataModel/ChipDTO.h"
+#include "dataModel/DatasetDTO.h"
+#include "dataModel/ImageAlignmentDTO.h"
+#include "dataModel/UserDTO.h"
+#include "dataModel/UserSelectionDTO.h"
+
+#include "tst_objectbindertest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// size of the synthetic lists
+const int DATASETS = 2000;
+const int SELECTIONS = 500;
+const int GENE_HITS = 50;
+
+QByteArray toJson(const QVariant &object)
+{
+    return QJsonDocument::fromVariant(object).toJson(QJsonDocument::Compact);
+}
+
+QVariantMap createDataset(const int index)
+{
+    QVariantMap dataset;
+    dataset.insert("id", QString("dataset%1").arg(index));
+    dataset.insert("name", QString("Dataset %1").arg(index));
+    dataset.insert("image_alignment_id", QString("alignment%1").arg(index));
+    dataset.insert("tissue", "Brain");
+    dataset.insert("species", "Mouse");
+    // some comments are null
+    dataset.insert("comment", index % 2 == 0 ? QVariant("Comment") : QVariant());
+    dataset.insert("enabled", true);
+    dataset.insert("granted_accounts", QVariantList() << "account1" << "account2");
+    dataset.insert("created_by_account_id", "account1");
+    dataset.insert("created_at", "2015-01-01");
+    dataset.insert("last_modified", QString("2015-02-%1").arg(index % 28 + 1));
+    // the unknown fields are skipped
+    QVariantMap extra;
+    extra.insert("nested", QVariantList() << 1 << QVariantList());
+    dataset.insert("extra", extra);
+    return dataset;
+}
+
+QVariantMap createSelection(const int index)
+{
+    QVariantMap selection;
+    selection.insert("id", QString("selection%1").arg(index));
+    selection.insert("name", QString("Selection %1").arg(index));
+    selection.insert("account_id", "account1");
+    selection.insert("dataset_id", QString("dataset%1").arg(index % 10));
+    // the features are stored as strings (see UserSelectionDTO)
+    QVariantList gene_hits;
+    for (int i = 0; i < GENE_HITS; ++i) {
+        gene_hits.append(QVariantList() << QString("Gene%1").arg(i) << QString::number(i * 10)
+                                        << QString::number(i) << QString::number(i + 1));
+    }
+    selection.insert("gene_hits", gene_hits);
+    selection.insert("type", index % 2 == 0 ? "Rubberband" : "Segmented");
+    selection.insert("status", "ok");
+    selection.insert("comment", "");
+    selection.insert("enabled", true);
+    selection.insert("created_at", "2015-01-01");
+    selection.insert("last_modified", "2015-02-01");
+    selection.insert("tissue_snapshot", QString("snapshot%1").arg(index));
+    return selection;
+}
+
+// the reflection path (the objects parsed with the DTOs)
+
+template <typename DTO>
+bool reflect(const QByteArray &json, DTO &dto)
+{
+    return data::parseObject(QJsonDocument::fromJson(json).toVariant(), &dto);
+}
+
+QList<Dataset> reflectDatasets(const QByteArray &json)
+{
+    QList<Dataset> datasets;
+    for (const QVariant &object : QJsonDocument::fromJson(json).toVariant().toList()) {
+        DatasetDTO dto;
+        data::parseObject(object, &dto);
+        datasets.append(dto.dataset());
+    }
+    return datasets;
+}
+
+QList<UserSelection> reflectSelections(const QByteArray &json)
+{
+    QList<UserSelection> selections;
+    for (const QVariant &object : QJsonDocument::fromJson(json).toVariant().toList()) {
+        UserSelectionDTO dto;
+        data::parseObject(object, &dto);
+        selections.append(dto.userSelection());
+    }
+    return selections;
+}
+}
+
+ObjectBinderTest::ObjectBinderTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ObjectBinderTest::initTestCase()
+{
+    QVariantList datasets;
+    for (int i = 0; i < DATASETS; ++i) {
+        datasets.append(createDataset(i));
+    }
+    m_datasets = toJson(datasets);
+
+    QVariantList selections;
+    for (int i = 0; i < SELECTIONS; ++i) {
+        selections.append(createSelection(i));
+    }
+    m_selections = toJson(selections);
+}
+
+void ObjectBinderTest::cleanupTestCase()
+{
+    m_datasets.clear();
+    m_selections.clear();
+}
+
+void ObjectBinderTest::testDatasets()
+{
+    QList<Dataset> datasets;
+    QVERIFY(data::bindObjects(m_datasets, datasets));
+    QCOMPARE(datasets.size(), DATASETS);
+    QVERIFY(datasets == reflectDatasets(m_datasets));
+
+    const Dataset &dataset = datasets.at(1);
+    QCOMPARE(dataset.id(), QString("dataset1"));
+    QCOMPARE(dataset.statTissue(), QString("Brain"));
+    QVERIFY(dataset.statComments().isNull());
+    QVERIFY(dataset.enabled());
+    QCOMPARE(dataset.grantedAccounts(), QVector<QString>() << "account1"
+                                                           << "account2");
+    QCOMPARE(dataset.lastModified(), QString("2015-02-2"));
+
+    // the datasets are appended to the ones given
+    QVERIFY(data::bindObjects(toJson(QVariantList() << createDataset(DATASETS)), datasets));
+    QCOMPARE(datasets.size(), DATASETS + 1);
+}
+
+void ObjectBinderTest::testUserSelections()
+{
+    QList<UserSelection> selections;
+    QVERIFY(data::bindObjects(m_selections, selections));
+    QCOMPARE(selections.size(), SELECTIONS);
+    QVERIFY(selections == reflectSelections(m_selections));
+
+    const UserSelection &selection = selections.at(3);
+    QCOMPARE(selection.userId(), QString("account1"));
+    QCOMPARE(selection.datasetId(), QString("dataset3"));
+    QCOMPARE(selection.type(), UserSelection::Segmented);
+    QCOMPARE(selection.totalFeatures(), GENE_HITS);
+    QCOMPARE(selection.geneDictionary().size(), GENE_HITS);
+    QCOMPARE(selection.tissueSnapShot(), QByteArray("snapshot3"));
+}
+
+void ObjectBinderTest::testObjects()
+{
+    QVariantMap chip_object;
+    chip_object.insert("id", "chip1");
+    chip_object.insert("name", "Chip 1");
+    chip_object.insert("barcodes", 1007);
+    chip_object.insert("x1", 1);
+    chip_object.insert("x2", 33);
+    chip_object.insert("y1", 1);
+    chip_object.insert("y2", 35);
+    chip_object.insert("x1_border", 0);
+    chip_object.insert("x2_border", 34);
+    chip_object.insert("y1_border", 0);
+    chip_object.insert("y2_border", 36);
+    chip_object.insert("x1_total", 0);
+    chip_object.insert("x2_total", 35);
+    chip_object.insert("y1_total", 0);
+    chip_object.insert("y2_total", 37);
+    const QByteArray chip_json = toJson(chip_object);
+    Chip chip;
+    ChipDTO chip_dto;
+    QVERIFY(data::bindObject(chip_json, chip));
+    QVERIFY(reflect(chip_json, chip_dto));
+    QVERIFY(chip == chip_dto.chip());
+    QCOMPARE(chip.spots(), 1007);
+    QCOMPARE(chip.y2Total(), 37);
+
+    QVariantMap alignment_object;
+    alignment_object.insert("id", "alignment1");
+    alignment_object.insert("chip_id", "chip1");
+    alignment_object.insert("figure_red", "red.jpg");
+    alignment_object.insert("figure_blue", "blue.jpg");
+    // the matrix is in column-major order
+    alignment_object.insert("alignment_matrix",
+                            QVariantList() << 2 << 0 << 10.5 << 0 << 3 << 20 << 0 << 0 << 1);
+    const QByteArray alignment_json = toJson(alignment_object);
+    ImageAlignment alignment;
+    ImageAlignmentDTO alignment_dto;
+    QVERIFY(data::bindObject(alignment_json, alignment));
+    QVERIFY(reflect(alignment_json, alignment_dto));
+    QVERIFY(alignment == alignment_dto.imageAlignment());
+    QCOMPARE(alignment.alignment(), QTransform(2, 0, 0, 0, 3, 0, 10.5, 20, 1));
+    QCOMPARE(alignment.figureBlue(), QString("blue.jpg"));
+
+    QVariantMap user_object;
+    user_object.insert("id", "user1");
+    user_object.insert("username", "user@st.se");
+    user_object.insert("first_name", "First");
+    user_object.insert("last_name", "Last");
+    user_object.insert("street_address", "Street 1");
+    user_object.insert("postcode", 12345);
+    user_object.insert("role", "ROLE_CM");
+    user_object.insert("enabled", true);
+    user_object.insert("granted_datasets", QVariantList() << "dataset1");
+    const QByteArray user_json = toJson(user_object);
+    User user;
+    UserDTO user_dto;
+    QVERIFY(data::bindObject(user_json, user));
+    QVERIFY(reflect(user_json, user_dto));
+    QVERIFY(user == user_dto.user());
+    QCOMPARE(user.secondName(), QString("Last"));
+    QCOMPARE(user.postcode(), 12345);
+    QCOMPARE(user.grantedDatasets(), QVector<QString>() << "dataset1");
+}
+
+void ObjectBinderTest::testConversions()
+{
+    // the values are converted to the types of the fields as QVariant does
+    const QByteArray json("{\"id\": 12, \"name\": null, \"enabled\": \"false\", "
+                          "\"granted_accounts\": [\"a\", 2, true], \"tissue\": [\"skipped\"]}");
+    Dataset dataset;
+    DatasetDTO dto;
+    QVERIFY(data::bindObject(json, dataset));
+    QVERIFY(reflect(json, dto));
+    QCOMPARE(dataset.id(), QString("12"));
+    QVERIFY(dataset.name().isNull());
+    QVERIFY(!dataset.enabled());
+    QCOMPARE(dataset.grantedAccounts(), QVector<QString>() << "a"
+                                                           << "2"
+                                                           << "true");
+    QCOMPARE(dataset.id(), dto.dataset().id());
+    QCOMPARE(dataset.enabled(), dto.dataset().enabled());
+
+    User user;
+    QVERIFY(data::bindObject("{\"postcode\": \"12345\", \"enabled\": 1}", user));
+    QCOMPARE(user.postcode(), 12345);
+    QVERIFY(user.enabled());
+}
+
+void ObjectBinderTest::testMalformedData()
+{
+    Dataset dataset;
+    QVERIFY(!data::bindObject(QByteArray(), dataset));
+    QVERIFY(!data::bindObject("{\"id\": \"1\"", dataset));
+    QVERIFY(!data::bindObject("{\"id\": \"1\"} {}", dataset));
+    // an array where an object is expected
+    QVERIFY(!data::bindObject("[{\"id\": \"1\"}]", dataset));
+
+    QList<Dataset> datasets;
+    QVERIFY(!data::bindObjects("{\"id\": \"1\"}", datasets));
+    QVERIFY(!data::bindObjects("[1, 2]", datasets));
+    QVERIFY(!data::bindObjects("[[{\"id\": \"1\"}]]", datasets));
+    QVERIFY(datasets.isEmpty());
+    QVERIFY(data::bindObjects("[]", datasets));
+    QVERIFY(datasets.isEmpty());
+}
+
+void ObjectBinderTest::benchmarkReflection()
+{
+    QFETCH(bool, selections);
+    if (selections) {
+        QBENCHMARK
+        {
+            reflectSelections(m_selections);
+        }
+    } else {
+        QBENCHMARK
+        {
+            reflectDatasets(m_datasets);
+        }
+    }
+}
+
+void ObjectBinderTest::benchmarkReflection_data()
+{
+    QTest::addColumn<bool>("selections");
+    QTest::newRow("datasets") << false;
+    QTest::newRow("selections") << true;
+}
+
+void ObjectBinderTest::benchmarkBinder()
+{
+    QFETCH(bool, selections);
+    if (selections) {
+        QBENCHMARK
+        {
+            QList<UserSelection> parsed;
+            data::bindObjects(m_selections, parsed);
+        }
+    } else {
+        QBENCHMARK
+        {
+            QList<Dataset> parsed;
+            data::bindObjects(m_datasets, parsed);
+        }
+    }
+}
+
+void ObjectBinderTest::benchmarkBinder_data()
+{
+    benchmarkReflection_data();
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::ObjectBinderTest)
+#include "tst_objectbindertest.moc"
@@ -0,0 +1,42 @@
+#ifndef TST_OBJECTBINDERTEST_H
+#define TST_OBJECTBINDERTEST_H
+
+#include <QObject>
+#include <QByteArray>
+
+namespace unit
+{
+
+// Tests of the object binder (the objects must be the same as the ones parsed
+// with the DTOs) and benchmarks of the binder against the reflection path
+class ObjectBinderTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ObjectBinderTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testDatasets();
+    void testUserSelections();
+    void testObjects();
+    void testConversions();
+    void testMalformedData();
+
+    void benchmarkReflection();
+    void benchmarkReflection_data();
+    void benchmarkBinder();
+    void benchmarkBinder_data();
+
+private:
+    // synthetic lists of datasets and selections in JSON format
+    QByteArray m_datasets;
+    QByteArray m_selections;
+};
+
+} // namespace unit //
+
+#endif // TST_OBJECTBINDERTEST_H
@@ -0,0 +1,128 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+
+#include "data/OfflineStore.h"
+
+#include "DatasetContentFixture.h"
+#include "tst_offlinestoretest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+User createUser(const QString &id)
+{
+    User user;
+    user.id(id);
+    user.username("user " + id);
+    return user;
+}
+
+Dataset createDataset(const QString &id, const QString &lastModified)
+{
+    Dataset dataset;
+    dataset.id(id);
+    dataset.name("dataset " + id);
+    dataset.lastModified(lastModified);
+    return dataset;
+}
+
+}
+
+OfflineStoreTest::OfflineStoreTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void OfflineStoreTest::testPinAndLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    {
+        OfflineStore store(dir.path());
+        QVERIFY(store.isEmpty());
+        QVERIFY(!store.hasUser());
+        store.setUser(createUser("user"));
+        store.pinDataset(createDataset("dataset", "1"));
+        UserSelection selection;
+        selection.id("selection");
+        selection.datasetId("dataset");
+        selection.name("selection");
+        store.pinSelection(selection);
+        QVERIFY(!store.isEmpty());
+    }
+
+    // the pinned objects are loaded by another instance
+    OfflineStore store(dir.path());
+    QVERIFY(store.hasUser());
+    QCOMPARE(store.user().id(), QString("user"));
+    QCOMPARE(store.user().username(), QString("user user"));
+    QVERIFY(store.isDatasetPinned("dataset"));
+    QCOMPARE(store.pinnedDatasets().size(), 1);
+    QCOMPARE(store.pinnedDatasets().first().name(), QString("dataset dataset"));
+    QCOMPARE(store.pinnedDatasets().first().lastModified(), QString("1"));
+    QVERIFY(store.isSelectionPinned("selection"));
+    QCOMPARE(store.pinnedSelections().size(), 1);
+    QCOMPARE(store.pinnedSelections().first().datasetId(), QString("dataset"));
+    QVERIFY(store.pinnedSelections().first().saved());
+
+    store.unpinDataset("dataset");
+    store.unpinSelection("selection");
+    QVERIFY(store.isEmpty());
+    QVERIFY(OfflineStore(dir.path()).isEmpty());
+}
+
+void OfflineStoreTest::testContent()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    OfflineStore store(dir.path());
+    store.setUser(createUser("user"));
+
+    // only the content of the pinned datasets is stored
+    const DatasetContentCache::Content written = createDatasetContent("1");
+    QVERIFY(!store.writeContent("dataset", written));
+    store.pinDataset(createDataset("dataset", "1"));
+    QVERIFY(!store.hasContent("dataset", "1"));
+    QVERIFY(store.writeContent("dataset", written));
+    QVERIFY(store.hasContent("dataset", "1"));
+    QVERIFY(!store.hasContent("dataset", "2"));
+
+    DatasetContentCache::Content content;
+    QVERIFY(store.readContent("dataset", "1", content));
+    QVERIFY(content.features == written.features);
+    QVERIFY(*content.chip == *written.chip);
+    QVERIFY(content.images == written.images);
+
+    // the content is removed with the dataset
+    store.unpinDataset("dataset");
+    store.pinDataset(createDataset("dataset", "1"));
+    QVERIFY(!store.hasContent("dataset", "1"));
+}
+
+void OfflineStoreTest::testOtherUser()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    OfflineStore store(dir.path());
+    store.setUser(createUser("user"));
+    store.pinDataset(createDataset("dataset", "1"));
+    QVERIFY(store.writeContent("dataset", createDatasetContent("1")));
+
+    // the same user keeps the pinned content
+    store.setUser(createUser("user"));
+    QVERIFY(store.hasContent("dataset", "1"));
+
+    // the content pinned by another user is removed
+    store.setUser(createUser("other"));
+    QVERIFY(store.isEmpty());
+    QVERIFY(!store.hasContent("dataset", "1"));
+    QCOMPARE(OfflineStore(dir.path()).user().id(), QString("other"));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::OfflineStoreTest)
+#include "tst_offlinestoretest.moc"
@@ -0,0 +1,24 @@
+#ifndef TST_OFFLINESTORETEST_H
+#define TST_OFFLINESTORETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class OfflineStoreTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OfflineStoreTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void testPinAndLoad();
+    void testContent();
+    void testOtherUser();
+};
+
+} // namespace unit //
+
+#endif // TST_OFFLINESTORETEST_H
@@ -0,0 +1,189 @@
+#include <QtTest/QTest>
+#include <QMultiHash>
+
+#include "dataModel/SpotGeneMatrix.h"
+
+#include "tst_spotgenematrixtest.h"
+
+namespace unit
+{
+
+// size of the synthetic dataset (spots x genes features)
+static const int SPOTS = 5000;
+static const int GENES_PER_SPOT = 200;
+static const int GENES = 20000;
+// reads threshold of the benchmarks
+static const int THRESHOLD = 50;
+
+// each spot is its own row
+static QVector<int> identityRows(const int spots)
+{
+    QVector<int> rows(spots);
+    for (int spot = 0; spot < spots; ++spot) {
+        rows[spot] = spot;
+    }
+    return rows;
+}
+
+SpotGeneMatrixTest::SpotGeneMatrixTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void SpotGeneMatrixTest::initTestCase()
+{
+    FeatureStoreBuilder builder;
+    builder.reserve(SPOTS * GENES_PER_SPOT);
+    for (int spot = 0; spot < SPOTS; ++spot) {
+        for (int gene = 0; gene < GENES_PER_SPOT; ++gene) {
+            builder.append(static_cast<GeneDictionary::GeneId>((spot * 7 + gene * 97) % GENES),
+                           spot % 70,
+                           spot / 70,
+                           (spot + gene) % 100 + 1);
+        }
+    }
+    m_store = builder.build();
+}
+
+void SpotGeneMatrixTest::cleanupTestCase()
+{
+    m_store = FeatureStore();
+}
+
+void SpotGeneMatrixTest::testRows()
+{
+    // three spots where the first and the last are the same row
+    FeatureStoreBuilder builder;
+    builder.append(0, 1.0f, 1.0f, 5);
+    builder.append(2, 1.0f, 1.0f, 1);
+    builder.append(1, 2.0f, 2.0f, 7);
+    builder.append(2, 3.0f, 3.0f, 2);
+    builder.append(3, 3.0f, 3.0f, 4);
+    const FeatureStore store = builder.build();
+    const SpotGeneMatrix matrix(store, QVector<int>() << 1 << 0 << 1, 2);
+    QCOMPARE(matrix.rows(), 2);
+    QCOMPARE(matrix.columns(), 4);
+    QCOMPARE(matrix.size(), 5);
+
+    QCOMPARE(matrix.rowGenes(0), 1);
+    QCOMPARE(matrix.rowReads(0), 7);
+    QCOMPARE(matrix.geneId(matrix.rowBegin(0)), 1u);
+    QCOMPARE(matrix.feature(matrix.rowBegin(0)), 2u);
+
+    // the features of the spots of a row are kept in order
+    QCOMPARE(matrix.rowGenes(1), 4);
+    QCOMPARE(matrix.rowReads(1), 12);
+    QVector<FeatureStore::FeatureIndex> features;
+    for (auto entry = matrix.rowBegin(1); entry < matrix.rowEnd(1); ++entry) {
+        QCOMPARE(matrix.geneId(entry), store.geneId(matrix.feature(entry)));
+        QCOMPARE(matrix.count(entry), store.count(matrix.feature(entry)));
+        features.append(matrix.feature(entry));
+    }
+    QCOMPARE(features, QVector<FeatureStore::FeatureIndex>() << 0 << 1 << 3 << 4);
+}
+
+void SpotGeneMatrixTest::testGenes()
+{
+    const SpotGeneMatrix matrix(m_store, identityRows(SPOTS), SPOTS);
+    QCOMPARE(matrix.size(), SPOTS * GENES_PER_SPOT);
+
+    // the transpose has the same entries grouped by gene with the rows sorted
+    int entries = 0;
+    for (int gene = 0; gene < matrix.columns(); ++gene) {
+        const auto gene_id = static_cast<GeneDictionary::GeneId>(gene);
+        for (auto entry = matrix.geneBegin(gene_id); entry < matrix.geneEnd(gene_id); ++entry) {
+            if (entry > matrix.geneBegin(gene_id)) {
+                QVERIFY(matrix.geneRow(entry - 1) <= matrix.geneRow(entry));
+            }
+            ++entries;
+        }
+    }
+    QCOMPARE(entries, matrix.size());
+
+    // the counts of a gene are the same in both directions
+    const GeneDictionary::GeneId gene = 97;
+    int reads = 0;
+    for (int row = 0; row < matrix.rows(); ++row) {
+        for (auto entry = matrix.rowBegin(row); entry < matrix.rowEnd(row); ++entry) {
+            if (matrix.geneId(entry) == gene) {
+                reads += matrix.count(entry);
+            }
+        }
+    }
+    int gene_reads = 0;
+    for (auto entry = matrix.geneBegin(gene); entry < matrix.geneEnd(gene); ++entry) {
+        gene_reads += matrix.geneCount(entry);
+    }
+    QVERIFY(reads > 0);
+    QCOMPARE(gene_reads, reads);
+
+    // the genes not present have no entries
+    const auto missing = static_cast<GeneDictionary::GeneId>(GENES + 1);
+    QCOMPARE(matrix.geneBegin(missing), matrix.geneEnd(missing));
+}
+
+void SpotGeneMatrixTest::testEmpty()
+{
+    const SpotGeneMatrix empty;
+    QVERIFY(empty.isEmpty());
+    QCOMPARE(empty.rows(), 0);
+    QCOMPARE(empty.columns(), 0);
+    QCOMPARE(empty.geneBegin(0), empty.geneEnd(0));
+
+    const SpotGeneMatrix matrix(FeatureStore(), QVector<int>(), 0);
+    QVERIFY(matrix.isEmpty());
+    QCOMPARE(matrix.rows(), 0);
+}
+
+void SpotGeneMatrixTest::benchmarkHashes()
+{
+    // the lookup containers the renderer used before the matrix
+    QMultiHash<int, FeatureStore::FeatureIndex> features_by_index;
+    QHash<int, int> total_reads;
+    for (FeatureStore::SpotIndex spot = 0; spot < static_cast<FeatureStore::SpotIndex>(SPOTS);
+         ++spot) {
+        const int index = static_cast<int>(spot);
+        for (auto feature = m_store.spotBegin(spot); feature < m_store.spotEnd(spot); ++feature) {
+            features_by_index.insert(index, feature);
+            total_reads[index] += m_store.count(feature);
+        }
+    }
+    int visible = 0;
+    QBENCHMARK
+    {
+        visible = 0;
+        for (int index = 0; index < SPOTS; ++index) {
+            if (total_reads.value(index) < THRESHOLD) {
+                continue;
+            }
+            for (const auto feature : features_by_index.values(index)) {
+                visible += m_store.count(feature) >= THRESHOLD ? 1 : 0;
+            }
+        }
+    }
+    QVERIFY(visible > 0);
+}
+
+void SpotGeneMatrixTest::benchmarkMatrix()
+{
+    const SpotGeneMatrix matrix(m_store, identityRows(SPOTS), SPOTS);
+    int visible = 0;
+    QBENCHMARK
+    {
+        visible = 0;
+        for (int index = 0; index < SPOTS; ++index) {
+            if (matrix.rowReads(index) < THRESHOLD) {
+                continue;
+            }
+            for (auto entry = matrix.rowBegin(index); entry < matrix.rowEnd(index); ++entry) {
+                visible += matrix.count(entry) >= THRESHOLD ? 1 : 0;
+            }
+        }
+    }
+    QVERIFY(visible > 0);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::SpotGeneMatrixTest)
+#include "tst_spotgenematrixtest.moc"
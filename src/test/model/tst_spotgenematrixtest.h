@@ -0,0 +1,38 @@
+#ifndef TST_SPOTGENEMATRIXTEST_H
+#define TST_SPOTGENEMATRIXTEST_H
+
+#include <QObject>
+
+#include "dataModel/FeatureStore.h"
+
+namespace unit
+{
+
+// Tests of the spot x gene matrix of the renderer and benchmarks of a
+// threshold pass over its rows against the hash containers it replaces
+class SpotGeneMatrixTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpotGeneMatrixTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRows();
+    void testGenes();
+    void testEmpty();
+
+    void benchmarkHashes();
+    void benchmarkMatrix();
+
+private:
+    // synthetic features (spots x genes)
+    FeatureStore m_store;
+};
+
+} // namespace unit //
+
+#endif // TST_SPOTGENEMATRIXTEST_H
@@ -0,0 +1,141 @@
+#include "MockFileServer.h"
+
+#include <QTcpSocket>
+#include <QUrl>
+
+namespace unit
+{
+
+MockFileServer::MockFileServer(QObject *parent)
+    : QTcpServer(parent)
+    , m_file()
+    , m_etag()
+    , m_version(0)
+    , m_rangesEnabled(true)
+    , m_failures(0)
+    , m_requests(0)
+    , m_rangeRequests(0)
+    , m_bytesSent(0)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(slotNewConnection()));
+}
+
+MockFileServer::~MockFileServer()
+{
+}
+
+void MockFileServer::setFile(const QByteArray &file)
+{
+    m_file = file;
+    ++m_version;
+    m_etag = "\"file" + QByteArray::number(m_version) + '"';
+}
+
+void MockFileServer::setRangesEnabled(const bool enabled)
+{
+    m_rangesEnabled = enabled;
+}
+
+void MockFileServer::failRanges(const int count)
+{
+    m_failures = count;
+}
+
+int MockFileServer::requests() const
+{
+    return m_requests;
+}
+
+int MockFileServer::rangeRequests() const
+{
+    return m_rangeRequests;
+}
+
+qint64 MockFileServer::bytesSent() const
+{
+    return m_bytesSent;
+}
+
+QUrl MockFileServer::url() const
+{
+    return QUrl(QString("http://127.0.0.1:%1/api/figure?access_token=token").arg(serverPort()));
+}
+
+void MockFileServer::slotNewConnection()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void MockFileServer::slotReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    Q_ASSERT(socket);
+    // the requests are GET so they end with an empty line
+    QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+    int end = buffer.indexOf("\r\n\r\n");
+    while (end != -1 && socket->state() == QAbstractSocket::ConnectedState) {
+        const QList<QByteArray> lines = buffer.left(end).split('\n');
+        buffer.remove(0, end + 4);
+        end = buffer.indexOf("\r\n\r\n");
+
+        QHash<QByteArray, QByteArray> headers;
+        for (int i = 1; i < lines.size(); ++i) {
+            const int separator = lines.at(i).indexOf(':');
+            if (separator > 0) {
+                headers.insert(lines.at(i).left(separator).trimmed().toLower(),
+                               lines.at(i).mid(separator + 1).trimmed());
+            }
+        }
+        respond(socket, headers);
+    }
+    socket->setProperty("buffer", buffer);
+}
+
+void MockFileServer::respond(QTcpSocket *socket, const QHash<QByteArray, QByteArray> &headers)
+{
+    ++m_requests;
+    QByteArray status = "200 OK";
+    QByteArray body = m_file;
+    QByteArray content_range;
+
+    // "bytes=FROM-TO"
+    const QByteArray range = headers.value("range");
+    const bool if_range = !headers.contains("if-range") || headers.value("if-range") == m_etag;
+    if (m_rangesEnabled && range.startsWith("bytes=") && if_range) {
+        ++m_rangeRequests;
+        const QList<QByteArray> limits = range.mid(6).split('-');
+        const qint64 from = limits.value(0).toLongLong();
+        const qint64 to = qMin(limits.value(1).toLongLong(), static_cast<qint64>(m_file.size()) - 1);
+        status = "206 Partial Content";
+        body = m_file.mid(static_cast<int>(from), static_cast<int>(to - from + 1));
+        content_range = "bytes " + QByteArray::number(from) + '-' + QByteArray::number(to) + '/'
+                        + QByteArray::number(m_file.size());
+    }
+
+    QByteArray data = "HTTP/1.1 " + status + "\r\n";
+    data += "Content-Type: image/jpeg\r\n";
+    data += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    data += "ETag: " + m_etag + "\r\n";
+    if (!content_range.isEmpty()) {
+        data += "Content-Range: " + content_range + "\r\n";
+    }
+    data += "\r\n";
+
+    // the connection is closed in the middle of the body
+    if (!content_range.isEmpty() && m_failures > 0) {
+        --m_failures;
+        body.truncate(body.size() / 2);
+        socket->write(data + body);
+        m_bytesSent += body.size();
+        socket->disconnectFromHost();
+        return;
+    }
+    socket->write(data + body);
+    m_bytesSent += body.size();
+}
+
+} // namespace unit //
@@ -0,0 +1,62 @@
+#ifndef MOCKFILESERVER_H
+#define MOCKFILESERVER_H
+
+#include <QTcpServer>
+#include <QHash>
+#include <QByteArray>
+
+class QTcpSocket;
+
+namespace unit
+{
+
+// Minimal HTTP server serving a file (any byte array) on any GET path
+// to test the range downloads (see RangeNetworkReply):
+// - answers the Range header with 206 Partial Content if ranges are enabled
+//   and the If-Range header (if any) has the current ETag
+// - answers the whole file otherwise
+// - can close the connection in the middle of the next range responses
+// Each change of the file changes its ETag.
+class MockFileServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit MockFileServer(QObject *parent = 0);
+    ~MockFileServer();
+
+    void setFile(const QByteArray &file);
+    void setRangesEnabled(const bool enabled);
+    // the next range responses given are cut in half
+    void failRanges(const int count);
+
+    // requests answered so far
+    int requests() const;
+    // range requests answered so far (including the failed ones)
+    int rangeRequests() const;
+    // bytes of the bodies sent so far
+    qint64 bytesSent() const;
+    // the URL of the file
+    QUrl url() const;
+
+private slots:
+    void slotNewConnection();
+    void slotReadyRead();
+
+private:
+    // answers the request given by its headers
+    void respond(QTcpSocket *socket, const QHash<QByteArray, QByteArray> &headers);
+
+    QByteArray m_file;
+    QByteArray m_etag;
+    int m_version;
+    bool m_rangesEnabled;
+    int m_failures;
+    int m_requests;
+    int m_rangeRequests;
+    qint64 m_bytesSent;
+};
+
+} // namespace unit //
+
+#endif // MOCKFILESERVER_H
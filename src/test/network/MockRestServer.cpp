@@ -0,0 +1,166 @@
+#include "MockRestServer.h"
+
+#include <QTcpSocket>
+#include <QJsonDocument>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QDateTime>
+#include <QLocale>
+
+namespace unit
+{
+
+namespace
+{
+
+const QString HTTP_DATE_FORMAT = QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+
+// the version of the list as an HTTP date (for the headers)
+QString versionToDate(const int version)
+{
+    return QLocale::c().toString(QDateTime::fromTime_t(version).toUTC(), HTTP_DATE_FORMAT);
+}
+
+// the version of an object or the list as the time of the server (ISO 8601)
+QString versionToTime(const int version)
+{
+    return QDateTime::fromTime_t(version).toUTC().toString(Qt::ISODate);
+}
+
+// the version of a time of the server (-1 if not valid)
+int timeToVersion(const QString &time)
+{
+    const QDateTime date = QDateTime::fromString(time, Qt::ISODate);
+    if (!date.isValid()) {
+        return -1;
+    }
+    return static_cast<int>(date.toTime_t());
+}
+}
+
+MockRestServer::MockRestServer(QObject *parent)
+    : QTcpServer(parent)
+    , m_objects()
+    , m_removed()
+    , m_version(1)
+    , m_bytesSent(0)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(slotNewConnection()));
+}
+
+MockRestServer::~MockRestServer()
+{
+}
+
+void MockRestServer::setObject(const QVariantMap &object)
+{
+    ++m_version;
+    const QString id = object.value("id").toString();
+    QVariantMap versioned = object;
+    versioned.insert("last_modified", versionToTime(m_version));
+    m_objects.insert(id, qMakePair(versioned, m_version));
+    m_removed.remove(id);
+}
+
+void MockRestServer::removeObject(const QString &id)
+{
+    ++m_version;
+    m_objects.remove(id);
+    m_removed.insert(id, m_version);
+}
+
+qint64 MockRestServer::bytesSent() const
+{
+    return m_bytesSent;
+}
+
+QUrl MockRestServer::url() const
+{
+    return QUrl(QString("http://127.0.0.1:%1/api/selections").arg(serverPort()));
+}
+
+void MockRestServer::slotNewConnection()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void MockRestServer::slotReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    Q_ASSERT(socket);
+    // the requests are GET so they end with an empty line
+    QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+    int end = buffer.indexOf("\r\n\r\n");
+    while (end != -1) {
+        const QList<QByteArray> lines = buffer.left(end).split('\n');
+        buffer.remove(0, end + 4);
+        end = buffer.indexOf("\r\n\r\n");
+
+        const QList<QByteArray> request_line = lines.first().trimmed().split(' ');
+        if (request_line.size() < 2) {
+            continue;
+        }
+        QHash<QByteArray, QByteArray> headers;
+        for (int i = 1; i < lines.size(); ++i) {
+            const int separator = lines.at(i).indexOf(':');
+            if (separator > 0) {
+                headers.insert(lines.at(i).left(separator).trimmed().toLower(),
+                               lines.at(i).mid(separator + 1).trimmed());
+            }
+        }
+        const QByteArray data = response(request_line.at(1), headers);
+        m_bytesSent += data.size();
+        socket->write(data);
+    }
+    socket->setProperty("buffer", buffer);
+}
+
+QByteArray MockRestServer::response(const QByteArray &target,
+                                    const QHash<QByteArray, QByteArray> &headers)
+{
+    const QByteArray etag = '"' + QByteArray::number(m_version) + '"';
+    QByteArray status = "200 OK";
+    QByteArray body;
+    if (headers.value("if-none-match") == etag) {
+        status = "304 Not Modified";
+    } else {
+        const QUrlQuery query(QUrl::fromEncoded(target));
+        const int since
+            = timeToVersion(query.queryItemValue("modified_since", QUrl::FullyDecoded));
+        QVariantList modified;
+        for (const auto &object : m_objects) {
+            if (object.second > since) {
+                modified.append(object.first);
+            }
+        }
+        if (since == -1) {
+            body = QJsonDocument::fromVariant(modified).toJson(QJsonDocument::Compact);
+        } else {
+            QStringList removed;
+            for (auto it = m_removed.constBegin(); it != m_removed.constEnd(); ++it) {
+                if (it.value() > since) {
+                    removed.append(it.key());
+                }
+            }
+            QVariantMap delta;
+            delta.insert("last_modified", versionToTime(m_version));
+            delta.insert("modified", modified);
+            delta.insert("removed", removed);
+            body = QJsonDocument::fromVariant(delta).toJson(QJsonDocument::Compact);
+        }
+    }
+
+    QByteArray data = "HTTP/1.1 " + status + "\r\n";
+    data += "Content-Type: application/json\r\n";
+    data += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    data += "ETag: " + etag + "\r\n";
+    data += "Last-Modified: " + versionToDate(m_version).toLatin1() + "\r\n";
+    data += "\r\n";
+    return data + body;
+}
+
+} // namespace unit //
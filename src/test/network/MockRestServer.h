@@ -0,0 +1,56 @@
+#ifndef MOCKRESTSERVER_H
+#define MOCKRESTSERVER_H
+
+#include <QTcpServer>
+#include <QHash>
+#include <QVariantMap>
+
+class QTcpSocket;
+
+namespace unit
+{
+
+// Minimal HTTP server serving a list of JSON objects on any GET path
+// to measure what refreshing the list transfers (see SyncState):
+// - answers 304 if the If-None-Match header has the current ETag
+// - answers the changes as {"last_modified", "modified", "removed"} if the
+//   modified_since query item is present
+// - answers the whole list otherwise
+// Each change increases the version of the list, which is given as the ETag
+// and as the Last-Modified time (seconds since the epoch)
+class MockRestServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit MockRestServer(QObject *parent = 0);
+    ~MockRestServer();
+
+    // adds or replaces the object (it must have an "id" field)
+    void setObject(const QVariantMap &object);
+    void removeObject(const QString &id);
+
+    // bytes of the responses (headers and bodies) sent so far
+    qint64 bytesSent() const;
+    // the URL of the list
+    QUrl url() const;
+
+private slots:
+    void slotNewConnection();
+    void slotReadyRead();
+
+private:
+    // answers the request given by its target (path and query) and headers
+    QByteArray response(const QByteArray &target, const QHash<QByteArray, QByteArray> &headers);
+
+    // the objects with the version they were modified in
+    QHash<QString, QPair<QVariantMap, int>> m_objects;
+    // the IDs of the objects removed with the version they were removed in
+    QHash<QString, int> m_removed;
+    int m_version;
+    qint64 m_bytesSent;
+};
+
+} // namespace unit //
+
+#endif // MOCKRESTSERVER_H
@@ -0,0 +1,120 @@
+#include <QtTest/QTest>
+#include <QJsonDocument>
+#include <QVariantMap>
+
+#include "network/HttpCompression.h"
+
+#include "tst_httpcompressiontest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+quint32 readLittleEndian(const QByteArray &data, const int offset)
+{
+    quint32 value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<quint8>(data.at(offset + i));
+    }
+    return value;
+}
+
+void appendBigEndian(QByteArray &data, const quint32 value)
+{
+    for (int i = 3; i >= 0; --i) {
+        data.append(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+quint32 adler32(const QByteArray &data)
+{
+    quint32 a = 1;
+    quint32 b = 0;
+    for (const char byte : data) {
+        a = (a + static_cast<quint8>(byte)) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// checks the gzip data is the data given compressed: the header and trailer
+// are checked and the deflate data is decompressed with qUncompress()
+// (wrapped with the size, zlib header and Adler-32 checksum it expects)
+bool isGzipOf(const QByteArray &gzip_data, const QByteArray &data)
+{
+    if (gzip_data.size() < 18 || static_cast<quint8>(gzip_data.at(0)) != 0x1f
+        || static_cast<quint8>(gzip_data.at(1)) != 0x8b || gzip_data.at(2) != 8
+        || readLittleEndian(gzip_data, gzip_data.size() - 8) != Network::crc32(data)
+        || readLittleEndian(gzip_data, gzip_data.size() - 4)
+               != static_cast<quint32>(data.size())) {
+        return false;
+    }
+    QByteArray zlib_data;
+    appendBigEndian(zlib_data, static_cast<quint32>(data.size()));
+    zlib_data.append("\x78\x9c", 2);
+    zlib_data.append(gzip_data.mid(10, gzip_data.size() - 18));
+    appendBigEndian(zlib_data, adler32(data));
+    return qUncompress(zlib_data) == data;
+}
+
+// a selection as it is uploaded (gene hits and tissue snapshot)
+QByteArray createSelection()
+{
+    QVariantList gene_hits;
+    for (int i = 0; i < 20000; ++i) {
+        gene_hits.append(QVariantList() << QString("Gene%1").arg(i % 3000)
+                                        << QString::number(i % 97) << QString::number(i % 13)
+                                        << QString::number(i % 7));
+    }
+    QVariantMap selection;
+    selection.insert("name", "Selection");
+    selection.insert("gene_hits", gene_hits);
+    selection.insert("tissue_snapshot", QString(64 * 1024, QChar('A')));
+    return QJsonDocument::fromVariant(selection).toJson(QJsonDocument::Compact);
+}
+}
+
+HttpCompressionTest::HttpCompressionTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void HttpCompressionTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void HttpCompressionTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void HttpCompressionTest::testCrc32()
+{
+    // the check value of CRC-32
+    QCOMPARE(Network::crc32("123456789"), 0xcbf43926u);
+    QCOMPARE(Network::crc32(QByteArray()), 0u);
+}
+
+void HttpCompressionTest::testGzip()
+{
+    const QByteArray text = "Spatial transcriptomics viewer";
+    QVERIFY(isGzipOf(Network::gzip(text), text));
+    QVERIFY(isGzipOf(Network::gzip(text, 9), text));
+    QVERIFY(isGzipOf(Network::gzip(QByteArray()), QByteArray()));
+}
+
+void HttpCompressionTest::testGzipSelection()
+{
+    const QByteArray selection = createSelection();
+    const QByteArray compressed = Network::gzip(selection);
+    QVERIFY(isGzipOf(compressed, selection));
+    QVERIFY(compressed.size() * 4 < selection.size());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::HttpCompressionTest)
+#include "tst_httpcompressiontest.moc"
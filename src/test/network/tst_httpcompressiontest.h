@@ -0,0 +1,27 @@
+#ifndef TST_HTTPCOMPRESSIONTEST_H
+#define TST_HTTPCOMPRESSIONTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class HttpCompressionTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HttpCompressionTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testCrc32();
+    void testGzip();
+    void testGzipSelection();
+};
+
+} // namespace unit //
+
+#endif // TST_HTTPCOMPRESSIONTEST_H
@@ -0,0 +1,255 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QNetworkCacheMetaData>
+#include <QScopedPointer>
+
+#include "network/NetworkDiskCache.h"
+
+#include "tst_networkdiskcachetest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// features of a dataset as the server sends them (~1MB)
+QByteArray createFeatures()
+{
+    QVariantList features;
+    for (int i = 0; i < 10000; ++i) {
+        QVariantMap feature;
+        feature.insert("barcode", QString("ACGTACGTACGT%1").arg(i % 1000));
+        feature.insert("gene", QString("Gene%1").arg(i % 500));
+        feature.insert("x", i % 33);
+        feature.insert("y", i / 33);
+        feature.insert("hits", i % 17);
+        features.append(feature);
+    }
+    return QJsonDocument::fromVariant(features).toJson(QJsonDocument::Compact);
+}
+
+// random bytes as a compressed image would be
+QByteArray createFigure(const int size)
+{
+    QByteArray figure(size, 0);
+    for (int i = 0; i < size; ++i) {
+        figure[i] = static_cast<char>(qrand() % 256);
+    }
+    return figure;
+}
+
+QNetworkCacheMetaData createMetaData(const QUrl &url, const QByteArray &mime, const qint64 length)
+{
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(url);
+    metaData.setSaveToDisk(true);
+    QNetworkCacheMetaData::RawHeaderList headers;
+    headers << qMakePair(QByteArray("Content-Type"), mime);
+    if (length >= 0) {
+        headers << qMakePair(QByteArray("Content-Length"), QByteArray::number(length));
+    }
+    metaData.setRawHeaders(headers);
+    return metaData;
+}
+
+// inserts the content and waits for it to be stored
+// (the content is streamed to a temporary file if its length is not given)
+bool insert(NetworkDiskCache &cache,
+            const QUrl &url,
+            const QByteArray &content,
+            const QByteArray &mime = "application/json",
+            const bool length = true)
+{
+    QIODevice *device = cache.prepare(createMetaData(url, mime, length ? content.size() : -1));
+    if (device == nullptr) {
+        return false;
+    }
+    device->write(content);
+    cache.insert(device);
+    cache.finishStores();
+    return true;
+}
+
+QByteArray read(NetworkDiskCache &cache, const QUrl &url)
+{
+    QScopedPointer<QIODevice> device(cache.data(url));
+    return device.isNull() ? QByteArray() : device->readAll();
+}
+}
+
+NetworkDiskCacheTest::NetworkDiskCacheTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void NetworkDiskCacheTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkDiskCacheTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkDiskCacheTest::testDeduplication()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    NetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+
+    // the same figure reached with different access tokens is stored once
+    const QByteArray figure = createFigure(512 * 1024);
+    QVERIFY(insert(cache, QUrl("http://server/figure/a?access_token=1"), figure, "image/jpeg"));
+    QVERIFY(insert(cache, QUrl("http://server/figure/a?access_token=2"), figure, "image/jpeg"));
+    QCOMPARE(cache.count(), 2);
+    QCOMPARE(cache.contentSize(), 2 * static_cast<qint64>(figure.size()));
+    QCOMPARE(cache.cacheSize(), static_cast<qint64>(figure.size()));
+    QCOMPARE(read(cache, QUrl("http://server/figure/a?access_token=2")), figure);
+
+    // the content is kept while an URL refers to it
+    QVERIFY(cache.remove(QUrl("http://server/figure/a?access_token=1")));
+    QCOMPARE(cache.cacheSize(), static_cast<qint64>(figure.size()));
+    QVERIFY(cache.remove(QUrl("http://server/figure/a?access_token=2")));
+    QCOMPARE(cache.cacheSize(), Q_INT64_C(0));
+    QVERIFY(read(cache, QUrl("http://server/figure/a?access_token=2")).isEmpty());
+
+    // the content types of the database only
+    QVERIFY(!insert(cache, QUrl("http://server/page"), figure, "text/html"));
+}
+
+void NetworkDiskCacheTest::testCompression()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    NetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+
+    const QByteArray features = createFeatures();
+    QVERIFY(insert(cache, QUrl("http://server/features/1"), features));
+    QVERIFY(cache.cacheSize() * 5 < features.size());
+    QCOMPARE(read(cache, QUrl("http://server/features/1")), features);
+
+    // the content already compressed is stored as it is
+    const QByteArray figure = createFigure(64 * 1024);
+    QVERIFY(insert(cache, QUrl("http://server/figure/1"), figure, "image/jpeg"));
+    QCOMPARE(read(cache, QUrl("http://server/figure/1")), figure);
+}
+
+void NetworkDiskCacheTest::testIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QUrl url("http://server/features/1");
+    const QByteArray features = createFeatures();
+    qint64 size = 0;
+    {
+        NetworkDiskCache cache;
+        cache.setCacheDirectory(dir.path());
+        QVERIFY(insert(cache, url, features));
+        size = cache.cacheSize();
+        QVERIFY(cache.saveIndex());
+    }
+
+    // the entries are loaded from the index without reading the content
+    NetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.cacheSize(), size);
+    QCOMPARE(cache.metaData(url).url(), url);
+    QCOMPARE(read(cache, url), features);
+
+    // a cache without a valid index is emptied
+    QFile index(QDir(dir.path()).filePath("index"));
+    QVERIFY(index.open(QIODevice::WriteOnly));
+    index.write("not an index");
+    index.close();
+    NetworkDiskCache invalid_cache;
+    invalid_cache.setCacheDirectory(dir.path());
+    QCOMPARE(invalid_cache.count(), 0);
+    QCOMPARE(invalid_cache.cacheSize(), Q_INT64_C(0));
+}
+
+void NetworkDiskCacheTest::testEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    NetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+    const int figure_size = 100 * 1024;
+    cache.setMaximumCacheSize(3 * figure_size);
+
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(insert(cache,
+                       QUrl(QString("http://server/figure/%1").arg(i)),
+                       createFigure(figure_size),
+                       "image/jpeg"));
+    }
+    QCOMPARE(cache.count(), 3);
+
+    // the least recently used figure is evicted
+    QVERIFY(!read(cache, QUrl("http://server/figure/0")).isEmpty());
+    QVERIFY(insert(cache, QUrl("http://server/figure/3"), createFigure(figure_size), "image/jpeg"));
+    QCOMPARE(cache.count(), 3);
+    QVERIFY(cache.cacheSize() <= cache.maximumCacheSize());
+    QVERIFY(cache.metaData(QUrl("http://server/figure/0")).isValid());
+    QVERIFY(!cache.metaData(QUrl("http://server/figure/1")).isValid());
+    QVERIFY(cache.budget() <= cache.maximumCacheSize());
+}
+
+void NetworkDiskCacheTest::testStreaming()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    NetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+    const QDir temporary_dir(QDir(dir.path()).filePath("tmp"));
+
+    // the contents of unknown size are written to a temporary file
+    const QUrl url("http://server/features/1");
+    const QByteArray features = createFeatures() + createFeatures() + createFeatures();
+    QIODevice *device = cache.prepare(createMetaData(url, "application/json", -1));
+    QVERIFY(qobject_cast<QFile *>(device) != nullptr);
+    device->write(features);
+    cache.insert(device);
+    QCOMPARE(cache.count(), 0);
+    cache.finishStores();
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(temporary_dir.entryList(QDir::Files).isEmpty());
+
+    // the compressed content is uncompressed (in chunks) as it is read
+    QScopedPointer<QIODevice> compressed(cache.data(url));
+    QVERIFY(!compressed.isNull());
+    QCOMPARE(compressed->size(), static_cast<qint64>(features.size()));
+    QCOMPARE(compressed->read(10), features.left(10));
+    QCOMPARE(compressed->readAll(), features.mid(10));
+
+    // the other contents are read from their file
+    const QByteArray figure = createFigure(2 * 1024 * 1024);
+    QVERIFY(insert(cache, QUrl("http://server/figure/1"), figure, "image/jpeg", false));
+    QScopedPointer<QIODevice> file(cache.data(QUrl("http://server/figure/1")));
+    QVERIFY(qobject_cast<QFile *>(file.data()) != nullptr);
+    QCOMPARE(file->readAll(), figure);
+
+    // the URL removed while its content is stored is not cached
+    const QUrl removed_url("http://server/figure/2");
+    device = cache.prepare(createMetaData(removed_url, "image/jpeg", -1));
+    QVERIFY(device != nullptr);
+    device->write(createFigure(64 * 1024));
+    cache.insert(device);
+    QVERIFY(!cache.remove(removed_url));
+    cache.finishStores();
+    QVERIFY(!cache.metaData(removed_url).isValid());
+    QCOMPARE(cache.count(), 2);
+    QVERIFY(temporary_dir.entryList(QDir::Files).isEmpty());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::NetworkDiskCacheTest)
+#include "tst_networkdiskcachetest.moc"
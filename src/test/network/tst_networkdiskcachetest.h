@@ -0,0 +1,29 @@
+#ifndef TST_NETWORKDISKCACHETEST_H
+#define TST_NETWORKDISKCACHETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class NetworkDiskCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkDiskCacheTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testDeduplication();
+    void testCompression();
+    void testIndex();
+    void testEviction();
+    void testStreaming();
+};
+
+} // namespace unit //
+
+#endif // TST_NETWORKDISKCACHETEST_H
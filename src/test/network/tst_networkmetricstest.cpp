@@ -0,0 +1,140 @@
+#include <QtTest/QTest>
+#include <QEventLoop>
+#include <QTimer>
+#include <QHostAddress>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "network/NetworkManager.h"
+#include "network/NetworkMetrics.h"
+#include "network/NetworkCommand.h"
+#include "network/NetworkReply.h"
+
+#include "MockRestServer.h"
+#include "tst_networkmetricstest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+RequestMetrics createMetrics(const QString &url, const bool cached, const qint64 total)
+{
+    RequestMetrics metrics;
+    metrics.url = url;
+    metrics.sent = 0;
+    metrics.firstByte = total / 2;
+    metrics.finished = total;
+    metrics.bytesReceived = 100;
+    metrics.cached = cached;
+    metrics.succeeded = true;
+    return metrics;
+}
+}
+
+NetworkMetricsTest::NetworkMetricsTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void NetworkMetricsTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkMetricsTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkMetricsTest::testRequestMetrics()
+{
+    MockRestServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    server.setObject(QVariantMap{{"id", "selection1"}});
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString log = QDir(dir.path()).filePath("network.log");
+
+    NetworkManager manager;
+    QVERIFY(manager.metrics().setLogFile(log));
+    QSharedPointer<NetworkCommand> cmd(new NetworkCommand(server.url(), HttpRequestTypeGet));
+    cmd->addQueryItem("access_token", "secret");
+    auto reply = manager.httpRequest(cmd, NetworkManager::Empty);
+    QVERIFY(!reply.isNull());
+    QEventLoop loop;
+    QObject::connect(reply.data(), &NetworkReply::signalFinished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(10000, &loop, SLOT(quit()));
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    QVERIFY(reply->isFinished());
+
+    // the metrics are recorded once the request finishes
+    QCOMPARE(manager.metrics().count(), 1);
+    const RequestMetrics metrics = manager.metrics().requests().first();
+    QCOMPARE(metrics.url, server.url().toString());
+    QCOMPARE(metrics.method, QString("GET"));
+    QCOMPARE(metrics.statusCode, 200);
+    QVERIFY(metrics.succeeded);
+    QVERIFY(!metrics.cached);
+    QVERIFY(metrics.bytesReceived > 0);
+    QVERIFY(metrics.sent >= 0);
+    QVERIFY(metrics.timeToFirstByte() >= 0);
+    QVERIFY(metrics.transferTime() >= 0);
+    QVERIFY(metrics.totalTime() >= metrics.timeToFirstByte());
+    // plain HTTP has no TLS handshake
+    QCOMPARE(metrics.connectTime(), Q_INT64_C(-1));
+
+    // the log has the request as JSON (without the access token)
+    QFile file(log);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray line = file.readLine();
+    QVERIFY(!line.contains("secret"));
+    const QJsonObject json = QJsonDocument::fromJson(line).object();
+    QCOMPARE(json.value("url").toString(), metrics.url);
+    QCOMPARE(json.value("status").toInt(), 200);
+    QVERIFY(file.atEnd());
+}
+
+void NetworkMetricsTest::testRegistry()
+{
+    NetworkMetrics metrics(3);
+    metrics.record(createMetrics("http://server/api/features/1", false, 100));
+    metrics.record(createMetrics("http://server/api/features/2", true, 0));
+    metrics.record(createMetrics("http://server/api/chip/1", false, 20));
+    RequestMetrics failed = createMetrics("http://server/api/features/3", false, 300);
+    failed.succeeded = false;
+    metrics.record(failed);
+
+    // only the last requests are kept
+    QCOMPARE(metrics.count(), 4);
+    QCOMPARE(metrics.requests().size(), 3);
+    QCOMPARE(metrics.requests().first().url, QString("http://server/api/features/2"));
+
+    const NetworkMetrics::Summary features = metrics.summary("http://server/api/features");
+    QCOMPARE(features.requests, 2);
+    QCOMPARE(features.cached, 1);
+    QCOMPARE(features.errors, 1);
+    QCOMPARE(features.bytesReceived, Q_INT64_C(200));
+    QCOMPARE(features.meanTotalTime, Q_INT64_C(300));
+    QCOMPARE(features.meanTimeToFirstByte, Q_INT64_C(150));
+
+    const NetworkMetrics::Summary all = metrics.summary();
+    QCOMPARE(all.requests, 3);
+    QCOMPARE(all.meanTotalTime, Q_INT64_C(160));
+    QCOMPARE(all.maxTotalTime, Q_INT64_C(300));
+
+    metrics.clear();
+    QCOMPARE(metrics.count(), 0);
+    QVERIFY(metrics.requests().isEmpty());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::NetworkMetricsTest)
+#include "tst_networkmetricstest.moc"
@@ -0,0 +1,26 @@
+#ifndef TST_NETWORKMETRICSTEST_H
+#define TST_NETWORKMETRICSTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class NetworkMetricsTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkMetricsTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRequestMetrics();
+    void testRegistry();
+};
+
+} // namespace unit //
+
+#endif // TST_NETWORKMETRICSTEST_H
@@ -0,0 +1,213 @@
+#include <QtTest/QTest>
+#include <QEventLoop>
+#include <QTimer>
+#include <QHostAddress>
+
+#include "network/NetworkManager.h"
+#include "network/NetworkCommand.h"
+#include "network/NetworkReply.h"
+
+#include "MockRestServer.h"
+#include "MockFileServer.h"
+#include "tst_networkschedulertest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+typedef QList<QSharedPointer<NetworkReply>> ReplyList;
+
+const qint64 RANGE_SEGMENT_SIZE = 64 * 1024;
+const int RANGE_SEGMENTS = 16;
+
+QSharedPointer<NetworkReply> request(NetworkManager &manager,
+                                     const QUrl &url,
+                                     const NetworkManager::Priority priority,
+                                     const QObject *owner = nullptr,
+                                     const NetworkManager::NetworkFlags flags = NetworkManager::Empty)
+{
+    QSharedPointer<NetworkCommand> cmd(new NetworkCommand(url, HttpRequestTypeGet));
+    return manager.httpRequest(cmd, flags, priority, owner);
+}
+
+QSharedPointer<NetworkReply> request(NetworkManager &manager,
+                                     const MockRestServer &server,
+                                     const NetworkManager::Priority priority,
+                                     const QObject *owner = nullptr)
+{
+    return request(manager, server.url(), priority, owner);
+}
+
+// the URL of the file of the server with the path given
+// (each range download has its own state, see RangeNetworkReply)
+QUrl fileUrl(const MockFileServer &server, const QString &path)
+{
+    QUrl url = server.url();
+    url.setPath(path);
+    return url;
+}
+
+// waits until all the replies have finished
+// returns false if they have not finished in 10 seconds
+bool waitFinished(const ReplyList &replies)
+{
+    QEventLoop loop;
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+    timer.start(10000);
+    for (const auto reply : replies) {
+        while (!reply->isFinished() && timer.isActive()) {
+            QObject::connect(reply.data(), &NetworkReply::signalFinished, &loop, &QEventLoop::quit);
+            loop.exec();
+        }
+    }
+    return timer.isActive();
+}
+}
+
+NetworkSchedulerTest::NetworkSchedulerTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void NetworkSchedulerTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkSchedulerTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void NetworkSchedulerTest::testHostLimits()
+{
+    MockRestServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    server.setObject(QVariantMap{{"id", "selection1"}});
+    NetworkManager manager;
+    ReplyList replies;
+
+    // only two prefetch requests run at the same time
+    for (int i = 0; i < 5; ++i) {
+        replies.append(request(manager, server, NetworkManager::Prefetch));
+        QVERIFY(!replies.last().isNull());
+    }
+    QCOMPARE(manager.runningRequests(server.url()), 2);
+    QCOMPARE(manager.pendingRequests(), 3);
+    QVERIFY(replies.first()->isStarted());
+    QVERIFY(!replies.last()->isStarted());
+
+    // the interactive requests are sent right away and do not count
+    replies.append(request(manager, server, NetworkManager::Interactive));
+    QVERIFY(replies.last()->isStarted());
+    QCOMPARE(manager.runningRequests(server.url()), 2);
+
+    // the visible content goes ahead of the prefetch waiting
+    replies.append(request(manager, server, NetworkManager::VisibleContent));
+    QVERIFY(replies.last()->isStarted());
+    QCOMPARE(manager.runningRequests(server.url()), 3);
+    QCOMPARE(manager.pendingRequests(), 3);
+
+    QVERIFY(waitFinished(replies));
+    for (const auto reply : replies) {
+        QVERIFY(!reply->hasErrors());
+        QCOMPARE(reply->return_code(), NetworkReply::CodeSuccess);
+    }
+    QCOMPARE(manager.runningRequests(server.url()), 0);
+    QCOMPARE(manager.pendingRequests(), 0);
+}
+
+void NetworkSchedulerTest::testCancelRequests()
+{
+    MockRestServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    server.setObject(QVariantMap{{"id", "selection1"}});
+    NetworkManager manager;
+    QObject first_owner;
+    QObject second_owner;
+    ReplyList first_replies;
+    ReplyList second_replies;
+    for (int i = 0; i < 3; ++i) {
+        first_replies.append(request(manager, server, NetworkManager::Prefetch, &first_owner));
+    }
+    for (int i = 0; i < 3; ++i) {
+        second_replies.append(request(manager, server, NetworkManager::Prefetch, &second_owner));
+    }
+
+    // the owners are served in turns
+    QVERIFY(first_replies.at(0)->isStarted());
+    QVERIFY(!first_replies.at(1)->isStarted());
+    QVERIFY(second_replies.at(0)->isStarted());
+    QCOMPARE(manager.pendingRequests(), 4);
+
+    // the requests of the owner are aborted (sent or not) and the rest take their place
+    manager.cancelRequests(&first_owner);
+    QVERIFY(waitFinished(first_replies));
+    QVERIFY(!first_replies.at(1)->isStarted());
+    QCOMPARE(first_replies.at(1)->return_code(), NetworkReply::CodeAbort);
+    QVERIFY(second_replies.at(1)->isStarted());
+
+    QVERIFY(waitFinished(second_replies));
+    for (const auto reply : second_replies) {
+        QCOMPARE(reply->return_code(), NetworkReply::CodeSuccess);
+    }
+    QCOMPARE(manager.pendingRequests(), 0);
+}
+
+void NetworkSchedulerTest::testRangedDownloads()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QByteArray file(static_cast<int>(RANGE_SEGMENTS * RANGE_SEGMENT_SIZE), 'x');
+    server.setFile(file);
+    NetworkManager manager;
+    manager.setRangeSegmentSize(RANGE_SEGMENT_SIZE);
+    const QUrl url = server.url();
+
+    // the segments of the downloads are counted on the host as they arrive
+    // (so 2 of the 6 connections of the host are always left for the interactive requests)
+    int max_running = 0;
+    const auto sample = [&]() {
+        max_running = std::max(max_running, manager.runningRequests(url));
+        QVERIFY(manager.runningRequests(url) <= 4);
+    };
+    ReplyList replies;
+    replies.append(request(manager,
+                           fileUrl(server, "/api/features"),
+                           NetworkManager::VisibleContent,
+                           nullptr,
+                           NetworkManager::UseRanges));
+    replies.append(request(manager,
+                           fileUrl(server, "/api/figure"),
+                           NetworkManager::Prefetch,
+                           nullptr,
+                           NetworkManager::UseRanges));
+    for (const auto reply : replies) {
+        QVERIFY(!reply.isNull());
+        QObject::connect(reply.data(), &NetworkReply::signalDataAvailable, sample);
+    }
+    QCOMPARE(manager.runningRequests(url), 2);
+
+    // the interactive requests are sent right away next to the downloads
+    replies.append(request(manager, fileUrl(server, "/api/chip"), NetworkManager::Interactive));
+    QVERIFY(replies.last()->isStarted());
+    QCOMPARE(manager.runningRequests(url), 2);
+
+    QVERIFY(waitFinished(replies));
+    for (const auto reply : replies) {
+        QCOMPARE(reply->return_code(), NetworkReply::CodeSuccess);
+        QCOMPARE(reply->getRaw(), file);
+    }
+    // the downloads used the room left on the host
+    QVERIFY(max_running > 2);
+    QCOMPARE(manager.runningRequests(url), 0);
+    QCOMPARE(manager.pendingRequests(), 0);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::NetworkSchedulerTest)
+#include "tst_networkschedulertest.moc"
@@ -0,0 +1,27 @@
+#ifndef TST_NETWORKSCHEDULERTEST_H
+#define TST_NETWORKSCHEDULERTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class NetworkSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkSchedulerTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testHostLimits();
+    void testCancelRequests();
+    void testRangedDownloads();
+};
+
+} // namespace unit //
+
+#endif // TST_NETWORKSCHEDULERTEST_H
@@ -0,0 +1,194 @@
+#include <QtTest/QTest>
+#include <QEventLoop>
+#include <QTimer>
+#include <QHostAddress>
+#include <QTemporaryDir>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+
+#include "network/RangeNetworkReply.h"
+
+#include "MockFileServer.h"
+#include "tst_rangenetworkreplytest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+const qint64 SEGMENT_SIZE = 64 * 1024;
+const int SEGMENTS = 16;
+
+QByteArray createFile(const char seed)
+{
+    QByteArray file(static_cast<int>(SEGMENTS * SEGMENT_SIZE - 100), 0);
+    for (int i = 0; i < file.size(); ++i) {
+        file[i] = static_cast<char>((i * 31 + seed) % 251);
+    }
+    return file;
+}
+
+// the result of a download
+struct Download {
+    Download()
+        : data()
+        , error(QNetworkReply::NoError)
+        , contentLength(-1)
+        , resumed(0)
+        , retries(0)
+    {
+    }
+    QByteArray data;
+    QNetworkReply::NetworkError error;
+    qint64 contentLength;
+    int resumed;
+    int retries;
+};
+
+// downloads the file of the server reading the data as it arrives
+// the download is aborted once abortAfter bytes are available (if not -1)
+Download download(MockFileServer &server,
+                  const QString &stateDirectory,
+                  const qint64 abortAfter = -1)
+{
+    QNetworkAccessManager nam;
+    RangeNetworkReply reply(&nam, QNetworkRequest(server.url()), stateDirectory, SEGMENT_SIZE);
+    Download result;
+    QObject::connect(&reply, &QNetworkReply::readyRead, [&]() {
+        result.contentLength = reply.header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        result.data += reply.readAll();
+        if (abortAfter != -1 && result.data.size() >= abortAfter) {
+            reply.abort();
+        }
+    });
+
+    QEventLoop loop;
+    QObject::connect(&reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(10000, &loop, SLOT(quit()));
+    loop.exec();
+    result.error = reply.isFinished() ? reply.error() : QNetworkReply::TimeoutError;
+    result.resumed = reply.segmentsResumed();
+    result.retries = reply.retries();
+    if (result.error == QNetworkReply::NoError) {
+        result.data += reply.readAll();
+    }
+    return result;
+}
+}
+
+RangeNetworkReplyTest::RangeNetworkReplyTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void RangeNetworkReplyTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void RangeNetworkReplyTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void RangeNetworkReplyTest::testSegmentedDownload()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QByteArray file = createFile(1);
+    server.setFile(file);
+
+    const Download result = download(server, QString());
+    QCOMPARE(result.error, QNetworkReply::NoError);
+    QCOMPARE(result.contentLength, static_cast<qint64>(file.size()));
+    QCOMPARE(result.data.size(), file.size());
+    QVERIFY(result.data == file);
+    QCOMPARE(server.rangeRequests(), SEGMENTS);
+}
+
+void RangeNetworkReplyTest::testRetry()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QByteArray file = createFile(2);
+    server.setFile(file);
+
+    // the segments cut are requested again
+    server.failRanges(3);
+    const Download result = download(server, QString());
+    QCOMPARE(result.error, QNetworkReply::NoError);
+    QVERIFY(result.data == file);
+    QCOMPARE(server.rangeRequests(), SEGMENTS + 3);
+    QCOMPARE(result.retries, 3);
+
+    // too many failures of the same segment
+    server.failRanges(SEGMENTS * (RangeNetworkReply::MAX_RETRIES + 1));
+    QVERIFY(download(server, QString()).error != QNetworkReply::NoError);
+}
+
+void RangeNetworkReplyTest::testResume()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QByteArray file = createFile(3);
+    server.setFile(file);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // the download is interrupted after some segments
+    const Download interrupted = download(server, dir.path(), 4 * SEGMENT_SIZE);
+    QCOMPARE(interrupted.error, QNetworkReply::OperationCanceledError);
+    const int requests = server.rangeRequests();
+
+    // only the segments missing (and one to validate the rest) are downloaded again
+    const Download resumed = download(server, dir.path());
+    QCOMPARE(resumed.error, QNetworkReply::NoError);
+    QVERIFY(resumed.data == file);
+    QVERIFY(resumed.resumed >= 4);
+    QVERIFY(server.rangeRequests() - requests <= SEGMENTS - resumed.resumed);
+
+    // the state is removed once the download finishes
+    const int completed_requests = server.rangeRequests();
+    QVERIFY(download(server, dir.path()).data == file);
+    QCOMPARE(server.rangeRequests() - completed_requests, SEGMENTS);
+}
+
+void RangeNetworkReplyTest::testChangedFile()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    server.setFile(createFile(4));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QCOMPARE(download(server, dir.path(), 4 * SEGMENT_SIZE).error,
+             QNetworkReply::OperationCanceledError);
+
+    // the segments stored belong to the previous file
+    const QByteArray file = createFile(5);
+    server.setFile(file);
+    const Download result = download(server, dir.path());
+    QCOMPARE(result.error, QNetworkReply::NoError);
+    QCOMPARE(result.resumed, 0);
+    QVERIFY(result.data == file);
+}
+
+void RangeNetworkReplyTest::testNoRangeSupport()
+{
+    MockFileServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QByteArray file = createFile(6);
+    server.setFile(file);
+    server.setRangesEnabled(false);
+
+    const Download result = download(server, QString());
+    QCOMPARE(result.error, QNetworkReply::NoError);
+    QVERIFY(result.data == file);
+    QCOMPARE(server.requests(), 1);
+    QCOMPARE(server.rangeRequests(), 0);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::RangeNetworkReplyTest)
+#include "tst_rangenetworkreplytest.moc"
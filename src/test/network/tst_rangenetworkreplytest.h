@@ -0,0 +1,29 @@
+#ifndef TST_RANGENETWORKREPLYTEST_H
+#define TST_RANGENETWORKREPLYTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class RangeNetworkReplyTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RangeNetworkReplyTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSegmentedDownload();
+    void testRetry();
+    void testResume();
+    void testChangedFile();
+    void testNoRangeSupport();
+};
+
+} // namespace unit //
+
+#endif // TST_RANGENETWORKREPLYTEST_H
@@ -0,0 +1,188 @@
+#include <QtTest/QTest>
+#include <QEventLoop>
+#include <QTimer>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+#include "data/SyncState.h"
+#include "network/NetworkManager.h"
+#include "network/NetworkCommand.h"
+#include "network/NetworkReply.h"
+
+#include "MockRestServer.h"
+#include "tst_syncstatetest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// selections with gene hits and a tissue snapshot (~10KB each)
+const int SELECTIONS = 500;
+const int SNAPSHOT_SIZE = 8 * 1024;
+
+QVariantMap createSelection(const int index, const QString &comment = QString())
+{
+    QVariantMap selection;
+    selection.insert("id", QString("selection%1").arg(index));
+    selection.insert("name", QString("Selection %1").arg(index));
+    selection.insert("comment", comment);
+    QVariantList gene_hits;
+    for (int i = 0; i < 50; ++i) {
+        gene_hits.append(QVariantList() << QString("Gene%1").arg(i) << i * 10 << i);
+    }
+    selection.insert("gene_hits", gene_hits);
+    selection.insert("tissue_snapshot", QString(SNAPSHOT_SIZE, QChar('A')));
+    return selection;
+}
+
+void populate(MockRestServer &server)
+{
+    for (int i = 0; i < SELECTIONS; ++i) {
+        server.setObject(createSelection(i));
+    }
+}
+
+// syncs the list of objects (by ID) with the server
+// returns the bytes transferred or -1 if the sync failed
+qint64 syncList(MockRestServer &server,
+                SyncState &state,
+                QHash<QString, QVariantMap> &objects,
+                const bool delta,
+                SyncState::Changes &changes)
+{
+    NetworkManager manager;
+    QSharedPointer<NetworkCommand> cmd(new NetworkCommand(server.url(), HttpRequestTypeGet));
+    state.prepare(*cmd, delta);
+    const qint64 bytes = server.bytesSent();
+    auto reply = manager.httpRequest(cmd, NetworkManager::Empty);
+    if (reply.isNull()) {
+        return -1;
+    }
+    QEventLoop loop;
+    QObject::connect(reply.data(), SIGNAL(signalFinished(QVariant)), &loop, SLOT(quit()));
+    QTimer::singleShot(10000, &loop, SLOT(quit()));
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    if (!reply->isFinished() || reply->hasErrors() || !state.update(*reply, changes)) {
+        return -1;
+    }
+
+    if (changes.full) {
+        objects.clear();
+    }
+    for (const QString &id : changes.removed) {
+        objects.remove(id);
+    }
+    const QVariantList modified = QJsonDocument::fromJson(changes.modified).toVariant().toList();
+    for (const QVariant &object : modified) {
+        objects.insert(object.toMap().value("id").toString(), object.toMap());
+    }
+    return server.bytesSent() - bytes;
+}
+}
+
+SyncStateTest::SyncStateTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void SyncStateTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void SyncStateTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void SyncStateTest::testRevalidation()
+{
+    MockRestServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    populate(server);
+
+    SyncState state;
+    QHash<QString, QVariantMap> objects;
+    SyncState::Changes changes;
+    const qint64 full_bytes = syncList(server, state, objects, false, changes);
+    QVERIFY(full_bytes > SELECTIONS * SNAPSHOT_SIZE);
+    QVERIFY(changes.full);
+    QCOMPARE(objects.size(), SELECTIONS);
+    QVERIFY(!state.isEmpty());
+
+    // nothing has changed, the server answers 304
+    const qint64 revalidation_bytes = syncList(server, state, objects, false, changes);
+    QVERIFY(revalidation_bytes > 0);
+    QVERIFY(revalidation_bytes < 1024);
+    QVERIFY(!changes.full);
+    QVERIFY(changes.modified.isEmpty());
+    QCOMPARE(objects.size(), SELECTIONS);
+
+    // something has changed, the whole list is downloaded again without delta sync
+    server.setObject(createSelection(1, "edited"));
+    QVERIFY(syncList(server, state, objects, false, changes) >= full_bytes);
+    QVERIFY(changes.full);
+    QCOMPARE(objects.value("selection1").value("comment").toString(), QString("edited"));
+
+    // without validators the whole list is downloaded
+    state.clear();
+    QVERIFY(syncList(server, state, objects, false, changes) >= full_bytes);
+}
+
+void SyncStateTest::testDeltaSync()
+{
+    MockRestServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    populate(server);
+
+    SyncState state;
+    QHash<QString, QVariantMap> objects;
+    SyncState::Changes changes;
+    // the first sync is always the whole list
+    QVERIFY(syncList(server, state, objects, true, changes) > SELECTIONS * SNAPSHOT_SIZE);
+    QVERIFY(changes.full);
+    QCOMPARE(objects.size(), SELECTIONS);
+    // the next delta starts from the latest object
+    const QString last = QString("selection%1").arg(SELECTIONS - 1);
+    QCOMPARE(state.lastModified(), objects.value(last).value("last_modified").toString());
+
+    // only the changed objects are transferred
+    server.setObject(createSelection(7, "edited"));
+    server.setObject(createSelection(SELECTIONS));
+    server.removeObject("selection3");
+    const qint64 delta_bytes = syncList(server, state, objects, true, changes);
+    QVERIFY(delta_bytes > 0);
+    QVERIFY(delta_bytes < 3 * SNAPSHOT_SIZE);
+    QVERIFY(!changes.full);
+    QCOMPARE(QJsonDocument::fromJson(changes.modified).array().size(), 2);
+    QCOMPARE(changes.removed, QStringList() << "selection3");
+    QCOMPARE(objects.size(), SELECTIONS);
+    QVERIFY(!objects.contains("selection3"));
+    QCOMPARE(objects.value("selection7").value("comment").toString(), QString("edited"));
+    const QString added = QString("selection%1").arg(SELECTIONS);
+    QCOMPARE(state.lastModified(), objects.value(added).value("last_modified").toString());
+
+    // a delta with only removals keeps the cursor
+    server.removeObject("selection4");
+    QVERIFY(syncList(server, state, objects, true, changes) > 0);
+    QCOMPARE(changes.removed, QStringList() << "selection4");
+    QVERIFY(changes.modified.isEmpty());
+    QCOMPARE(state.lastModified(), objects.value(added).value("last_modified").toString());
+
+    // nothing has changed since the delta
+    const qint64 revalidation_bytes = syncList(server, state, objects, true, changes);
+    QVERIFY(revalidation_bytes > 0);
+    QVERIFY(revalidation_bytes < 1024);
+    QVERIFY(changes.modified.isEmpty() && changes.removed.isEmpty());
+    QCOMPARE(objects.size(), SELECTIONS - 1);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::SyncStateTest)
+#include "tst_syncstatetest.moc"
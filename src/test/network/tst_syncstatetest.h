@@ -0,0 +1,26 @@
+#ifndef TST_SYNCSTATETEST_H
+#define TST_SYNCSTATETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class SyncStateTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyncStateTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRevalidation();
+    void testDeltaSync();
+};
+
+} // namespace unit //
+
+#endif // TST_SYNCSTATETEST_H
@@ -0,0 +1,201 @@
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <random>
+
+#include "viewOpenGL/IndexAggregates.h"
+#include "dataModel/FeatureStore.h"
+#include "dataModel/SpotGeneMatrix.h"
+#include "dataModel/Gene.h"
+#include "SettingsVisual.h"
+
+#include "tst_indexaggregatestest.h"
+
+namespace unit
+{
+
+// size of the synthetic dataset (spots x genes features)
+static const int SPOTS = 400;
+static const int GENES_PER_SPOT = 30;
+static const int GENES = 200;
+// rounds of random changes of the genes
+static const int ROUNDS = 200;
+
+namespace
+{
+
+// each spot is its own row and the genes of a spot are unique
+SpotGeneMatrix createMatrix()
+{
+    FeatureStoreBuilder builder;
+    builder.reserve(SPOTS * GENES_PER_SPOT);
+    QVector<int> rows(SPOTS);
+    for (int spot = 0; spot < SPOTS; ++spot) {
+        for (int gene = 0; gene < GENES_PER_SPOT; ++gene) {
+            builder.append(static_cast<GeneDictionary::GeneId>((spot * 7 + gene * 13) % GENES),
+                           spot % 20,
+                           spot / 20,
+                           (spot * 31 + gene * 17) % 50 + 1);
+        }
+        rows[spot] = spot;
+    }
+    return SpotGeneMatrix(builder.build(), rows, SPOTS);
+}
+
+DataProxy::GeneList createGenes()
+{
+    DataProxy::GeneList genes;
+    for (int id = 0; id < GENES; ++id) {
+        genes.append(std::make_shared<Gene>(QString::number(id),
+                                            static_cast<GeneDictionary::GeneId>(id),
+                                            id % 2 == 0,
+                                            QColor::fromHsv((id * 7) % 360, 255, 255),
+                                            id % 10));
+    }
+    return genes;
+}
+
+// the aggregates computed from scratch with the current state of the genes
+IndexAggregates rebuild(const SpotGeneMatrix &matrix,
+                        const DataProxy::GeneList &genes,
+                        const IndexAggregates::Filter &filter)
+{
+    IndexAggregates aggregates;
+    aggregates.reset(matrix);
+    aggregates.storeGeneStates(genes);
+    for (int index = 0; index < matrix.rows(); ++index) {
+        aggregates.rebuild(index, filter);
+    }
+    return aggregates;
+}
+}
+
+IndexAggregatesTest::IndexAggregatesTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void IndexAggregatesTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void IndexAggregatesTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void IndexAggregatesTest::testAggregate()
+{
+    IndexAggregates::Aggregate aggregate;
+    QCOMPARE(aggregate.color(), Visual::DEFAULT_COLOR_GENE);
+
+    // the color is the mean of the colors of the genes
+    aggregate.add(10, QColor(100, 0, 50, 255));
+    aggregate.add(5, QColor(0, 100, 150, 255));
+    QCOMPARE(aggregate.genes, 2);
+    QCOMPARE(aggregate.reads, 15);
+    QCOMPARE(aggregate.color(), QColor(50, 50, 100, 255));
+
+    // removing a gene leaves no rounding errors
+    aggregate.remove(5, QColor(0, 100, 150, 255));
+    QCOMPARE(aggregate.reads, 10);
+    QCOMPARE(aggregate.color(), QColor(100, 0, 50, 255));
+    aggregate.remove(10, QColor(100, 0, 50, 255));
+    QVERIFY(aggregate == IndexAggregates::Aggregate());
+}
+
+void IndexAggregatesTest::testFilter()
+{
+    const IndexAggregates::Filter filter(5, 20, true);
+    QVERIFY(filter.shown(10, true, 1));
+    QVERIFY(!filter.shown(10, false, 1));
+    QVERIFY(!filter.shown(4, true, 1));
+    QVERIFY(!filter.shown(21, true, 1));
+    QVERIFY(filter.shown(5, true, 5));
+    QVERIFY(!filter.shown(5, true, 6));
+
+    // the cut-off of the genes is not applied if it is disabled
+    const IndexAggregates::Filter no_cutoff(5, 20, false);
+    QVERIFY(no_cutoff.shown(5, true, 6));
+}
+
+void IndexAggregatesTest::testIncrementalUpdates()
+{
+    const SpotGeneMatrix matrix = createMatrix();
+    DataProxy::GeneList genes = createGenes();
+    IndexAggregates::Filter filter(1, 50, true);
+
+    IndexAggregates aggregates;
+    aggregates.reset(matrix);
+    aggregates.storeGeneStates(genes);
+    for (int index = 0; index < matrix.rows(); ++index) {
+        aggregates.rebuild(index, filter);
+    }
+    QCOMPARE(aggregates.size(), SPOTS);
+
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> random_gene(0, GENES - 1);
+    std::uniform_int_distribution<int> random_change(0, 2);
+    std::uniform_int_distribution<int> random_value(0, 50);
+    QVector<int> indexes;
+    for (int round = 0; round < ROUNDS; ++round) {
+        // the thresholds or the cut-off mode change every few rounds, the renderer
+        // then stores the states of the genes and rebuilds all the aggregates
+        if (round % 20 == 19) {
+            filter = IndexAggregates::Filter(random_value(random) % 10 + 1,
+                                             random_value(random) + 10,
+                                             !filter.genesCutoff);
+            aggregates.storeGeneStates(genes);
+            for (int index = 0; index < matrix.rows(); ++index) {
+                aggregates.rebuild(index, filter);
+            }
+        }
+
+        // random toggles, recolours and cut-off changes of some genes
+        DataProxy::GeneList changed;
+        for (int i = 0; i < 5; ++i) {
+            const DataProxy::GenePtr gene = genes.at(random_gene(random));
+            switch (random_change(random)) {
+            case 0:
+                gene->selected(!gene->selected());
+                break;
+            case 1:
+                gene->color(QColor::fromHsv(random_value(random) * 7, 255, 255));
+                break;
+            case 2:
+                gene->cut_off(random_value(random));
+                break;
+            default:
+                break;
+            }
+            changed.append(gene);
+        }
+        // a gene that did not change updates nothing
+        changed.append(genes.at(random_gene(random)));
+
+        const IndexAggregates before = aggregates;
+        aggregates.update(changed, filter, indexes);
+        const IndexAggregates expected = rebuild(matrix, genes, filter);
+
+        // the indexes given are unique and every aggregate changed is in them
+        QVector<int> sorted = indexes;
+        std::sort(sorted.begin(), sorted.end());
+        QVERIFY(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+        for (int index = 0; index < matrix.rows(); ++index) {
+            QVERIFY(aggregates.at(index) == expected.at(index));
+            if (!(aggregates.at(index) == before.at(index))) {
+                QVERIFY(std::binary_search(sorted.begin(), sorted.end(), index));
+            }
+        }
+    }
+
+    // no change updates no index
+    aggregates.update(genes, filter, indexes);
+    QVERIFY(indexes.isEmpty());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::IndexAggregatesTest)
+#include "tst_indexaggregatestest.moc"
@@ -0,0 +1,29 @@
+#ifndef TST_INDEXAGGREGATESTEST_H
+#define TST_INDEXAGGREGATESTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// Tests that the aggregates of the renderer updated with the changes of the
+// genes are the same as the ones rebuilt from scratch (no OpenGL is needed)
+class IndexAggregatesTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IndexAggregatesTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testAggregate();
+    void testFilter();
+    void testIncrementalUpdates();
+};
+
+} // namespace unit //
+
+#endif // TST_INDEXAGGREGATESTEST_H
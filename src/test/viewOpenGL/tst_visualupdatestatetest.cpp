@@ -0,0 +1,173 @@
+#include <QtTest/QTest>
+
+#include "viewOpenGL/VisualUpdateState.h"
+
+#include "tst_visualupdatestatetest.h"
+
+namespace unit
+{
+
+VisualUpdateStateTest::VisualUpdateStateTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void VisualUpdateStateTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void VisualUpdateStateTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void VisualUpdateStateTest::testCompleted()
+{
+    VisualUpdateState state;
+    QVERIFY(!state.isInFlight());
+    QVERIFY(!state.takeResult());
+
+    // an update of some indexes
+    VisualUpdateState::Job job = state.start(false);
+    QVERIFY(!job.aggregates);
+    QVERIFY(!job.allIndexes);
+    QVERIFY(state.isInFlight());
+    QVERIFY(!state.isCancelled());
+    state.finish(true);
+    QVERIFY(!state.isInFlight());
+    QVERIFY(!state.isStale());
+
+    // the result is drawn once
+    QVERIFY(state.takeResult());
+    QVERIFY(!state.takeResult());
+
+    // the aggregates are dirty while they are recomputed
+    job = state.start(true);
+    QVERIFY(job.aggregates);
+    QVERIFY(job.allIndexes);
+    QVERIFY(state.aggregatesDirty());
+    state.finish(true);
+    QVERIFY(!state.aggregatesDirty());
+    QVERIFY(state.takeResult());
+}
+
+void VisualUpdateStateTest::testCancelled()
+{
+    VisualUpdateState state;
+
+    // an update of some indexes cancelled leaves the rendering data stale
+    state.start(false);
+    state.cancel();
+    QVERIFY(state.isCancelled());
+    state.finish(false);
+    QVERIFY(state.isStale());
+    QVERIFY(!state.aggregatesDirty());
+    QVERIFY(!state.takeResult());
+
+    // so the next one updates all the indexes
+    VisualUpdateState::Job job = state.start(false);
+    QVERIFY(!job.aggregates);
+    QVERIFY(job.allIndexes);
+    QVERIFY(!state.isStale());
+    QVERIFY(!state.isCancelled());
+    state.finish(true);
+    QVERIFY(state.takeResult());
+
+    // the aggregates of an update cancelled are dirty
+    state.start(true);
+    state.cancel();
+    state.finish(false);
+    QVERIFY(state.aggregatesDirty());
+    QVERIFY(state.isStale());
+
+    // so the next one recomputes them even if it only changes some genes
+    job = state.start(false);
+    QVERIFY(job.aggregates);
+    QVERIFY(job.allIndexes);
+    state.cancel();
+    state.finish(false);
+    QVERIFY(state.aggregatesDirty());
+
+    // until one completes
+    job = state.start(false);
+    QVERIFY(job.aggregates);
+    state.finish(true);
+    QVERIFY(!state.aggregatesDirty());
+    QVERIFY(!state.isStale());
+    QVERIFY(state.takeResult());
+    job = state.start(false);
+    QVERIFY(!job.aggregates);
+    QVERIFY(!job.allIndexes);
+    state.finish(true);
+}
+
+void VisualUpdateStateTest::testCompletedBeforeCancel()
+{
+    // the update could have completed before being cancelled
+    VisualUpdateState state;
+    state.start(true);
+    state.cancel();
+    state.finish(true);
+    QVERIFY(!state.aggregatesDirty());
+    QVERIFY(!state.isStale());
+    QVERIFY(state.takeResult());
+
+    // nothing is cancelled if no update is in flight
+    state.cancel();
+    QVERIFY(!state.isCancelled());
+}
+
+void VisualUpdateStateTest::testSupersede()
+{
+    VisualUpdateState state;
+
+    // the frames are only counted while an update is in flight
+    state.nextFrame();
+    QVERIFY(!state.supersede());
+
+    // an update started in the last frames is not cancelled by newer changes
+    state.start(false);
+    for (int frame = 0; frame < VisualUpdateState::MAX_FRAMES; ++frame) {
+        state.nextFrame();
+        QVERIFY(!state.supersede());
+        QVERIFY(!state.isCancelled());
+    }
+
+    // but a slow one is
+    state.nextFrame();
+    QVERIFY(state.supersede());
+    QVERIFY(state.isCancelled());
+    state.finish(false);
+    QVERIFY(state.isStale());
+
+    // the frames start again with the next update
+    const VisualUpdateState::Job job = state.start(false);
+    QVERIFY(job.allIndexes);
+    state.nextFrame();
+    QVERIFY(!state.supersede());
+    state.finish(true);
+    QVERIFY(state.takeResult());
+}
+
+void VisualUpdateStateTest::testReset()
+{
+    VisualUpdateState state;
+    state.start(true);
+    state.cancel();
+    state.finish(false);
+    state.reset();
+    QVERIFY(!state.aggregatesDirty());
+    QVERIFY(!state.isStale());
+    QVERIFY(!state.takeResult());
+
+    state.start(false);
+    state.finish(true);
+    state.reset();
+    QVERIFY(!state.takeResult());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::VisualUpdateStateTest)
+#include "tst_visualupdatestatetest.moc"
@@ -0,0 +1,32 @@
+#ifndef TST_VISUALUPDATESTATETEST_H
+#define TST_VISUALUPDATESTATETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// Tests of the state of the background updates of the renderer: what each
+// update computes after the previous one was completed or cancelled and
+// when newer changes cancel the update in flight (no OpenGL is needed)
+class VisualUpdateStateTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VisualUpdateStateTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testCompleted();
+    void testCancelled();
+    void testCompletedBeforeCancel();
+    void testSupersede();
+    void testReset();
+};
+
+} // namespace unit //
+
+#endif // TST_VISUALUPDATESTATETEST_H
@@ -0,0 +1,11 @@
+#include "utils/FileFunctions.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QSaveFile>
+
+bool writeFile(const QString &filename, const QByteArray &data)
+{
+    QSaveFile file(filename);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+}
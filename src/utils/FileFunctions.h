@@ -0,0 +1,15 @@
+#ifndef FILEFUNCTIONS_H
+#define FILEFUNCTIONS_H
+
+#include <qglobal.h>
+
+QT_FORWARD_DECLARE_CLASS(QString)
+QT_FORWARD_DECLARE_CLASS(QByteArray)
+
+// Convenience functions to work with the files of the caches
+
+// writes the data given to the file atomically (the file is either replaced
+// completely or left as it was), returns false if it fails
+bool writeFile(const QString &filename, const QByteArray &data);
+
+#endif // FILEFUNCTIONS_H
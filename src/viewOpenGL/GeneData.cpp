@@ -72,72 +72,97 @@ int GeneData::addQuad(const float x, const float y, const float size, const QCol
         m_selected.append(0.0);
     }
 
-    // return first index of the quad created
-    return index_count;
+    // return the index of the quad created (quads are numbered from 0)
+    return index_count / QUAD_SIZE;
 }
 
 void GeneData::updateQuadSize(const int index, const float x, const float y, const float size)
 {
-    m_vertices[index] = QVector3D(x - size / 2.0, y - size / 2.0, 0.0);
-    m_vertices[index + 1] = QVector3D(x + size / 2.0, y - size / 2.0, 0.0);
-    m_vertices[index + 2] = QVector3D(x + size / 2.0, y + size / 2.0, 0.0);
-    m_vertices[index + 3] = QVector3D(x - size / 2.0, y + size / 2.0, 0.0);
+    const int first = index * QUAD_SIZE;
+    m_vertices[first] = QVector3D(x - size / 2.0, y - size / 2.0, 0.0);
+    m_vertices[first + 1] = QVector3D(x + size / 2.0, y - size / 2.0, 0.0);
+    m_vertices[first + 2] = QVector3D(x + size / 2.0, y + size / 2.0, 0.0);
+    m_vertices[first + 3] = QVector3D(x - size / 2.0, y + size / 2.0, 0.0);
 }
 
 void GeneData::updateQuadColor(const int index, const QColor &color)
 {
     const QVector4D opengl_color = fromQtColor(color);
     for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_colors[index + i] = opengl_color;
+        m_colors[index * QUAD_SIZE + i] = opengl_color;
     }
 }
 
 void GeneData::updateQuadSelected(const int index, const bool selected)
 {
     for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_selected[index + i] = static_cast<float>(selected);
+        m_selected[index * QUAD_SIZE + i] = static_cast<float>(selected);
     }
 }
 
 void GeneData::updateQuadVisible(const int index, const bool visible)
 {
     for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_visible[index + i] = static_cast<float>(visible);
+        m_visible[index * QUAD_SIZE + i] = static_cast<float>(visible);
     }
 }
 
 void GeneData::updateQuadReads(const int index, const int reads)
 {
     for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_reads[index + i] = static_cast<float>(reads);
+        m_reads[index * QUAD_SIZE + i] = static_cast<float>(reads);
     }
 }
 
 QColor GeneData::quadColor(const int index) const
 {
     // all vertices has same color
-    return fromOpenGLColor(m_colors.at(index));
+    return fromOpenGLColor(m_colors.at(index * QUAD_SIZE));
 }
 
 bool GeneData::quadSelected(const int index) const
 {
     // all vertices has same value
-    return static_cast<bool>(m_selected.at(index));
+    return static_cast<bool>(m_selected.at(index * QUAD_SIZE));
 }
 
 bool GeneData::quadVisible(const int index) const
 {
     // all vertices has same value
-    return static_cast<bool>(m_visible.at(index));
+    return static_cast<bool>(m_visible.at(index * QUAD_SIZE));
 }
 
 int GeneData::quadReads(const int index) const
 {
     // all vertices has same value
-    return static_cast<int>(m_reads.at(index));
+    return static_cast<int>(m_reads.at(index * QUAD_SIZE));
 }
 
 void GeneData::clearSelectionArray()
 {
     std::fill(m_selected.begin(), m_selected.end(), 0.0);
 }
+
+void GeneData::copyRenderingData(const GeneData &other)
+{
+    m_colors = other.m_colors;
+    m_reads = other.m_reads;
+    m_visible = other.m_visible;
+    // the arrays are implicitly shared so they are detached here
+    // (detaching from several threads at the same time is not safe)
+    m_colors.detach();
+    m_reads.detach();
+    m_visible.detach();
+}
+
+void GeneData::swapRenderingData(GeneData &other)
+{
+    m_colors.swap(other.m_colors);
+    m_reads.swap(other.m_reads);
+    m_visible.swap(other.m_visible);
+    for (int i = 0; i < m_selected.size(); ++i) {
+        if (m_visible.at(i) == 0.0) {
+            m_selected[i] = 0.0;
+        }
+    }
+}
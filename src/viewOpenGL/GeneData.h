@@ -25,7 +25,8 @@ public:
     // clear data and geometry arrays
     void clearData();
 
-    // adds a new data point to the arrays (returns the new index of the element)
+    // adds a new data point to the arrays (returns the index of the new quad,
+    // the quads are numbered from 0 in order of addition)
     int addQuad(const float x,
                 const float y,
                 const float size = 1.0,
@@ -47,6 +48,14 @@ public:
     // set selected array to all false
     void clearSelectionArray();
 
+    // copies the rendering data arrays (colors, reads and visible) of the
+    // other object so they can be written from other threads (the selection
+    // is only kept in the object drawn)
+    void copyRenderingData(const GeneData &other);
+    // swaps the rendering data arrays (colors, reads and visible) with the
+    // other object and unselects the quads that are not visible anymore
+    void swapRenderingData(GeneData &other);
+
     // OpenGL data arrays
     QVector<QVector3D> m_vertices;
     QVector<QVector2D> m_textures;
@@ -9,17 +9,39 @@
 #include "dataModel/UserSelection.h"
 #include "dataModel/Feature.h"
 #include "dataModel/Gene.h"
+#include "concurrent/DataRenderer.h"
 #include "SettingsVisual.h"
 
+#include <memory>
+
 static const int INVALID_INDEX = -1;
 static const float GENE_SIZE_DEFAULT = 0.5;
 static const float GENE_INTENSITY_DEFAULT = 1.0;
 static const GeneRendererGL::GeneShape DEFAULT_SHAPE_GENE = GeneRendererGL::GeneShape::Circle;
+// minimum number of indexes of each concurrent task of updateVisual()
+static const int PARALLEL_MIN_INDEXES = 512;
+// the updates drawn later than this (in ms) since the first change are logged
+static const qint64 UPDATE_LATENCY_BUDGET = 50;
 
 GeneRendererGL::GeneRendererGL(QSharedPointer<DataProxy> dataProxy, QObject *parent)
     : GraphicItemGL(parent)
+    , m_parameters()
     , m_isInitialized(false)
     , m_dataProxy(dataProxy)
+    , m_backPooledMin(std::numeric_limits<int>::max())
+    , m_backPooledMax(std::numeric_limits<int>::min())
+    , m_backParameters()
+    , m_visualWatcher()
+    , m_visualState()
+    , m_requested()
+    , m_pendingUpdate(NoUpdate)
+    , m_pendingGenes()
+    , m_pendingSelection()
+    , m_visualSelection()
+    , m_requestTimer()
+    , m_requestChanges(0)
+    , m_visualTimer()
+    , m_visualChanges(0)
 {
     setVisualOption(GraphicItemGL::Transformable, true);
     setVisualOption(GraphicItemGL::Visible, true);
@@ -28,55 +50,83 @@ GeneRendererGL::GeneRendererGL(QSharedPointer<DataProxy> dataProxy, QObject *par
     setVisualOption(GraphicItemGL::Xinverted, false);
     setVisualOption(GraphicItemGL::RubberBandable, true);
 
+    // the result of the background visual updates
+    connect(&m_visualWatcher,
+            &QFutureWatcher<bool>::finished,
+            this,
+            &GeneRendererGL::slotVisualUpdated);
+
     // initialize variables
     clearData();
 }
 
 GeneRendererGL::~GeneRendererGL()
 {
+    finishVisualUpdate(true);
 }
 
 void GeneRendererGL::clearData()
 {
+    // cancel the visual update in flight
+    finishVisualUpdate(true);
+
     // clear gene plot data
     m_geneData.clearData();
+    m_backData.clearData();
+    m_visualState.reset();
+
+    // pending changes
+    m_pendingUpdate = NoUpdate;
+    m_pendingGenes.clear();
+    m_pendingSelection.clear();
+    m_visualSelection.clear();
+    m_requestTimer.invalidate();
+    m_requestChanges = 0;
+    m_visualTimer.invalidate();
+    m_visualChanges = 0;
 
     // clear selection
     m_geneInfoSelectedFeatures.clear();
 
     // lookup data
-    m_geneInfoByIndex.clear();
-    m_geneInfoTotalReadsIndex.clear();
-    m_geneInfoTotalGenesIndex.clear();
-    m_geneInfoByGene.clear();
-    m_geneInfoByGeneFeatures.clear();
+    m_features = FeatureStore();
+    m_matrix = SpotGeneMatrix();
+    m_indexSpots.clear();
+    m_indexMarks.clear();
+    m_geneIndexes.clear();
+    m_aggregates.clear();
     m_indexes.clear();
 
     // variables
     m_intensity = GENE_INTENSITY_DEFAULT;
     m_size = GENE_SIZE_DEFAULT;
-    m_thresholdReadsLower = std::numeric_limits<int>::max();
-    m_thresholdReadsUpper = std::numeric_limits<int>::min();
-    m_thresholdGenesLower = std::numeric_limits<int>::max();
-    m_thresholdGenesUpper = std::numeric_limits<int>::min();
-    m_thresholdTotalReadsLower = std::numeric_limits<int>::max();
-    m_thresholdTotalReadsUpper = std::numeric_limits<int>::min();
     m_shape = DEFAULT_SHAPE_GENE;
     m_localPooledMin = std::numeric_limits<int>::max();
     m_localPooledMax = std::numeric_limits<int>::min();
-    m_genes_cutoff = true;
 
-    // visual mode
-    m_visualMode = NormalMode;
-    // pooling mode
-    m_poolingMode = Visual::PoolReadsCount;
-    // color mode
-    m_colorComputingMode = Visual::LinearColor;
+    // default thresholds and modes (the slots start from them)
+    m_parameters = VisualParameters();
+    m_backParameters = m_parameters;
+    m_requested = m_parameters;
 
     // set dirty and initialized to false
     m_isInitialized = false;
 }
 
+GeneRendererGL::VisualParameters::VisualParameters()
+    : readsLower(std::numeric_limits<int>::max())
+    , readsUpper(std::numeric_limits<int>::min())
+    , genesLower(std::numeric_limits<int>::max())
+    , genesUpper(std::numeric_limits<int>::min())
+    , totalReadsLower(std::numeric_limits<int>::max())
+    , totalReadsUpper(std::numeric_limits<int>::min())
+    , genesCutoff(true)
+    , visualMode(NormalMode)
+    , poolingMode(Visual::PoolReadsCount)
+    , colorMode(Visual::LinearColor)
+{
+}
+
 void GeneRendererGL::resetQuadTree(const QRectF &rect)
 {
     m_geneInfoQuadTree.clear();
@@ -101,49 +151,49 @@ void GeneRendererGL::setSize(float size)
 
 void GeneRendererGL::setReadsUpperLimit(const int limit)
 {
-    if (m_thresholdReadsUpper != limit) {
-        m_thresholdReadsUpper = limit;
-        updateVisual();
+    if (m_requested.readsUpper != limit) {
+        m_requested.readsUpper = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
 void GeneRendererGL::setReadsLowerLimit(const int limit)
 {
-    if (m_thresholdReadsLower != limit) {
-        m_thresholdReadsLower = limit;
-        updateVisual();
+    if (m_requested.readsLower != limit) {
+        m_requested.readsLower = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
 void GeneRendererGL::setGenesUpperLimit(const int limit)
 {
-    if (m_thresholdGenesUpper != limit) {
-        m_thresholdGenesUpper = limit;
-        updateVisual();
+    if (m_requested.genesUpper != limit) {
+        m_requested.genesUpper = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
 void GeneRendererGL::setGenesLowerLimit(const int limit)
 {
-    if (m_thresholdGenesLower != limit) {
-        m_thresholdGenesLower = limit;
-        updateVisual();
+    if (m_requested.genesLower != limit) {
+        m_requested.genesLower = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
 void GeneRendererGL::setTotalReadsUpperLimit(const int limit)
 {
-    if (m_thresholdTotalReadsUpper != limit) {
-        m_thresholdTotalReadsUpper = limit;
-        updateVisual();
+    if (m_requested.totalReadsUpper != limit) {
+        m_requested.totalReadsUpper = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
 void GeneRendererGL::setTotalReadsLowerLimit(const int limit)
 {
-    if (m_thresholdTotalReadsLower != limit) {
-        m_thresholdTotalReadsLower = limit;
-        updateVisual();
+    if (m_requested.totalReadsLower != limit) {
+        m_requested.totalReadsLower = limit;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
@@ -155,14 +205,17 @@ void GeneRendererGL::generateData()
     setupShaders();
 
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-    for (const auto &feature : m_dataProxy->getFeatureList()) {
-        Q_ASSERT(feature);
-        // Get the feature's gene
-        auto gene = m_dataProxy->geneGeneObject(feature->gene());
-        Q_ASSERT(gene);
-
-        // feature cordinates
-        const QPointF point(feature->x(), feature->y());
+    // the features are stored grouped by spot so they are iterated spot by spot
+    m_features = m_dataProxy->getFeatureList().store();
+    const FeatureStore::SpotIndex spots_count
+        = static_cast<FeatureStore::SpotIndex>(m_features.spotsCount());
+    // the index of each spot of the store
+    QVector<int> spot_indexes(static_cast<int>(spots_count));
+    for (FeatureStore::SpotIndex spot = 0; spot < spots_count; ++spot) {
+        // spot cordinates
+        const float x = m_features.spotX(spot);
+        const float y = m_features.spotY(spot);
+        const QPointF point(x, y);
 
         // test if point already exists (quad tree)
         GeneInfoQuadTree::PointItem item(point, INVALID_INDEX);
@@ -173,43 +226,47 @@ void GeneRendererGL::generateData()
 
         // if it does not exists, create a quad and store the index
         if (item.second == INVALID_INDEX) {
-            index = m_geneData.addQuad(feature->x(),
-                                       feature->y(),
-                                       m_size,
-                                       Visual::DEFAULT_COLOR_GENE);
+            index = m_geneData.addQuad(x, y, m_size, Visual::DEFAULT_COLOR_GENE);
             // update look up container for the quad tree
             m_geneInfoQuadTree.insert(point, index);
             // add to list of indexes
-            m_indexes.insert(index);
+            m_indexes.push_back(index);
+            m_indexSpots.push_back(spot);
         }
-
-        // update look up container for the features and indexes
-        // multiple features per index
-        m_geneInfoByIndex.insert(index, feature);
-        // multiple indexes per gene
-        m_geneInfoByGene.insert(gene, index);
-        // mutiple count per gene
-        m_geneInfoByGeneFeatures[gene].push_back(feature->count());
-
-        // updated total reads/genes per spot/index
-        const int feature_reads = feature->count();
-        const int num_genes_spot = ++m_geneInfoTotalGenesIndex[index];
-        const int num_reads_spot = m_geneInfoTotalReadsIndex[index] += feature_reads;
-
-        // update thresholds (TODO next API will contain this information so no need for this)
-        m_thresholdGenesLower = std::min(num_genes_spot, m_thresholdGenesLower);
-        m_thresholdGenesUpper = std::max(num_genes_spot, m_thresholdGenesUpper);
-        m_thresholdReadsLower = std::min(feature_reads, m_thresholdReadsLower);
-        m_thresholdReadsUpper = std::max(feature_reads, m_thresholdReadsUpper);
-        m_thresholdTotalReadsLower = std::min(num_reads_spot, m_thresholdTotalReadsLower);
-        m_thresholdTotalReadsUpper = std::max(num_reads_spot, m_thresholdTotalReadsUpper);
+        spot_indexes[static_cast<int>(spot)] = index;
 
     } // endforeach
 
+    // create the lookup matrix (index x gene) of the features
+    m_matrix = SpotGeneMatrix(m_features, spot_indexes, m_indexes.size());
+    m_indexMarks.assign(static_cast<size_t>(m_indexes.size()), false);
+    m_geneIndexes.reserve(m_indexes.size());
+
+    // update thresholds (TODO next API will contain this information so no need for this)
+    for (const auto index : m_indexes) {
+        const int num_genes_spot = m_matrix.rowGenes(index);
+        const int num_reads_spot = m_matrix.rowReads(index);
+        m_parameters.genesLower = std::min(num_genes_spot, m_parameters.genesLower);
+        m_parameters.genesUpper = std::max(num_genes_spot, m_parameters.genesUpper);
+        m_parameters.totalReadsLower = std::min(num_reads_spot, m_parameters.totalReadsLower);
+        m_parameters.totalReadsUpper = std::max(num_reads_spot, m_parameters.totalReadsUpper);
+        for (auto entry = m_matrix.rowBegin(index); entry < m_matrix.rowEnd(index); ++entry) {
+            Q_ASSERT(m_dataProxy->geneObject(m_matrix.geneId(entry)));
+            const int feature_reads = m_matrix.count(entry);
+            m_parameters.readsLower = std::min(feature_reads, m_parameters.readsLower);
+            m_parameters.readsUpper = std::max(feature_reads, m_parameters.readsUpper);
+        }
+    }
+
     // compute gene's cut off
     compuateGenesCutoff();
-    QGuiApplication::restoreOverrideCursor();
+    m_aggregates.reset(m_matrix);
     m_isInitialized = true;
+    // the thresholds of the data are the ones requested
+    m_requested = m_parameters;
+    // compute the aggregates of the indexes with the current state of the genes
+    scheduleUpdate(AggregatesUpdate);
+    QGuiApplication::restoreOverrideCursor();
 }
 
 void GeneRendererGL::compuateGenesCutoff()
@@ -218,7 +275,16 @@ void GeneRendererGL::compuateGenesCutoff()
     for (auto gene : m_dataProxy->getGeneList()) {
         Q_ASSERT(gene);
         // get all the counts of the spots that contain that gene
-        auto counts = m_geneInfoByGeneFeatures.value(gene);
+        const auto begin = m_matrix.geneBegin(gene->id());
+        const auto end = m_matrix.geneEnd(gene->id());
+        if (begin == end) {
+            continue;
+        }
+        std::vector<int> counts;
+        counts.reserve(static_cast<size_t>(end - begin));
+        for (auto entry = begin; entry < end; ++entry) {
+            counts.push_back(m_matrix.geneCount(entry));
+        }
         const size_t num_features = counts.size();
         // if too little counts or if all the counts are the same cut off is the min count present
         if (num_features < minseglen + 1
@@ -275,32 +341,32 @@ void GeneRendererGL::compuateGenesCutoff()
 
 int GeneRendererGL::getMinReadsThreshold() const
 {
-    return m_thresholdReadsLower;
+    return m_parameters.readsLower;
 }
 
 int GeneRendererGL::getMaxReadsThreshold() const
 {
-    return m_thresholdReadsUpper;
+    return m_parameters.readsUpper;
 }
 
 int GeneRendererGL::getMinGenesThreshold() const
 {
-    return m_thresholdGenesLower;
+    return m_parameters.genesLower;
 }
 
 int GeneRendererGL::getMaxGenesThreshold() const
 {
-    return m_thresholdGenesUpper;
+    return m_parameters.genesUpper;
 }
 
 int GeneRendererGL::getMinTotalReadsThreshold() const
 {
-    return m_thresholdTotalReadsLower;
+    return m_parameters.totalReadsLower;
 }
 
 int GeneRendererGL::getMaxTotalReadsThreshold() const
 {
-    return m_thresholdTotalReadsUpper;
+    return m_parameters.totalReadsUpper;
 }
 
 void GeneRendererGL::updateSize()
@@ -313,9 +379,8 @@ void GeneRendererGL::updateSize()
     for (const auto index : m_indexes) {
         // update size of the quad for only one feature
         // (all features of same index have same coordinates)
-        const auto feature = m_geneInfoByIndex.value(index);
-        Q_ASSERT(feature);
-        m_geneData.updateQuadSize(index, feature->x(), feature->y(), m_size);
+        const FeatureStore::SpotIndex spot = m_indexSpots.at(index);
+        m_geneData.updateQuadSize(index, m_features.spotX(spot), m_features.spotY(spot), m_size);
     }
 
     QGuiApplication::restoreOverrideCursor();
@@ -328,7 +393,8 @@ void GeneRendererGL::updateColor(const DataProxy::GeneList &geneList)
         return;
     }
 
-    updateVisual(geneList);
+    m_pendingGenes.append(geneList);
+    scheduleUpdate(GenesUpdate);
 }
 
 void GeneRendererGL::updateVisible(const DataProxy::GeneList &geneList)
@@ -337,7 +403,8 @@ void GeneRendererGL::updateVisible(const DataProxy::GeneList &geneList)
         return;
     }
 
-    updateVisual(geneList);
+    m_pendingGenes.append(geneList);
+    scheduleUpdate(GenesUpdate);
 }
 
 void GeneRendererGL::updateGene(const DataProxy::GenePtr gene)
@@ -345,126 +412,326 @@ void GeneRendererGL::updateGene(const DataProxy::GenePtr gene)
     if (!gene) {
         return;
     }
-    // get unique indexes from the gene
-    auto unique_indexes = m_geneInfoByGene.values(gene);
-    updateVisual(IndexesList::fromList(unique_indexes));
+    // only the indexes that contain the gene are updated
+    m_pendingGenes.append(gene);
+    scheduleUpdate(GenesUpdate);
+}
+
+void GeneRendererGL::scheduleUpdate(const UpdateLevel level)
+{
+    if (!m_requestTimer.isValid()) {
+        m_requestTimer.start();
+    }
+    ++m_requestChanges;
+    m_pendingUpdate = std::max(level, m_pendingUpdate);
+    // the repaints are merged by the view so the update is computed
+    // once per frame however many changes are made in between
+    emit updated();
+}
+
+void GeneRendererGL::flushUpdate()
+{
+    m_visualState.nextFrame();
+    if (m_pendingUpdate == NoUpdate) {
+        return;
+    }
+    // the update in flight reads the aggregates and the parameters so the new
+    // one is started once it has finished (see slotVisualUpdated()) instead of
+    // waiting for it. The changes made meanwhile are merged into the pending update,
+    // an update started a few frames ago (for example while a slider is dragged) is
+    // drawn even if it is stale so something is drawn, only a slow one is cancelled
+    if (m_visualState.isInFlight()) {
+        if (m_pendingUpdate > ParametersUpdate) {
+            m_visualState.supersede();
+        }
+        return;
+    }
+    const UpdateLevel level = m_pendingUpdate;
+    m_pendingUpdate = NoUpdate;
+
+    // the latency of the update is measured from the first change not drawn
+    // (the one of the update cancelled if it was not completed)
+    if (!m_visualTimer.isValid()) {
+        m_visualTimer = m_requestTimer;
+        m_visualChanges = 0;
+    }
+    m_visualChanges += m_requestChanges;
+    m_requestTimer.invalidate();
+    m_requestChanges = 0;
+
+    // the parameters requested are drawn with the result of the update
+    // (see swapVisualData())
+    m_backParameters = m_requested;
+    switch (level) {
+    case AggregatesUpdate:
+        updateVisual();
+        break;
+    case IndexesUpdate:
+        // the changes of the genes are applied to the aggregates first
+        m_aggregates.update(m_pendingGenes, m_backParameters.aggregatesFilter(), m_geneIndexes);
+        updateVisual(m_indexes);
+        break;
+    case GenesUpdate:
+        updateVisual(m_pendingGenes);
+        break;
+    case ParametersUpdate:
+        // the update cancelled must be computed again
+        if (m_visualState.isStale()) {
+            updateVisual(m_indexes);
+        } else {
+            // the rendering data does not depend on them
+            m_parameters = m_backParameters;
+            m_visualTimer.invalidate();
+        }
+        break;
+    case NoUpdate:
+    default:
+        break;
+    }
+    m_pendingGenes.clear();
 }
 
 void GeneRendererGL::updateVisual()
 {
-    // call updateVisual with all the genes
-    updateVisual(m_indexes);
+    // recompute the aggregates and update all the indexes
+    m_aggregates.storeGeneStates(m_dataProxy->getGeneList());
+    updateVisual(m_indexes, true);
 }
 
 void GeneRendererGL::updateVisual(const DataProxy::GeneList &geneList)
 {
-    // get unique indexes from the list of genes
-    IndexesList unique_indexes;
-    for (const auto &gene : geneList) {
-        auto indexes = m_geneInfoByGene.values(gene);
-        unique_indexes.unite(IndexesList::fromList(indexes));
+    // the changes can only be applied to the aggregates if they were
+    // completely computed
+    if (m_visualState.aggregatesDirty()) {
+        updateVisual();
+        return;
     }
 
-    // compute the rendering information for the selected genes
-    updateVisual(unique_indexes);
+    // apply the changes of the genes to the indexes that contain them
+    m_aggregates.update(geneList, m_backParameters.aggregatesFilter(), m_geneIndexes);
+
+    // compute the rendering information for the affected indexes
+    updateVisual(m_geneIndexes);
 }
 
-void GeneRendererGL::updateVisual(const IndexesList &indexes)
+void GeneRendererGL::indexesOfGenes(const DataProxy::GeneList &geneList, IndexesList &indexes)
+{
+    // the indexes of each gene are unique so the marks are only needed
+    // to merge the ones of several genes
+    indexes.resize(0);
+    for (const auto &gene : geneList) {
+        for (auto entry = m_matrix.geneBegin(gene->id()); entry < m_matrix.geneEnd(gene->id());
+             ++entry) {
+            const int index = m_matrix.geneRow(entry);
+            if (!m_indexMarks[static_cast<size_t>(index)]) {
+                m_indexMarks[static_cast<size_t>(index)] = true;
+                indexes.push_back(index);
+            }
+        }
+    }
+    // clear the marks for the next call
+    for (const auto index : indexes) {
+        m_indexMarks[static_cast<size_t>(index)] = false;
+    }
+}
+
+void GeneRendererGL::updateVisual(const IndexesList &indexes, const bool aggregates)
 {
     if (!m_isInitialized) {
         return;
     }
 
-    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    // no update is in flight (see flushUpdate()) and the back buffer starts
+    // from the rendering data drawn so the result of the last update must
+    // have been swapped (see draw())
+    // all the aggregates are recomputed if the last time was cancelled
+    // and all the indexes updated if the last update was cancelled
+    const VisualUpdateState::Job job = m_visualState.start(aggregates);
+    m_backData.copyRenderingData(m_geneData);
+    // the spots of the genes selected are selected when this update is drawn
+    if (!m_pendingSelection.empty()) {
+        m_visualSelection = m_pendingSelection;
+        m_pendingSelection.clear();
+    }
+    m_visualWatcher.setFuture(QtConcurrent::run(this,
+                                                &GeneRendererGL::computeVisual,
+                                                job.allIndexes ? m_indexes : indexes,
+                                                job.aggregates));
+}
 
-    // we want to get the max and min value of the reads that are going
-    // to be rendered to pass these values to the shaders to compute normalized colors
-    m_localPooledMin = std::numeric_limits<int>::max();
-    m_localPooledMax = std::numeric_limits<int>::min();
+bool GeneRendererGL::computeVisual(const IndexesList &indexes, const bool aggregates)
+{
+    // the indexes are split in contiguous ranges, one per thread, and the
+    // last range is computed in this thread
+    const int size = indexes.size();
+    const int tasks
+        = std::max(1, std::min(m_threadPool.maxThreadCount(), size / PARALLEL_MIN_INDEXES));
+    std::vector<std::unique_ptr<DataRenderer> > renderers;
+    for (int task = 0; task < tasks - 1; ++task) {
+        renderers.emplace_back(new DataRenderer(*this,
+                                                indexes,
+                                                size * task / tasks,
+                                                size * (task + 1) / tasks,
+                                                aggregates));
+        renderers.back()->setAutoDelete(false);
+        m_threadPool.start(renderers.back().get());
+    }
+    int pooled_min = std::numeric_limits<int>::max();
+    int pooled_max = std::numeric_limits<int>::min();
+    updateIndexes(indexes, size * (tasks - 1) / tasks, size, aggregates, pooled_min, pooled_max);
+    m_threadPool.waitForDone();
+    if (m_visualState.isCancelled()) {
+        return false;
+    }
 
-    // some visualization options
-    const bool pooling_genes = m_poolingMode == Visual::PoolNumberGenes;
-    const bool pooling_tpm = m_poolingMode == Visual::PoolTPMs;
-    const bool isPooled = m_visualMode == DynamicRangeMode || m_visualMode == HeatMapMode;
+    // the boundaries for color computation are the ones of all the visible spots
+    // so they can only be merged from the tasks when all the indexes were updated
+    if (size == m_indexes.size()) {
+        for (const auto &renderer : renderers) {
+            pooled_min = std::min(renderer->pooledMin(), pooled_min);
+            pooled_max = std::max(renderer->pooledMax(), pooled_max);
+        }
+        m_backPooledMin = pooled_min;
+        m_backPooledMax = pooled_max;
+    } else {
+        updatePooledRange();
+    }
+    return true;
+}
 
-    // iterate the indexes (spots) to compute the visual data by going trough all the
-    // features (gene counts) in each spot
-    foreach (const auto &index, indexes) {
+void GeneRendererGL::finishVisualUpdate(const bool cancel)
+{
+    if (!m_visualState.isInFlight()) {
+        return;
+    }
+    if (cancel) {
+        m_visualState.cancel();
+    }
+    m_visualWatcher.waitForFinished();
+    m_visualState.finish(m_visualWatcher.result());
+}
 
-        // check if spot's total reads/genes are inside the total reads/genes thresholds
-        const int total_reads_feature = m_geneInfoTotalReadsIndex.value(index);
-        const int total_genes_feature = m_geneInfoTotalGenesIndex.value(index);
-        if (featureGenesOutsideRange(total_genes_feature)
-            || featureTotalReadsOutsideRange(total_reads_feature)) {
-            // set spot to not visible
-            m_geneData.updateQuadSelected(index, false);
-            m_geneData.updateQuadVisible(index, false);
-            continue;
-        }
+bool GeneRendererGL::swapVisualData()
+{
+    if (!m_visualState.takeResult()) {
+        return false;
+    }
+    m_geneData.swapRenderingData(m_backData);
+    m_localPooledMin = m_backPooledMin;
+    m_localPooledMax = m_backPooledMax;
+    // the parameters are drawn with the data computed with them
+    m_parameters = m_backParameters;
+
+    // the spots of the genes selected are visible now (see selectGenes())
+    if (!m_visualSelection.empty()) {
+        IndexesList unique_indexes;
+        indexesOfGenes(m_visualSelection, unique_indexes);
+        m_visualSelection.clear();
+        selectSpots(unique_indexes, SelectionEvent::NewSelection);
+    }
 
-        // temp local variables to store the color of the spot
-        QColor indexColor = Visual::DEFAULT_COLOR_GENE;
-        int indexValue = 0;
-        int indexValueGenes = 0;
+    // the changes of the update are drawn from now on
+    if (m_visualTimer.isValid()) {
+        const qint64 latency = m_visualTimer.elapsed();
+        if (latency > UPDATE_LATENCY_BUDGET) {
+            qDebug() << "[GeneRendererGL] Visual update of" << m_visualChanges
+                     << "changes drawn after" << latency << "ms";
+        }
+        m_visualTimer.invalidate();
+        m_visualChanges = 0;
+    }
+    return true;
+}
 
-        // iterate the genes in the spot to compute rendering data for an specific index (spot)
-        for (const auto feature : m_geneInfoByIndex.values(index)) {
-            Q_ASSERT(feature);
-            // get the feature's gene
-            auto gene = m_dataProxy->geneGeneObject(feature->gene());
-            Q_ASSERT(gene);
+void GeneRendererGL::slotVisualUpdated()
+{
+    // the result could have been taken already (see finishVisualUpdate())
+    if (m_visualState.isInFlight()) {
+        finishVisualUpdate(false);
+        // the buffers are swapped and the update pending, if any, is
+        // started when the next frame is drawn
+        emit updated();
+    }
+}
 
-            // get the gene status and the count
-            const bool isSelected = gene->selected();
-            const int geneCutOff = gene->cut_off();
-            const int currentHits = feature->count();
+void GeneRendererGL::updateIndexes(const IndexesList &indexes,
+                                   const int begin,
+                                   const int end,
+                                   const bool aggregates,
+                                   int &pooledMin,
+                                   int &pooledMax)
+{
+    // some visualization options
+    const VisualParameters &parameters = m_backParameters;
+    const bool pooling_genes = parameters.poolingMode == Visual::PoolNumberGenes;
+    const bool pooling_tpm = parameters.poolingMode == Visual::PoolTPMs;
+    const bool isPooled = parameters.pooled();
+    const IndexAggregates::Filter filter = parameters.aggregatesFilter();
+
+    // iterate the indexes (spots) to compute the visual data from the aggregates
+    // of the features (gene counts) in each spot
+    for (int i = begin; i < end; ++i) {
+        // a newer update is waiting
+        if (m_visualState.isCancelled()) {
+            return;
+        }
+        const int index = indexes.at(i);
 
-            // check if the reads count of the gene in this spot are outside the threshold
-            // or the gene is not selected
-            if (featureReadsOutsideRange(currentHits)
-                || (m_genes_cutoff && currentHits < geneCutOff) || !isSelected) {
-                continue;
-            }
+        // iterate the genes in the index to add the ones shown
+        if (aggregates) {
+            m_aggregates.rebuild(index, filter);
+        }
+        const IndexAggregates::Aggregate &aggregate = m_aggregates.at(index);
 
-            // update local variables for number of reads and genes
-            indexValue += currentHits;
-            ++indexValueGenes;
-
-            // when the color of the new feature is different than the color
-            // in the feature's index we do linear interpolation adjusted
-            // by the number of genes in the feature to obtain the new color
-            const QColor &featureColor = gene->color();
-            if (indexColor != featureColor) {
-                const float adjustment = 1.0 / indexValueGenes;
-                indexColor = Math::lerp(adjustment, indexColor, featureColor);
-            }
+        // check if spot's total reads/genes are inside the total reads/genes thresholds
+        const int total_reads_feature = m_matrix.rowReads(index);
+        const int total_genes_feature = m_matrix.rowGenes(index);
+        if (parameters.featureGenesOutsideRange(total_genes_feature)
+            || parameters.featureTotalReadsOutsideRange(total_reads_feature)) {
+            // set spot to not visible
+            m_backData.updateQuadVisible(index, false);
+            continue;
         }
 
         // we only show indexes where there is at least one gene-feature activated
-        const bool visible = indexValueGenes > 0;
+        const bool visible = aggregate.genes > 0;
+        int indexValue = aggregate.reads;
 
         // update pooled min-max to compute colors if applies
         if (isPooled && visible) {
             if (pooling_genes) {
-                indexValue = indexValueGenes;
+                indexValue = aggregate.genes;
             } else if (pooling_tpm) {
                 indexValue = Math::tpmNormalization<int>(indexValue, total_reads_feature);
             }
-            // only update the boundaries for color computation in pooled mode
-            m_localPooledMin = std::min(indexValue, m_localPooledMin);
-            m_localPooledMax = std::max(indexValue, m_localPooledMax);
+            pooledMin = std::min(indexValue, pooledMin);
+            pooledMax = std::max(indexValue, pooledMax);
         }
 
         // update rendering data arrays
-        m_geneData.updateQuadReads(index, indexValue);
-        m_geneData.updateQuadVisible(index, visible);
-        if (!visible) {
-            m_geneData.updateQuadSelected(index, false);
+        m_backData.updateQuadReads(index, indexValue);
+        m_backData.updateQuadVisible(index, visible);
+        m_backData.updateQuadColor(index, visible ? aggregate.color() : Visual::DEFAULT_COLOR_GENE);
+    }
+}
+
+void GeneRendererGL::updatePooledRange()
+{
+    // we want to get the max and min value of the reads that are rendered
+    // to pass these values to the shaders to compute normalized colors
+    m_backPooledMin = std::numeric_limits<int>::max();
+    m_backPooledMax = std::numeric_limits<int>::min();
+    // only update the boundaries for color computation in pooled mode
+    if (!m_backParameters.pooled()) {
+        return;
+    }
+    for (const auto index : m_indexes) {
+        if (m_backData.quadVisible(index)) {
+            const int indexValue = m_backData.quadReads(index);
+            m_backPooledMin = std::min(indexValue, m_backPooledMin);
+            m_backPooledMax = std::max(indexValue, m_backPooledMax);
         }
-        m_geneData.updateQuadColor(index, indexColor);
     }
-    QGuiApplication::restoreOverrideCursor();
-    emit updated();
 }
 
 void GeneRendererGL::clearSelection()
@@ -481,14 +748,18 @@ void GeneRendererGL::selectGenes(const DataProxy::GeneList &genes)
     // is that this function is invoked from the reg-exp selection tool.
     // We want to make the spots visible that contain genes present in the
     // search and we also want to select those spots
-    IndexesList unique_indexes;
-    for (const auto &gene : genes) {
-        unique_indexes.unite(IndexesList::fromList(m_geneInfoByGene.values(gene)));
+    if (genes.empty()) {
+        // no spots to wait for, the selection is just cleared
+        m_pendingSelection.clear();
+        m_visualSelection.clear();
+        clearSelection();
+        return;
     }
-    // we update the rendering data
-    updateVisual(genes);
-    // we select the spots that contain the genes
-    selectSpots(unique_indexes, SelectionEvent::NewSelection);
+    // we update the rendering data and the spots that contain the genes
+    // are selected when the result of the update is drawn (see swapVisualData())
+    m_pendingGenes.append(genes);
+    m_pendingSelection = genes;
+    scheduleUpdate(GenesUpdate);
 }
 
 void GeneRendererGL::setSelectionArea(const SelectionEvent *event)
@@ -506,16 +777,16 @@ void GeneRendererGL::setSelectionArea(const SelectionEvent *event)
     // create a list of indexes from the quadtree' points.
     IndexesList indexes;
     for (const auto point : pointList) {
-        indexes.insert(point.second);
+        indexes.push_back(point.second);
     }
 
     // make the selection
     selectSpots(indexes, mode);
 }
 
-const DataProxy::FeatureList &GeneRendererGL::getSelectedFeatures() const
+const DataProxy::FeatureList GeneRendererGL::getSelectedFeatures() const
 {
-    return m_geneInfoSelectedFeatures;
+    return DataProxy::FeatureList(m_features, m_geneInfoSelectedFeatures);
 }
 
 void GeneRendererGL::selectSpots(const IndexesList &indexes,
@@ -548,20 +819,18 @@ void GeneRendererGL::selectSpots(const IndexesList &indexes,
 
         // iterate all the features in the position to select when possible
         bool no_feature_selected = true;
-        auto features = m_geneInfoByIndex.values(index);
-        for (const auto feature : features) {
+        for (auto entry = m_matrix.rowBegin(index); entry < m_matrix.rowEnd(index); ++entry) {
             // not filtering if the feature's gene is selected
             // as we want to include in the selection all the genes
             // of the feature regardless if they are selected or not
             // we just filter features outside the threshold
-            Q_ASSERT(feature);
             // get the feature's gene
-            auto gene = m_dataProxy->geneGeneObject(feature->gene());
+            auto gene = m_dataProxy->geneObject(m_matrix.geneId(entry));
             Q_ASSERT(gene);
             const int geneCutOff = gene->cut_off();
-            const int currentHits = feature->count();
-            if (featureReadsOutsideRange(currentHits)
-                || (m_genes_cutoff && currentHits < geneCutOff)) {
+            const int currentHits = m_matrix.count(entry);
+            if (m_parameters.featureReadsOutsideRange(currentHits)
+                || (m_parameters.genesCutoff && currentHits < geneCutOff)) {
                 continue;
             }
 
@@ -569,6 +838,7 @@ void GeneRendererGL::selectSpots(const IndexesList &indexes,
             no_feature_selected = false;
 
             // update the container with selected features
+            const FeatureStore::FeatureIndex feature = m_matrix.feature(entry);
             if (!remove_selection) {
                 m_geneInfoSelectedFeatures.push_back(feature);
             } else {
@@ -587,39 +857,36 @@ void GeneRendererGL::selectSpots(const IndexesList &indexes,
 void GeneRendererGL::setVisualMode(const GeneVisualMode &mode)
 {
     // update visual mode
-    if (m_visualMode != mode) {
-        m_visualMode = mode;
-        updateVisual();
+    if (m_requested.visualMode != mode) {
+        m_requested.visualMode = mode;
+        // the aggregates do not depend on the mode
+        scheduleUpdate(IndexesUpdate);
     }
 }
 
 void GeneRendererGL::setPoolingMode(const Visual::GenePooledMode &mode)
 {
     // update pooling mode
-    if (m_poolingMode != mode) {
-        m_poolingMode = mode;
-        if (m_visualMode != NormalMode) {
-            updateVisual();
-        }
+    if (m_requested.poolingMode != mode) {
+        m_requested.poolingMode = mode;
+        scheduleUpdate(m_requested.visualMode != NormalMode ? IndexesUpdate : ParametersUpdate);
     }
 }
 
 void GeneRendererGL::setColorComputingMode(const Visual::GeneColorMode &mode)
 {
     // update color computing mode
-    if (m_colorComputingMode != mode) {
-        m_colorComputingMode = mode;
-        if (m_visualMode != NormalMode) {
-            updateVisual();
-        }
+    if (m_requested.colorMode != mode) {
+        m_requested.colorMode = mode;
+        scheduleUpdate(m_requested.visualMode != NormalMode ? IndexesUpdate : ParametersUpdate);
     }
 }
 
 void GeneRendererGL::slotSetGenesCutOff(bool enable)
 {
-    if (m_genes_cutoff != enable) {
-        m_genes_cutoff = enable;
-        updateVisual();
+    if (m_requested.genesCutoff != enable) {
+        m_requested.genesCutoff = enable;
+        scheduleUpdate(AggregatesUpdate);
     }
 }
 
@@ -629,6 +896,11 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
         return;
     }
 
+    // frame boundary, the result of the last visual update is drawn from now on
+    // and the changes made since the last frame are computed
+    swapVisualData();
+    flushUpdate();
+
     m_shader_program.bind();
 
     const QMatrix4x4 projectionModelViewMatrix = getProjection() * getModelView();
@@ -648,9 +920,9 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
     int texture = m_shader_program.attributeLocation("textureAttr");
 
     // add UNIFORM values to shader program
-    m_shader_program.setUniformValue(visualMode, static_cast<GLint>(m_visualMode));
-    m_shader_program.setUniformValue(colorMode, static_cast<GLint>(m_colorComputingMode));
-    m_shader_program.setUniformValue(poolingMode, static_cast<GLint>(m_poolingMode));
+    m_shader_program.setUniformValue(visualMode, static_cast<GLint>(m_parameters.visualMode));
+    m_shader_program.setUniformValue(colorMode, static_cast<GLint>(m_parameters.colorMode));
+    m_shader_program.setUniformValue(poolingMode, static_cast<GLint>(m_parameters.poolingMode));
     m_shader_program.setUniformValue(upperLimit, static_cast<GLint>(m_localPooledMax));
     m_shader_program.setUniformValue(lowerLimit, static_cast<GLint>(m_localPooledMin));
     m_shader_program.setUniformValue(intensity, static_cast<GLfloat>(m_intensity));
@@ -699,6 +971,14 @@ void GeneRendererGL::setupShaders()
         return;
     }
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    // the binary of the linked program is cached on disk by Qt (when the driver
+    // supports program binaries) so the shaders are only compiled the first time
+    m_shader_program.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex,
+                                                      ":shader/geneShader.vert");
+    m_shader_program.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment,
+                                                      ":shader/geneShader.frag");
+#else
     QOpenGLShader vShader(QOpenGLShader::Vertex);
     vShader.compileSourceFile(":shader/geneShader.vert");
 
@@ -707,6 +987,7 @@ void GeneRendererGL::setupShaders()
 
     m_shader_program.addShader(&vShader);
     m_shader_program.addShader(&fShader);
+#endif
 
     if (!m_shader_program.link()) {
         qDebug() << "GeneRendererGL: unable to link a shader program." + m_shader_program.log();
@@ -734,17 +1015,27 @@ void GeneRendererGL::setShape(const GeneShape &shape)
     }
 }
 
-bool GeneRendererGL::featureReadsOutsideRange(const int value)
+IndexAggregates::Filter GeneRendererGL::VisualParameters::aggregatesFilter() const
+{
+    return IndexAggregates::Filter(readsLower, readsUpper, genesCutoff);
+}
+
+bool GeneRendererGL::VisualParameters::featureReadsOutsideRange(const int value) const
+{
+    return (value < readsLower || value > readsUpper);
+}
+
+bool GeneRendererGL::VisualParameters::featureGenesOutsideRange(const int value) const
 {
-    return (value < m_thresholdReadsLower || value > m_thresholdReadsUpper);
+    return (value < genesLower || value > genesUpper);
 }
 
-bool GeneRendererGL::featureGenesOutsideRange(const int value)
+bool GeneRendererGL::VisualParameters::featureTotalReadsOutsideRange(const int value) const
 {
-    return (value < m_thresholdGenesLower || value > m_thresholdGenesUpper);
+    return (value < totalReadsLower || value > totalReadsUpper);
 }
 
-bool GeneRendererGL::featureTotalReadsOutsideRange(const int value)
+bool GeneRendererGL::VisualParameters::pooled() const
 {
-    return (value < m_thresholdTotalReadsLower || value > m_thresholdTotalReadsUpper);
+    return visualMode == DynamicRangeMode || visualMode == HeatMapMode;
 }
@@ -4,15 +4,22 @@
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
 
 #include "math/QuadTree.h"
 #include "SelectionEvent.h"
 #include "GeneData.h"
+#include "IndexAggregates.h"
+#include "VisualUpdateState.h"
 #include "data/DataProxy.h"
+#include "dataModel/SpotGeneMatrix.h"
 #include "SettingsVisual.h"
 
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 #include "GraphicItemGL.h"
 
@@ -30,8 +37,13 @@ inline uint qHash(const std::shared_ptr<T> &key, uint seed = 0)
 // To clarify, by index(spot) we mean the physical spot in the array
 // and by feature we mean the gene-index combination
 
-//TODO data and API will be split into two and the data containers will
-//be optimized a lot
+// The lookup data is a spot x gene matrix (see SpotGeneMatrix) built once
+// in generateData() where the rows are the OpenGL indexes (spots)
+// The rendering data is computed in the background into a back buffer that
+// is swapped with the one drawn at the next frame (see updateVisual())
+// The changes made by the slots are not computed right away, they are
+// collected and computed by a single update when the next frame is drawn
+// (see scheduleUpdate())
 class GeneRendererGL : public GraphicItemGL
 {
     Q_OBJECT
@@ -44,23 +56,8 @@ public:
     // different visualization modes
     enum GeneVisualMode { NormalMode = 1, DynamicRangeMode = 2, HeatMapMode = 3 };
 
-    // Visualization data
-    // TODO this approach to store and visualization data will be refactored soon
-    // visualization data will be stored and encapsulated in an object and it will
-    // have a much more memory/speed efficient way to access and compute the
-    // visualization data.
-
     // list of unique spot indexes
-    // Qt containers are faster than STL containers
-    typedef QSet<int> IndexesList;
-    // Spot index to list of features (gene-spot)
-    typedef QMultiHash<int, DataProxy::FeaturePtr> FeaturesByIndexMap;
-    // Gene object to list of features (accross all spots)
-    typedef QHash<DataProxy::GenePtr, std::vector<int> > FeaturesByGeneMap;
-    // gene object to list of spot indexes
-    typedef QMultiHash<DataProxy::GenePtr, int> IndexesByGeneMap;
-    // spot index to total reads/genes
-    typedef QHash<int, int> IndexTotalCount;
+    typedef QVector<int> IndexesList;
     // lookup quadtree type (spot indexes)
     typedef QuadTree<int, 8> GeneInfoQuadTree;
 
@@ -84,10 +81,11 @@ public:
     void setDimensions(const QRectF &border);
 
     // makes a selection of spots given a list of genes (always account for the tresholds)
+    // the spots are selected when the update of the genes is drawn
     void selectGenes(const DataProxy::GeneList &genes);
 
     // returns the currently selected features (counts on each selected spot)
-    const DataProxy::FeatureList &getSelectedFeatures() const;
+    const DataProxy::FeatureList getSelectedFeatures() const;
 
     // some getters for the thresholds
     int getMinReadsThreshold() const;
@@ -143,6 +141,10 @@ signals:
     // to notify the gene selections model that a selection has been made
     void selectionUpdated();
 
+private slots:
+    // the background visual update has finished
+    void slotVisualUpdated();
+
 protected:
     // Make a selections based on an area (box)
     void setSelectionArea(const SelectionEvent *event) override;
@@ -152,23 +154,96 @@ protected:
 
 private:
 
-    // helper functions to test whether a feature is outside the threshold
-    // area or not by reads/genes or TPM
-    bool featureReadsOutsideRange(const int value);
-    bool featureGenesOutsideRange(const int value);
-    bool featureTotalReadsOutsideRange(const int value);
+    // what has to be recomputed at the next frame (in increasing order of cost)
+    enum UpdateLevel {
+        NoUpdate = 0,
+        // only the parameters used by the shaders changed
+        ParametersUpdate = 1,
+        // the state of some genes changed (see updateVisual(geneList))
+        GenesUpdate = 2,
+        // the rendering values of all the indexes must be recomputed
+        IndexesUpdate = 3,
+        // the thresholds or the cut-off changed (see updateVisual())
+        AggregatesUpdate = 4
+    };
+
+    // the visual parameters changeable by the slots
+    struct VisualParameters
+    {
+        VisualParameters();
+
+        // helper functions to test whether a feature is outside the threshold
+        // area or not by reads/genes or TPM
+        bool featureReadsOutsideRange(const int value) const;
+        bool featureGenesOutsideRange(const int value) const;
+        bool featureTotalReadsOutsideRange(const int value) const;
+        // the features added to the aggregates (reads threshold and genes cut-off)
+        IndexAggregates::Filter aggregatesFilter() const;
+        // whether the colors are computed from the pooled min-max
+        bool pooled() const;
+
+        int readsLower;
+        int readsUpper;
+        int genesLower;
+        int genesUpper;
+        int totalReadsLower;
+        int totalReadsUpper;
+        bool genesCutoff;
+        GeneVisualMode visualMode;
+        Visual::GenePooledMode poolingMode;
+        Visual::GeneColorMode colorMode;
+    };
+
+    // requests an update of the level given at the next frame
+    // (the pending changes are merged and a repaint is requested)
+    void scheduleUpdate(const UpdateLevel level);
+    // starts the update pending, if any, with the parameters requested
+    // (they are drawn with its result) or, if an update is in flight, merges it
+    // with the next changes so it is started once the one in flight has finished
+    // (which is only cancelled if it has been running for several frames)
+    void flushUpdate();
 
     // will iterate all the features to change size
     void updateSize();
-    // will call updateVisual over all the unique genes present in all the
-    // features
+    // stores the state of every gene and recomputes the aggregates of all the
+    // indexes and their rendering values
+    // (needed when the thresholds or the cut-off mode change)
     void updateVisual();
-    // will call updateVisual with the indexes that contain genes present in the
-    // input
+    // applies the changes of the genes given to the aggregates of the indexes
+    // that contain them and updates the rendering values of those indexes
     void updateVisual(const DataProxy::GeneList &geneList);
-    // goes trough each index(spot) and computes its rendering values by
-    // iterating over all its features. Thresholds are applied too.
-    void updateVisual(const IndexesList &indexes);
+    // starts a background update of the rendering values of each index(spot)
+    // given from its aggregates (recomputing them first if aggregates is true)
+    // into the back buffer. The total reads/genes thresholds are applied too.
+    // No update can be in flight (see flushUpdate()).
+    void updateVisual(const IndexesList &indexes, const bool aggregates = false);
+    // the background job of updateVisual(), large lists of indexes are split in
+    // ranges computed concurrently (see DataRenderer)
+    // returns false if the update was cancelled
+    bool computeVisual(const IndexesList &indexes, const bool aggregates);
+    // waits for the update in flight (cancelling it first if cancel is true)
+    // and marks the back buffer as ready if it was completed
+    // it only blocks when the data is cleared, otherwise it is called once the
+    // update has finished (see slotVisualUpdated())
+    void finishVisualUpdate(const bool cancel);
+    // swaps the back buffer and its parameters with the ones drawn if it is
+    // ready and selects the spots of the genes selected with the update
+    // (see selectGenes())
+    // returns true if the buffers were swapped
+    bool swapVisualData();
+    // the kernel of updateVisual() for the range [begin, end) of the indexes given
+    // the pooled min-max given are updated with the visible indexes of the range
+    // it only writes to the elements of the indexes in the range so calls with
+    // disjoint ranges can run concurrently
+    void updateIndexes(const IndexesList &indexes,
+                       const int begin,
+                       const int end,
+                       const bool aggregates,
+                       int &pooledMin,
+                       int &pooledMax);
+    // updates the pooled min-max of the back buffer with the rendering values
+    // of all its visible indexes
+    void updatePooledRange();
     // iterates the spots given and selects them to update the list of selected
     // features (spot-gene)
     // only features that are inside threshold will be counted
@@ -177,6 +252,10 @@ private:
     // mode can be = new , add or remove
     void selectSpots(const IndexesList &indexes, const SelectionEvent::SelectionMode &mode);
 
+    // fills the list given with the unique indexes that contain genes of the list
+    // (the marks of the indexes are reused so no allocation is made)
+    void indexesOfGenes(const DataProxy::GeneList &geneList, IndexesList &indexes);
+
     // reset quad tree to rect size
     void resetQuadTree(const QRectF &rect);
 
@@ -185,20 +264,22 @@ private:
 
     // lookup data (features respesent counts, a feature = (gene,spot) count
     // index is the OpenGL index
-    // just the set of indexes for convenience
+    // just the list of all the indexes for convenience
     IndexesList m_indexes;
-    // lookup data (index -> features)
-    FeaturesByIndexMap m_geneInfoByIndex;
-    // lookup data (gene -> indexes)
-    IndexesByGeneMap m_geneInfoByGene;
-    // look up data (gene -> counts)
-    FeaturesByGeneMap m_geneInfoByGeneFeatures;
-    // list of selected features
-    DataProxy::FeatureList m_geneInfoSelectedFeatures;
-    // gene look up (index -> total reads)
-    IndexTotalCount m_geneInfoTotalReadsIndex;
-    // gene look up (index -> total genes)
-    IndexTotalCount m_geneInfoTotalGenesIndex;
+    // the features of the dataset (shared with DataProxy)
+    FeatureStore m_features;
+    // lookup data (index x gene counts and totals, gene -> indexes)
+    SpotGeneMatrix m_matrix;
+    // the spot of the store of each index (for its coordinates)
+    QVector<FeatureStore::SpotIndex> m_indexSpots;
+    // reusable marks and list of indexes (see indexesOfGenes())
+    std::vector<bool> m_indexMarks;
+    IndexesList m_geneIndexes;
+    // list of selected features (indexes of the feature store)
+    QVector<FeatureStore::FeatureIndex> m_geneInfoSelectedFeatures;
+
+    // running aggregates of the features shown in each index
+    IndexAggregates m_aggregates;
     // quad tree container (used to find by coordinates)
     GeneInfoQuadTree m_geneInfoQuadTree;
 
@@ -207,16 +288,10 @@ private:
     float m_size;
     GeneShape m_shape;
 
-    // threshold limits for gene hits
-    int m_thresholdReadsLower;
-    int m_thresholdReadsUpper;
-    int m_thresholdGenesLower;
-    int m_thresholdGenesUpper;
-    int m_thresholdTotalReadsLower;
-    int m_thresholdTotalReadsUpper;
-
-    // enable/disable genes cutoff
-    bool m_genes_cutoff;
+    // threshold limits, genes cutoff and visual, pooling (by gene count or reads
+    // counts or tpm counts) and color computing (exp - log - linear) modes
+    // of the rendering data drawn
+    VisualParameters m_parameters;
 
     // local pooled min-max for rendering (Adjusted according to what is being
     // rendered)
@@ -226,15 +301,6 @@ private:
     // bounding rect area
     QRectF m_border;
 
-    // visual mode
-    GeneVisualMode m_visualMode;
-
-    // pooling mode (by gene count or reads counts or tpm counts)
-    Visual::GenePooledMode m_poolingMode;
-
-    // color computing mode (exp - log - linear)
-    Visual::GeneColorMode m_colorComputingMode;
-
     // to know if the rendering data is ready
     bool m_isInitialized;
 
@@ -245,6 +311,38 @@ private:
     GeneData m_geneData;
     QOpenGLShaderProgram m_shader_program;
 
+    // back buffer of the rendering data (written by the visual updates)
+    GeneData m_backData;
+    int m_backPooledMin;
+    int m_backPooledMax;
+    // the parameters of the back buffer (read by the update in flight)
+    VisualParameters m_backParameters;
+    // the visual update in flight (see updateVisual()) and the state of the
+    // updates (cancellation, result ready to be drawn, aggregates dirty)
+    QFutureWatcher<bool> m_visualWatcher;
+    VisualUpdateState m_visualState;
+
+    // the parameters requested by the slots (applied at the next frame)
+    VisualParameters m_requested;
+    // the update pending for the next frame and the genes changed
+    UpdateLevel m_pendingUpdate;
+    DataProxy::GeneList m_pendingGenes;
+    // the genes whose spots are selected (see selectGenes()) by the next update
+    // and by the update in flight once its result is drawn
+    DataProxy::GeneList m_pendingSelection;
+    DataProxy::GeneList m_visualSelection;
+    // latency instrumentation: time since the first change not computed yet
+    // and number of changes merged, and the same for the update in flight
+    // (measured until its result is drawn)
+    QElapsedTimer m_requestTimer;
+    int m_requestChanges;
+    QElapsedTimer m_visualTimer;
+    int m_visualChanges;
+
+    // threads to compute the rendering data (see DataRenderer)
+    QThreadPool m_threadPool;
+
+    friend class DataRenderer;
     Q_DISABLE_COPY(GeneRendererGL)
 };
 
@@ -0,0 +1,187 @@
+#include "IndexAggregates.h"
+
+#include "SettingsVisual.h"
+
+IndexAggregates::Aggregate::Aggregate()
+    : genes(0)
+    , reads(0)
+    , red(0)
+    , green(0)
+    , blue(0)
+    , alpha(0)
+{
+}
+
+void IndexAggregates::Aggregate::add(const int count, const QColor &color)
+{
+    ++genes;
+    reads += count;
+    red += color.red();
+    green += color.green();
+    blue += color.blue();
+    alpha += color.alpha();
+}
+
+void IndexAggregates::Aggregate::remove(const int count, const QColor &color)
+{
+    Q_ASSERT(genes > 0);
+    --genes;
+    reads -= count;
+    red -= color.red();
+    green -= color.green();
+    blue -= color.blue();
+    alpha -= color.alpha();
+}
+
+QColor IndexAggregates::Aggregate::color() const
+{
+    // the channels are summed as integers so adding and removing
+    // genes does not accumulate rounding errors
+    if (genes == 0) {
+        return Visual::DEFAULT_COLOR_GENE;
+    }
+    return QColor(red / genes, green / genes, blue / genes, alpha / genes);
+}
+
+bool IndexAggregates::Aggregate::operator==(const Aggregate &other) const
+{
+    return genes == other.genes && reads == other.reads && red == other.red
+           && green == other.green && blue == other.blue && alpha == other.alpha;
+}
+
+IndexAggregates::Filter::Filter(const int readsLower, const int readsUpper, const bool genesCutoff)
+    : readsLower(readsLower)
+    , readsUpper(readsUpper)
+    , genesCutoff(genesCutoff)
+{
+}
+
+bool IndexAggregates::Filter::shown(const int count, const bool selected, const int cutOff) const
+{
+    return selected && count >= readsLower && count <= readsUpper
+           && !(genesCutoff && count < cutOff);
+}
+
+IndexAggregates::GeneState::GeneState()
+    : selected(false)
+    , cutOff(0)
+    , color(Visual::DEFAULT_COLOR_GENE)
+{
+}
+
+IndexAggregates::IndexAggregates()
+    : m_matrix()
+    , m_aggregates()
+    , m_geneStates()
+    , m_marks()
+{
+}
+
+IndexAggregates::~IndexAggregates()
+{
+}
+
+void IndexAggregates::reset(const SpotGeneMatrix &matrix)
+{
+    m_matrix = matrix;
+    m_aggregates.fill(Aggregate(), m_matrix.rows());
+    m_geneStates.fill(GeneState(), m_matrix.columns());
+    m_marks.assign(static_cast<size_t>(m_matrix.rows()), false);
+}
+
+void IndexAggregates::clear()
+{
+    m_matrix = SpotGeneMatrix();
+    m_aggregates.clear();
+    m_geneStates.clear();
+    m_marks.clear();
+}
+
+void IndexAggregates::storeGeneStates(const DataProxy::GeneList &genes)
+{
+    m_geneStates.fill(GeneState(), m_matrix.columns());
+    for (const auto &gene : genes) {
+        Q_ASSERT(gene);
+        const int id = static_cast<int>(gene->id());
+        if (id < m_geneStates.size()) {
+            GeneState &state = m_geneStates[id];
+            state.selected = gene->selected();
+            state.cutOff = gene->cut_off();
+            state.color = gene->color();
+        }
+    }
+}
+
+void IndexAggregates::rebuild(const int index, const Filter &filter)
+{
+    Aggregate &aggregate = m_aggregates[index];
+    aggregate = Aggregate();
+    for (auto entry = m_matrix.rowBegin(index); entry < m_matrix.rowEnd(index); ++entry) {
+        const GeneState &state = m_geneStates.at(static_cast<int>(m_matrix.geneId(entry)));
+        const int count = m_matrix.count(entry);
+        if (filter.shown(count, state.selected, state.cutOff)) {
+            aggregate.add(count, state.color);
+        }
+    }
+}
+
+void IndexAggregates::update(const DataProxy::GeneList &genes,
+                             const Filter &filter,
+                             QVector<int> &indexes)
+{
+    indexes.resize(0);
+    for (const auto &gene : genes) {
+        Q_ASSERT(gene);
+        const int id = static_cast<int>(gene->id());
+        if (id >= m_geneStates.size()) {
+            continue;
+        }
+        GeneState &state = m_geneStates[id];
+        const bool selected = gene->selected();
+        const int cutOff = gene->cut_off();
+        const QColor color = gene->color();
+        if (state.selected == selected && state.cutOff == cutOff && state.color == color) {
+            continue;
+        }
+
+        // apply the difference to the indexes that contain the gene
+        for (auto entry = m_matrix.geneBegin(gene->id()); entry < m_matrix.geneEnd(gene->id());
+             ++entry) {
+            const int index = m_matrix.geneRow(entry);
+            const int count = m_matrix.geneCount(entry);
+            const bool was_shown = filter.shown(count, state.selected, state.cutOff);
+            const bool shown = filter.shown(count, selected, cutOff);
+            if (!was_shown && !shown) {
+                continue;
+            }
+            Aggregate &aggregate = m_aggregates[index];
+            if (was_shown) {
+                aggregate.remove(count, state.color);
+            }
+            if (shown) {
+                aggregate.add(count, color);
+            }
+            if (!m_marks[static_cast<size_t>(index)]) {
+                m_marks[static_cast<size_t>(index)] = true;
+                indexes.push_back(index);
+            }
+        }
+        state.selected = selected;
+        state.cutOff = cutOff;
+        state.color = color;
+    }
+    // clear the marks for the next call
+    for (const auto index : indexes) {
+        m_marks[static_cast<size_t>(index)] = false;
+    }
+}
+
+int IndexAggregates::size() const
+{
+    return m_aggregates.size();
+}
+
+const IndexAggregates::Aggregate &IndexAggregates::at(const int index) const
+{
+    return m_aggregates.at(index);
+}
@@ -0,0 +1,92 @@
+#ifndef INDEXAGGREGATES_H
+#define INDEXAGGREGATES_H
+
+#include <QVector>
+#include <QColor>
+
+#include <vector>
+
+#include "data/DataProxy.h"
+#include "dataModel/SpotGeneMatrix.h"
+
+// Running aggregates of the features shown in each index (spot) of a spot x
+// gene matrix (see GeneRendererGL): the features inside the reads threshold
+// and the cut-off of a selected gene. The color of an index is the mean of
+// the colors of its genes.
+// The state of the genes is stored when they are added so the aggregates can
+// be updated with the difference between it and the current state of some
+// genes instead of being rebuilt, which is only needed when the thresholds
+// or the cut-off mode change. No OpenGL is used.
+class IndexAggregates
+{
+
+public:
+    // the aggregate of an index
+    struct Aggregate {
+        Aggregate();
+        void add(const int count, const QColor &color);
+        void remove(const int count, const QColor &color);
+        QColor color() const;
+        bool operator==(const Aggregate &other) const;
+
+        int genes;
+        int reads;
+        int red;
+        int green;
+        int blue;
+        int alpha;
+    };
+
+    // the features added to the aggregates
+    struct Filter {
+        Filter(const int readsLower, const int readsUpper, const bool genesCutoff);
+        // whether a feature of a gene in the state given is added
+        bool shown(const int count, const bool selected, const int cutOff) const;
+
+        int readsLower;
+        int readsUpper;
+        bool genesCutoff;
+    };
+
+    IndexAggregates();
+    ~IndexAggregates();
+
+    // empty aggregates for every row of the matrix given
+    void reset(const SpotGeneMatrix &matrix);
+    void clear();
+
+    // stores the current state of every gene given (see rebuild())
+    void storeGeneStates(const DataProxy::GeneList &genes);
+    // recomputes the aggregate of the index from the states stored
+    // it only writes the aggregate of the index so calls with different
+    // indexes can run concurrently
+    void rebuild(const int index, const Filter &filter);
+    // applies the difference between the stored state of each gene given and
+    // the current one to the aggregates of the indexes that contain the gene
+    // and fills the list given with those indexes (unique)
+    void update(const DataProxy::GeneList &genes, const Filter &filter, QVector<int> &indexes);
+
+    int size() const;
+    const Aggregate &at(const int index) const;
+
+private:
+    // the state of a gene when it was added to the aggregates
+    struct GeneState {
+        GeneState();
+
+        bool selected;
+        int cutOff;
+        QColor color;
+    };
+
+    // the lookup data (shared with the renderer)
+    SpotGeneMatrix m_matrix;
+    // aggregates of each index
+    QVector<Aggregate> m_aggregates;
+    // state of each gene (by gene ID)
+    QVector<GeneState> m_geneStates;
+    // reusable marks of the indexes updated
+    std::vector<bool> m_marks;
+};
+
+#endif // INDEXAGGREGATES_H //
@@ -0,0 +1,121 @@
+#include "VisualUpdateState.h"
+
+const int VisualUpdateState::MAX_FRAMES;
+
+VisualUpdateState::Job::Job()
+    : aggregates(false)
+    , allIndexes(false)
+{
+}
+
+VisualUpdateState::VisualUpdateState()
+    : m_inFlight(false)
+    , m_inFlightAggregates(false)
+    , m_frames(0)
+    , m_cancelled(0)
+    , m_resultReady(false)
+    , m_aggregatesDirty(false)
+    , m_stale(false)
+{
+}
+
+VisualUpdateState::~VisualUpdateState()
+{
+}
+
+VisualUpdateState::Job VisualUpdateState::start(const bool aggregates)
+{
+    // the update starts from the rendering data drawn so the result
+    // of the last update must have been taken
+    Q_ASSERT(!m_inFlight && !m_resultReady);
+
+    Job job;
+    job.aggregates = aggregates || m_aggregatesDirty;
+    job.allIndexes = job.aggregates || m_stale;
+    // the aggregates are dirty until the update completes
+    m_aggregatesDirty = job.aggregates;
+    m_stale = false;
+    m_inFlightAggregates = job.aggregates;
+    m_frames = 0;
+    m_cancelled.store(0);
+    m_inFlight = true;
+    return job;
+}
+
+void VisualUpdateState::finish(const bool completed)
+{
+    Q_ASSERT(m_inFlight);
+    m_inFlight = false;
+    // the update could have been completed before being cancelled
+    if (completed) {
+        m_resultReady = true;
+        if (m_inFlightAggregates) {
+            m_aggregatesDirty = false;
+        }
+    } else {
+        m_stale = true;
+    }
+}
+
+void VisualUpdateState::nextFrame()
+{
+    if (m_inFlight) {
+        ++m_frames;
+    }
+}
+
+bool VisualUpdateState::supersede()
+{
+    if (!m_inFlight || m_frames <= MAX_FRAMES) {
+        return false;
+    }
+    cancel();
+    return true;
+}
+
+void VisualUpdateState::cancel()
+{
+    if (m_inFlight) {
+        m_cancelled.store(1);
+    }
+}
+
+bool VisualUpdateState::takeResult()
+{
+    if (!m_resultReady) {
+        return false;
+    }
+    m_resultReady = false;
+    return true;
+}
+
+void VisualUpdateState::reset()
+{
+    Q_ASSERT(!m_inFlight);
+    m_inFlightAggregates = false;
+    m_frames = 0;
+    m_cancelled.store(0);
+    m_resultReady = false;
+    m_aggregatesDirty = false;
+    m_stale = false;
+}
+
+bool VisualUpdateState::isInFlight() const
+{
+    return m_inFlight;
+}
+
+bool VisualUpdateState::isCancelled() const
+{
+    return m_cancelled.load() != 0;
+}
+
+bool VisualUpdateState::aggregatesDirty() const
+{
+    return m_aggregatesDirty;
+}
+
+bool VisualUpdateState::isStale() const
+{
+    return m_stale;
+}
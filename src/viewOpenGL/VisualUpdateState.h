@@ -0,0 +1,77 @@
+#ifndef VISUALUPDATESTATE_H
+#define VISUALUPDATESTATE_H
+
+#include <QAtomicInt>
+
+// The state of the background updates of the rendering data of GeneRendererGL
+// (one in flight at a time), it decides what each update computes:
+// - an update cancelled leaves the aggregates it was rebuilding dirty and the
+//   rendering data stale so the next one rebuilds them and updates all the indexes
+// - the result of an update completed is ready until it is drawn (see takeResult())
+// - newer changes only cancel the update in flight once it has been running for
+//   more than MAX_FRAMES frames, otherwise its result is drawn
+// No OpenGL is used.
+class VisualUpdateState
+{
+
+public:
+    // frames an update can be in flight before it is cancelled by newer changes
+    static const int MAX_FRAMES = 3;
+
+    // what an update computes
+    struct Job {
+        Job();
+
+        // the aggregates of the indexes are recomputed
+        bool aggregates;
+        // all the indexes are updated (not only the ones changed)
+        bool allIndexes;
+    };
+
+    VisualUpdateState();
+    ~VisualUpdateState();
+
+    // starts an update (none can be in flight and no result can be ready)
+    // the aggregates are recomputed if aggregates is true or the last time was
+    // cancelled and all the indexes are updated if the last update was cancelled
+    Job start(const bool aggregates);
+    // the update in flight has finished, completed is false if it was cancelled
+    void finish(const bool completed);
+    // a frame has been drawn
+    void nextFrame();
+    // newer changes are waiting, the update in flight is cancelled if it has been
+    // running for more than MAX_FRAMES frames, returns true if it was cancelled
+    bool supersede();
+    // cancels the update in flight (if any)
+    void cancel();
+    // takes the result of the last update completed to be drawn
+    // returns false if there is none
+    bool takeResult();
+    // forgets everything (no update can be in flight)
+    void reset();
+
+    // an update was started and it has not finished
+    bool isInFlight() const;
+    // the update in flight must stop (the workers check it)
+    bool isCancelled() const;
+    // the aggregates were not completely recomputed
+    bool aggregatesDirty() const;
+    // the rendering data was not completely updated (the next update must update all)
+    bool isStale() const;
+
+private:
+    bool m_inFlight;
+    // the update in flight recomputes the aggregates
+    bool m_inFlightAggregates;
+    // frames drawn since the update in flight was started
+    int m_frames;
+    // set to cancel the update in flight
+    QAtomicInt m_cancelled;
+    bool m_resultReady;
+    bool m_aggregatesDirty;
+    bool m_stale;
+
+    Q_DISABLE_COPY(VisualUpdateState)
+};
+
+#endif // VISUALUPDATESTATE_H //
@@ -810,8 +810,8 @@ void CellViewPage::slotCreateSelection()
     const auto dataset = m_dataProxy->getDatasetById(m_openedDatasetId);
     Q_ASSERT(dataset);
     // get selected features and create the selection object
-    const auto &selectedFeatures = m_gene_plotter->getSelectedFeatures();
-    if (selectedFeatures.empty()) {
+    const auto selectedFeatures = m_gene_plotter->getSelectedFeatures();
+    if (selectedFeatures.isEmpty()) {
         // the user has probably clear the selections
         return;
     }
@@ -819,7 +819,7 @@ void CellViewPage::slotCreateSelection()
     UserSelection new_selection;
     // loadFeatures() will populate list of aggregated genes and spots
     new_selection.id(QUuid::createUuid().toString());
-    new_selection.loadFeatures(selectedFeatures);
+    new_selection.loadFeatures(selectedFeatures, m_dataProxy->geneDictionary());
     new_selection.enabled(true);
     new_selection.saved(false);
     new_selection.datasetId(dataset->id());
@@ -6,6 +6,9 @@
 #include <QMessageBox>
 #include <QUuid>
 #include <QDateTime>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QMenu>
 
 #include "QtWaitingSpinner/waitingspinnerwidget.h"
 
@@ -16,6 +19,7 @@
 #include "dataModel/Dataset.h"
 #include "dataModel/Chip.h"
 #include "dataModel/ImageAlignment.h"
+#include "io/BinaryFeatureFile.h"
 #include "dataModel/Dataset.h"
 #include "SettingsStyle.h"
 
@@ -65,6 +69,15 @@ DatasetPage::DatasetPage(QSharedPointer<DataProxy> dataProxy, QWidget *parent)
     connect(m_ui->editDataset, SIGNAL(clicked(bool)), this, SLOT(slotEditDataset()));
     connect(m_ui->openDataset, SIGNAL(clicked(bool)), this, SLOT(slotOpenDataset()));
     connect(m_ui->importDataset, SIGNAL(clicked(bool)), this, SLOT(slotImportDataset()));
+    m_ui->datasetsTableView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_ui->datasetsTableView,
+            SIGNAL(customContextMenuRequested(QPoint)),
+            this,
+            SLOT(slotDatasetContextMenu(QPoint)));
+    connect(m_dataProxy.data(),
+            &DataProxy::signalFeaturesParsing,
+            this,
+            &DatasetPage::slotFeaturesParsing);
 
     clearControls();
 }
@@ -118,6 +131,7 @@ void DatasetPage::slotDatasetSelected(QModelIndex index)
     const auto currentDatasets = datasetsModel()->getDatasets(selected);
     // Check if the selection is valid
     if (!index.isValid() || currentDatasets.empty()) {
+        m_dataProxy->cancelPrefetch();
         return;
     }
     // Enable only remove if more than one selected
@@ -125,6 +139,13 @@ void DatasetPage::slotDatasetSelected(QModelIndex index)
     m_ui->deleteDataset->setEnabled(true);
     m_ui->editDataset->setEnabled(!more_than_one);
     m_ui->openDataset->setEnabled(!more_than_one);
+    // the dataset will probably be opened so its content is downloaded in the
+    // background (if enabled) and the prefetch of the previous one is canceled
+    if (more_than_one) {
+        m_dataProxy->cancelPrefetch();
+    } else {
+        m_dataProxy->prefetchDatasetContent(currentDatasets.front());
+    }
 }
 
 void DatasetPage::slotSelectAndOpenDataset(QModelIndex index)
@@ -139,12 +160,20 @@ void DatasetPage::slotLoadDatasets()
         return;
     }
 
-    // download datasets
+    // download datasets (the page is not blocked while they are downloaded)
     m_waiting_spinner->start();
-    if (m_dataProxy->loadDatasets()) {
-        slotDatasetsUpdated();
-    }
-    m_waiting_spinner->stop();
+    auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+    connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+        m_waiting_spinner->stop();
+        const auto result = watcher->result();
+        if (result.ok()) {
+            slotDatasetsUpdated();
+        } else {
+            QMessageBox::critical(this, result.error->name(), result.error->description());
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_dataProxy->loadDatasetsAsync());
 }
 
 void DatasetPage::slotEditDataset()
@@ -205,12 +234,20 @@ void DatasetPage::slotOpenDataset()
 
     m_waiting_spinner->start();
     if (dataset->downloaded()) {
-        if (m_dataProxy->loadDatasetContent(dataset)) {
-            emit signalDatasetOpen(dataset->id());
-        } else {
-            // NOTE show error here?
-            qDebug() << "Error downloading the dataset content..";
-        }
+        // the dataset may be being prefetched so its content is loaded once it is ready
+        auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+        connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+            m_waiting_spinner->stop();
+            const DataProxy::RequestResult result = watcher->result();
+            if (result.ok()) {
+                emit signalDatasetOpen(dataset->id());
+            } else {
+                qDebug() << "Error downloading the dataset content..";
+                QMessageBox::critical(this, result.error->name(), result.error->description());
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(m_dataProxy->loadDatasetContentAsync(dataset));
     } else {
 
         const auto importer = m_importedDatasets.value(dataset->id());
@@ -240,10 +277,15 @@ void DatasetPage::slotOpenDataset()
         chip.y2Total(y2 + 2);
         m_dataProxy->loadChip(chip);
 
-        // add the features
-        const QByteArray &featuresFile = importer->featuresFile();
-        Q_ASSERT(!featuresFile.isNull() && !featuresFile.isEmpty());
-        parsedOk &= m_dataProxy->loadFeatures(featuresFile);
+        // add the features (binary files are memory mapped instead of read)
+        BinaryFeatureFile binaryFeaturesFile;
+        if (binaryFeaturesFile.open(importer->featuresFilePath())) {
+            parsedOk &= m_dataProxy->loadFeatures(binaryFeaturesFile);
+        } else {
+            const QByteArray &featuresFile = importer->featuresFile();
+            Q_ASSERT(!featuresFile.isNull() && !featuresFile.isEmpty());
+            parsedOk &= m_dataProxy->loadFeatures(featuresFile);
+        }
 
         // creates an image alignment with the previous chip and the images
         ImageAlignment alignment;
@@ -272,9 +314,53 @@ void DatasetPage::slotOpenDataset()
             QMessageBox::critical(this, tr("Dataset content"), tr("Error loading dataset content"));
             // TODO clear up the content in dataProxy
         }
+        m_waiting_spinner->stop();
     }
+}
 
-    m_waiting_spinner->stop();
+void DatasetPage::slotFeaturesParsing(QFuture<void> future)
+{
+    // the dialog is modal so no other dataset can be opened meanwhile
+    // NOTE the progress is reported in bytes
+    QProgressDialog *progress
+        = new QProgressDialog(tr("Loading ST data..."), tr("Cancel"), 0, 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(progress);
+    connect(watcher, SIGNAL(progressRangeChanged(int, int)), progress, SLOT(setRange(int, int)));
+    connect(watcher, SIGNAL(progressValueChanged(int)), progress, SLOT(setValue(int)));
+    connect(watcher, &QFutureWatcher<void>::progressTextChanged, [=](const QString &features) {
+        progress->setLabelText(tr("Loading ST data... %1 features").arg(features));
+    });
+    // DataProxy will keep the current features if the parsing is canceled
+    connect(progress, SIGNAL(canceled()), watcher, SLOT(cancel()));
+    connect(watcher, SIGNAL(finished()), progress, SLOT(deleteLater()));
+    watcher->setFuture(future);
+}
+
+void DatasetPage::slotDatasetContextMenu(const QPoint &pos)
+{
+    const auto selected = m_ui->datasetsTableView->datasetsTableItemSelection();
+    const auto currentDatasets = datasetsModel()->getDatasets(selected);
+    // only one dataset of the database can be pinned at a time
+    if (currentDatasets.size() != 1 || !currentDatasets.front()->downloaded()) {
+        return;
+    }
+    const auto dataset = currentDatasets.front();
+
+    QMenu menu(this);
+    QAction *pin = menu.addAction(tr("Available offline"));
+    pin->setCheckable(true);
+    pin->setChecked(m_dataProxy->isDatasetPinned(dataset->id()));
+    if (menu.exec(m_ui->datasetsTableView->viewport()->mapToGlobal(pos)) != pin) {
+        return;
+    }
+    // the content is downloaded in the background if needed
+    if (pin->isChecked()) {
+        m_dataProxy->pinDataset(dataset);
+    } else {
+        m_dataProxy->unpinDataset(dataset->id());
+    }
 }
 
 void DatasetPage::slotRemoveDataset()
@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QModelIndex>
+#include <QFuture>
 #include <memory>
 #include "data/DataProxy.h"
 
@@ -59,6 +60,12 @@ private slots:
     void slotEditDataset();
     void slotImportDataset();
 
+    // shows the progress of the features parsing and allows to cancel it
+    void slotFeaturesParsing(QFuture<void> future);
+
+    // shows the menu to pin the selected dataset for offline use
+    void slotDatasetContextMenu(const QPoint &pos);
+
 signals:
 
     // to notify about dataset/s action/s
@@ -8,9 +8,13 @@
 #include <QScrollArea>
 #include <QDateTime>
 #include <QLabel>
+#include <QFutureWatcher>
+#include <QMenu>
 #include "QtWaitingSpinner/waitingspinnerwidget.h"
 
+#include "error/Error.h"
 #include "dataModel/User.h"
+#include "dataModel/UserSelection.h"
 #include "io/FeatureExporter.h"
 #include "model/UserSelectionsItemModel.h"
 #include "dialogs/EditSelectionDialog.h"
@@ -63,6 +67,11 @@ UserSelectionsPage::UserSelectionsPage(QSharedPointer<DataProxy> dataProxy, QWid
     connect(m_ui->showTissue, SIGNAL(clicked(bool)), this, SLOT(slotShowTissue()));
     connect(m_ui->showTable, SIGNAL(clicked(bool)), this, SLOT(slotShowTable()));
     connect(m_ui->saveDB, SIGNAL(clicked(bool)), this, SLOT(slotSaveSelection()));
+    m_ui->selections_tableView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_ui->selections_tableView,
+            SIGNAL(customContextMenuRequested(QPoint)),
+            this,
+            SLOT(slotSelectionContextMenu(QPoint)));
     //connect(m_ui->importSelection, SIGNAL(clicked(bool)), this, SLOT(slotImportSelection()));
 
     clearControls();
@@ -125,12 +134,20 @@ void UserSelectionsPage::loadSelections()
         return;
     }
 
-    // load selections
+    // load selections (the page is not blocked while they are downloaded)
     m_waiting_spinner->start();
-    m_dataProxy->loadUserSelections();
-    m_waiting_spinner->stop();
-    // update the model
-    slotSelectionsUpdated();
+    auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+    connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+        m_waiting_spinner->stop();
+        const auto result = watcher->result();
+        if (!result.ok()) {
+            QMessageBox::critical(this, result.error->name(), result.error->description());
+        }
+        // update the model
+        slotSelectionsUpdated();
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_dataProxy->loadUserSelectionsAsync());
 }
 
 void UserSelectionsPage::slotSelectionSelected(QModelIndex index)
@@ -174,14 +191,36 @@ void UserSelectionsPage::slotRemoveSelection()
         return;
     }
 
-    m_waiting_spinner->start();
+    // the saved selections are removed from the database concurrently and
+    // the selections are updated once all of them have been removed
+    auto pending = QSharedPointer<int>::create(0);
     for (const auto &selection : currentSelections) {
         Q_ASSERT(selection);
-        m_dataProxy->removeSelection(selection->id(), selection->saved());
+        if (!selection->saved()) {
+            m_dataProxy->removeSelection(selection->id(), false);
+            continue;
+        }
+        ++*pending;
+        auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+        connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+            const auto result = watcher->result();
+            if (!result.ok()) {
+                QMessageBox::critical(this, result.error->name(), result.error->description());
+            }
+            watcher->deleteLater();
+            if (--*pending == 0) {
+                m_waiting_spinner->stop();
+                loadSelections();
+            }
+        });
+        watcher->setFuture(m_dataProxy->removeSelectionAsync(selection->id()));
+    }
+    if (*pending == 0) {
+        // update the selections
+        loadSelections();
+    } else {
+        m_waiting_spinner->start();
     }
-    m_waiting_spinner->stop();
-    // update the selections
-    loadSelections();
 }
 
 void UserSelectionsPage::slotExportSelection()
@@ -219,7 +258,9 @@ void UserSelectionsPage::slotExportSelection()
     if (textFile.open(QFile::WriteOnly | QFile::Truncate)) {
         FeatureExporter exporter
             = FeatureExporter(FeatureExporter::SimpleFull, FeatureExporter::TabDelimited);
-        exporter.exportItem(textFile, selectionItem->selectedFeatures());
+        exporter.exportItem(textFile,
+                            selectionItem->selectedFeatures(),
+                            selectionItem->geneDictionary());
     }
 
     textFile.close();
@@ -259,8 +300,16 @@ void UserSelectionsPage::slotEditSelection()
         if (m_dataProxy->userLogIn() && selection->saved()) {
             // update the selection object in the database
             m_waiting_spinner->start();
-            m_dataProxy->updateUserSelection(*selection);
-            m_waiting_spinner->stop();
+            auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+            connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+                m_waiting_spinner->stop();
+                const auto result = watcher->result();
+                if (!result.ok()) {
+                    QMessageBox::critical(this, result.error->name(), result.error->description());
+                }
+                watcher->deleteLater();
+            });
+            watcher->setFuture(m_dataProxy->updateUserSelectionAsync(*selection));
         }
         // NOTE no need for this
         // slotSelectionsUpdated();
@@ -358,11 +407,19 @@ void UserSelectionsPage::slotSaveSelection()
 
     // save the selection object in the database and remove the old one
     m_waiting_spinner->start();
-    m_dataProxy->addUserSelection(*selectionObject, true);
-    m_dataProxy->removeSelection(selectionObject->id(), false);
-    m_waiting_spinner->stop();
-    // update the selections
-    loadSelections();
+    auto watcher = new QFutureWatcher<DataProxy::RequestResult>(this);
+    connect(watcher, &QFutureWatcher<DataProxy::RequestResult>::finished, this, [=]() {
+        m_waiting_spinner->stop();
+        const auto result = watcher->result();
+        if (!result.ok()) {
+            QMessageBox::critical(this, result.error->name(), result.error->description());
+        }
+        watcher->deleteLater();
+        m_dataProxy->removeSelection(selectionObject->id(), false);
+        // update the selections
+        loadSelections();
+    });
+    watcher->setFuture(m_dataProxy->addUserSelectionAsync(*selectionObject));
 }
 
 void UserSelectionsPage::slotShowTable()
@@ -394,3 +451,27 @@ void UserSelectionsPage::slotImportSelection()
 {
     // TODO
 }
+
+void UserSelectionsPage::slotSelectionContextMenu(const QPoint &pos)
+{
+    const auto selected = m_ui->selections_tableView->userSelecionTableItemSelection();
+    const auto currentSelections = selectionsModel()->getSelections(selected);
+    // only one selection of the database can be pinned at a time
+    if (currentSelections.size() != 1 || !currentSelections.front()->saved()) {
+        return;
+    }
+    const auto selection = currentSelections.front();
+
+    QMenu menu(this);
+    QAction *pin = menu.addAction(tr("Available offline"));
+    pin->setCheckable(true);
+    pin->setChecked(m_dataProxy->isSelectionPinned(selection->id()));
+    if (menu.exec(m_ui->selections_tableView->viewport()->mapToGlobal(pos)) != pin) {
+        return;
+    }
+    if (pin->isChecked()) {
+        m_dataProxy->pinSelection(selection);
+    } else {
+        m_dataProxy->unpinSelection(selection->id());
+    }
+}
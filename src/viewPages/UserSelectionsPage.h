@@ -71,6 +71,8 @@ private slots:
     void slotShowTable();
     // to import a selection from a file
     void slotImportSelection();
+    // shows the menu to pin the selected selection for offline use
+    void slotSelectionContextMenu(const QPoint &pos);
 
 protected:
     void showEvent(QShowEvent *event);